@@ -3,11 +3,16 @@
 #include <QApplication>
 #include <QSize>
 #include <login.h>
+#include "asynclog.h"
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+    // 此时 log.h 中的 logger 已注册，之后的 LOG_* 只入环，由写线程落盘
+    zg::log::installAsyncBackend();
     Login w;
     w.show();
-    return a.exec();
+    const int ret = a.exec();
+    zg::log::shutdownAsyncBackend();
+    return ret;
 }
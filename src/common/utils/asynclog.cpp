@@ -0,0 +1,388 @@
+#include "asynclog.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <utility>
+
+namespace zg::log {
+
+namespace {
+// 槽位预留的字节数，更长的消息首次写入该槽位时扩容，之后复用
+constexpr size_t kReservedBytes = 256;
+// 写线程空闲时的等待上限；调用线程只在环过半时才唤醒写线程，平时不进内核
+constexpr auto kIdleWait = std::chrono::milliseconds(5);
+
+std::mutex g_mutex;
+std::shared_ptr<AsyncLogBackend> g_backend;
+}
+
+AsyncLogBackend::AsyncLogBackend(const AsyncOptions &options)
+    : options_(options)
+{
+    size_t capacity = 2;
+    while (capacity < static_cast<size_t>(std::max(2, options_.capacity)))
+        capacity *= 2;
+    options_.capacity = static_cast<int>(capacity);
+    mask_ = capacity - 1;
+
+    slots_.reset(new Slot[capacity]);
+    for (size_t i = 0; i < capacity; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+        slots_[i].payload.reserve(kReservedBytes);
+    }
+    current_.payload.reserve(kReservedBytes);
+}
+
+AsyncLogBackend::~AsyncLogBackend()
+{
+    stop();
+}
+
+int AsyncLogBackend::addRoute(std::vector<spdlog::sink_ptr> sinks)
+{
+    routes_.push_back(std::move(sinks));
+    return static_cast<int>(routes_.size()) - 1;
+}
+
+void AsyncLogBackend::start()
+{
+    if (thread_.joinable())
+        return;
+    stopping_ = false;
+    drained_.store(false, std::memory_order_relaxed);
+    running_.store(true);
+    thread_ = std::thread([this]() { run(); });
+}
+
+void AsyncLogBackend::stop()
+{
+    if (!thread_.joinable())
+        return;
+
+    // 新日志不再入环；已在入环途中的调用（含 Block 策略下等待槽位的）由仍在运行的写线程配合完成，
+    // 全部退出后再结束写线程，保证不会有消息落在最后一次清空之后
+    running_.store(false);
+    while (pushers_.load() != 0)
+        std::this_thread::yield();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_one();
+    thread_.join();
+
+    // 写线程退出前正在入环的几条
+    while (tryPop(true)) {
+    }
+    reportDropped();
+    flushSinks();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flushDone_ = flushRequested_;
+    }
+    flushed_.notify_all();
+    // 此后的同步直写排在环中所有消息之后
+    drained_.store(true, std::memory_order_release);
+}
+
+void AsyncLogBackend::push(int route, const spdlog::details::log_msg &msg)
+{
+    // 与 stop() 配对：先登记再检查 running_（均为 seq_cst），stop() 要么看到登记并等待，要么这里看到已停止
+    pushers_.fetch_add(1);
+    if (!running_.load()) {
+        pushers_.fetch_sub(1);
+        // stop() 正在清空时等它写完，直写的消息不会排到环中旧消息之前
+        while (!drained_.load(std::memory_order_acquire))
+            std::this_thread::yield();
+        writeDirect(route, msg);
+        return;
+    }
+    if (!tryPush(route, msg))
+        pushOverflow(route, msg);
+    pushers_.fetch_sub(1, std::memory_order_release);
+}
+
+void AsyncLogBackend::pushOverflow(int route, const spdlog::details::log_msg &msg)
+{
+    switch (options_.overflow) {
+    case OverflowPolicy::DropNewest:
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case OverflowPolicy::DropOldest:
+        // 队列为 MPMC，调用线程可以直接从队首取走一条丢弃
+        do {
+            if (tryPop(false))
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+        } while (!tryPush(route, msg));
+        break;
+    case OverflowPolicy::Block:
+        // stop() 会等本调用结束后才结束写线程，这里总能等到槽位
+        wake();
+        while (!tryPush(route, msg))
+            std::this_thread::yield();
+        break;
+    }
+}
+
+void AsyncLogBackend::flush(int route)
+{
+    if (!running_.load()) {
+        // 已停止时只 flush 本路由，其它路由所属的 logger 可能已经释放
+        for (const spdlog::sink_ptr &sink : routes_[route])
+            sink->flush();
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    const uint64_t ticket = ++flushRequested_;
+    wakeup_.notify_one();
+    flushed_.wait(lock, [this, ticket]() { return flushDone_ >= ticket || stopping_; });
+}
+
+AsyncStats AsyncLogBackend::stats() const
+{
+    AsyncStats stats;
+    stats.enqueued = enqueuePos_.load(std::memory_order_relaxed);
+    stats.written = written_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.capacity = options_.capacity;
+    return stats;
+}
+
+bool AsyncLogBackend::tryPush(int route, const spdlog::details::log_msg &msg)
+{
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    Slot *slot = nullptr;
+    for (;;) {
+        slot = &slots_[pos & mask_];
+        const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false;                       // 满
+        } else {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->time = msg.time;
+    slot->source = msg.source;
+    slot->threadId = msg.thread_id;
+    slot->level = msg.level;
+    slot->route = route;
+    slot->logger.assign(msg.logger_name.data(), msg.logger_name.size());
+    slot->payload.assign(msg.payload.data(), msg.payload.size());
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    // 环已过半而写线程还在空闲等待时才唤醒，其余情况由写线程按 kIdleWait 轮询
+    if (sleeping_.load(std::memory_order_relaxed)
+        && pos - dequeuePos_.load(std::memory_order_relaxed) >= (mask_ + 1) / 2)
+        wake();
+    return true;
+}
+
+bool AsyncLogBackend::tryPop(bool forward)
+{
+    size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    Slot *slot = nullptr;
+    for (;;) {
+        slot = &slots_[pos & mask_];
+        const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false;                       // 空，或队首的槽位还在写入
+        } else {
+            pos = dequeuePos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    if (!forward) {
+        slot->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 与 current_ 交换字符串（双方都保有预留容量），先归还槽位再写下游，慢 sink 不占用环
+    current_.time = slot->time;
+    current_.source = slot->source;
+    current_.threadId = slot->threadId;
+    current_.level = slot->level;
+    current_.route = slot->route;
+    current_.logger.swap(slot->logger);
+    current_.payload.swap(slot->payload);
+    slot->sequence.store(pos + mask_ + 1, std::memory_order_release);
+
+    write(current_);
+    written_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void AsyncLogBackend::write(const Slot &slot)
+{
+    spdlog::details::log_msg msg(slot.time, slot.source, slot.logger, slot.level, slot.payload);
+    msg.thread_id = slot.threadId;
+    for (const spdlog::sink_ptr &sink : routes_[slot.route]) {
+        if (!sink->should_log(msg.level))
+            continue;
+        try {
+            sink->log(msg);
+        } catch (const std::exception &e) {
+            std::fprintf(stderr, "async log sink error: %s\n", e.what());
+        }
+    }
+}
+
+void AsyncLogBackend::writeDirect(int route, const spdlog::details::log_msg &msg)
+{
+    for (const spdlog::sink_ptr &sink : routes_[route]) {
+        if (sink->should_log(msg.level))
+            sink->log(msg);
+    }
+}
+
+void AsyncLogBackend::reportDropped()
+{
+    const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped == reportedDropped_ || routes_.empty())
+        return;
+    const std::string text = "async log overflow, " + std::to_string(dropped - reportedDropped_) + " messages dropped";
+    reportedDropped_ = dropped;
+    spdlog::details::log_msg msg(spdlog::source_loc(), "log", spdlog::level::warn, text);
+    for (const auto &route : routes_) {
+        for (const spdlog::sink_ptr &sink : route) {
+            if (sink->should_log(msg.level))
+                sink->log(msg);
+        }
+    }
+}
+
+void AsyncLogBackend::flushSinks()
+{
+    for (const auto &route : routes_) {
+        for (const spdlog::sink_ptr &sink : route)
+            sink->flush();
+    }
+}
+
+void AsyncLogBackend::wake()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    wakeup_.notify_one();
+}
+
+void AsyncLogBackend::run()
+{
+    const auto flushInterval = std::chrono::milliseconds(std::max(1, options_.flushIntervalMs));
+    auto lastFlush = std::chrono::steady_clock::now();
+    for (;;) {
+        // 先取请求再清空环：flush() 之前入环的消息一定在这次清空中写出
+        uint64_t requested = 0;
+        bool stopping = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            requested = flushRequested_;
+            stopping = stopping_;
+        }
+
+        while (tryPop(true)) {
+        }
+        reportDropped();
+
+        const auto now = std::chrono::steady_clock::now();
+        if (requested != flushDone_ || now - lastFlush >= flushInterval) {
+            flushSinks();
+            lastFlush = now;
+            if (requested != flushDone_) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    flushDone_ = requested;
+                }
+                flushed_.notify_all();
+            }
+        }
+        if (stopping)
+            return;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleeping_.store(true, std::memory_order_relaxed);
+        if (!stopping_ && flushRequested_ == flushDone_)
+            wakeup_.wait_for(lock, kIdleWait);
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+}
+
+AsyncLogSink::AsyncLogSink(std::shared_ptr<AsyncLogBackend> backend, int route)
+    : backend_(std::move(backend))
+    , route_(route)
+{
+}
+
+void AsyncLogSink::log(const spdlog::details::log_msg &msg)
+{
+    backend_->push(route_, msg);
+}
+
+void AsyncLogSink::flush()
+{
+    backend_->flush(route_);
+}
+
+void AsyncLogSink::set_pattern(const std::string &pattern)
+{
+    for (const spdlog::sink_ptr &sink : backend_->routeSinks(route_))
+        sink->set_pattern(pattern);
+}
+
+void AsyncLogSink::set_formatter(std::unique_ptr<spdlog::formatter> formatter)
+{
+    for (const spdlog::sink_ptr &sink : backend_->routeSinks(route_))
+        sink->set_formatter(formatter->clone());
+}
+
+void installAsyncBackend(const AsyncOptions &options)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_backend)
+        return;
+
+    // 只在启动时、其它线程开始写日志之前调用：替换 logger 的 sinks 本身不是线程安全的
+    auto backend = std::make_shared<AsyncLogBackend>(options);
+    spdlog::apply_all([&backend](const std::shared_ptr<spdlog::logger> &logger) {
+        std::vector<spdlog::sink_ptr> &sinks = logger->sinks();
+        // 上一次 shutdown 留下的 AsyncLogSink 换回它背后的下游 sink，避免两层转发
+        if (sinks.size() == 1) {
+            if (auto previous = std::dynamic_pointer_cast<AsyncLogSink>(sinks.front()))
+                sinks = previous->targets();
+        }
+        const int route = backend->addRoute(sinks);
+        sinks.assign(1, std::make_shared<AsyncLogSink>(backend, route));
+    });
+    backend->start();
+    g_backend = std::move(backend);
+}
+
+void shutdownAsyncBackend()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!g_backend)
+        return;
+    // 其它线程可能仍在写日志并遍历 logger 的 sinks，不能替换这个 vector。
+    // stop() 写完环中剩余消息后，AsyncLogSink 自动改为同步直写下游，顺序也不会乱；
+    // backend 由各 AsyncLogSink 持有，随 logger 一起释放
+    g_backend->stop();
+    g_backend.reset();
+}
+
+AsyncStats asyncStats()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_backend ? g_backend->stats() : AsyncStats();
+}
+
+} // namespace zg::log
@@ -0,0 +1,135 @@
+#ifndef ASYNCLOG_H
+#define ASYNCLOG_H
+
+#include <spdlog/sinks/sink.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace zg::log {
+
+// 环满时的处理：Block 等待写线程腾出槽位；DropOldest 丢弃环中最早的一条；DropNewest 丢弃当前这条
+enum class OverflowPolicy { Block, DropOldest, DropNewest };
+
+struct AsyncOptions {
+    int capacity = 8192;                        // 槽位数，向上取 2 的幂
+    OverflowPolicy overflow = OverflowPolicy::DropOldest;
+    int flushIntervalMs = 1000;                 // 写线程定期 flush 下游 sink
+};
+
+struct AsyncStats {
+    uint64_t enqueued = 0;
+    uint64_t written = 0;
+    uint64_t dropped = 0;
+    int capacity = 0;
+};
+
+// 异步日志后端：预分配的有界无锁环（Vyukov MPMC 队列，按 MPSC 使用）加一个写线程。
+// 调用线程只做 spdlog 自身的格式化并把结果拷进槽位（槽位内的 std::string 预留了容量，一般不分配），
+// 写线程取出后交给原来的 sink 按各自的 pattern 输出。每个 logger 一条路由，保留各自的下游 sink。
+// 丢弃的条数计入统计，写线程随后以一条 warn 输出。flush() 会等写线程处理完此前的消息再 flush 下游，
+// 因此 flush_on 级别以上的日志仍是同步落盘的。stop() 之后的日志直接同步写下游。
+class AsyncLogBackend
+{
+public:
+    explicit AsyncLogBackend(const AsyncOptions& options);
+    ~AsyncLogBackend();
+
+    AsyncLogBackend(const AsyncLogBackend&) = delete;
+    AsyncLogBackend& operator=(const AsyncLogBackend&) = delete;
+
+    // 只能在 start() 之前调用
+    int addRoute(std::vector<spdlog::sink_ptr> sinks);
+    const std::vector<spdlog::sink_ptr>& routeSinks(int route) const { return routes_[route]; }
+
+    void start();
+    // 处理完环中剩余的消息后结束写线程
+    void stop();
+
+    void push(int route, const spdlog::details::log_msg& msg);
+    // 运行中：等写线程写完此前的消息并 flush 全部下游；已停止：同步 flush 该路由
+    void flush(int route);
+    AsyncStats stats() const;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<size_t> sequence{0};
+        spdlog::log_clock::time_point time;
+        spdlog::source_loc source;
+        size_t threadId = 0;
+        spdlog::level::level_enum level = spdlog::level::info;
+        int route = 0;
+        std::string logger;
+        std::string payload;
+    };
+
+    void pushOverflow(int route, const spdlog::details::log_msg& msg);
+    bool tryPush(int route, const spdlog::details::log_msg& msg);
+    bool tryPop(bool forward);
+    void write(const Slot& slot);
+    void writeDirect(int route, const spdlog::details::log_msg& msg);
+    void reportDropped();
+    void flushSinks();
+    void wake();
+    void run();
+
+    AsyncOptions options_;
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+    std::atomic<int> pushers_{0};               // 正在入环的调用数，与 enqueuePos_ 同一缓存行
+    alignas(64) std::atomic<size_t> dequeuePos_{0};
+    alignas(64) std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<bool> sleeping_{false};
+    std::atomic<bool> running_{false};
+    std::atomic<bool> drained_{true};           // 未启动或 stop() 已清空环，可以同步直写
+
+    std::vector<std::vector<spdlog::sink_ptr>> routes_;
+    Slot current_;                              // 写线程取出的消息，槽位在写下游前即归还
+    uint64_t reportedDropped_ = 0;              // 写线程已报告的丢弃数
+
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::condition_variable flushed_;
+    uint64_t flushRequested_ = 0;               // 以下由 mutex_ 保护
+    uint64_t flushDone_ = 0;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+// 替代 logger 原有 sinks 的 spdlog sink，log() 只入环
+class AsyncLogSink : public spdlog::sinks::sink
+{
+public:
+    AsyncLogSink(std::shared_ptr<AsyncLogBackend> backend, int route);
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void flush() override;
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override;
+
+    const std::vector<spdlog::sink_ptr>& targets() const { return backend_->routeSinks(route_); }
+
+private:
+    std::shared_ptr<AsyncLogBackend> backend_;
+    int route_ = 0;
+};
+
+// 把已注册到 spdlog 的 logger（log.h 中的 CORE / APP 等）切换到异步后端，LOG_* 宏无需改动。
+// 重复调用无效；之后新注册的 logger 不受影响
+void installAsyncBackend(const AsyncOptions& options = AsyncOptions());
+// 退出前调用：写完剩余日志、结束写线程。logger 保留 AsyncLogSink，之后的日志同步直写原来的 sinks，
+// 调用时其它线程可以继续写日志
+void shutdownAsyncBackend();
+AsyncStats asyncStats();
+
+} // namespace zg::log
+
+#endif // ASYNCLOG_H
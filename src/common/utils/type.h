@@ -120,6 +120,18 @@ namespace zg::path{
         return QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
     }
 
+    // 弹幕屏蔽词表，一行一个关键词（热更新使用）
+    inline QString danmuBlocklist() {
+        return appDataRoot() + "/danmu_blocklist.txt";
+    }
+
+    // 视频缩略图缓存（按内容指纹寻址）
+    inline QString thumbnailCacheDir() {
+        QString dir = cacheDir() + "/thumbnails";
+        ensureDir(dir);
+        return dir;
+    }
+
     // Temp
     inline QString tempDir() {
         QString temp = appDataRoot() + "/temp";
@@ -0,0 +1,219 @@
+#include "audiooutput.h"
+#include "playbackclock.h"
+
+#include <QAudioSink>
+#include <QMediaDevices>
+#include <QAudioDevice>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+// 写入 pts 与按字节推算的 pts 偏差超过该值（秒）时视为不连续
+constexpr double kDiscontinuityThreshold = 0.05;
+// 缓冲时长：足够吸收解码抖动，又不至于让视频等待过久
+constexpr double kRingSeconds = 0.5;
+}
+
+// ---------------- AudioRingDevice ----------------
+
+AudioRingDevice::AudioRingDevice(QObject *parent)
+    : QIODevice(parent)
+{
+}
+
+void AudioRingDevice::configure(int bytesPerSecond, double capacitySeconds, PlaybackClock *clock)
+{
+    QMutexLocker locker(&mutex_);
+    bytesPerSecond_ = bytesPerSecond;
+    clock_ = clock;
+    ring_.assign(static_cast<size_t>(std::max(4096.0, bytesPerSecond * capacitySeconds)), 0);
+    readTotal_ = 0;
+    writeTotal_ = 0;
+    markerHead_ = 0;
+    markerCount_ = 0;
+    hasWriteBase_ = false;
+    hasReadBase_ = false;
+    aborted_ = false;
+}
+
+void AudioRingDevice::setOutputLatency(double seconds)
+{
+    QMutexLocker locker(&mutex_);
+    outputLatency_ = seconds;
+}
+
+bool AudioRingDevice::writePcm(const uint8_t *data, int bytes, double pts)
+{
+    QMutexLocker locker(&mutex_);
+    if (ring_.empty() || bytesPerSecond_ <= 0)
+        return false;
+
+    // 记录不连续点，读端据此修正时钟基准
+    const double expected = hasWriteBase_
+        ? writeBase_.pts + double(writeTotal_ - writeBase_.offset) / bytesPerSecond_
+        : 0.0;
+    if (!hasWriteBase_ || std::abs(pts - expected) > kDiscontinuityThreshold) {
+        writeBase_ = PtsMarker{ writeTotal_, pts };
+        hasWriteBase_ = true;
+        if (markerCount_ < kMaxMarkers) {
+            markers_[(markerHead_ + markerCount_) % kMaxMarkers] = writeBase_;
+            ++markerCount_;
+        }
+    }
+
+    const qint64 capacity = static_cast<qint64>(ring_.size());
+    int written = 0;
+    while (written < bytes) {
+        while (!aborted_ && writeTotal_ - readTotal_ >= capacity)
+            notFull_.wait(&mutex_);
+        if (aborted_)
+            return false;
+
+        const qint64 space = capacity - (writeTotal_ - readTotal_);
+        const qint64 pos = writeTotal_ % capacity;
+        const qint64 chunk = std::min<qint64>({ space, bytes - written, capacity - pos });
+        std::memcpy(ring_.data() + pos, data + written, static_cast<size_t>(chunk));
+        writeTotal_ += chunk;
+        written += static_cast<int>(chunk);
+    }
+    return true;
+}
+
+void AudioRingDevice::abort()
+{
+    QMutexLocker locker(&mutex_);
+    aborted_ = true;
+    notFull_.wakeAll();
+}
+
+void AudioRingDevice::reset()
+{
+    discard();
+    QMutexLocker locker(&mutex_);
+    aborted_ = false;
+}
+
+void AudioRingDevice::discard()
+{
+    QMutexLocker locker(&mutex_);
+    readTotal_ = writeTotal_;
+    markerHead_ = 0;
+    markerCount_ = 0;
+    hasWriteBase_ = false;
+    hasReadBase_ = false;
+    notFull_.wakeAll();
+}
+
+double AudioRingDevice::bufferedSeconds() const
+{
+    QMutexLocker locker(&mutex_);
+    if (bytesPerSecond_ <= 0)
+        return 0.0;
+    return double(writeTotal_ - readTotal_) / bytesPerSecond_;
+}
+
+qint64 AudioRingDevice::bytesAvailable() const
+{
+    QMutexLocker locker(&mutex_);
+    return (writeTotal_ - readTotal_) + QIODevice::bytesAvailable();
+}
+
+qint64 AudioRingDevice::readData(char *data, qint64 maxSize)
+{
+    QMutexLocker locker(&mutex_);
+    const qint64 capacity = static_cast<qint64>(ring_.size());
+    if (capacity == 0)
+        return 0;
+
+    qint64 read = 0;
+    while (read < maxSize && readTotal_ < writeTotal_) {
+        const qint64 pos = readTotal_ % capacity;
+        const qint64 chunk = std::min<qint64>({ maxSize - read, writeTotal_ - readTotal_, capacity - pos });
+        std::memcpy(data + read, ring_.data() + pos, static_cast<size_t>(chunk));
+        readTotal_ += chunk;
+        read += chunk;
+    }
+
+    if (read > 0) {
+        notFull_.wakeAll();
+
+        while (markerCount_ > 0 && markers_[markerHead_].offset <= readTotal_) {
+            readBase_ = markers_[markerHead_];
+            hasReadBase_ = true;
+            markerHead_ = (markerHead_ + 1) % kMaxMarkers;
+            --markerCount_;
+        }
+
+        // 刚交给设备的数据要经过设备缓冲才会被听到
+        if (hasReadBase_ && clock_) {
+            const double pts = readBase_.pts
+                + double(readTotal_ - readBase_.offset) / bytesPerSecond_
+                - outputLatency_;
+            clock_->setAudioTime(pts);
+        }
+    }
+    return read;
+}
+
+qint64 AudioRingDevice::writeData(const char *, qint64)
+{
+    return -1;  // 只读设备，生产者通过 writePcm 写入
+}
+
+// ---------------- AudioOutput ----------------
+
+AudioOutput::AudioOutput(QObject *parent)
+    : QObject(parent)
+    , device_(new AudioRingDevice(this))
+{
+}
+
+AudioOutput::~AudioOutput()
+{
+    stop();
+}
+
+QAudioFormat AudioOutput::outputFormat()
+{
+    QAudioFormat format;
+    format.setSampleRate(48000);
+    format.setChannelCount(2);
+    format.setSampleFormat(QAudioFormat::Int16);
+    return format;
+}
+
+void AudioOutput::prepare(PlaybackClock *clock)
+{
+    device_->configure(outputFormat().bytesForDuration(1000000), kRingSeconds, clock);
+}
+
+void AudioOutput::start()
+{
+    stop();
+
+    const QAudioFormat format = outputFormat();
+    const QAudioDevice outputDevice = QMediaDevices::defaultAudioOutput();
+    if (outputDevice.isNull() || !outputDevice.isFormatSupported(format)) {
+        qWarning() << "Audio output unavailable, falling back to wall clock";
+        device_->abort();
+        return;
+    }
+
+    device_->open(QIODevice::ReadOnly);
+
+    sink_ = new QAudioSink(outputDevice, format, this);
+    sink_->start(device_);
+    device_->setOutputLatency(double(format.durationForBytes(sink_->bufferSize())) / 1e6);
+}
+
+void AudioOutput::stop()
+{
+    if (!sink_)
+        return;
+    sink_->stop();
+    delete sink_;
+    sink_ = nullptr;
+    device_->close();
+}
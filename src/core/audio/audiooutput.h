@@ -0,0 +1,95 @@
+#ifndef AUDIOOUTPUT_H
+#define AUDIOOUTPUT_H
+
+#include <QObject>
+#include <QIODevice>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAudioFormat>
+#include <vector>
+
+class QAudioSink;
+class PlaybackClock;
+
+// 解码线程写入、音频设备拉取的 PCM 环形缓冲。
+// 设备每次读取时按已播放字节数推算当前播放位置，驱动 PlaybackClock。
+class AudioRingDevice : public QIODevice
+{
+    Q_OBJECT
+public:
+    explicit AudioRingDevice(QObject *parent = nullptr);
+
+    // bytesPerSecond 用于字节数与时间互换，capacitySeconds 决定缓冲时长
+    void configure(int bytesPerSecond, double capacitySeconds, PlaybackClock *clock);
+    void setOutputLatency(double seconds);
+
+    // 生产者：缓冲满时阻塞，abort() 后返回 false
+    bool writePcm(const uint8_t *data, int bytes, double pts);
+    void abort();
+    void reset();
+    // 跳转时丢弃尚未播放的数据，保留 abort 状态
+    void discard();
+
+    double bufferedSeconds() const;
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    // 写入端遇到 pts 不连续（首包、丢包、跳转）时记录的位置标记
+    struct PtsMarker {
+        qint64 offset = 0;
+        double pts = 0.0;
+    };
+    static constexpr int kMaxMarkers = 64;
+
+    mutable QMutex mutex_;
+    QWaitCondition notFull_;
+    std::vector<char> ring_;
+    qint64 readTotal_ = 0;
+    qint64 writeTotal_ = 0;
+    bool aborted_ = false;
+
+    int bytesPerSecond_ = 0;
+    double outputLatency_ = 0.0;
+    PlaybackClock *clock_ = nullptr;
+
+    PtsMarker markers_[kMaxMarkers];
+    int markerHead_ = 0;
+    int markerCount_ = 0;
+    PtsMarker writeBase_;
+    PtsMarker readBase_;
+    bool hasWriteBase_ = false;
+    bool hasReadBase_ = false;
+};
+
+// 音频输出：持有 QAudioSink（拉模式），需在 GUI 线程创建和启动
+class AudioOutput : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AudioOutput(QObject *parent = nullptr);
+    ~AudioOutput() override;
+
+    // 解码端统一重采样到该格式
+    static QAudioFormat outputFormat();
+
+    AudioRingDevice *device() { return device_; }
+    bool isActive() const { return sink_ != nullptr; }
+
+    // 任意线程：按输出格式重置环形缓冲并绑定时钟，之后即可写入 PCM
+    void prepare(PlaybackClock *clock);
+    // GUI 线程：打开默认输出设备开始拉取；设备不可用时中止缓冲，写端随即返回 false
+    void start();
+    void stop();
+
+private:
+    QAudioSink *sink_ = nullptr;
+    AudioRingDevice *device_ = nullptr;
+};
+
+#endif // AUDIOOUTPUT_H
@@ -0,0 +1,283 @@
+#include "yuvconvert.h"
+#include "yuvconvert_p.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+inline int sat16(int x)
+{
+    return x < -32768 ? -32768 : (x > 32767 ? 32767 : x);
+}
+
+inline int mulhi(int a, int b)
+{
+    return (a * b) >> 16;
+}
+
+inline uint8_t toPixel(int x)
+{
+    x >>= 6;
+    return static_cast<uint8_t>(x < 0 ? 0 : (x > 255 ? 255 : x));
+}
+
+YuvCoefficients makeCoefficients(const YuvConverter::Options &options)
+{
+    const bool bt709 = options.colorSpace == YuvConverter::ColorSpace::Bt709;
+    const double kr = bt709 ? 0.2126 : 0.299;
+    const double kb = bt709 ? 0.0722 : 0.114;
+    const double kg = 1.0 - kr - kb;
+    const double rv = 2.0 * (1.0 - kr);
+    const double bu = 2.0 * (1.0 - kb);
+    const double gu = bu * kb / kg;
+    const double gv = rv * kr / kg;
+
+    // 有限范围先拉伸到 [0, 255]，与 RenderOpenGL 着色器中的矩阵一致
+    const double ys = options.fullRange ? 1.0 : 255.0 / 219.0;
+    const double cs = options.fullRange ? 1.0 : 255.0 / 224.0;
+    const double yOffset = options.fullRange ? 0.0 : 16.0;
+
+    const auto q14 = [](double v) { return static_cast<int16_t>(std::lround(v * 16384.0)); };
+    YuvCoefficients k;
+    k.cy = q14(ys);
+    k.yBias = static_cast<int16_t>(32 - std::lround(yOffset * ys * 64.0));
+    k.crv = q14(rv * cs);
+    k.cgu = q14(gu * cs);
+    k.cgv = q14(gv * cs);
+    k.cbu1 = q14(bu * cs - 1.0);
+    return k;
+}
+
+YuvRowKernel kernelFor(YuvConverter::Isa isa)
+{
+    switch (isa) {
+#ifdef YUVCONVERT_X86
+    case YuvConverter::Isa::Avx2: return &yuvRowAvx2;
+    case YuvConverter::Isa::Sse2: return &yuvRowSse2;
+#endif
+    default: return &yuvRowScalar;
+    }
+}
+
+std::atomic<YuvConverter::Isa> &activeIsa()
+{
+    static std::atomic<YuvConverter::Isa> isa{YuvConverter::bestSupportedIsa()};
+    return isa;
+}
+
+// 缩放时目标坐标到源坐标的映射（像素中心对齐），权重为 8 位定点
+struct Tap {
+    int index0 = 0;
+    int index1 = 0;
+    int weight = 0;   // index1 的权重，0..256
+};
+
+void makeTaps(int srcSize, int dstSize, std::vector<Tap> &taps)
+{
+    taps.resize(static_cast<size_t>(dstSize));
+    const double ratio = double(srcSize) / dstSize;
+    for (int i = 0; i < dstSize; ++i) {
+        const double pos = std::clamp((i + 0.5) * ratio - 0.5, 0.0, double(srcSize - 1));
+        Tap &tap = taps[static_cast<size_t>(i)];
+        tap.index0 = static_cast<int>(pos);
+        tap.index1 = std::min(tap.index0 + 1, srcSize - 1);
+        tap.weight = static_cast<int>(std::lround((pos - tap.index0) * 256.0));
+    }
+}
+
+// 两行源数据按行权重 wy 与列映射双线性插值；step 为同一分量相邻样本的字节间距（NV12 为 2）
+void resampleRow(const uint8_t *row0, const uint8_t *row1, int wy, int step,
+                 const std::vector<Tap> &taps, uint8_t *out)
+{
+    const int wy0 = 256 - wy;
+    for (size_t i = 0; i < taps.size(); ++i) {
+        const Tap &tap = taps[i];
+        const int a = row0[tap.index0 * step] * (256 - tap.weight) + row0[tap.index1 * step] * tap.weight;
+        const int b = row1[tap.index0 * step] * (256 - tap.weight) + row1[tap.index1 * step] * tap.weight;
+        out[i] = static_cast<uint8_t>((a * wy0 + b * wy + 32768) >> 16);
+    }
+}
+
+void deinterleave(const uint8_t *uv, uint8_t *u, uint8_t *v, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        u[i] = uv[2 * i];
+        v[i] = uv[2 * i + 1];
+    }
+}
+
+}
+
+struct YuvConverter::Workspace::Data {
+    int srcWidth = 0;
+    int srcHeight = 0;
+    int dstWidth = 0;
+    int dstHeight = 0;
+    std::vector<Tap> lumaX;
+    std::vector<Tap> lumaY;
+    std::vector<Tap> chromaX;
+    std::vector<Tap> chromaY;
+    std::vector<uint8_t> rowY;
+    std::vector<uint8_t> rowU;      // NV12 原尺寸时存放拆分后的 U、V 两段
+    std::vector<uint8_t> rowV;
+};
+
+YuvConverter::Workspace::Workspace()
+    : d_(new Data)
+{
+}
+
+YuvConverter::Workspace::~Workspace() = default;
+
+void yuvRowScalar(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                  uint8_t *dst, int width, const YuvCoefficients &k)
+{
+    const int cy = static_cast<uint16_t>(k.cy);
+    for (int x = 0; x < width; ++x) {
+        const int y1 = sat16(((y[x] << 8) * cy >> 16) + k.yBias);
+        const int cu = (u[x >> 1] - 128) * 256;
+        const int cv = (v[x >> 1] - 128) * 256;
+
+        dst[0] = toPixel(sat16(y1 + mulhi(cv, k.crv)));
+        dst[1] = toPixel(sat16(sat16(y1 - mulhi(cu, k.cgu)) - mulhi(cv, k.cgv)));
+        dst[2] = toPixel(sat16(sat16(y1 + (cu >> 2)) + mulhi(cu, k.cbu1)));
+        dst[3] = 0xff;
+        dst += 4;
+    }
+}
+
+void YuvConverter::toRgba(const Source &src, uint8_t *dst, int dstStride, int dstWidth, int dstHeight,
+                          const Options &options)
+{
+    thread_local Workspace workspace;
+    toRgba(src, dst, dstStride, dstWidth, dstHeight, options, workspace);
+}
+
+void YuvConverter::toRgba(const Source &src, uint8_t *dst, int dstStride, int dstWidth, int dstHeight,
+                          const Options &options, Workspace &workspace)
+{
+    if (src.width <= 0 || src.height <= 0 || dstWidth <= 0 || dstHeight <= 0)
+        return;
+
+    const YuvCoefficients k = makeCoefficients(options);
+    const YuvRowKernel kernel = kernelFor(activeIsa().load(std::memory_order_relaxed));
+    const bool nv12 = src.format == Format::NV12;
+    const int srcChromaWidth = (src.width + 1) / 2;
+    const int srcChromaHeight = (src.height + 1) / 2;
+    const auto outputRow = [&](int row) {
+        return dst + static_cast<ptrdiff_t>(options.flipVertical ? dstHeight - 1 - row : row) * dstStride;
+    };
+
+    // 尺寸变化时才重建系数表；resize 不缩小容量，稳态下不分配
+    Workspace::Data &w = *workspace.d_;
+    const int dstChromaWidth = (dstWidth + 1) / 2;
+    if (w.srcWidth != src.width || w.srcHeight != src.height
+        || w.dstWidth != dstWidth || w.dstHeight != dstHeight) {
+        w.srcWidth = src.width;
+        w.srcHeight = src.height;
+        w.dstWidth = dstWidth;
+        w.dstHeight = dstHeight;
+        makeTaps(src.width, dstWidth, w.lumaX);
+        makeTaps(src.height, dstHeight, w.lumaY);
+        makeTaps(srcChromaWidth, dstChromaWidth, w.chromaX);
+        makeTaps(srcChromaHeight, (dstHeight + 1) / 2, w.chromaY);
+        w.rowY.resize(static_cast<size_t>(dstWidth));
+        w.rowU.resize(static_cast<size_t>(std::max(dstChromaWidth, srcChromaWidth * 2)));
+        w.rowV.resize(static_cast<size_t>(dstChromaWidth));
+    }
+
+    if (dstWidth == src.width && dstHeight == src.height) {
+        // 原尺寸：I420 直接按行调用内核；NV12 每个色度行拆分一次，供相邻两行亮度共用
+        uint8_t *chroma = w.rowU.data();
+        int splitRow = -1;
+        for (int row = 0; row < src.height; ++row) {
+            const int chromaRow = row >> 1;
+            const uint8_t *u = nullptr;
+            const uint8_t *v = nullptr;
+            if (nv12) {
+                if (chromaRow != splitRow) {
+                    deinterleave(src.u + static_cast<ptrdiff_t>(chromaRow) * src.uStride,
+                                 chroma, chroma + srcChromaWidth, srcChromaWidth);
+                    splitRow = chromaRow;
+                }
+                u = chroma;
+                v = chroma + srcChromaWidth;
+            } else {
+                u = src.u + static_cast<ptrdiff_t>(chromaRow) * src.uStride;
+                v = src.v + static_cast<ptrdiff_t>(chromaRow) * src.vStride;
+            }
+            kernel(src.y + static_cast<ptrdiff_t>(row) * src.yStride, u, v, outputRow(row), src.width, k);
+        }
+        return;
+    }
+
+    // 缩放：逐行把亮度与色度双线性重采样到目标宽度，再交给同一个行内核，不落地中间帧
+    const std::vector<Tap> &lumaX = w.lumaX;
+    const std::vector<Tap> &lumaY = w.lumaY;
+    const std::vector<Tap> &chromaX = w.chromaX;
+    const std::vector<Tap> &chromaY = w.chromaY;
+    uint8_t *rowY = w.rowY.data();
+    uint8_t *rowU = w.rowU.data();
+    uint8_t *rowV = w.rowV.data();
+
+    int chromaRowDone = -1;
+    for (int row = 0; row < dstHeight; ++row) {
+        const Tap &ty = lumaY[static_cast<size_t>(row)];
+        resampleRow(src.y + static_cast<ptrdiff_t>(ty.index0) * src.yStride,
+                    src.y + static_cast<ptrdiff_t>(ty.index1) * src.yStride,
+                    ty.weight, 1, lumaX, rowY);
+
+        const int chromaRow = row >> 1;
+        if (chromaRow != chromaRowDone) {
+            const Tap &tc = chromaY[static_cast<size_t>(chromaRow)];
+            const uint8_t *u0 = src.u + static_cast<ptrdiff_t>(tc.index0) * src.uStride;
+            const uint8_t *u1 = src.u + static_cast<ptrdiff_t>(tc.index1) * src.uStride;
+            if (nv12) {
+                resampleRow(u0, u1, tc.weight, 2, chromaX, rowU);
+                resampleRow(u0 + 1, u1 + 1, tc.weight, 2, chromaX, rowV);
+            } else {
+                resampleRow(u0, u1, tc.weight, 1, chromaX, rowU);
+                resampleRow(src.v + static_cast<ptrdiff_t>(tc.index0) * src.vStride,
+                            src.v + static_cast<ptrdiff_t>(tc.index1) * src.vStride,
+                            tc.weight, 1, chromaX, rowV);
+            }
+            chromaRowDone = chromaRow;
+        }
+
+        kernel(rowY, rowU, rowV, outputRow(row), dstWidth, k);
+    }
+}
+
+YuvConverter::Isa YuvConverter::isa()
+{
+    return activeIsa().load(std::memory_order_relaxed);
+}
+
+void YuvConverter::setIsa(Isa isa)
+{
+    activeIsa().store(std::min(isa, bestSupportedIsa()), std::memory_order_relaxed);
+}
+
+YuvConverter::Isa YuvConverter::bestSupportedIsa()
+{
+#ifdef YUVCONVERT_X86
+    // x86-64 基线即包含 SSE2
+    static const Isa best = cpuSupportsAvx2() ? Isa::Avx2 : Isa::Sse2;
+    return best;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+const char *YuvConverter::isaName(Isa isa)
+{
+    switch (isa) {
+    case Isa::Avx2: return "avx2";
+    case Isa::Sse2: return "sse2";
+    default: return "scalar";
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef YUVCONVERT_H
+#define YUVCONVERT_H
+
+#include <cstdint>
+#include <memory>
+
+// YUV420P / NV12 → RGBA8888 转换，色彩转换、缩放与垂直翻转在同一遍内完成，
+// 不产生中间整帧。用于需要 CPU 端 RGB 图像的场合（截图、软件渲染回退）。
+// 行内核按 CPU 特性在运行时选择 AVX2 / SSE2 / 标量实现，三者输出逐字节一致。
+class YuvConverter
+{
+public:
+    enum class Format { I420, NV12 };
+    enum class ColorSpace { Bt601, Bt709 };
+    enum class Isa { Scalar, Sse2, Avx2 };
+
+    // I420 使用 y/u/v 三个平面；NV12 使用 y 和 u（交错 UV），v 忽略
+    struct Source {
+        Format format = Format::I420;
+        int width = 0;
+        int height = 0;
+        const uint8_t *y = nullptr;
+        const uint8_t *u = nullptr;
+        const uint8_t *v = nullptr;
+        int yStride = 0;
+        int uStride = 0;
+        int vStride = 0;
+    };
+
+    struct Options {
+        ColorSpace colorSpace = ColorSpace::Bt709;
+        bool fullRange = false;     // true 为 JPEG 全范围，否则 Y ∈ [16, 235]
+        bool flipVertical = false;  // 输出首行对应源末行（OpenGL 左下角原点）
+    };
+
+    // 缩放系数表与行缓冲，按（源尺寸, 目标尺寸）缓存；尺寸不变时逐帧复用，不再分配。
+    // 不可跨线程同时使用
+    class Workspace
+    {
+    public:
+        Workspace();
+        ~Workspace();
+        Workspace(const Workspace &) = delete;
+        Workspace &operator=(const Workspace &) = delete;
+
+    private:
+        friend class YuvConverter;
+        struct Data;
+        std::unique_ptr<Data> d_;
+    };
+
+    // dst 为 dstWidth × dstHeight 的 RGBA8888（字节序 R,G,B,A），尺寸与源不同时做双线性缩放。
+    // 源与目标宽高须为正数
+    static void toRgba(const Source &src, uint8_t *dst, int dstStride, int dstWidth, int dstHeight,
+                       const Options &options, Workspace &workspace);
+    // 使用本线程私有的 Workspace
+    static void toRgba(const Source &src, uint8_t *dst, int dstStride, int dstWidth, int dstHeight,
+                       const Options &options);
+
+    // 当前使用的行内核；setIsa 用于测试与基准，超出 CPU 能力时降到可用的最高级别
+    static Isa isa();
+    static void setIsa(Isa isa);
+    static Isa bestSupportedIsa();
+    static const char *isaName(Isa isa);
+};
+
+#endif // YUVCONVERT_H
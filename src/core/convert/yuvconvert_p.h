@@ -0,0 +1,39 @@
+#ifndef YUVCONVERT_P_H
+#define YUVCONVERT_P_H
+
+#include <cstdint>
+
+// 行内核共用的定点系数，所有实现按相同的 16 位整数运算顺序计算，保证结果逐字节一致：
+//   y1 = mulhi_u16(Y << 8, cy) + yBias                          （Q6，含 +32 舍入）
+//   c  = (C - 128) << 8                                         （有符号 16 位）
+//   R  = sat(y1 + mulhi(v, crv))
+//   G  = sat(sat(y1 - mulhi(u, cgu)) - mulhi(v, cgv))
+//   B  = sat(sat(y1 + (u >> 2)) + mulhi(u, cbu1))               （cbu 超出 Q14 范围，拆出整数 1）
+//   输出 = clamp(x >> 6, 0, 255)
+struct YuvCoefficients {
+    int16_t cy = 0;      // Q14，按无符号参与乘法
+    int16_t yBias = 0;   // Q6
+    int16_t crv = 0;     // Q14
+    int16_t cgu = 0;
+    int16_t cgv = 0;
+    int16_t cbu1 = 0;    // (cbu - 1) 的 Q14
+};
+
+// 将 width 个像素写入 dst；u/v 为半宽色度行，像素 x 取色度 x / 2
+using YuvRowKernel = void (*)(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                              uint8_t *dst, int width, const YuvCoefficients &k);
+
+void yuvRowScalar(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                  uint8_t *dst, int width, const YuvCoefficients &k);
+
+// 只在 x86-64 上启用 SIMD：SSE2 属于基线指令集，无需检测
+#if defined(__x86_64__) || defined(_M_X64)
+#define YUVCONVERT_X86 1
+void yuvRowSse2(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                uint8_t *dst, int width, const YuvCoefficients &k);
+void yuvRowAvx2(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                uint8_t *dst, int width, const YuvCoefficients &k);
+bool cpuSupportsAvx2();
+#endif
+
+#endif // YUVCONVERT_P_H
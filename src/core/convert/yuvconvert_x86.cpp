@@ -0,0 +1,159 @@
+#include "yuvconvert_p.h"
+
+#ifdef YUVCONVERT_X86
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define YUV_TARGET_AVX2
+#else
+// 按函数启用 AVX2，本文件其余部分和调用方无需 -mavx2
+#define YUV_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+
+// 8 个像素（16 位通道）的 R/G/B，公式见 yuvconvert_p.h
+struct Rgb16 {
+    __m128i r, g, b;
+};
+
+inline Rgb16 convert8(__m128i y, __m128i u, __m128i v, const YuvCoefficients &k)
+{
+    const __m128i y1 = _mm_adds_epi16(_mm_mulhi_epu16(y, _mm_set1_epi16(k.cy)), _mm_set1_epi16(k.yBias));
+    Rgb16 out;
+    out.r = _mm_adds_epi16(y1, _mm_mulhi_epi16(v, _mm_set1_epi16(k.crv)));
+    out.g = _mm_subs_epi16(_mm_subs_epi16(y1, _mm_mulhi_epi16(u, _mm_set1_epi16(k.cgu))),
+                           _mm_mulhi_epi16(v, _mm_set1_epi16(k.cgv)));
+    out.b = _mm_adds_epi16(_mm_adds_epi16(y1, _mm_srai_epi16(u, 2)),
+                           _mm_mulhi_epi16(u, _mm_set1_epi16(k.cbu1)));
+    return out;
+}
+
+YUV_TARGET_AVX2 inline void convert16x2(__m256i y, __m256i u, __m256i v, const YuvCoefficients &k,
+                                        __m256i *r, __m256i *g, __m256i *b)
+{
+    const __m256i y1 = _mm256_adds_epi16(_mm256_mulhi_epu16(y, _mm256_set1_epi16(k.cy)),
+                                         _mm256_set1_epi16(k.yBias));
+    *r = _mm256_adds_epi16(y1, _mm256_mulhi_epi16(v, _mm256_set1_epi16(k.crv)));
+    *g = _mm256_subs_epi16(_mm256_subs_epi16(y1, _mm256_mulhi_epi16(u, _mm256_set1_epi16(k.cgu))),
+                           _mm256_mulhi_epi16(v, _mm256_set1_epi16(k.cgv)));
+    *b = _mm256_adds_epi16(_mm256_adds_epi16(y1, _mm256_srai_epi16(u, 2)),
+                           _mm256_mulhi_epi16(u, _mm256_set1_epi16(k.cbu1)));
+}
+
+}
+
+void yuvRowSse2(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                uint8_t *dst, int width, const YuvCoefficients &k)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+    const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xff));
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i y8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x));
+        __m128i u8 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + x / 2));
+        __m128i v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + x / 2));
+        // 每个色度样本复制给相邻两个像素
+        u8 = _mm_unpacklo_epi8(u8, u8);
+        v8 = _mm_unpacklo_epi8(v8, v8);
+
+        // 字节放到高位得到 x << 8；色度再减 128 << 8 变为有符号
+        const Rgb16 lo = convert8(_mm_unpacklo_epi8(zero, y8),
+                                  _mm_xor_si128(_mm_unpacklo_epi8(zero, u8), bias),
+                                  _mm_xor_si128(_mm_unpacklo_epi8(zero, v8), bias), k);
+        const Rgb16 hi = convert8(_mm_unpackhi_epi8(zero, y8),
+                                  _mm_xor_si128(_mm_unpackhi_epi8(zero, u8), bias),
+                                  _mm_xor_si128(_mm_unpackhi_epi8(zero, v8), bias), k);
+
+        const __m128i r = _mm_packus_epi16(_mm_srai_epi16(lo.r, 6), _mm_srai_epi16(hi.r, 6));
+        const __m128i g = _mm_packus_epi16(_mm_srai_epi16(lo.g, 6), _mm_srai_epi16(hi.g, 6));
+        const __m128i b = _mm_packus_epi16(_mm_srai_epi16(lo.b, 6), _mm_srai_epi16(hi.b, 6));
+
+        const __m128i rgLo = _mm_unpacklo_epi8(r, g);
+        const __m128i rgHi = _mm_unpackhi_epi8(r, g);
+        const __m128i baLo = _mm_unpacklo_epi8(b, alpha);
+        const __m128i baHi = _mm_unpackhi_epi8(b, alpha);
+        __m128i *out = reinterpret_cast<__m128i *>(dst + x * 4);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(rgLo, baLo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(rgLo, baLo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(rgHi, baHi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(rgHi, baHi));
+    }
+
+    if (x < width)
+        yuvRowScalar(y + x, u + x / 2, v + x / 2, dst + x * 4, width - x, k);
+}
+
+YUV_TARGET_AVX2 void yuvRowAvx2(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                uint8_t *dst, int width, const YuvCoefficients &k)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i bias = _mm256_set1_epi16(static_cast<short>(0x8000));
+    const __m256i alpha = _mm256_set1_epi8(static_cast<char>(0xff));
+
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const __m256i y8 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + x));
+        const __m128i u16 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(u + x / 2));
+        const __m128i v16 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(v + x / 2));
+        // 复制后按像素顺序拼成 32 字节，与 y8 的排列一致
+        const __m256i u8 = _mm256_set_m128i(_mm_unpackhi_epi8(u16, u16), _mm_unpacklo_epi8(u16, u16));
+        const __m256i v8 = _mm256_set_m128i(_mm_unpackhi_epi8(v16, v16), _mm_unpacklo_epi8(v16, v16));
+
+        // AVX2 的 unpack 在每个 128 位通道内进行：lo 为像素 0-7 与 16-23，hi 为 8-15 与 24-31
+        __m256i rLo, gLo, bLo, rHi, gHi, bHi;
+        convert16x2(_mm256_unpacklo_epi8(zero, y8),
+                    _mm256_xor_si256(_mm256_unpacklo_epi8(zero, u8), bias),
+                    _mm256_xor_si256(_mm256_unpacklo_epi8(zero, v8), bias), k, &rLo, &gLo, &bLo);
+        convert16x2(_mm256_unpackhi_epi8(zero, y8),
+                    _mm256_xor_si256(_mm256_unpackhi_epi8(zero, u8), bias),
+                    _mm256_xor_si256(_mm256_unpackhi_epi8(zero, v8), bias), k, &rHi, &gHi, &bHi);
+
+        // packus 同样按通道，结果恢复为像素 0-15 | 16-31
+        const __m256i r = _mm256_packus_epi16(_mm256_srai_epi16(rLo, 6), _mm256_srai_epi16(rHi, 6));
+        const __m256i g = _mm256_packus_epi16(_mm256_srai_epi16(gLo, 6), _mm256_srai_epi16(gHi, 6));
+        const __m256i b = _mm256_packus_epi16(_mm256_srai_epi16(bLo, 6), _mm256_srai_epi16(bHi, 6));
+
+        const __m256i rgLo = _mm256_unpacklo_epi8(r, g);   // 像素 0-7 | 16-23
+        const __m256i rgHi = _mm256_unpackhi_epi8(r, g);   // 像素 8-15 | 24-31
+        const __m256i baLo = _mm256_unpacklo_epi8(b, alpha);
+        const __m256i baHi = _mm256_unpackhi_epi8(b, alpha);
+        const __m256i p0 = _mm256_unpacklo_epi16(rgLo, baLo);   // 0-3 | 16-19
+        const __m256i p1 = _mm256_unpackhi_epi16(rgLo, baLo);   // 4-7 | 20-23
+        const __m256i p2 = _mm256_unpacklo_epi16(rgHi, baHi);   // 8-11 | 24-27
+        const __m256i p3 = _mm256_unpackhi_epi16(rgHi, baHi);   // 12-15 | 28-31
+
+        __m256i *out = reinterpret_cast<__m256i *>(dst + x * 4);
+        _mm256_storeu_si256(out + 0, _mm256_permute2x128_si256(p0, p1, 0x20));
+        _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(p2, p3, 0x20));
+        _mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(p0, p1, 0x31));
+        _mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(p2, p3, 0x31));
+    }
+
+    // 余下不足 32 像素交给 SSE2，再不足 16 的由其转给标量
+    if (x < width)
+        yuvRowSse2(y + x, u + x / 2, v + x / 2, dst + x * 4, width - x, k);
+}
+
+bool cpuSupportsAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = {};
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // YUVCONVERT_X86
@@ -0,0 +1,239 @@
+#include "danmudedup.h"
+#include "danmutext_p.h"
+
+#include <QChar>
+#include <algorithm>
+
+namespace {
+constexpr int kMaxRun = 3;
+
+// FNV-1a 按码点累加，同一码点连续超过 kMaxRun 个的部分不计入
+struct RunHash {
+    quint64 hash = 0xcbf29ce484222325ull;
+    char32_t last = 0;
+    int run = 0;
+    int length = 0;
+
+    void add(char32_t codePoint)
+    {
+        if (run > 0 && codePoint == last) {
+            if (++run > kMaxRun)
+                return;
+        } else {
+            last = codePoint;
+            run = 1;
+        }
+        hash = (hash ^ codePoint) * 0x100000001b3ull;
+        ++length;
+    }
+};
+
+// 同时计算去掉空白标点与保留全部字符的两个指纹，前者为空时才用后者
+struct Normalizer {
+    RunHash stripped;
+    RunHash full;
+
+    bool operator()(char32_t codePoint)
+    {
+        if (codePoint >= 0xFF01 && codePoint <= 0xFF5E)
+            codePoint -= 0xFEE0;            // 全角 ASCII
+        else if (codePoint == 0x3000)
+            codePoint = u' ';               // 全角空格
+        codePoint = QChar::toCaseFolded(codePoint);
+        full.add(codePoint);
+        if (!QChar::isSpace(codePoint) && !QChar::isPunct(codePoint))
+            stripped.add(codePoint);
+        return false;
+    }
+
+    quint64 result() const
+    {
+        quint64 h = stripped.length > 0 ? stripped.hash : full.hash ^ 0x9E3779B97F4A7C15ull;
+        // splitmix64 的末端混合，开放寻址表直接取低位
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebull;
+        h ^= h >> 31;
+        return h;
+    }
+};
+
+template <typename Text>
+quint64 fingerprintOf(Text text)
+{
+    Normalizer normalizer;
+    forEachCodePoint(text, normalizer);
+    return normalizer.result();
+}
+}
+
+DanmuDedup::DanmuDedup()
+    : DanmuDedup(Config())
+{
+}
+
+DanmuDedup::DanmuDedup(const Config &config)
+{
+    setConfig(config);
+}
+
+void DanmuDedup::setConfig(const Config &config)
+{
+    config_ = config;
+    config_.capacity = std::max(1, config_.capacity);
+    clear();
+}
+
+void DanmuDedup::clear()
+{
+    // 装载率不超过 1/2，线性探测的查找长度保持很短
+    qsizetype buckets = 16;
+    while (buckets < 2 * qsizetype(config_.capacity))
+        buckets *= 2;
+    entries_.assign(config_.capacity, Entry());
+    table_.assign(buckets, -1);
+    head_ = size_ = live_ = 0;
+}
+
+bool DanmuDedup::add(quint64 id, QStringView text, double now, Merge *merge, std::vector<quint64> *released)
+{
+    return insert(id, fingerprint(text), now, merge, released);
+}
+
+bool DanmuDedup::add(quint64 id, QUtf8StringView text, double now, Merge *merge, std::vector<quint64> *released)
+{
+    return insert(id, fingerprint(text), now, merge, released);
+}
+
+void DanmuDedup::remove(quint64 id)
+{
+    // 通常是刚加入的一条，从环尾往前找
+    const int capacity = static_cast<int>(entries_.size());
+    for (int i = size_ - 1; i >= 0; --i) {
+        Entry &entry = entries_[(head_ + i) % capacity];
+        if (entry.live && entry.id == id) {
+            erase(find(entry.fingerprint));
+            entry.live = false;
+            --live_;
+            return;
+        }
+    }
+}
+
+DanmuDedup::Stats DanmuDedup::stats() const
+{
+    Stats stats = stats_;
+    stats.tracked = live_;
+    stats.memoryBytes = static_cast<qsizetype>(entries_.size() * sizeof(Entry) + table_.size() * sizeof(qint32));
+    return stats;
+}
+
+quint64 DanmuDedup::fingerprint(QStringView text)
+{
+    return fingerprintOf(text);
+}
+
+quint64 DanmuDedup::fingerprint(QUtf8StringView text)
+{
+    return fingerprintOf(text);
+}
+
+bool DanmuDedup::insert(quint64 id, quint64 fingerprint, double now, Merge *merge, std::vector<quint64> *released)
+{
+    ++stats_.received;
+    if (config_.window <= 0.0)
+        return false;
+
+    expire(now, released);
+    const qsizetype bucket = find(fingerprint);
+    if (bucket >= 0) {
+        Entry &entry = entries_[table_[bucket]];
+        ++entry.count;
+        ++stats_.merged;
+        if (merge)
+            *merge = Merge{ entry.id, entry.count };
+        return true;
+    }
+
+    const int capacity = static_cast<int>(entries_.size());
+    if (size_ == capacity) {
+        if (entries_[head_].live)
+            ++stats_.evicted;
+        popFront(released);
+    }
+    const int slot = (head_ + size_) % capacity;
+    Entry &entry = entries_[slot];
+    entry.fingerprint = fingerprint;
+    entry.id = id;
+    entry.first = now;
+    entry.count = 1;
+    entry.live = true;
+    ++size_;
+    ++live_;
+
+    const qsizetype mask = static_cast<qsizetype>(table_.size()) - 1;
+    qsizetype b = home(fingerprint);
+    while (table_[b] >= 0)
+        b = (b + 1) & mask;
+    table_[b] = slot;
+    return false;
+}
+
+void DanmuDedup::expire(double now, std::vector<quint64> *released)
+{
+    while (size_ > 0) {
+        const Entry &front = entries_[head_];
+        if (front.live && front.first + config_.window >= now)
+            break;
+        popFront(released);
+    }
+}
+
+void DanmuDedup::popFront(std::vector<quint64> *released)
+{
+    Entry &front = entries_[head_];
+    if (front.live) {
+        erase(find(front.fingerprint));
+        front.live = false;
+        --live_;
+        if (released)
+            released->push_back(front.id);
+    }
+    head_ = (head_ + 1) % static_cast<int>(entries_.size());
+    --size_;
+}
+
+qsizetype DanmuDedup::find(quint64 fingerprint) const
+{
+    const qsizetype mask = static_cast<qsizetype>(table_.size()) - 1;
+    for (qsizetype b = home(fingerprint);; b = (b + 1) & mask) {
+        const qint32 slot = table_[b];
+        if (slot < 0)
+            return -1;
+        if (entries_[slot].fingerprint == fingerprint)
+            return b;
+    }
+}
+
+void DanmuDedup::erase(qsizetype bucket)
+{
+    // 线性探测的后移删除：把同一探测链上后面的项前移填洞，不留墓碑
+    const qsizetype mask = static_cast<qsizetype>(table_.size()) - 1;
+    qsizetype hole = bucket;
+    for (qsizetype b = (hole + 1) & mask; table_[b] >= 0; b = (b + 1) & mask) {
+        const qsizetype k = home(entries_[table_[b]].fingerprint);
+        // 起始桶在 (hole, b] 内的项不能越过起始桶前移
+        const bool stays = hole <= b ? (hole < k && k <= b) : (hole < k || k <= b);
+        if (!stays) {
+            table_[hole] = table_[b];
+            hole = b;
+        }
+    }
+    table_[hole] = -1;
+}
+
+qsizetype DanmuDedup::home(quint64 fingerprint) const
+{
+    return static_cast<qsizetype>(fingerprint & (table_.size() - 1));
+}
@@ -0,0 +1,86 @@
+#ifndef DANMUDEDUP_H
+#define DANMUDEDUP_H
+
+#include <QStringView>
+#include <QUtf8StringView>
+#include <QtGlobal>
+#include <vector>
+
+// 弹幕去重：刷屏时同一句话在一秒内出现成百上千次，逐条排布、渲染既费时又挡画面。
+// 对归一化后的文本取 64 位指纹，在滑动时间窗口内（从首条算起）出现的相同文本并入首条，
+// 由调用方显示为“×N”。指纹按首条到达顺序存放在定长环中，另用开放寻址表按指纹查找，
+// 内存只取决于 capacity，与弹幕流长度无关；窗口内不同文本超过 capacity 时最早的提前移出。
+// 归一化：按码点做大小写折叠，全角 ASCII 转半角，忽略空白与标点，同一字符连续超过 3 个按 3 个计
+// （“哈哈哈哈哈”与“哈哈哈”、“2333”与“23333”相同）；全为标点的文本只做折叠与连续字符截断。
+// 非线程安全，now 须单调不减。
+class DanmuDedup
+{
+public:
+    struct Config {
+        double window = 3.0;        // 秒，<= 0 时不合并
+        int capacity = 16384;       // 同时跟踪的不同文本数上限，约 40 字节/项；宜不小于窗口内的不同文本数
+    };
+
+    struct Merge {
+        quint64 id = 0;             // 首条的 id
+        int count = 0;              // 含首条在内的累计条数
+    };
+
+    struct Stats {
+        quint64 received = 0;
+        quint64 merged = 0;         // 被并入首条、省去的渲染条数
+        quint64 evicted = 0;        // 窗口未到就因容量不足移出的文本
+        int tracked = 0;
+        qsizetype memoryBytes = 0;
+    };
+
+    DanmuDedup();
+    explicit DanmuDedup(const Config& config);
+
+    // 清空已跟踪的文本，统计保留
+    void setConfig(const Config& config);
+    const Config& config() const { return config_; }
+    void clear();
+
+    // 窗口内已有相同文本时计数加一、写入 merge 并返回 true，调用方应丢弃这一条；
+    // 否则以 id 记下这条并返回 false。released 收集本次移出窗口（过期或被挤出）的首条 id，
+    // 之后不会再有弹幕并入它们
+    bool add(quint64 id, QStringView text, double now, Merge* merge = nullptr,
+             std::vector<quint64>* released = nullptr);
+    bool add(quint64 id, QUtf8StringView text, double now, Merge* merge = nullptr,
+             std::vector<quint64>* released = nullptr);
+    // 首条未能显示（如被排布丢弃）时撤销，之后相同文本重新作为新弹幕
+    void remove(quint64 id);
+
+    Stats stats() const;
+
+    // 归一化文本的指纹，UTF-16 与 UTF-8 输入结果相同
+    static quint64 fingerprint(QStringView text);
+    static quint64 fingerprint(QUtf8StringView text);
+
+private:
+    struct Entry {
+        quint64 fingerprint = 0;
+        quint64 id = 0;
+        double first = 0.0;
+        int count = 0;
+        bool live = false;          // remove() 后置为 false，等到达环首时回收
+    };
+
+    bool insert(quint64 id, quint64 fingerprint, double now, Merge* merge, std::vector<quint64>* released);
+    void expire(double now, std::vector<quint64>* released);
+    void popFront(std::vector<quint64>* released);
+    qsizetype find(quint64 fingerprint) const;
+    void erase(qsizetype bucket);
+    qsizetype home(quint64 fingerprint) const;
+
+    Config config_;
+    std::vector<Entry> entries_;    // 按首条到达顺序的环，[head_, head_ + size_)
+    int head_ = 0;
+    int size_ = 0;
+    int live_ = 0;
+    std::vector<qint32> table_;     // 开放寻址（线性探测），存 entries_ 下标，-1 为空
+    Stats stats_;
+};
+
+#endif // DANMUDEDUP_H
@@ -0,0 +1,160 @@
+#include "danmulayout.h"
+
+#include <algorithm>
+
+DanmuLayout::DanmuLayout()
+    : DanmuLayout(Config())
+{
+}
+
+DanmuLayout::DanmuLayout(const Config &config)
+{
+    setConfig(config);
+}
+
+void DanmuLayout::setConfig(const Config &config)
+{
+    config_ = config;
+    config_.lineHeight = std::max(1, config_.lineHeight);
+    config_.scrollDuration = std::max(0.1, config_.scrollDuration);
+
+    const int rows = std::max(1, config_.height / config_.lineHeight);
+    const int scrollRows = std::clamp(static_cast<int>(config_.height * config_.areaRatio / config_.lineHeight), 1, rows);
+    // 顶部、底部各占一半，避免两者在中间重叠
+    const int fixedRows = std::max(1, rows / 2);
+
+    scroll_.assign(scrollRows, ScrollLane());
+    top_.assign(fixedRows, -1.0);
+    bottom_.assign(fixedRows, -1.0);
+    clear();
+}
+
+void DanmuLayout::clear()
+{
+    std::fill(scroll_.begin(), scroll_.end(), ScrollLane());
+    std::fill(top_.begin(), top_.end(), -1.0);
+    std::fill(bottom_.begin(), bottom_.end(), -1.0);
+    for (std::deque<Pending> &queue : queues_)
+        queue.clear();
+    queued_ = 0;
+}
+
+DanmuLayout::Result DanmuLayout::place(quint64 id, double width, Mode mode, double now, Placement *out)
+{
+    std::deque<Pending> &queue = queues_[modeIndex(mode)];
+    // 同模式已有弹幕在排队时直接排到队尾，保持到达顺序
+    if (queue.empty() && tryPlace(id, width, mode, now, out)) {
+        ++stats_.placed;
+        return Result::Placed;
+    }
+
+    if (config_.overflow == OverflowPolicy::Drop || queued_ >= config_.maxQueued) {
+        ++stats_.dropped;
+        return Result::Dropped;
+    }
+    queue.push_back(Pending{ id, width, now });
+    ++queued_;
+    return Result::Queued;
+}
+
+int DanmuLayout::pump(double now, std::vector<Placement> *out, std::vector<quint64> *expired)
+{
+    int placed = 0;
+    for (int m = 0; m < 3; ++m) {
+        std::deque<Pending> &queue = queues_[m];
+        while (!queue.empty()) {
+            const Pending &front = queue.front();
+            if (now - front.arrival > config_.maxQueueDelay) {
+                ++stats_.expired;
+                if (expired)
+                    expired->push_back(front.id);
+            } else {
+                Placement placement;
+                // 队首放不下时后面的也不尝试，保持先来先上屏
+                if (!tryPlace(front.id, front.width, static_cast<Mode>(m), now, &placement))
+                    break;
+                placement.queuedFor = now - front.arrival;
+                out->push_back(placement);
+                ++stats_.placed;
+                ++stats_.placedFromQueue;
+                ++placed;
+            }
+            queue.pop_front();
+            --queued_;
+        }
+    }
+    return placed;
+}
+
+DanmuLayout::Stats DanmuLayout::stats() const
+{
+    Stats stats = stats_;
+    stats.queued = queued_;
+    return stats;
+}
+
+bool DanmuLayout::tryPlace(quint64 id, double width, Mode mode, double now, Placement *out)
+{
+    int lane = -1;
+    double y = 0.0;
+    switch (mode) {
+    case Mode::Scroll:
+        lane = tryScroll(width, now);
+        y = lane * config_.lineHeight;
+        break;
+    case Mode::Top:
+        lane = tryFixed(top_, now);
+        y = lane * config_.lineHeight;
+        break;
+    case Mode::Bottom:
+        lane = tryFixed(bottom_, now);
+        y = config_.height - (lane + 1) * config_.lineHeight;
+        break;
+    }
+    if (lane < 0)
+        return false;
+
+    out->id = id;
+    out->mode = mode;
+    out->lane = lane;
+    out->y = y;
+    out->start = now;
+    out->queuedFor = 0.0;
+    return true;
+}
+
+int DanmuLayout::tryScroll(double width, double now)
+{
+    const double screen = config_.width;
+    const double speed = (screen + width) / config_.scrollDuration;
+
+    // 自上而下找第一条可用的行，每行只和它的最后一条比较
+    for (int i = 0; i < static_cast<int>(scroll_.size()); ++i) {
+        ScrollLane &lane = scroll_[i];
+        if (lane.exit >= now) {
+            // 上一条尚未完全进入屏幕（含间距）
+            if (lane.speed * (now - lane.start) < lane.width + config_.minGap)
+                continue;
+            // 追尾：上一条完全移出时，新弹幕的左端不能越过左边缘减去间距的位置
+            if (speed * (lane.exit - now) > screen - config_.minGap)
+                continue;
+        }
+        lane.start = now;
+        lane.speed = speed;
+        lane.width = width;
+        lane.exit = now + config_.scrollDuration;
+        return i;
+    }
+    return -1;
+}
+
+int DanmuLayout::tryFixed(std::vector<double> &lanes, double now)
+{
+    for (int i = 0; i < static_cast<int>(lanes.size()); ++i) {
+        if (lanes[i] <= now) {
+            lanes[i] = now + config_.fixedDuration;
+            return i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,94 @@
+#ifndef DANMULAYOUT_H
+#define DANMULAYOUT_H
+
+#include <QtGlobal>
+#include <deque>
+#include <vector>
+
+// 弹幕排布：为每条到达的弹幕分配滚动、顶部或底部的行，保证同行弹幕互不重叠。
+// 每行只记录最后一条弹幕（滚动行）或当前占用者的结束时间（固定行），判断能否放入只看这一条，
+// 单条放置的开销只与行数（由高度与行高决定，通常几十）有关，与屏上弹幕总数无关。
+// 放不下时按 OverflowPolicy 丢弃或排队，排队的弹幕由 pump() 按到达顺序重试，超过等待上限后丢弃。
+// 时间单位为秒，须单调不减；坐标单位为像素，原点在左上角。非线程安全。
+class DanmuLayout
+{
+public:
+    enum class Mode { Scroll, Top, Bottom };
+    enum class OverflowPolicy { Drop, Queue };
+    enum class Result { Placed, Queued, Dropped };
+
+    struct Config {
+        int width = 1920;
+        int height = 1080;
+        int lineHeight = 36;
+        double areaRatio = 1.0;           // 弹幕可用的高度比例，从顶部算起
+        double scrollDuration = 8.0;      // 从右边缘进入到左边缘完全移出
+        double fixedDuration = 4.0;       // 顶部、底部弹幕的停留时间
+        double minGap = 24.0;             // 同行前后两条滚动弹幕之间的最小间距
+        OverflowPolicy overflow = OverflowPolicy::Queue;
+        int maxQueued = 2000;             // 各模式合计
+        double maxQueueDelay = 2.0;       // 排队超过该时长仍放不下则丢弃
+    };
+
+    struct Placement {
+        quint64 id = 0;
+        Mode mode = Mode::Scroll;
+        int lane = 0;
+        double y = 0.0;                   // 行顶边
+        double start = 0.0;               // 开始显示的时刻
+        double queuedFor = 0.0;           // 在队列中等待的时长
+    };
+
+    struct Stats {
+        quint64 placed = 0;
+        quint64 placedFromQueue = 0;
+        quint64 dropped = 0;              // 放不下且不排队，或队列已满
+        quint64 expired = 0;              // 排队超时
+        int queued = 0;                   // 当前排队数
+    };
+
+    DanmuLayout();
+    explicit DanmuLayout(const Config& config);
+
+    // 重新划分行并清空所有状态（窗口尺寸、行高变化时调用）
+    void setConfig(const Config& config);
+    const Config& config() const { return config_; }
+    int laneCount() const { return static_cast<int>(scroll_.size()); }
+
+    // width 为弹幕文本宽度（像素）；返回 Placed 时写入 out
+    Result place(quint64 id, double width, Mode mode, double now, Placement* out);
+    // 重试排队中的弹幕，放下的追加到 out，排队超时的 id 追加到 expired，返回本次放下的条数。每帧调用一次即可
+    int pump(double now, std::vector<Placement>* out, std::vector<quint64>* expired = nullptr);
+    void clear();
+
+    Stats stats() const;
+
+private:
+    struct ScrollLane {
+        double start = 0.0;
+        double speed = 0.0;
+        double width = 0.0;
+        double exit = -1.0;               // 最后一条完全移出的时刻，< now 即空闲
+    };
+
+    struct Pending {
+        quint64 id = 0;
+        double width = 0.0;
+        double arrival = 0.0;
+    };
+
+    int tryScroll(double width, double now);
+    int tryFixed(std::vector<double>& lanes, double now);
+    bool tryPlace(quint64 id, double width, Mode mode, double now, Placement* out);
+    static int modeIndex(Mode mode) { return static_cast<int>(mode); }
+
+    Config config_;
+    std::vector<ScrollLane> scroll_;
+    std::vector<double> top_;             // 各行占用者的结束时刻
+    std::vector<double> bottom_;
+    std::deque<Pending> queues_[3];       // 按 Mode 分开排队，各自保持到达顺序
+    int queued_ = 0;
+    Stats stats_;
+};
+
+#endif // DANMULAYOUT_H
@@ -0,0 +1,111 @@
+#include "danmuloopback.h"
+#include "danmu.pb.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <zlib.h>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+const char *const kPhrases[] = {
+    "哈哈哈哈", "前方高能", "awsl", "好活", "这波操作", "666", "来了来了", "笑死",
+    "名场面", "泪目", "打卡", "下次一定", "经典", "GG", "nice", "??", "妙啊",
+    "弹幕护体", "从头看到尾", "这也行", "高手", "up 主辛苦了", "第一次来", "2333",
+};
+constexpr int kPhraseCount = static_cast<int>(std::size(kPhrases));
+
+// 常见弹幕颜色，白色之外按出现频率排列
+const quint32 kColors[] = { 0xFE0302, 0xFFFF00, 0x00CD00, 0x4266BE, 0xCC0273, 0x89D5FF };
+constexpr int kColorCount = static_cast<int>(std::size(kColors));
+}
+
+DanmuLoopbackProducer::DanmuLoopbackProducer()
+    : DanmuLoopbackProducer(Options())
+{
+}
+
+DanmuLoopbackProducer::DanmuLoopbackProducer(const Options &options)
+    : options_(options)
+    , rng_(options.seed)
+    , batch_(std::make_unique<danmu::wire::Batch>())
+{
+    options_.batchSize = std::max(1, options_.batchSize);
+    options_.compressionLevel = std::clamp(options_.compressionLevel, 1, 9);
+    options_.users = std::max(1, options_.users);
+}
+
+DanmuLoopbackProducer::~DanmuLoopbackProducer() = default;
+
+qsizetype DanmuLoopbackProducer::produce(qint64 baseTimeMs, int spanMs, QByteArray *out)
+{
+    std::uniform_int_distribution<int> phrase(0, kPhraseCount - 1);
+    std::uniform_int_distribution<int> repeat(1, 3);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> offset(0, std::max(0, spanMs - 1));
+    std::uniform_int_distribution<int> color(0, kColorCount - 1);
+    std::uniform_int_distribution<int> user(0, options_.users - 1);
+
+    batch_->Clear();
+    batch_->set_sequence(++sequence_);
+    batch_->set_base_time_ms(baseTimeMs);
+
+    std::string text;
+    for (int i = 0; i < options_.batchSize; ++i) {
+        danmu::wire::Comment *comment = batch_->add_comments();
+        comment->set_id(nextId_++);
+        comment->set_offset_ms(static_cast<quint32>(offset(rng_)));
+
+        // 85% 滚动、10% 顶部、5% 底部；80% 白色
+        const int mode = percent(rng_);
+        comment->set_mode(mode < 85 ? danmu::wire::SCROLL : mode < 95 ? danmu::wire::TOP : danmu::wire::BOTTOM);
+        if (percent(rng_) >= 80)
+            comment->set_color(kColors[color(rng_)]);
+        comment->set_user(static_cast<quint64>(user(rng_)) * 0x9E3779B97F4A7C15ull);
+
+        text.clear();
+        const int parts = repeat(rng_);
+        for (int p = 0; p < parts; ++p)
+            text += kPhrases[phrase(rng_)];
+        comment->set_text(text);
+    }
+
+    batch_->SerializeToString(&raw_);
+
+    danmu::wire::Packet packet;
+    packet.set_raw_size(static_cast<quint32>(raw_.size()));
+    bool compressed = false;
+    if (options_.compress) {
+        uLongf size = compressBound(static_cast<uLong>(raw_.size()));
+        compressed_.resize(size);
+        compressed = compress2(reinterpret_cast<Bytef*>(compressed_.data()), &size,
+                               reinterpret_cast<const Bytef*>(raw_.data()), static_cast<uLong>(raw_.size()),
+                               options_.compressionLevel) == Z_OK
+                     && size < raw_.size();
+        compressed_.resize(size);
+    }
+    // 单条或很短的批次压缩后反而变大，此时按原样发送
+    if (compressed) {
+        packet.set_codec(danmu::wire::Packet::ZLIB);
+        packet.set_payload(compressed_);
+    } else {
+        packet.set_codec(danmu::wire::Packet::RAW);
+        packet.set_payload(raw_);
+    }
+
+    // 与 protobuf 的 SerializeDelimitedTo 相同：varint32 长度 + 消息
+    std::string framed;
+    {
+        google::protobuf::io::StringOutputStream stream(&framed);
+        google::protobuf::io::CodedOutputStream output(&stream);
+        output.WriteVarint32(static_cast<quint32>(packet.ByteSizeLong()));
+        packet.SerializeWithCachedSizes(&output);
+    }
+    out->append(framed.data(), static_cast<qsizetype>(framed.size()));
+    return static_cast<qsizetype>(framed.size());
+}
+
+const danmu::wire::Batch &DanmuLoopbackProducer::lastBatch() const
+{
+    return *batch_;
+}
@@ -0,0 +1,52 @@
+#ifndef DANMULOOPBACK_H
+#define DANMULOOPBACK_H
+
+#include <QByteArray>
+#include <QtGlobal>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace danmu::wire {
+class Batch;
+}
+
+// 本地回环弹幕源：按固定种子生成合成弹幕，用生成的 protobuf 代码（danmu.pb.h）编码成
+// 与服务端相同的字节流（带长度前缀的 Packet），供测试、基准以及无服务端时的界面调试使用。
+// 文本在若干中英文短语中随机组合，颜色、模式、发送者按常见直播间的比例分布。
+class DanmuLoopbackProducer
+{
+public:
+    struct Options {
+        int batchSize = 64;             // 每批弹幕数
+        bool compress = true;           // 按批 zlib 压缩，压缩后不更小时按原样发送
+        int compressionLevel = 6;       // zlib 压缩级别 1~9
+        quint32 seed = 1;
+        int users = 5000;               // 发送者数量
+    };
+
+    DanmuLoopbackProducer();
+    explicit DanmuLoopbackProducer(const Options& options);
+    ~DanmuLoopbackProducer();
+
+    // 生成下一批弹幕，编码后追加到 out，返回追加的字节数。baseTimeMs 为批次基准时间，
+    // 批内弹幕在其后 [0, spanMs) 内均匀分布
+    qsizetype produce(qint64 baseTimeMs, int spanMs, QByteArray* out);
+
+    // 最近一批的内容，测试用于与解码结果比对
+    const danmu::wire::Batch& lastBatch() const;
+
+    quint64 batches() const { return sequence_; }
+    quint64 comments() const { return nextId_; }
+
+private:
+    Options options_;
+    std::mt19937 rng_;
+    std::unique_ptr<danmu::wire::Batch> batch_;
+    std::string raw_;                   // 序列化缓冲，复用
+    std::string compressed_;
+    quint64 sequence_ = 0;
+    quint64 nextId_ = 0;
+};
+
+#endif // DANMULOOPBACK_H
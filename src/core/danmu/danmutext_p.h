@@ -0,0 +1,61 @@
+#ifndef DANMUTEXT_P_H
+#define DANMUTEXT_P_H
+
+#include <QChar>
+#include <QStringView>
+#include <QUtf8StringView>
+
+// 弹幕文本逐码点遍历，UTF-16 与 UTF-8 输入走同一套处理，不做整串转换。
+// fn(char32_t) 返回 true 时提前结束，整体返回 true。
+
+// 孤立的代理项原样作为码点
+template <typename Fn>
+bool forEachCodePoint(QStringView text, Fn &&fn)
+{
+    const qsizetype size = text.size();
+    for (qsizetype i = 0; i < size; ++i) {
+        char32_t codePoint = text[i].unicode();
+        if (QChar::isHighSurrogate(codePoint) && i + 1 < size && text[i + 1].isLowSurrogate()) {
+            codePoint = QChar::surrogateToUcs4(text[i].unicode(), text[i + 1].unicode());
+            ++i;
+        }
+        if (fn(codePoint))
+            return true;
+    }
+    return false;
+}
+
+// 非法序列按 U+FFFD 处理并跳过一个字节
+template <typename Fn>
+bool forEachCodePoint(QUtf8StringView text, Fn &&fn)
+{
+    const uchar *p = reinterpret_cast<const uchar*>(text.data());
+    const uchar *end = p + text.size();
+    while (p < end) {
+        const uchar lead = *p;
+        char32_t codePoint = 0xFFFD;
+        int length = 1;
+        if (lead < 0x80) {
+            codePoint = lead;
+        } else if (lead >= 0xC2 && lead < 0xF5) {
+            const int expected = lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+            if (end - p >= expected) {
+                char32_t value = lead & (0x3F >> (expected - 1));
+                int i = 1;
+                for (; i < expected && (p[i] & 0xC0) == 0x80; ++i)
+                    value = (value << 6) | (p[i] & 0x3F);
+                const char32_t minimum = expected == 2 ? 0x80 : expected == 3 ? 0x800 : 0x10000;
+                if (i == expected && value >= minimum && value <= 0x10FFFF && (value < 0xD800 || value > 0xDFFF)) {
+                    codePoint = value;
+                    length = expected;
+                }
+            }
+        }
+        p += length;
+        if (fn(codePoint))
+            return true;
+    }
+    return false;
+}
+
+#endif // DANMUTEXT_P_H
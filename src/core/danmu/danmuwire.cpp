@@ -0,0 +1,288 @@
+#include "danmuwire.h"
+
+#include <QDebug>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <zlib.h>
+#include <algorithm>
+
+using google::protobuf::io::CodedInputStream;
+using google::protobuf::internal::WireFormatLite;
+
+namespace {
+// 字段号与 danmu.proto 一致
+enum PacketField { kPacketCodec = 1, kPacketRawSize = 2, kPacketPayload = 3 };
+enum BatchField { kBatchSequence = 1, kBatchBaseTime = 2, kBatchComments = 3 };
+enum CommentField { kCommentId = 1, kCommentOffset = 2, kCommentMode = 3, kCommentColor = 4,
+                    kCommentUser = 5, kCommentText = 6 };
+enum Codec { kCodecRaw = 0, kCodecZlib = 1 };
+
+constexpr int kVarint = WireFormatLite::WIRETYPE_VARINT;
+constexpr int kDelimited = WireFormatLite::WIRETYPE_LENGTH_DELIMITED;
+
+// 读一个长度前缀，返回占用的字节数；数据不足返回 0，超过 5 字节返回 -1
+int readLengthPrefix(const quint8 *data, qsizetype size, quint32 *value)
+{
+    quint32 result = 0;
+    for (int i = 0; i < 5; ++i) {
+        if (i >= size)
+            return 0;
+        result |= static_cast<quint32>(data[i] & 0x7F) << (7 * i);
+        if (!(data[i] & 0x80)) {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+// 读一个长度受限的字段，返回指向流内数据的指针，不拷贝
+bool readDelimited(CodedInputStream *input, const quint8 **data, int *size)
+{
+    quint32 length = 0;
+    if (!input->ReadVarint32(&length))
+        return false;
+    const void *pointer = nullptr;
+    int available = 0;
+    input->GetDirectBufferPointerInline(&pointer, &available);
+    if (length > static_cast<quint32>(available))
+        return false;
+    *data = static_cast<const quint8*>(pointer);
+    *size = static_cast<int>(length);
+    return input->Skip(static_cast<int>(length));
+}
+
+bool skipField(CodedInputStream *input, quint32 tag)
+{
+    return WireFormatLite::SkipField(input, tag);
+}
+
+bool parseComment(const quint8 *data, int size, DanmuArena *arena)
+{
+    CodedInputStream input(data, size);
+    DanmuArena::Comment &comment = arena->append();
+    quint32 tag = 0;
+    while ((tag = input.ReadTag()) != 0) {
+        const int field = WireFormatLite::GetTagFieldNumber(tag);
+        const int type = WireFormatLite::GetTagWireType(tag);
+        bool ok = true;
+        quint32 value32 = 0;
+        quint64 value64 = 0;
+        if (field == kCommentId && type == kVarint) {
+            ok = input.ReadVarint64(&value64);
+            comment.id = value64;
+        } else if (field == kCommentOffset && type == kVarint) {
+            ok = input.ReadVarint32(&value32);
+            comment.timeMs = value32;
+        } else if (field == kCommentMode && type == kVarint) {
+            ok = input.ReadVarint32(&value32);
+            // 未知模式按滚动显示
+            comment.mode = value32 <= 2 ? static_cast<DanmuArena::Mode>(value32) : DanmuArena::Mode::Scroll;
+        } else if (field == kCommentColor && type == kVarint) {
+            ok = input.ReadVarint32(&value32);
+            comment.color = value32 & 0xFFFFFF;
+        } else if (field == kCommentUser && type == kVarint) {
+            ok = input.ReadVarint64(&value64);
+            comment.user = value64;
+        } else if (field == kCommentText && type == kDelimited) {
+            const quint8 *text = nullptr;
+            int length = 0;
+            ok = readDelimited(&input, &text, &length);
+            if (ok) {
+                comment.textOffset = arena->appendText(reinterpret_cast<const char*>(text), length);
+                comment.textSize = static_cast<quint32>(length);
+            }
+        } else {
+            ok = skipField(&input, tag);
+        }
+        if (!ok)
+            return false;
+    }
+    return input.ConsumedEntireMessage();
+}
+}
+
+void DanmuArena::clear()
+{
+    comments_.clear();
+    text_.clear();
+}
+
+void DanmuArena::reserve(int comments, int textBytes)
+{
+    comments_.reserve(comments);
+    text_.reserve(textBytes);
+}
+
+QUtf8StringView DanmuArena::text(const Comment &comment) const
+{
+    return QUtf8StringView(text_.data() + comment.textOffset, comment.textSize);
+}
+
+DanmuArena::Comment &DanmuArena::append()
+{
+    comments_.emplace_back();
+    return comments_.back();
+}
+
+quint32 DanmuArena::appendText(const char *data, int size)
+{
+    const quint32 offset = static_cast<quint32>(text_.size());
+    text_.insert(text_.end(), data, data + size);
+    return offset;
+}
+
+void DanmuArena::truncate(int comments, qsizetype textBytes)
+{
+    comments_.resize(std::min(static_cast<size_t>(comments), comments_.size()));
+    text_.resize(std::min(static_cast<size_t>(textBytes), text_.size()));
+}
+
+int DanmuWireDecoder::feed(const char *data, qsizetype size, DanmuArena *arena)
+{
+    // 没有残留时直接在输入上解析，只把末尾不完整的包拷进 pending_
+    const bool direct = pending_.empty();
+    if (!direct)
+        pending_.insert(pending_.end(), reinterpret_cast<const quint8*>(data), reinterpret_cast<const quint8*>(data) + size);
+    const quint8 *begin = direct ? reinterpret_cast<const quint8*>(data) : pending_.data();
+    const qsizetype total = direct ? size : static_cast<qsizetype>(pending_.size());
+
+    const int before = arena->size();
+    qsizetype consumed = 0;
+    bool failed = false;
+    while (consumed < total) {
+        quint32 length = 0;
+        const int prefix = readLengthPrefix(begin + consumed, total - consumed, &length);
+        if (prefix == 0)
+            break;
+        if (prefix < 0 || length > static_cast<quint32>(maxPacketSize_)) {
+            failed = true;
+            break;
+        }
+        if (total - consumed - prefix < static_cast<qsizetype>(length))
+            break;
+        if (!decodePacket(begin + consumed + prefix, static_cast<int>(length), arena)) {
+            ++stats_.errors;
+            qWarning() << "Danmu packet corrupted, skipped" << length << "bytes";
+        }
+        consumed += prefix + length;
+        stats_.wireBytes += prefix + length;
+    }
+
+    if (failed) {
+        // 长度前缀不可信，无法再找到下一个包的边界，整段丢弃
+        ++stats_.errors;
+        pending_.clear();
+        qWarning() << "Danmu stream framing corrupted, dropped" << (total - consumed) << "buffered bytes";
+        return -1;
+    }
+    if (direct)
+        pending_.assign(begin + consumed, begin + total);
+    else
+        pending_.erase(pending_.begin(), pending_.begin() + consumed);
+    return arena->size() - before;
+}
+
+bool DanmuWireDecoder::decodePacket(const quint8 *data, int size, DanmuArena *arena)
+{
+    CodedInputStream input(data, size);
+    quint32 codec = kCodecRaw;
+    quint32 rawSize = 0;
+    const quint8 *payload = nullptr;
+    int payloadSize = 0;
+
+    quint32 tag = 0;
+    while ((tag = input.ReadTag()) != 0) {
+        const int field = WireFormatLite::GetTagFieldNumber(tag);
+        const int type = WireFormatLite::GetTagWireType(tag);
+        bool ok = true;
+        if (field == kPacketCodec && type == kVarint)
+            ok = input.ReadVarint32(&codec);
+        else if (field == kPacketRawSize && type == kVarint)
+            ok = input.ReadVarint32(&rawSize);
+        else if (field == kPacketPayload && type == kDelimited)
+            ok = readDelimited(&input, &payload, &payloadSize);
+        else
+            ok = skipField(&input, tag);
+        if (!ok)
+            return false;
+    }
+    if (!input.ConsumedEntireMessage())
+        return false;
+
+    ++stats_.packets;
+    switch (codec) {
+    case kCodecRaw:
+        return decodeBatch(payload, payloadSize, arena);
+    case kCodecZlib: {
+        if (rawSize > static_cast<quint32>(maxPacketSize_) || !payload)
+            return false;
+        if (inflated_.size() < rawSize)
+            inflated_.resize(rawSize);
+        uLongf inflatedSize = rawSize;
+        if (uncompress(inflated_.data(), &inflatedSize, payload, static_cast<uLong>(payloadSize)) != Z_OK
+            || inflatedSize != rawSize)
+            return false;
+        return decodeBatch(inflated_.data(), static_cast<int>(rawSize), arena);
+    }
+    default:
+        return false;
+    }
+}
+
+bool DanmuWireDecoder::decodeBatch(const quint8 *data, int size, DanmuArena *arena)
+{
+    const int first = arena->size();
+    const qsizetype firstText = arena->textBytes();
+    CodedInputStream input(data, size);
+    quint64 sequence = 0;
+    qint64 baseTime = 0;
+
+    bool ok = true;
+    quint32 tag = 0;
+    while (ok && (tag = input.ReadTag()) != 0) {
+        const int field = WireFormatLite::GetTagFieldNumber(tag);
+        const int type = WireFormatLite::GetTagWireType(tag);
+        quint64 value = 0;
+        if (field == kBatchSequence && type == kVarint) {
+            ok = input.ReadVarint64(&value);
+            sequence = value;
+        } else if (field == kBatchBaseTime && type == kVarint) {
+            ok = input.ReadVarint64(&value);
+            baseTime = static_cast<qint64>(value);
+        } else if (field == kBatchComments && type == kDelimited) {
+            const quint8 *comment = nullptr;
+            int length = 0;
+            ok = readDelimited(&input, &comment, &length) && parseComment(comment, length, arena);
+        } else {
+            ok = skipField(&input, tag);
+        }
+    }
+    if (!ok || !input.ConsumedEntireMessage()) {
+        arena->truncate(first, firstText);
+        return false;
+    }
+
+    // 字段顺序不保证，基准时间与批次号在整批解析完后补上
+    const int count = arena->size() - first;
+    for (int i = first; i < arena->size(); ++i) {
+        DanmuArena::Comment &comment = arena->at(i);
+        comment.timeMs += baseTime;
+        comment.batch = sequence;
+    }
+
+    if (hasSequence_ && sequence != lastSequence_ + 1)
+        ++stats_.sequenceGaps;
+    lastSequence_ = sequence;
+    hasSequence_ = true;
+    stats_.rawBytes += size;
+    stats_.comments += count;
+    return true;
+}
+
+void DanmuWireDecoder::reset()
+{
+    pending_.clear();
+    hasSequence_ = false;
+    stats_ = Stats();
+}
@@ -0,0 +1,85 @@
+#ifndef DANMUWIRE_H
+#define DANMUWIRE_H
+
+#include <QtGlobal>
+#include <QUtf8StringView>
+#include <vector>
+
+// 解码后的弹幕平铺存放：定长记录放在一个数组里，文本（UTF-8）连续存放在另一块缓冲中，
+// 记录只保存偏移与长度。clear() 保留容量，稳定运行后解码不再为单条弹幕分配内存。
+class DanmuArena
+{
+public:
+    // 与 danmu.proto 中 Mode 的取值一致
+    enum class Mode : quint8 { Scroll = 0, Top = 1, Bottom = 2 };
+
+    struct Comment {
+        quint64 id = 0;
+        quint64 user = 0;
+        quint64 batch = 0;          // 所在批次的 sequence
+        qint64 timeMs = 0;          // 批次基准时间加偏移
+        quint32 color = 0xFFFFFF;   // 0xRRGGBB
+        quint32 textOffset = 0;
+        quint32 textSize = 0;
+        Mode mode = Mode::Scroll;
+    };
+
+    void clear();
+    void reserve(int comments, int textBytes);
+
+    int size() const { return static_cast<int>(comments_.size()); }
+    bool isEmpty() const { return comments_.empty(); }
+    const Comment& at(int index) const { return comments_[index]; }
+    Comment& at(int index) { return comments_[index]; }
+    const std::vector<Comment>& comments() const { return comments_; }
+    QUtf8StringView text(const Comment& comment) const;
+    qsizetype textBytes() const { return static_cast<qsizetype>(text_.size()); }
+
+    // 解码器使用：追加一条记录，文本随后由 appendText 写入
+    Comment& append();
+    quint32 appendText(const char* data, int size);
+    // 回退到之前的大小，用于丢弃解析失败的批次
+    void truncate(int comments, qsizetype textBytes);
+
+private:
+    std::vector<Comment> comments_;
+    std::vector<char> text_;
+};
+
+// 弹幕流解码：输入为连接上收到的字节（任意切分），按 varint32 长度前缀拆出 Packet，
+// 解压后逐字段解析 Batch，直接写入 DanmuArena，不构造 protobuf 消息对象。
+// 字段号与 danmu.proto 一致，未知字段跳过，便于服务端加字段。非线程安全。
+class DanmuWireDecoder
+{
+public:
+    struct Stats {
+        quint64 packets = 0;
+        quint64 comments = 0;
+        quint64 wireBytes = 0;          // 含长度前缀
+        quint64 rawBytes = 0;           // 解压后的 Batch 字节数
+        quint64 errors = 0;             // 损坏或超长的包
+        quint64 sequenceGaps = 0;       // sequence 不连续的次数
+    };
+
+    // 追加收到的数据并解出所有完整的包，返回本次解出的弹幕条数。内容损坏的包计入 errors 后跳过；
+    // 长度前缀损坏时无法再定位包边界，丢弃已缓存的数据并返回 -1，调用方应重连
+    int feed(const char* data, qsizetype size, DanmuArena* arena);
+    // 解一个不带长度前缀的 Packet
+    bool decodePacket(const quint8* data, int size, DanmuArena* arena);
+    void reset();
+
+    void setMaxPacketSize(int bytes) { maxPacketSize_ = bytes; }
+    Stats stats() const { return stats_; }
+
+private:
+    bool decodeBatch(const quint8* data, int size, DanmuArena* arena);
+
+    std::vector<quint8> pending_;       // 尚不完整的包
+    std::vector<quint8> inflated_;      // 解压缓冲，复用
+    int maxPacketSize_ = 16 * 1024 * 1024;
+    quint64 lastSequence_ = 0;
+    bool hasSequence_ = false;
+    Stats stats_;
+};
+
+#endif // DANMUWIRE_H
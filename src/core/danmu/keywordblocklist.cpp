@@ -0,0 +1,21 @@
+#include "keywordblocklist.h"
+#include "filewatcher.h"
+
+KeywordBlocklist::KeywordBlocklist(QObject *parent)
+    : KeywordFilterLoader(parent)
+    , fileWatcher_(new FileWatcher(this))
+{
+    connect(fileWatcher_, &FileWatcher::fileChanged, this, [this]() {
+        if (!path_.isEmpty())
+            rebuild(path_, QStringList());
+    });
+}
+
+void KeywordBlocklist::load(const QString &path)
+{
+    if (path != path_) {
+        path_ = path;
+        fileWatcher_->addWatch(path_);
+    }
+    rebuild(path_, QStringList());
+}
@@ -0,0 +1,24 @@
+#ifndef KEYWORDBLOCKLIST_H
+#define KEYWORDBLOCKLIST_H
+
+#include "keywordfilterloader.h"
+
+class FileWatcher;
+
+// 弹幕屏蔽词表：从文件加载关键词，文件变化时经由 FileWatcher（与 TrayManager 热更新菜单相同的机制）
+// 自动重新加载。后台构建与替换见 KeywordFilterLoader。
+class KeywordBlocklist : public KeywordFilterLoader
+{
+    Q_OBJECT
+public:
+    explicit KeywordBlocklist(QObject *parent = nullptr);
+
+    // 异步加载并开始监视 path，文件不存在时屏蔽词为空
+    void load(const QString &path);
+
+private:
+    QString path_;
+    FileWatcher *fileWatcher_ = nullptr;
+};
+
+#endif // KEYWORDBLOCKLIST_H
@@ -0,0 +1,208 @@
+#include "keywordfilter.h"
+#include "danmutext_p.h"
+
+#include <QSet>
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+
+namespace {
+constexpr int kRoot = 0;
+constexpr int kAlphabet = 0x10000;
+
+char32_t fold(char32_t codePoint)
+{
+    return QChar::toCaseFolded(codePoint);
+}
+
+void appendFolded(QString *out, char32_t codePoint)
+{
+    const char32_t folded = fold(codePoint);
+    if (QChar::requiresSurrogates(folded)) {
+        out->append(QChar(QChar::highSurrogate(folded)));
+        out->append(QChar(QChar::lowSurrogate(folded)));
+    } else {
+        out->append(QChar(static_cast<char16_t>(folded)));
+    }
+}
+}
+
+KeywordFilter::KeywordFilter()
+    : KeywordFilter(QStringList())
+{
+}
+
+KeywordFilter::KeywordFilter(const QStringList &keywords)
+{
+    QSet<QString> seen;
+    for (const QString &keyword : keywords) {
+        QString folded;
+        folded.reserve(keyword.size());
+        forEachCodePoint(QStringView(keyword), [&folded](char32_t codePoint) {
+            appendFolded(&folded, codePoint);
+            return false;
+        });
+        if (folded.isEmpty() || seen.contains(folded))
+            continue;
+        seen.insert(folded);
+        keywords_.append(folded);
+    }
+    if (keywords_.isEmpty())
+        return;
+
+    // 先用哈希表建 trie，再把出边按 (状态, 字符) 排序压成 CSR
+    struct Edge {
+        qint32 from;
+        char16_t unit;
+        qint32 to;
+    };
+    std::vector<Edge> edges;
+    std::unordered_map<quint64, qint32> children;
+    std::vector<qint32> terminal(1, -1);
+    for (int k = 0; k < keywords_.size(); ++k) {
+        qint32 state = kRoot;
+        for (QChar c : keywords_.at(k)) {
+            const quint64 key = (quint64(state) << 16) | c.unicode();
+            auto it = children.find(key);
+            if (it == children.end()) {
+                const qint32 child = static_cast<qint32>(terminal.size());
+                terminal.push_back(-1);
+                edges.push_back({ state, c.unicode(), child });
+                it = children.emplace(key, child).first;
+            }
+            state = it->second;
+        }
+        if (terminal[state] < 0)
+            terminal[state] = k;
+    }
+
+    const int states = static_cast<int>(terminal.size());
+    std::sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) {
+        return a.from != b.from ? a.from < b.from : a.unit < b.unit;
+    });
+    edgeBegin_.assign(states + 1, 0);
+    edgeUnit_.resize(edges.size());
+    edgeTarget_.resize(edges.size());
+    rootNext_.assign(kAlphabet, kRoot);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        ++edgeBegin_[edges[i].from + 1];
+        edgeUnit_[i] = edges[i].unit;
+        edgeTarget_[i] = edges[i].to;
+        if (edges[i].from == kRoot)
+            rootNext_[edges[i].unit] = edges[i].to;
+    }
+    for (int s = 0; s < states; ++s)
+        edgeBegin_[s + 1] += edgeBegin_[s];
+
+    // 按层次遍历求失败指针；较浅的状态先处理，输出沿失败指针继承
+    fail_.assign(states, kRoot);
+    output_.assign(states, -1);
+    std::deque<qint32> queue;
+    for (qint32 e = edgeBegin_[kRoot]; e < edgeBegin_[kRoot + 1]; ++e) {
+        const qint32 child = edgeTarget_[e];
+        output_[child] = terminal[child];
+        queue.push_back(child);
+    }
+    while (!queue.empty()) {
+        const qint32 state = queue.front();
+        queue.pop_front();
+        for (qint32 e = edgeBegin_[state]; e < edgeBegin_[state + 1]; ++e) {
+            const qint32 child = edgeTarget_[e];
+            const char16_t unit = edgeUnit_[e];
+            qint32 f = fail_[state];
+            qint32 target = next(f, unit);
+            while (target < 0) {
+                f = fail_[f];
+                target = next(f, unit);
+            }
+            fail_[child] = target;
+            output_[child] = terminal[child] >= 0 ? terminal[child] : output_[target];
+            queue.push_back(child);
+        }
+    }
+}
+
+KeywordFilter::Stats KeywordFilter::stats() const
+{
+    Stats stats;
+    stats.keywords = keywords_.size();
+    stats.states = static_cast<int>(fail_.size());
+    stats.memoryBytes = static_cast<qsizetype>(rootNext_.size() * sizeof(qint32)
+                                               + edgeBegin_.size() * sizeof(qint32)
+                                               + edgeUnit_.size() * sizeof(char16_t)
+                                               + edgeTarget_.size() * sizeof(qint32)
+                                               + fail_.size() * sizeof(qint32)
+                                               + output_.size() * sizeof(qint32));
+    return stats;
+}
+
+int KeywordFilter::next(int state, char16_t unit) const
+{
+    // 根状态不会失败：没有出边时留在根
+    if (state == kRoot)
+        return rootNext_[unit];
+    const char16_t *begin = edgeUnit_.data() + edgeBegin_[state];
+    const char16_t *end = edgeUnit_.data() + edgeBegin_[state + 1];
+    const char16_t *it = std::lower_bound(begin, end, unit);
+    if (it == end || *it != unit)
+        return -1;
+    return edgeTarget_[it - edgeUnit_.data()];
+}
+
+bool KeywordFilter::feed(int *state, char32_t codePoint, int *keyword) const
+{
+    const char32_t folded = fold(codePoint);
+    char16_t units[2];
+    int count = 1;
+    if (QChar::requiresSurrogates(folded)) {
+        units[0] = QChar::highSurrogate(folded);
+        units[1] = QChar::lowSurrogate(folded);
+        count = 2;
+    } else {
+        units[0] = static_cast<char16_t>(folded);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        int s = *state;
+        int target = next(s, units[i]);
+        while (target < 0) {
+            s = fail_[s];
+            target = next(s, units[i]);
+        }
+        *state = target;
+        if (output_[target] >= 0) {
+            if (keyword)
+                *keyword = output_[target];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool KeywordFilter::matches(QStringView text, int *keyword) const
+{
+    if (keywords_.isEmpty())
+        return false;
+    int state = kRoot;
+    return forEachCodePoint(text, [&](char32_t codePoint) { return feed(&state, codePoint, keyword); });
+}
+
+bool KeywordFilter::matches(QUtf8StringView text, int *keyword) const
+{
+    if (keywords_.isEmpty())
+        return false;
+    int state = kRoot;
+    return forEachCodePoint(text, [&](char32_t codePoint) { return feed(&state, codePoint, keyword); });
+}
+
+QStringList KeywordFilter::parse(const QString &content)
+{
+    QStringList keywords;
+    for (QStringView line : QStringView(content).split(u'\n')) {
+        line = line.trimmed();
+        if (line.isEmpty() || line.startsWith(u'#'))
+            continue;
+        keywords.append(line.toString());
+    }
+    return keywords;
+}
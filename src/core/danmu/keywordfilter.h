@@ -0,0 +1,52 @@
+#ifndef KEYWORDFILTER_H
+#define KEYWORDFILTER_H
+
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QUtf8StringView>
+#include <vector>
+
+// 弹幕关键词屏蔽：把关键词表编译成 Aho-Corasick 自动机，每条弹幕只扫描一遍即可判断是否命中任一关键词，
+// 耗时与弹幕长度成正比，与关键词数量无关。匹配不区分大小写（按码点做简单大小写折叠）。
+// 自动机以 UTF-16 码元为字母表：根状态用 65536 项的直接跳转表，其余状态的出边按字符排序
+// 连续存放（CSR），二分查找。UTF-8 输入边解码边匹配，不做整串转换。
+// 构建后只读，可在多个线程中同时使用；后台构建与热更新见 KeywordFilterLoader / KeywordBlocklist。
+class KeywordFilter
+{
+public:
+    struct Stats {
+        int keywords = 0;
+        int states = 0;
+        qsizetype memoryBytes = 0;
+    };
+
+    KeywordFilter();
+    // 空串与重复的关键词被忽略
+    explicit KeywordFilter(const QStringList& keywords);
+
+    bool isEmpty() const { return keywords_.isEmpty(); }
+    Stats stats() const;
+
+    // 命中任一关键词时返回 true，keyword 不为空时写入最先结束的命中关键词下标
+    bool matches(QStringView text, int* keyword = nullptr) const;
+    bool matches(QUtf8StringView text, int* keyword = nullptr) const;
+    const QString& keyword(int index) const { return keywords_.at(index); }
+
+    // 屏蔽词文件：一行一个关键词，首尾空白被去掉，空行与 # 开头的行忽略
+    static QStringList parse(const QString& content);
+
+private:
+    int next(int state, char16_t unit) const;
+    bool feed(int* state, char32_t codePoint, int* keyword) const;
+
+    QStringList keywords_;                  // 折叠后的关键词
+    std::vector<qint32> rootNext_;          // 根状态的直接跳转表
+    std::vector<qint32> edgeBegin_;         // 状态 s 的出边为 [edgeBegin_[s], edgeBegin_[s + 1])
+    std::vector<char16_t> edgeUnit_;
+    std::vector<qint32> edgeTarget_;
+    std::vector<qint32> fail_;
+    std::vector<qint32> output_;            // 到达该状态即命中的关键词（含后缀链上的），-1 为无
+};
+
+#endif // KEYWORDFILTER_H
@@ -0,0 +1,91 @@
+#include "keywordfilterloader.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMetaObject>
+
+KeywordFilterLoader::KeywordFilterLoader(QObject *parent)
+    : QObject(parent)
+    , filter_(std::make_shared<const KeywordFilter>())
+{
+    // 构建按提交顺序进行，旧的结果即使晚到也会被 generation 过滤
+    pool_.setMaxThreadCount(1);
+}
+
+KeywordFilterLoader::~KeywordFilterLoader()
+{
+    pool_.clear();
+    pool_.waitForDone();
+}
+
+quint64 KeywordFilterLoader::rebuild(const QString &path, const QStringList &keywords)
+{
+    const quint64 generation = ++generation_;
+    // 尚未开始的旧任务已无意义
+    pool_.clear();
+    pool_.start([this, generation, path, keywords]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        QStringList list = keywords;
+        if (!path.isEmpty() && !readKeywords(path, &list)) {
+            QMetaObject::invokeMethod(this, [this, path]() {
+                qWarning() << "KeywordFilterLoader: cannot open" << path;
+                emit reloadFailed(path);
+            }, Qt::QueuedConnection);
+            return;
+        }
+
+        auto filter = std::make_shared<const KeywordFilter>(list);
+        const double buildMs = timer.nsecsElapsed() / 1e6;
+        QMetaObject::invokeMethod(this, [this, generation, filter, buildMs]() {
+            install(generation, filter, buildMs);
+        }, Qt::QueuedConnection);
+    });
+    return generation;
+}
+
+void KeywordFilterLoader::setKeywords(const QStringList &keywords)
+{
+    rebuild(QString(), keywords);
+}
+
+std::shared_ptr<const KeywordFilter> KeywordFilterLoader::filter() const
+{
+    return std::atomic_load(&filter_);
+}
+
+bool KeywordFilterLoader::isBlocked(QStringView text) const
+{
+    return filter()->matches(text);
+}
+
+bool KeywordFilterLoader::isBlocked(QUtf8StringView text) const
+{
+    return filter()->matches(text);
+}
+
+bool KeywordFilterLoader::readKeywords(const QString &path, QStringList *keywords)
+{
+    QFile file(path);
+    if (!file.exists()) {
+        keywords->clear();
+        return true;
+    }
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    *keywords = KeywordFilter::parse(QString::fromUtf8(file.readAll()));
+    return true;
+}
+
+void KeywordFilterLoader::install(quint64 generation, std::shared_ptr<const KeywordFilter> filter, double buildMs)
+{
+    if (generation != generation_)
+        return;
+    const KeywordFilter::Stats stats = filter->stats();
+    std::atomic_store(&filter_, std::shared_ptr<const KeywordFilter>(std::move(filter)));
+    qInfo() << "KeywordFilterLoader: loaded" << stats.keywords << "keywords," << stats.states << "states,"
+            << stats.memoryBytes / 1024 << "KiB in" << buildMs << "ms";
+    emit reloaded(stats.keywords, buildMs);
+}
@@ -0,0 +1,50 @@
+#ifndef KEYWORDFILTERLOADER_H
+#define KEYWORDFILTERLOADER_H
+
+#include "keywordfilter.h"
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <memory>
+
+// 在后台构建 KeywordFilter 并整体替换当前自动机。读文件与构建在单线程的线程池中按提交顺序进行，
+// 每次提交递增 generation，过期的构建结果到达时直接丢弃，因此只有最后一次提交会生效；
+// 正在进行的匹配继续使用旧的自动机。filter() / isBlocked() 可在任意线程调用，其余接口只在对象所在线程调用。
+class KeywordFilterLoader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit KeywordFilterLoader(QObject *parent = nullptr);
+    ~KeywordFilterLoader() override;
+
+    // 异步构建；path 非空时从文件读取（格式见 KeywordFilter::parse，文件不存在时为空表），否则使用 keywords。
+    // 返回本次提交的 generation
+    quint64 rebuild(const QString &path, const QStringList &keywords);
+    // 直接替换关键词
+    void setKeywords(const QStringList &keywords);
+
+    std::shared_ptr<const KeywordFilter> filter() const;
+    bool isBlocked(QStringView text) const;
+    bool isBlocked(QUtf8StringView text) const;
+    quint64 generation() const { return generation_; }
+
+signals:
+    // 新的自动机已生效；连续多次变化时只有最后一次会生效并发出
+    void reloaded(int keywords, double buildMs);
+    void reloadFailed(const QString &path);
+
+protected:
+    // 在线程池中调用，读取失败返回 false
+    virtual bool readKeywords(const QString &path, QStringList *keywords);
+
+private:
+    void install(quint64 generation, std::shared_ptr<const KeywordFilter> filter, double buildMs);
+
+    QThreadPool pool_;
+    quint64 generation_ = 0;
+    std::shared_ptr<const KeywordFilter> filter_;   // 通过 std::atomic_load / atomic_store 访问
+};
+
+#endif // KEYWORDFILTERLOADER_H
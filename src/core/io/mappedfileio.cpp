@@ -0,0 +1,168 @@
+#include "mappedfileio.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+extern "C" {
+#include <libavutil/error.h>
+#include <libavutil/mem.h>
+}
+
+namespace {
+// 大于该值的 avio_read 会绕过内部缓冲直接调用 readPacket，包数据只拷贝一次
+constexpr int kContextBufferSize = 256 * 1024;
+
+#ifdef Q_OS_UNIX
+qint64 pageSize()
+{
+    static const qint64 size = sysconf(_SC_PAGESIZE);
+    return size;
+}
+#endif
+}
+
+MappedFileIO::MappedFileIO(qint64 readAheadBytes)
+    : readAhead_(readAheadBytes)
+{
+}
+
+MappedFileIO::~MappedFileIO()
+{
+    close();
+}
+
+bool MappedFileIO::open(const QString &path)
+{
+    close();
+
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::ReadOnly))
+        return false;
+
+    size_ = file_.size();
+    data_ = size_ > 0 ? file_.map(0, size_) : nullptr;
+    if (!data_) {
+        qWarning() << "mmap failed, falling back to file protocol:" << path << file_.errorString();
+        file_.close();
+        size_ = 0;
+        return false;
+    }
+
+#ifdef Q_OS_UNIX
+    madvise(const_cast<uchar *>(data_), static_cast<size_t>(size_), MADV_SEQUENTIAL);
+#endif
+
+    position_ = 0;
+    bytesRead_ = 0;
+    reads_ = 0;
+    seeks_ = 0;
+    adviseCalls_ = 0;
+    advisedUntil_ = 0;
+    adviseAhead();
+
+    auto *buffer = static_cast<unsigned char *>(av_malloc(kContextBufferSize));
+    context_ = avio_alloc_context(buffer, kContextBufferSize, 0, this,
+                                  &MappedFileIO::readPacket, nullptr, &MappedFileIO::seekPacket);
+    context_->seekable = AVIO_SEEKABLE_NORMAL;
+    return true;
+}
+
+void MappedFileIO::close()
+{
+    if (context_) {
+        av_freep(&context_->buffer);
+        avio_context_free(&context_);
+    }
+    if (data_) {
+        file_.unmap(const_cast<uchar *>(data_));
+        data_ = nullptr;
+    }
+    if (file_.isOpen())
+        file_.close();
+    size_ = 0;
+}
+
+MappedFileIO::Stats MappedFileIO::stats() const
+{
+    Stats stats;
+    stats.size = size_;
+    stats.position = position_.load(std::memory_order_relaxed);
+    stats.bytesRead = bytesRead_.load(std::memory_order_relaxed);
+    stats.reads = reads_.load(std::memory_order_relaxed);
+    stats.seeks = seeks_.load(std::memory_order_relaxed);
+    stats.adviseCalls = adviseCalls_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+int MappedFileIO::readPacket(void *opaque, uint8_t *buf, int size)
+{
+    auto *self = static_cast<MappedFileIO *>(opaque);
+    const qint64 position = self->position_.load(std::memory_order_relaxed);
+    const qint64 remaining = self->size_ - position;
+    if (remaining <= 0)
+        return AVERROR_EOF;
+
+    const int count = static_cast<int>(std::min<qint64>(size, remaining));
+    std::memcpy(buf, self->data_ + position, static_cast<size_t>(count));
+    self->position_.store(position + count, std::memory_order_relaxed);
+    self->bytesRead_.fetch_add(count, std::memory_order_relaxed);
+    self->reads_.fetch_add(1, std::memory_order_relaxed);
+    self->adviseAhead();
+    return count;
+}
+
+int64_t MappedFileIO::seekPacket(void *opaque, int64_t offset, int whence)
+{
+    auto *self = static_cast<MappedFileIO *>(opaque);
+    if (whence & AVSEEK_SIZE)
+        return self->size_;
+
+    int64_t target = offset;
+    switch (whence & ~AVSEEK_FORCE) {
+    case SEEK_SET:
+        break;
+    case SEEK_CUR:
+        target += self->position_.load(std::memory_order_relaxed);
+        break;
+    case SEEK_END:
+        target += self->size_;
+        break;
+    default:
+        return AVERROR(EINVAL);
+    }
+    if (target < 0 || target > self->size_)
+        return AVERROR(EINVAL);
+
+    self->position_.store(target, std::memory_order_relaxed);
+    self->seeks_.fetch_add(1, std::memory_order_relaxed);
+    // 跳转后从新位置重新预读
+    self->advisedUntil_ = target;
+    self->adviseAhead();
+    return target;
+}
+
+void MappedFileIO::adviseAhead()
+{
+#ifdef Q_OS_UNIX
+    // 读位置越过已提示窗口的一半时，再把后面一整个窗口提示给内核
+    const qint64 position = position_.load(std::memory_order_relaxed);
+    if (readAhead_ <= 0 || position + readAhead_ / 2 < advisedUntil_ || advisedUntil_ >= size_)
+        return;
+
+    const qint64 page = pageSize();
+    const qint64 begin = std::max(position, advisedUntil_) / page * page;
+    const qint64 end = std::min(size_, position + readAhead_);
+    if (end <= begin)
+        return;
+
+    madvise(const_cast<uchar *>(data_) + begin, static_cast<size_t>(end - begin), MADV_WILLNEED);
+    advisedUntil_ = end;
+    adviseCalls_.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
@@ -0,0 +1,64 @@
+#ifndef MAPPEDFILEIO_H
+#define MAPPEDFILEIO_H
+
+#include <QFile>
+#include <QString>
+#include <atomic>
+
+extern "C" {
+#include <libavformat/avio.h>
+}
+
+// 本地文件的内存映射 AVIOContext：数据直接从映射区拷给 FFmpeg，
+// 省去 file 协议逐块 read() 的系统调用与内核拷贝。POSIX 下对整个映射声明顺序访问，
+// 并在读位置前方按窗口发出 MADV_WILLNEED，让内核提前把页读进页缓存。
+// 播放期间文件被截断时访问映射区会触发 SIGBUS，只用于不会被改写的本地录像。
+class MappedFileIO
+{
+public:
+    struct Stats {
+        qint64 size = 0;
+        qint64 position = 0;
+        qint64 bytesRead = 0;
+        quint64 reads = 0;
+        quint64 seeks = 0;
+        quint64 adviseCalls = 0;   // WILLNEED 提示次数
+    };
+
+    explicit MappedFileIO(qint64 readAheadBytes = 16 << 20);
+    ~MappedFileIO();
+
+    MappedFileIO(const MappedFileIO &) = delete;
+    MappedFileIO &operator=(const MappedFileIO &) = delete;
+
+    // 映射失败（空文件、32 位进程地址空间不足等）返回 false，调用方退回默认协议
+    bool open(const QString &path);
+    void close();
+
+    // 交给 AVFormatContext::pb，调用方需设置 AVFMT_FLAG_CUSTOM_IO，且不负责释放
+    AVIOContext *context() const { return context_; }
+
+    Stats stats() const;
+
+private:
+    static int readPacket(void *opaque, uint8_t *buf, int size);
+    static int64_t seekPacket(void *opaque, int64_t offset, int whence);
+
+    void adviseAhead();
+
+    QFile file_;
+    const uchar *data_ = nullptr;
+    qint64 size_ = 0;
+    qint64 readAhead_ = 0;
+    AVIOContext *context_ = nullptr;
+
+    // 只有解复用线程读写，原子量仅为 stats() 跨线程读取
+    std::atomic<qint64> position_{0};
+    std::atomic<qint64> bytesRead_{0};
+    std::atomic<quint64> reads_{0};
+    std::atomic<quint64> seeks_{0};
+    std::atomic<quint64> adviseCalls_{0};
+    qint64 advisedUntil_ = 0;
+};
+
+#endif // MAPPEDFILEIO_H
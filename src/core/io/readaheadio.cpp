@@ -0,0 +1,295 @@
+#include "readaheadio.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/error.h>
+#include <libavutil/mem.h>
+}
+
+namespace {
+// 交给 FFmpeg 的 AVIOContext 内部缓冲，与预读环形缓冲无关
+constexpr int kContextBufferSize = 32 * 1024;
+}
+
+ReadAheadIO::ReadAheadIO(const Options &options)
+    : options_(options)
+{
+}
+
+ReadAheadIO::~ReadAheadIO()
+{
+    close();
+}
+
+void ReadAheadIO::setOptions(const Options &options)
+{
+    options_ = options;
+}
+
+int ReadAheadIO::open(const QString &url)
+{
+    close();
+    aborted_ = false;
+
+    AVIOInterruptCB interrupt{ &ReadAheadIO::interruptCallback, this };
+    const int ret = avio_open2(&source_, url.toStdString().c_str(), AVIO_FLAG_READ, &interrupt, nullptr);
+    if (ret < 0)
+        return ret;
+
+    const qint64 wanted = static_cast<qint64>(options_.bufferSeconds * options_.assumedBitrate / 8);
+    {
+        QMutexLocker locker(&mutex_);
+        ring_.assign(static_cast<size_t>(std::clamp(wanted, options_.minBufferBytes, options_.maxBufferBytes)), 0);
+        readTotal_ = writeTotal_ = 0;
+        readOffset_ = 0;
+        sourceSize_ = avio_size(source_);
+        seekable_ = (source_->seekable & AVIO_SEEKABLE_NORMAL) != 0;
+        endOfStream_ = false;
+        error_ = 0;
+        rebuffering_ = true;
+        bitrate_ = options_.assumedBitrate;
+        underruns_ = 0;
+        stallNs_ = lastRefillNs_ = totalRefillNs_ = maxRefillNs_ = 0;
+        refills_ = 0;
+        totalBytes_ = 0;
+    }
+
+    auto *buffer = static_cast<unsigned char *>(av_malloc(kContextBufferSize));
+    context_ = avio_alloc_context(buffer, kContextBufferSize, 0, this,
+                                  &ReadAheadIO::readPacket, nullptr,
+                                  seekable_ ? &ReadAheadIO::seekPacket : nullptr);
+    context_->seekable = seekable_ ? AVIO_SEEKABLE_NORMAL : 0;
+
+    thread_ = QThread::create([this]() { fillLoop(); });
+    thread_->start();
+    return 0;
+}
+
+void ReadAheadIO::close()
+{
+    abort();
+    if (thread_) {
+        thread_->wait();
+        delete thread_;
+        thread_ = nullptr;
+    }
+    if (context_) {
+        av_freep(&context_->buffer);
+        avio_context_free(&context_);
+    }
+    if (source_)
+        avio_closep(&source_);
+}
+
+void ReadAheadIO::abort()
+{
+    aborted_ = true;
+    QMutexLocker locker(&mutex_);
+    dataAvailable_.wakeAll();
+    spaceAvailable_.wakeAll();
+    seekDone_.wakeAll();
+}
+
+void ReadAheadIO::setBitrate(qint64 bitsPerSecond)
+{
+    if (bitsPerSecond <= 0)
+        return;
+    QMutexLocker locker(&mutex_);
+    bitrate_ = bitsPerSecond;
+}
+
+ReadAheadIO::Stats ReadAheadIO::stats() const
+{
+    QMutexLocker locker(&mutex_);
+    Stats stats;
+    stats.capacity = static_cast<qint64>(ring_.size());
+    stats.buffered = writeTotal_ - readTotal_;
+    stats.fillLevel = stats.capacity > 0 ? double(stats.buffered) / stats.capacity : 0.0;
+    stats.bufferedSeconds = bitrate_ > 0 ? stats.buffered * 8.0 / bitrate_ : 0.0;
+    stats.underruns = underruns_;
+    stats.stallMs = stallNs_ / 1e6;
+    stats.lastRefillMs = lastRefillNs_ / 1e6;
+    stats.averageRefillMs = refills_ > 0 ? totalRefillNs_ / 1e6 / refills_ : 0.0;
+    stats.maxRefillMs = maxRefillNs_ / 1e6;
+    stats.totalBytes = totalBytes_;
+    stats.endOfStream = endOfStream_;
+    return stats;
+}
+
+int ReadAheadIO::readPacket(void *opaque, uint8_t *buf, int size)
+{
+    return static_cast<ReadAheadIO *>(opaque)->read(buf, size);
+}
+
+int64_t ReadAheadIO::seekPacket(void *opaque, int64_t offset, int whence)
+{
+    return static_cast<ReadAheadIO *>(opaque)->seek(offset, whence);
+}
+
+int ReadAheadIO::interruptCallback(void *opaque)
+{
+    return static_cast<ReadAheadIO *>(opaque)->aborted_ ? 1 : 0;
+}
+
+qint64 ReadAheadIO::prebufferBytesLocked() const
+{
+    const qint64 bytes = static_cast<qint64>(options_.prebufferSeconds * bitrate_ / 8);
+    // 不能超过容量，否则永远攒不够
+    return std::min<qint64>(bytes, static_cast<qint64>(ring_.size()) / 2);
+}
+
+// --- 读端（解复用线程） ---
+int ReadAheadIO::read(uint8_t *buf, int size)
+{
+    QMutexLocker locker(&mutex_);
+
+    if (writeTotal_ == readTotal_ && !endOfStream_ && !aborted_ && !rebuffering_) {
+        ++underruns_;
+        rebuffering_ = options_.prebufferSeconds > 0;
+    }
+
+    QElapsedTimer stall;
+    stall.start();
+    const qint64 prebuffer = prebufferBytesLocked();
+    while (!aborted_ && !endOfStream_) {
+        const qint64 buffered = writeTotal_ - readTotal_;
+        if (buffered > 0 && (!rebuffering_ || buffered >= prebuffer))
+            break;
+        dataAvailable_.wait(&mutex_);
+    }
+    rebuffering_ = false;
+    stallNs_ += stall.nsecsElapsed();
+
+    if (aborted_)
+        return AVERROR_EXIT;
+
+    const qint64 buffered = writeTotal_ - readTotal_;
+    if (buffered == 0)
+        return error_ < 0 ? error_ : AVERROR_EOF;
+
+    const qint64 capacity = static_cast<qint64>(ring_.size());
+    const int count = static_cast<int>(std::min<qint64>(size, buffered));
+    const qint64 pos = readTotal_ % capacity;
+    const qint64 first = std::min<qint64>(count, capacity - pos);
+    std::memcpy(buf, ring_.data() + pos, static_cast<size_t>(first));
+    if (first < count)
+        std::memcpy(buf + first, ring_.data(), static_cast<size_t>(count - first));
+
+    readTotal_ += count;
+    readOffset_ += count;
+    spaceAvailable_.wakeOne();
+    return count;
+}
+
+int64_t ReadAheadIO::seek(int64_t offset, int whence)
+{
+    QMutexLocker locker(&mutex_);
+    if (whence & AVSEEK_SIZE)
+        return sourceSize_ >= 0 ? sourceSize_ : AVERROR(ENOSYS);
+
+    whence &= ~AVSEEK_FORCE;
+    int64_t target = offset;
+    if (whence == SEEK_CUR)
+        target = readOffset_ + offset;
+    else if (whence == SEEK_END) {
+        if (sourceSize_ < 0)
+            return AVERROR(ENOSYS);
+        target = sourceSize_ + offset;
+    } else if (whence != SEEK_SET) {
+        return AVERROR(EINVAL);
+    }
+    if (target < 0)
+        return AVERROR(EINVAL);
+
+    // 目标已在缓冲内（探测格式时常见的小幅向前跳），直接丢弃中间数据
+    const qint64 buffered = writeTotal_ - readTotal_;
+    if (target >= readOffset_ && target <= readOffset_ + buffered) {
+        readTotal_ += target - readOffset_;
+        readOffset_ = target;
+        spaceAvailable_.wakeOne();
+        return target;
+    }
+
+    ++generation_;
+    readTotal_ = writeTotal_;
+    seekTarget_ = target;
+    seekRequested_ = true;
+    endOfStream_ = false;
+    error_ = 0;
+    spaceAvailable_.wakeAll();
+    while (seekRequested_ && !aborted_)
+        seekDone_.wait(&mutex_);
+    if (aborted_)
+        return AVERROR_EXIT;
+
+    if (seekResult_ >= 0)
+        readOffset_ = target;
+    return seekResult_;
+}
+
+// --- 预读线程 ---
+void ReadAheadIO::fillLoop()
+{
+    std::vector<uint8_t> chunk(static_cast<size_t>(options_.chunkBytes));
+    QElapsedTimer timer;
+
+    QMutexLocker locker(&mutex_);
+    while (!aborted_) {
+        if (seekRequested_) {
+            locker.unlock();
+            const int64_t result = avio_seek(source_, seekTarget_, SEEK_SET);
+            locker.relock();
+            seekResult_ = result;
+            seekRequested_ = false;
+            // 可跳转的源（点播、本地文件）读得比消费快，跳转后不必再攒预缓冲
+            rebuffering_ = false;
+            seekDone_.wakeAll();
+            continue;
+        }
+
+        const qint64 capacity = static_cast<qint64>(ring_.size());
+        const qint64 space = capacity - (writeTotal_ - readTotal_);
+        if (space == 0 || endOfStream_) {
+            spaceAvailable_.wait(&mutex_);
+            continue;
+        }
+
+        const quint64 generation = generation_;
+        const int want = static_cast<int>(std::min<qint64>(space, options_.chunkBytes));
+        locker.unlock();
+
+        timer.start();
+        const int got = avio_read_partial(source_, chunk.data(), want);
+        const qint64 elapsed = timer.nsecsElapsed();
+
+        locker.relock();
+        // 读取期间发生了跳转，这段数据属于旧位置
+        if (generation != generation_)
+            continue;
+
+        lastRefillNs_ = elapsed;
+        totalRefillNs_ += elapsed;
+        maxRefillNs_ = std::max(maxRefillNs_, elapsed);
+        ++refills_;
+
+        if (got > 0) {
+            const qint64 pos = writeTotal_ % capacity;
+            const qint64 first = std::min<qint64>(got, capacity - pos);
+            std::memcpy(ring_.data() + pos, chunk.data(), static_cast<size_t>(first));
+            if (first < got)
+                std::memcpy(ring_.data(), chunk.data() + first, static_cast<size_t>(got - first));
+            writeTotal_ += got;
+            totalBytes_ += got;
+        } else if (got == AVERROR_EOF || got < 0) {
+            if (got != AVERROR_EOF && got != AVERROR_EXIT)
+                qWarning() << "Read-ahead source error" << got;
+            error_ = got == AVERROR_EOF ? 0 : got;
+            endOfStream_ = true;
+        }
+        dataAvailable_.wakeAll();
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef READAHEADIO_H
+#define READAHEADIO_H
+
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+#include <vector>
+
+extern "C" {
+#include <libavformat/avio.h>
+}
+
+// 带预读线程的自定义 AVIOContext：后台线程通过 FFmpeg 协议层（http/tcp/file…）
+// 持续读取到环形缓冲，解复用线程只从缓冲取数据，网络卡顿不再直接阻塞解码流水线。
+// 缓冲读空后进入重新缓冲，攒够 prebufferSeconds 再继续输出，相当于一个抖动缓冲。
+class ReadAheadIO
+{
+public:
+    struct Options {
+        double bufferSeconds = 8.0;       // 环形缓冲容量（按码率折算）
+        double prebufferSeconds = 1.0;    // 起播与欠载后需攒够的数据量，<= 0 表示有数据即返回
+        qint64 assumedBitrate = 8'000'000;   // 探测出实际码率前用于折算（bit/s）
+        qint64 minBufferBytes = 1 << 20;
+        qint64 maxBufferBytes = 64 << 20;
+        int chunkBytes = 64 * 1024;       // 预读线程单次读取上限
+    };
+
+    struct Stats {
+        qint64 capacity = 0;
+        qint64 buffered = 0;
+        double fillLevel = 0.0;           // buffered / capacity
+        double bufferedSeconds = 0.0;     // 按当前码率估算
+        quint64 underruns = 0;            // 读端遇到空缓冲的次数（不含起播）
+        double stallMs = 0.0;             // 读端累计等待时间
+        double lastRefillMs = 0.0;        // 预读线程最近一次上游读取耗时
+        double averageRefillMs = 0.0;
+        double maxRefillMs = 0.0;
+        qint64 totalBytes = 0;            // 上游读取总量
+        bool endOfStream = false;
+    };
+
+    explicit ReadAheadIO(const Options &options = Options());
+    ~ReadAheadIO();
+
+    ReadAheadIO(const ReadAheadIO &) = delete;
+    ReadAheadIO &operator=(const ReadAheadIO &) = delete;
+
+    // 下次 open() 生效，不能与 open() 并发调用
+    void setOptions(const Options &options);
+    const Options &options() const { return options_; }
+
+    // 打开上游并启动预读线程；失败时返回 FFmpeg 错误码
+    int open(const QString &url);
+    void close();
+
+    // 交给 AVFormatContext::pb，调用方需设置 AVFMT_FLAG_CUSTOM_IO，且不负责释放
+    AVIOContext *context() const { return context_; }
+
+    // 唤醒所有等待并让后续读取返回 AVERROR_EXIT，可从任意线程调用
+    void abort();
+
+    // 探测出码率后调用，用于秒数与字节数的折算
+    void setBitrate(qint64 bitsPerSecond);
+
+    Stats stats() const;
+
+private:
+    static int readPacket(void *opaque, uint8_t *buf, int size);
+    static int64_t seekPacket(void *opaque, int64_t offset, int whence);
+    static int interruptCallback(void *opaque);
+
+    int read(uint8_t *buf, int size);
+    int64_t seek(int64_t offset, int whence);
+    void fillLoop();
+    qint64 prebufferBytesLocked() const;
+
+    Options options_;
+    AVIOContext *source_ = nullptr;
+    AVIOContext *context_ = nullptr;
+    QThread *thread_ = nullptr;
+    std::atomic<bool> aborted_{false};
+
+    mutable QMutex mutex_;
+    QWaitCondition dataAvailable_;
+    QWaitCondition spaceAvailable_;
+    QWaitCondition seekDone_;
+    std::vector<uint8_t> ring_;
+    qint64 readTotal_ = 0;
+    qint64 writeTotal_ = 0;
+    qint64 readOffset_ = 0;        // 读端下一个字节在上游中的偏移
+    qint64 sourceSize_ = -1;
+    bool seekable_ = false;
+    bool endOfStream_ = false;
+    int error_ = 0;
+    bool rebuffering_ = true;
+    quint64 generation_ = 0;       // 每次跳转递增，作废跳转前发起的上游读取
+    bool seekRequested_ = false;
+    qint64 seekTarget_ = 0;
+    int64_t seekResult_ = 0;
+    qint64 bitrate_ = 0;
+
+    quint64 underruns_ = 0;
+    qint64 stallNs_ = 0;
+    qint64 lastRefillNs_ = 0;
+    qint64 totalRefillNs_ = 0;
+    qint64 maxRefillNs_ = 0;
+    quint64 refills_ = 0;
+    qint64 totalBytes_ = 0;
+};
+
+#endif // READAHEADIO_H
@@ -0,0 +1,25 @@
+#ifndef ASPECTFIT_H
+#define ASPECTFIT_H
+
+#include <QRectF>
+
+// 在 bounds 内按 w:h 等比放置画面并居中（留黑边），尺寸无效时返回 bounds
+inline QRectF aspectFit(const QRectF &bounds, int w, int h)
+{
+    if (w <= 0 || h <= 0 || bounds.isEmpty())
+        return bounds;
+
+    const double boundsAspect = bounds.width() / bounds.height();
+    const double videoAspect = double(w) / h;
+    QSizeF size = bounds.size();
+    if (boundsAspect > videoAspect)
+        size.setWidth(bounds.height() * videoAspect);    // 区域比视频宽，宽度缩小
+    else
+        size.setHeight(bounds.width() / videoAspect);    // 区域比视频高，高度缩小
+
+    QRectF rect(QPointF(), size);
+    rect.moveCenter(bounds.center());
+    return rect;
+}
+
+#endif // ASPECTFIT_H
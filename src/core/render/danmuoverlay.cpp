@@ -0,0 +1,574 @@
+#include "danmuoverlay.h"
+#include "danmutext_p.h"
+
+#include <QDebug>
+#include <QFontMetricsF>
+#include <QImage>
+#include <QPainter>
+#include <QPainterPath>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace {
+// 实例环的初始容量（字形数），不够时翻倍
+constexpr int kInitialSlots = 8192;
+// 描边宽度（像素），黑色描边保证弹幕在亮画面上可读
+constexpr qreal kOutlineWidth = 1.5;
+}
+
+DanmuOverlay::DanmuOverlay()
+{
+    QFont font;
+    font.setPixelSize(25);
+    font.setBold(true);
+    setFont(font);
+}
+
+void DanmuOverlay::initialize(QOpenGLFunctions_4_3_Core *gl)
+{
+    gl_ = gl;
+
+    program_ = new QOpenGLShaderProgram();
+    const char *vShader =
+        R"(#version 430 core
+        layout(location = 0) in vec4 a_comment;    // 起始时间、时长、顶边 y、整条宽度
+        layout(location = 1) in vec4 a_glyph;      // 相对弹幕左端的 x、宽、高、是否固定
+        layout(location = 2) in vec4 a_uv;
+        layout(location = 3) in vec4 a_color;
+        uniform float u_time;
+        uniform vec2 u_viewport;
+        out vec2 v_uv;
+        out vec4 v_color;
+        void main() {
+            // 空槽（时长为 0）与尚未开始、已经移出的字形退化到裁剪空间之外
+            float progress = a_comment.y > 0.0 ? (u_time - a_comment.x) / a_comment.y : 2.0;
+            if (progress < 0.0 || progress > 1.0) {
+                gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+                v_uv = vec2(0.0);
+                v_color = vec4(0.0);
+                return;
+            }
+            // 滚动弹幕从右边缘完全进入到左边缘完全移出，固定弹幕水平居中
+            float left = (a_glyph.w > 0.5 ? (u_viewport.x - a_comment.w) * 0.5 : mix(u_viewport.x, -a_comment.w, progress)) + a_glyph.x;
+            vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+            vec2 pixel = vec2(left, a_comment.z) + corner * a_glyph.yz;
+            gl_Position = vec4(pixel.x / u_viewport.x * 2.0 - 1.0, 1.0 - pixel.y / u_viewport.y * 2.0, 0.0, 1.0);
+            v_uv = mix(a_uv.xy, a_uv.zw, corner);
+            v_color = a_color;
+        })";
+
+    const char *fShader =
+        R"(#version 430 core
+        in vec2 v_uv;
+        in vec4 v_color;
+        out vec4 fragColor;
+        uniform sampler2D u_atlas;
+        uniform float u_opacity;
+        void main() {
+            vec2 coverage = texture(u_atlas, v_uv).rg;    // 字形、描边
+            float shape = max(coverage.r, coverage.g);
+            float alpha = shape * v_color.a * u_opacity;
+            // 描边为黑色，颜色按字形覆盖率在描边与填充色之间过渡；输出预乘 alpha
+            vec3 rgb = v_color.rgb * (coverage.r / max(shape, 1e-3));
+            fragColor = vec4(rgb * alpha, alpha);
+        })";
+
+    if (!program_->addShaderFromSourceCode(QOpenGLShader::Vertex, vShader))
+        qDebug() << "Danmu vertex shader compile error:" << program_->log();
+    if (!program_->addShaderFromSourceCode(QOpenGLShader::Fragment, fShader))
+        qDebug() << "Danmu fragment shader compile error:" << program_->log();
+    if (!program_->link())
+        qDebug() << "Danmu shader link error:" << program_->log();
+
+    gl_->glGenVertexArrays(1, &vao_);
+    gl_->glGenBuffers(1, &instanceBuffer_);
+    gl_->glBindVertexArray(vao_);
+    gl_->glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+
+    const GLsizei stride = sizeof(GlyphInstance);
+    gl_->glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GlyphInstance, comment));
+    gl_->glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GlyphInstance, glyph));
+    gl_->glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GlyphInstance, uv));
+    gl_->glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(GlyphInstance, color));
+    for (GLuint i = 0; i < 4; ++i) {
+        gl_->glEnableVertexAttribArray(i);
+        gl_->glVertexAttribDivisor(i, 1);
+    }
+    gl_->glBindVertexArray(0);
+    gl_->glBindBuffer(GL_ARRAY_BUFFER, 0);
+    bufferCapacity_ = 0;
+
+    gl_->glGenTextures(1, &atlasTexture_);
+    gl_->glBindTexture(GL_TEXTURE_2D, atlasTexture_);
+    gl_->glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG8, kAtlasSize, kAtlasSize);
+    gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    gl_->glBindTexture(GL_TEXTURE_2D, 0);
+    // 新纹理内容未定义，已光栅化的字形全部重传
+    dirtyTop_ = 0;
+    dirtyBottom_ = atlasAllocated_ ? std::min(kAtlasSize, penY_ + cellHeight_) : 0;
+}
+
+void DanmuOverlay::release()
+{
+    if (!gl_)
+        return;
+    if (atlasTexture_)
+        gl_->glDeleteTextures(1, &atlasTexture_);
+    if (instanceBuffer_)
+        gl_->glDeleteBuffers(1, &instanceBuffer_);
+    if (vao_)
+        gl_->glDeleteVertexArrays(1, &vao_);
+    atlasTexture_ = 0;
+    instanceBuffer_ = 0;
+    vao_ = 0;
+    bufferCapacity_ = 0;
+    delete program_;
+    program_ = nullptr;
+    gl_ = nullptr;
+}
+
+void DanmuOverlay::setFont(const QFont &font)
+{
+    font_ = font;
+    const QFontMetricsF metrics(font_);
+    ascent_ = static_cast<int>(std::ceil(metrics.ascent()));
+    pad_ = static_cast<int>(std::ceil(kOutlineWidth)) + 1;
+    cellHeight_ = static_cast<int>(std::ceil(metrics.height())) + 2 * pad_;
+    resetAtlas();
+}
+
+quint64 DanmuOverlay::add(const QString &text, const QColor &color, double y, Motion motion)
+{
+    if (text.isEmpty())
+        return 0;
+
+    expire(now());
+    if (comments_.empty()) {
+        // 没有在屏弹幕时重新计时，时间戳保持在 float 精度足够的范围内
+        clock_.start();
+        head_ = size_ = 0;
+        pendingStart_ = pendingCount_ = 0;
+        patches_.clear();
+    }
+
+    Comment comment;
+    comment.text = text;
+    comment.color = color;
+    comment.start = static_cast<float>(now());
+    comment.fixed = motion == Motion::Fixed;
+    comment.duration = static_cast<float>(comment.fixed ? fixedDuration_ : duration_);
+    if (y < 0.0) {
+        const int lines = std::max(1, viewport_.height() / std::max(1, cellHeight_));
+        y = (nextLine_++ % lines) * cellHeight_;
+    }
+    comment.y = static_cast<float>(y);
+    return append(comment);
+}
+
+void DanmuOverlay::setBadge(quint64 handle, const QString &badge)
+{
+    expire(now());
+    Comment *owner = find(handle);
+    if (!owner || owner->span > 0.0f)
+        return;
+    hide(owner->badge);
+    owner->badge = 0;
+    if (badge.isEmpty())
+        return;
+
+    Comment comment;
+    comment.text = badge;
+    comment.color = owner->color;
+    comment.start = owner->start;
+    comment.duration = owner->duration;
+    comment.y = owner->y;
+    comment.fixed = owner->fixed;
+    comment.offset = owner->width + cellHeight_ * 0.25f;
+    comment.span = owner->width;
+    if (!comment.fixed) {
+        // 滚动速度为 (视口宽 + span) / 时长：span 计入角标、时长按比例延长，
+        // 速度与所属弹幕相同，并随之完整移出左边缘
+        const float viewportWidth = static_cast<float>(viewport_.width());
+        comment.span = comment.offset + static_cast<float>(textWidth(badge));
+        comment.duration = owner->duration * (viewportWidth + comment.span) / (viewportWidth + owner->width);
+    }
+    // deque 尾部追加不会使 owner 失效
+    owner->badge = append(comment);
+}
+
+quint64 DanmuOverlay::append(Comment comment)
+{
+    // 复用成员缓冲，稳态下逐条追加不分配
+    std::vector<GlyphInstance> &instances = scratch_;
+    instances.clear();
+    atlasFull_ = false;
+    layout(&comment, &instances);
+    comment.glyphs = static_cast<int>(instances.size());
+    comment.firstGlyph = ringBase_ + size_;
+    comments_.push_back(comment);
+    const quint64 handle = frontHandle_ + comments_.size() - 1;
+
+    if (atlasFull_) {
+        // 图集写满：清空后按所有在屏弹幕（含这一条）重新生成
+        resetAtlas();
+        return handle;
+    }
+
+    const int count = static_cast<int>(instances.size());
+    reserveSlots(count);
+    const int capacity = static_cast<int>(ring_.size());
+    const int tail = (head_ + size_) % capacity;
+    const int first = std::min(count, capacity - tail);
+    std::copy(instances.begin(), instances.begin() + first, ring_.begin() + tail);
+    std::copy(instances.begin() + first, instances.end(), ring_.begin());
+
+    if (pendingCount_ == 0)
+        pendingStart_ = tail;
+    pendingCount_ += count;
+    size_ += count;
+    return handle;
+}
+
+DanmuOverlay::Comment *DanmuOverlay::find(quint64 handle)
+{
+    if (handle < frontHandle_ || handle - frontHandle_ >= comments_.size())
+        return nullptr;
+    return &comments_[handle - frontHandle_];
+}
+
+void DanmuOverlay::hide(quint64 handle)
+{
+    Comment *comment = find(handle);
+    if (!comment || comment->hidden)
+        return;
+    comment->hidden = true;
+    if (comment->glyphs == 0 || ring_.empty())
+        return;
+
+    // 时长置 0 即为空槽，由着色器剔除；槽位随队首一并回收
+    const int capacity = static_cast<int>(ring_.size());
+    const int slot = static_cast<int>((head_ + (comment->firstGlyph - ringBase_)) % capacity);
+    for (int i = 0; i < comment->glyphs; ++i)
+        ring_[(slot + i) % capacity].comment[1] = 0.0f;
+    const int first = std::min(comment->glyphs, capacity - slot);
+    patches_.emplace_back(slot, first);
+    if (first < comment->glyphs)
+        patches_.emplace_back(0, comment->glyphs - first);
+}
+
+double DanmuOverlay::textWidth(const QString &text) const
+{
+    return QFontMetricsF(font_).horizontalAdvance(text);
+}
+
+void DanmuOverlay::clear()
+{
+    frontHandle_ += comments_.size();
+    comments_.clear();
+    head_ = size_ = 0;
+    pendingStart_ = pendingCount_ = 0;
+    patches_.clear();
+}
+
+void DanmuOverlay::render(const QSize &viewport)
+{
+    viewport_ = viewport;
+    if (!gl_ || viewport.isEmpty())
+        return;
+
+    const double time = now();
+    expire(time);
+    if (comments_.empty())
+        return;
+
+    QElapsedTimer cpuTimer;
+    cpuTimer.start();
+
+    gl_->glActiveTexture(GL_TEXTURE0);
+    gl_->glBindTexture(GL_TEXTURE_2D, atlasTexture_);
+    if (dirtyBottom_ > dirtyTop_) {
+        // 新字形所在的整行上传，行内未用区域为 0，不影响采样
+        gl_->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        gl_->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, dirtyTop_, kAtlasSize, dirtyBottom_ - dirtyTop_,
+                             GL_RG, GL_UNSIGNED_BYTE, atlas_.data() + static_cast<size_t>(dirtyTop_) * kAtlasSize * 2);
+        gl_->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        stats_.uploadedBytes += static_cast<quint64>(dirtyBottom_ - dirtyTop_) * kAtlasSize * 2;
+        dirtyTop_ = dirtyBottom_ = 0;
+    }
+
+    uploadPending();
+
+    gl_->glEnable(GL_BLEND);
+    gl_->glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    program_->bind();
+    program_->setUniformValue("u_time", static_cast<GLfloat>(time));
+    program_->setUniformValue("u_viewport", QSizeF(viewport));
+    program_->setUniformValue("u_opacity", opacity_);
+    program_->setUniformValue("u_atlas", 0);
+    gl_->glBindVertexArray(vao_);
+
+    const int capacity = static_cast<int>(ring_.size());
+    if (head_ + size_ <= capacity) {
+        gl_->glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, size_, head_);
+    } else {
+        // 有效区间跨过环尾时整环绘制，空槽与已移出的字形由顶点着色器剔除
+        gl_->glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, capacity);
+    }
+
+    gl_->glBindVertexArray(0);
+    program_->release();
+    gl_->glDisable(GL_BLEND);
+    gl_->glBindTexture(GL_TEXTURE_2D, 0);
+
+    const double drawUs = cpuTimer.nsecsElapsed() / 1000.0;
+    ++stats_.draws;
+    stats_.averageDrawUs += (drawUs - stats_.averageDrawUs) / stats_.draws;
+}
+
+DanmuOverlay::Stats DanmuOverlay::stats() const
+{
+    Stats stats = stats_;
+    stats.comments = static_cast<int>(comments_.size());
+    stats.glyphInstances = size_;
+    stats.atlasGlyphs = glyphs_.size();
+    return stats;
+}
+
+DanmuOverlay::Glyph DanmuOverlay::glyphFor(char32_t codePoint)
+{
+    auto it = glyphs_.constFind(codePoint);
+    if (it != glyphs_.constEnd())
+        return *it;
+
+    Glyph glyph;
+    if (!rasterize(codePoint, &glyph)) {
+        // 不缓存：图集清空后再重新光栅化
+        atlasFull_ = true;
+        return glyph;
+    }
+    glyphs_.insert(codePoint, glyph);
+    return glyph;
+}
+
+bool DanmuOverlay::rasterize(char32_t codePoint, Glyph *glyph)
+{
+    const QString text = QString::fromUcs4(&codePoint, 1);
+    const QFontMetricsF metrics(font_);
+    glyph->advance = static_cast<float>(metrics.horizontalAdvance(text));
+    glyph->blank = true;
+    if (QChar::isSpace(codePoint) || glyph->advance <= 0.0f)
+        return true;
+
+    const int w = static_cast<int>(std::ceil(glyph->advance)) + 2 * pad_;
+    const int h = cellHeight_;
+    if (penX_ + w > kAtlasSize) {
+        penX_ = 0;
+        penY_ += h;
+    }
+    if (penY_ + h > kAtlasSize || w > kAtlasSize)
+        return false;
+
+    if (atlas_.empty())
+        atlas_.assign(static_cast<size_t>(kAtlasSize) * kAtlasSize * 2, 0);
+    atlasAllocated_ = true;
+
+    QPainterPath path;
+    path.addText(pad_, pad_ + ascent_, font_, text);
+
+    QImage fill(w, h, QImage::Format_Alpha8);
+    fill.fill(0);
+    QImage outline(w, h, QImage::Format_Alpha8);
+    outline.fill(0);
+    {
+        QPainter painter(&fill);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.fillPath(path, Qt::white);
+    }
+    {
+        QPainter painter(&outline);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.strokePath(path, QPen(Qt::white, kOutlineWidth * 2.0, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+        painter.fillPath(path, Qt::white);
+    }
+
+    for (int row = 0; row < h; ++row) {
+        const uchar *f = fill.constScanLine(row);
+        const uchar *o = outline.constScanLine(row);
+        uint8_t *dst = atlas_.data() + (static_cast<size_t>(penY_ + row) * kAtlasSize + penX_) * 2;
+        for (int x = 0; x < w; ++x) {
+            dst[2 * x] = f[x];
+            dst[2 * x + 1] = o[x];
+        }
+    }
+
+    glyph->blank = false;
+    glyph->width = static_cast<float>(w);
+    glyph->u0 = float(penX_) / kAtlasSize;
+    glyph->v0 = float(penY_) / kAtlasSize;
+    glyph->u1 = float(penX_ + w) / kAtlasSize;
+    glyph->v1 = float(penY_ + h) / kAtlasSize;
+
+    if (dirtyBottom_ <= dirtyTop_)
+        dirtyTop_ = penY_;
+    dirtyTop_ = std::min(dirtyTop_, penY_);
+    dirtyBottom_ = std::max(dirtyBottom_, penY_ + h);
+    penX_ += w;
+    return true;
+}
+
+void DanmuOverlay::resetAtlas()
+{
+    if (!glyphs_.isEmpty())
+        ++stats_.atlasResets;
+    glyphs_.clear();
+    std::fill(atlas_.begin(), atlas_.end(), 0);
+    penX_ = penY_ = 0;
+    dirtyTop_ = dirtyBottom_ = 0;
+
+    // 在屏弹幕按新图集重新排布，整环从 0 开始重写并整体重传
+    std::vector<GlyphInstance> &instances = scratch_;
+    instances.clear();
+    atlasFull_ = false;
+    for (Comment &comment : comments_) {
+        const size_t before = instances.size();
+        layout(&comment, &instances);
+        comment.glyphs = static_cast<int>(instances.size() - before);
+        comment.firstGlyph = before;
+    }
+    if (atlasFull_)
+        qWarning() << "Danmu glyph atlas is full, some glyphs are not drawn";
+
+    const int count = static_cast<int>(instances.size());
+    if (count > static_cast<int>(ring_.size()))
+        ring_.resize(static_cast<size_t>(std::max({ count, static_cast<int>(ring_.size()) * 2, kInitialSlots })));
+    std::copy(instances.begin(), instances.end(), ring_.begin());
+    head_ = 0;
+    size_ = count;
+    ringBase_ = 0;
+    pendingStart_ = 0;
+    pendingCount_ = count;
+    patches_.clear();
+    bufferCapacity_ = -1;
+}
+
+void DanmuOverlay::layout(Comment *comment, std::vector<GlyphInstance> *out)
+{
+    if (comment->hidden)
+        return;
+
+    const size_t first = out->size();
+    float pen = 0.0f;
+    GLubyte color[4] = {
+        static_cast<GLubyte>(comment->color.red()), static_cast<GLubyte>(comment->color.green()),
+        static_cast<GLubyte>(comment->color.blue()), static_cast<GLubyte>(comment->color.alpha())
+    };
+
+    // 直接按 UTF-16 逐码点遍历，不经 toUcs4() 生成临时数组
+    forEachCodePoint(QStringView(comment->text), [&](char32_t codePoint) {
+        const Glyph glyph = glyphFor(codePoint);
+        if (!glyph.blank) {
+            GlyphInstance instance{};
+            instance.glyph[0] = comment->offset + pen - pad_;
+            instance.glyph[1] = glyph.width;
+            instance.glyph[2] = static_cast<GLfloat>(cellHeight_);
+            instance.glyph[3] = comment->fixed ? 1.0f : 0.0f;
+            instance.uv[0] = glyph.u0;
+            instance.uv[1] = glyph.v0;
+            instance.uv[2] = glyph.u1;
+            instance.uv[3] = glyph.v1;
+            std::copy(std::begin(color), std::end(color), instance.color);
+            out->push_back(instance);
+        }
+        pen += glyph.advance;
+        return false;
+    });
+
+    // 整条宽度在排完所有字形后才知道
+    comment->width = pen;
+    const float span = comment->span > 0.0f ? comment->span : pen;
+    for (size_t i = first; i < out->size(); ++i) {
+        GlyphInstance &instance = (*out)[i];
+        instance.comment[0] = comment->start;
+        instance.comment[1] = comment->duration;
+        instance.comment[2] = comment->y;
+        instance.comment[3] = span;
+    }
+}
+
+void DanmuOverlay::reserveSlots(int count)
+{
+    const int capacity = static_cast<int>(ring_.size());
+    if (size_ + count <= capacity)
+        return;
+
+    // 扩容时把有效区间搬到新环的开头，GPU 端随后整体重传
+    const int newCapacity = std::max({ capacity * 2, size_ + count, kInitialSlots });
+    std::vector<GlyphInstance> ring(static_cast<size_t>(newCapacity));
+    for (int i = 0; i < size_; ++i)
+        ring[i] = ring_[(head_ + i) % capacity];
+    ring_.swap(ring);
+    head_ = 0;
+    pendingStart_ = pendingCount_ = 0;
+}
+
+void DanmuOverlay::expire(double now)
+{
+    while (!comments_.empty()) {
+        const Comment &front = comments_.front();
+        if (front.start + front.duration >= now)
+            break;
+        head_ = ring_.empty() ? 0 : (head_ + front.glyphs) % static_cast<int>(ring_.size());
+        size_ -= front.glyphs;
+        ringBase_ += front.glyphs;
+        comments_.pop_front();
+        ++frontHandle_;
+    }
+    if (comments_.empty()) {
+        head_ = size_ = 0;
+        pendingStart_ = pendingCount_ = 0;
+        patches_.clear();
+    }
+}
+
+void DanmuOverlay::uploadPending()
+{
+    const int capacity = static_cast<int>(ring_.size());
+    constexpr size_t stride = sizeof(GlyphInstance);
+    gl_->glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+    if (bufferCapacity_ != capacity) {
+        gl_->glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity * stride), ring_.data(), GL_DYNAMIC_DRAW);
+        bufferCapacity_ = capacity;
+        stats_.uploadedBytes += capacity * stride;
+    } else {
+        if (pendingCount_ > 0) {
+            // 只传新加入的字形，跨过环尾时分两段
+            const int first = std::min(pendingCount_, capacity - pendingStart_);
+            gl_->glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(pendingStart_ * stride),
+                                 static_cast<GLsizeiptr>(first * stride), ring_.data() + pendingStart_);
+            if (first < pendingCount_) {
+                gl_->glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>((pendingCount_ - first) * stride),
+                                     ring_.data());
+            }
+            stats_.uploadedBytes += pendingCount_ * stride;
+        }
+        // 被替换的角标
+        for (const auto &[slot, count] : patches_) {
+            gl_->glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(slot * stride),
+                                 static_cast<GLsizeiptr>(count * stride), ring_.data() + slot);
+            stats_.uploadedBytes += count * stride;
+        }
+    }
+    patches_.clear();
+    pendingStart_ = pendingCount_ = 0;
+    gl_->glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+double DanmuOverlay::now() const
+{
+    return clock_.isValid() ? clock_.nsecsElapsed() / 1e9 : 0.0;
+}
@@ -0,0 +1,158 @@
+#ifndef DANMUOVERLAY_H
+#define DANMUOVERLAY_H
+
+#include <QOpenGLFunctions_4_3_Core>
+#include <QOpenGLShaderProgram>
+#include <QColor>
+#include <QElapsedTimer>
+#include <QFont>
+#include <QHash>
+#include <QSize>
+#include <QString>
+#include <deque>
+#include <utility>
+#include <vector>
+
+// 弹幕叠加层：由 RenderOpenGL 在 paintGL 中调用，画在视频之上。
+// 字形按需光栅化进 RG8 图集（R 为字形覆盖率，G 为描边覆盖率），每个字形是一个实例，
+// 实例数据（所属弹幕的起始时间、时长、行位置、宽度、颜色及字形在图集中的位置）只在加入时写入一次，
+// 追加到流式实例缓冲环中。每帧只更新时间 uniform 并做一次实例化绘制，滚动位置在顶点着色器中计算，
+// CPU 不逐字形处理。弹幕按加入顺序回收：队首未过期时其后已过期的（如较短的固定弹幕）由着色器剔除，稍后一并回收。
+// 合并的重复弹幕用角标（如“×12”）表示：角标作为单独的一组字形紧跟在所属弹幕之后同速移动，
+// 更新时旧角标的字形原地置为空槽，只重传这几个实例。
+// 只能在 GUI 线程使用；initialize/render/release 须在 GL 上下文当前时调用。
+class DanmuOverlay
+{
+public:
+    // Scroll 从右向左滚过整个宽度；Fixed 水平居中停留（顶部、底部弹幕）
+    enum class Motion { Scroll, Fixed };
+
+    struct Stats {
+        int comments = 0;             // 仍在缓冲中的弹幕
+        int glyphInstances = 0;
+        int atlasGlyphs = 0;
+        quint64 atlasResets = 0;      // 图集写满后清空重建的次数
+        quint64 uploadedBytes = 0;    // 累计上传的实例与图集数据
+        quint64 draws = 0;
+        double averageDrawUs = 0.0;   // 每帧上传与绘制命令提交的 CPU 耗时
+    };
+
+    DanmuOverlay();
+
+    void initialize(QOpenGLFunctions_4_3_Core* gl);
+    void release();
+
+    // 更换字体会清空图集，已在屏幕上的弹幕按新字形重新生成
+    void setFont(const QFont& font);
+    // 从右边缘完全移出左边缘所用的秒数
+    void setDuration(double seconds) { duration_ = seconds > 0.0 ? seconds : duration_; }
+    double duration() const { return duration_; }
+    // 固定弹幕的停留秒数
+    void setFixedDuration(double seconds) { fixedDuration_ = seconds > 0.0 ? seconds : fixedDuration_; }
+    double fixedDuration() const { return fixedDuration_; }
+    void setOpacity(float opacity) { opacity_ = opacity; }
+
+    // y 为弹幕顶边（像素）；y < 0 时按行轮流排布。返回供 setBadge 使用的句柄，文本为空时返回 0
+    quint64 add(const QString& text, const QColor& color = Qt::white, double y = -1.0, Motion motion = Motion::Scroll);
+    // 替换弹幕的角标，badge 为空时去掉；弹幕已移出时忽略
+    void setBadge(quint64 handle, const QString& badge);
+    void clear();
+
+    // 屏幕上仍有弹幕，调用方需要继续逐帧重绘
+    bool isActive() const { return !comments_.empty(); }
+    int lineHeight() const { return cellHeight_; }
+    // 按当前字体排布后的整条宽度（像素），供排布引擎分配行
+    double textWidth(const QString& text) const;
+
+    void render(const QSize& viewport);
+    Stats stats() const;
+
+private:
+    // 与顶点属性布局一致，每个字形 48 字节
+    struct GlyphInstance {
+        GLfloat comment[4];           // 起始时间（秒）、时长、顶边 y、整条弹幕宽度
+        GLfloat glyph[4];             // 字形相对弹幕左端的 x、宽、高、是否固定（1 为居中不动）
+        GLfloat uv[4];                // 图集中的 u0, v0, u1, v1
+        GLubyte color[4];
+    };
+
+    struct Glyph {
+        float u0 = 0, v0 = 0, u1 = 0, v1 = 0;
+        float width = 0;              // 图集单元宽度（含描边留白）
+        float advance = 0;
+        bool blank = true;            // 空白字符只前进，不生成实例
+    };
+
+    struct Comment {
+        QString text;
+        QColor color;
+        float start = 0.0f;
+        float duration = 0.0f;
+        float y = 0.0f;
+        bool fixed = false;
+        int glyphs = 0;
+        quint64 firstGlyph = 0;       // 首个字形的绝对序号，与 ringBase_ 相减得到在环中的位置
+        float width = 0.0f;           // 排布后的文本宽度
+        float offset = 0.0f;          // 角标：字形整体右移到所属弹幕之后
+        float span = 0.0f;            // 角标：按此宽度计算位置（与所属弹幕同速），0 为自身宽度
+        quint64 badge = 0;            // 当前角标的句柄
+        bool hidden = false;          // 已被替换的角标，字形为空槽
+    };
+
+    quint64 append(Comment comment);
+    Comment* find(quint64 handle);
+    void hide(quint64 handle);
+    Glyph glyphFor(char32_t codePoint);
+    bool rasterize(char32_t codePoint, Glyph* glyph);
+    void resetAtlas();
+    void layout(Comment* comment, std::vector<GlyphInstance>* out);
+    void reserveSlots(int count);
+    void expire(double now);
+    void uploadPending();
+    double now() const;
+
+    QOpenGLFunctions_4_3_Core* gl_ = nullptr;
+    QOpenGLShaderProgram* program_ = nullptr;
+    GLuint vao_ = 0;
+    GLuint instanceBuffer_ = 0;
+    GLuint atlasTexture_ = 0;
+
+    QFont font_;
+    int ascent_ = 0;
+    int cellHeight_ = 0;
+    int pad_ = 2;                     // 单元四周为描边留出的像素
+
+    // CPU 端图集，2 字节/像素，按行写满后整行上传
+    static constexpr int kAtlasSize = 2048;
+    std::vector<uint8_t> atlas_;
+    QHash<char32_t, Glyph> glyphs_;
+    int penX_ = 0;
+    int penY_ = 0;
+    int dirtyTop_ = 0;                // [dirtyTop_, dirtyBottom_) 行尚未上传
+    int dirtyBottom_ = 0;
+    bool atlasAllocated_ = false;
+    bool atlasFull_ = false;          // 本次排布中有字形放不进图集
+
+    // 实例环：[head_, head_ + size_) 为有效字形，按 ring_ 容量取模
+    std::vector<GlyphInstance> ring_;
+    int head_ = 0;
+    int size_ = 0;
+    int pendingStart_ = 0;            // 尚未上传的新实例
+    int pendingCount_ = 0;
+    std::vector<std::pair<int, int>> patches_;   // 原地修改过、需要重传的 (起始槽, 个数)
+    std::vector<GlyphInstance> scratch_;          // append / resetAtlas 排布用，保留容量
+    quint64 ringBase_ = 0;            // head_ 处字形的绝对序号
+    int bufferCapacity_ = 0;          // GPU 端缓冲的实例容量，与 ring_ 不同时整体重传
+    std::deque<Comment> comments_;
+    quint64 frontHandle_ = 1;         // comments_ 队首的句柄，之后的依次加一
+
+    QElapsedTimer clock_;             // 弹幕按墙钟滚动；清空后重新计时，保证 float 精度
+    double duration_ = 8.0;
+    double fixedDuration_ = 4.0;
+    float opacity_ = 1.0f;
+    int nextLine_ = 0;
+    QSize viewport_;
+    Stats stats_;
+};
+
+#endif // DANMUOVERLAY_H
@@ -0,0 +1,586 @@
+#include "multiviewrenderer.h"
+#include "aspectfit.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+
+namespace {
+// 队首帧与该格时钟偏差超过该值（秒）时重新锚定，用于换流或解码长时间卡顿
+constexpr double kResyncThreshold = 1.0;
+
+// 层尺寸按此对齐，色度层正好为亮度层的一半，也减少帧尺寸小幅变化引起的重建
+constexpr int kLayerAlignment = 16;
+
+// 与 LayerArrayIndex 对应：Y、U、V、UV、RGB
+constexpr GLenum kArrayFormats[] = { GL_R8, GL_R8, GL_R8, GL_RG8, GL_RGBA8 };
+
+int alignLayer(int size)
+{
+    return (size + kLayerAlignment - 1) / kLayerAlignment * kLayerAlignment;
+}
+
+// 与 RenderOpenGL 相同的取值：未标注色彩空间时按分辨率猜测
+bool isBt709(AVColorSpace space, int height)
+{
+    switch (space) {
+    case AVCOL_SPC_BT709:
+        return true;
+    case AVCOL_SPC_BT470BG:
+    case AVCOL_SPC_SMPTE170M:
+    case AVCOL_SPC_FCC:
+        return false;
+    default:
+        return height >= 720;
+    }
+}
+}
+
+MultiviewRenderer::MultiviewRenderer(QWidget *parent)
+    : QOpenGLWidget(parent)
+{
+    setMinimumSize(640, 360);
+    monotonic_.start();
+
+    throttleTimer_.setSingleShot(true);
+    throttleTimer_.setTimerType(Qt::PreciseTimer);
+    connect(&throttleTimer_, &QTimer::timeout, this, [this]() { update(); });
+
+    // 交换缓冲后若仍有可取的帧，继续请求下一次 vsync 绘制
+    connect(this, &QOpenGLWidget::frameSwapped, this, [this]() {
+        scheduleNextPaint(monotonic_.nsecsElapsed());
+    });
+}
+
+MultiviewRenderer::~MultiviewRenderer()
+{
+    cleanup();
+}
+
+void MultiviewRenderer::setGrid(int columns, int rows)
+{
+    columns_ = std::max(1, columns);
+    rows_ = std::max(1, rows);
+    const size_t count = static_cast<size_t>(columns_) * rows_;
+
+    tiles_.resize(count);
+    for (Tile &tile : tiles_) {
+        if (!tile.clock)
+            tile.clock = std::make_unique<PlaybackClock>();
+    }
+
+    instancesDirty_ = true;
+    emitTargetSizes();
+    update();
+}
+
+void MultiviewRenderer::setSpacing(int pixels)
+{
+    spacing_ = std::max(0, pixels);
+    instancesDirty_ = true;
+    emitTargetSizes();
+    update();
+}
+
+void MultiviewRenderer::setTileQueue(int tile, FrameQueue *queue)
+{
+    if (tile < 0 || tile >= tileCount())
+        return;
+
+    Tile &t = tiles_[tile];
+    t.queue = queue;
+    t.clock->reset();
+    t.serial = 0;
+    t.lastPresentNs = -1;
+    if (!queue) {
+        t.layout = PixelLayout::None;
+        instancesDirty_ = true;
+    }
+    update();
+}
+
+void MultiviewRenderer::setTileMaxFps(int tile, double fps)
+{
+    if (tile < 0 || tile >= tileCount())
+        return;
+    tiles_[tile].minIntervalNs = fps > 0.0 ? static_cast<qint64>(1e9 / fps) : 0;
+}
+
+QRectF MultiviewRenderer::tileRect(int tile) const
+{
+    if (tile < 0 || tile >= tileCount())
+        return QRectF();
+
+    const double cellWidth = (width() - spacing_ * (columns_ - 1)) / double(columns_);
+    const double cellHeight = (height() - spacing_ * (rows_ - 1)) / double(rows_);
+    const int column = tile % columns_;
+    const int row = tile / columns_;
+    return QRectF(column * (cellWidth + spacing_), row * (cellHeight + spacing_),
+                  std::max(0.0, cellWidth), std::max(0.0, cellHeight));
+}
+
+MultiviewRenderer::TileStats MultiviewRenderer::tileStats(int tile) const
+{
+    if (tile < 0 || tile >= tileCount())
+        return TileStats();
+    return tiles_[tile].stats;
+}
+
+void MultiviewRenderer::resetStats()
+{
+    stats_ = Stats();
+    for (Tile &tile : tiles_)
+        tile.stats = TileStats();
+}
+
+void MultiviewRenderer::onFrameQueued()
+{
+    // 受限流的分格入队不直接触发重绘，由 throttleTimer_ 在其允许取帧时再画
+    scheduleNextPaint(monotonic_.nsecsElapsed());
+}
+
+void MultiviewRenderer::initializeGL()
+{
+    initializeOpenGLFunctions();
+    initShaders();
+
+    // 四边形顶点由 gl_VertexID 生成，只需要逐实例属性
+    glGenVertexArrays(1, &vao_);
+    glGenBuffers(1, &instanceBuffer_);
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+
+    const GLsizei stride = sizeof(TileInstance);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(TileInstance, rect));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(TileInstance, texScale));
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(TileInstance, yuv));
+    glVertexAttribIPointer(3, 2, GL_INT, stride, (void*)offsetof(TileInstance, layer));
+    for (GLuint i = 0; i < 4; ++i) {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void MultiviewRenderer::resizeGL(int w, int h)
+{
+    glViewport(0, 0, w, h);
+    instancesDirty_ = true;
+    emitTargetSizes();
+}
+
+void MultiviewRenderer::paintGL()
+{
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if (tiles_.empty())
+        return;
+
+    ++stats_.paints;
+    if (layerCount_ < tileCount())
+        growLayers(layerWidth_, layerHeight_, tileCount());
+
+    const qint64 nowNs = monotonic_.nsecsElapsed();
+    QElapsedTimer cpuTimer;
+    cpuTimer.start();
+
+    int uploaded = 0;
+    for (int i = 0; i < tileCount(); ++i) {
+        VideoFrame frame;
+        if (!pullTile(tiles_[i], nowNs, &frame))
+            continue;
+        uploadTile(i, *frame.buffer);
+        ++uploaded;
+    }
+
+    if (uploaded > 0) {
+        stats_.uploads += uploaded;
+        const double perFrameUs = cpuTimer.nsecsElapsed() / 1000.0 / uploaded;
+        stats_.averageUploadUs += (perFrameUs - stats_.averageUploadUs) * uploaded / stats_.uploads;
+    }
+
+    if (instancesDirty_)
+        rebuildInstances();
+    stats_.instances = instances_.size();
+    if (instances_.empty())
+        return;
+    cpuTimer.start();
+
+    const GLenum units[ArrayCount] = { GL_TEXTURE0, GL_TEXTURE1, GL_TEXTURE2, GL_TEXTURE3, GL_TEXTURE4 };
+    for (int i = 0; i < ArrayCount; ++i) {
+        glActiveTexture(units[i]);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, arrays_[i].texture);
+    }
+
+    shaderProgram_->bind();
+    glBindVertexArray(vao_);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(instances_.size()));
+    glBindVertexArray(0);
+    shaderProgram_->release();
+
+    for (int i = ArrayCount - 1; i >= 0; --i) {
+        glActiveTexture(units[i]);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+
+    const double drawUs = cpuTimer.nsecsElapsed() / 1000.0;
+    ++stats_.draws;
+    stats_.averageDrawUs += (drawUs - stats_.averageDrawUs) / stats_.draws;
+}
+
+bool MultiviewRenderer::pullTile(Tile &tile, qint64 nowNs, VideoFrame *out)
+{
+    if (!tile.queue)
+        return false;
+    VideoFrame *head = tile.queue->peek();
+    if (!head)
+        return false;
+
+    if (tile.minIntervalNs > 0 && tile.lastPresentNs >= 0 && nowNs - tile.lastPresentNs < tile.minIntervalNs) {
+        ++tile.stats.throttled;
+        return false;
+    }
+
+    // 各路互不相关，每格用自己的墙钟锚定；跳转后以新位置的首帧重新锚定
+    PlaybackClock &clock = *tile.clock;
+    if (!clock.isAnchored() || head->serial != tile.serial) {
+        tile.serial = head->serial;
+        clock.anchor(head->pts);
+    }
+    double now = clock.now();
+    if (std::abs(head->pts - now) > kResyncThreshold) {
+        clock.anchor(head->pts);
+        now = head->pts;
+    }
+
+    int dropped = 0;
+    if (!tile.queue->popDue(now, dropPolicy_, *out, &dropped))
+        return false;
+
+    tile.stats.dropped += dropped;
+    ++tile.stats.presented;
+    tile.lastPresentNs = nowNs;
+    return static_cast<bool>(out->buffer);
+}
+
+void MultiviewRenderer::uploadTile(int index, const FrameBuffer &frame)
+{
+    const int w = frame.width;
+    const int h = frame.height;
+    const int cw = (w + 1) / 2;
+    const int ch = (h + 1) / 2;
+
+    PixelLayout layout = PixelLayout::None;
+    switch (frame.format) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+        layout = PixelLayout::I420;
+        break;
+    case AV_PIX_FMT_NV12:
+        layout = PixelLayout::Nv12;
+        break;
+    case AV_PIX_FMT_RGB24:
+    case AV_PIX_FMT_RGBA:
+        layout = PixelLayout::Rgb;
+        break;
+    default:
+        qDebug() << "Unsupported frame format:" << frame.format;
+        return;
+    }
+
+    growLayers(w, h, layerCount_);
+
+    switch (frame.format) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+        uploadLayer(ArrayY, index, GL_RED, 1, frame.data[0], frame.linesize[0], w, h);
+        uploadLayer(ArrayU, index, GL_RED, 1, frame.data[1], frame.linesize[1], cw, ch);
+        uploadLayer(ArrayV, index, GL_RED, 1, frame.data[2], frame.linesize[2], cw, ch);
+        break;
+    case AV_PIX_FMT_NV12:
+        uploadLayer(ArrayY, index, GL_RED, 1, frame.data[0], frame.linesize[0], w, h);
+        uploadLayer(ArrayUV, index, GL_RG, 2, frame.data[1], frame.linesize[1], cw, ch);
+        break;
+    case AV_PIX_FMT_RGB24:
+        uploadLayer(ArrayRgb, index, GL_RGB, 3, frame.data[0], frame.linesize[0], w, h);
+        break;
+    default:
+        uploadLayer(ArrayRgb, index, GL_RGBA, 4, frame.data[0], frame.linesize[0], w, h);
+        break;
+    }
+
+    float yuv[3] = {};
+    if (layout != PixelLayout::Rgb) {
+        const bool bt709 = isBt709(frame.colorSpace, h);
+        const bool full = frame.colorRange == AVCOL_RANGE_JPEG || frame.format == AV_PIX_FMT_YUVJ420P;
+        yuv[0] = bt709 ? 0.2126f : 0.299f;
+        yuv[1] = bt709 ? 0.0722f : 0.114f;
+        yuv[2] = full ? 1.0f : 0.0f;
+    }
+
+    // 只有分格的格式、尺寸或色彩参数变化时才需要重建实例数据
+    Tile &tile = tiles_[index];
+    if (tile.layout != layout || tile.width != w || tile.height != h
+        || std::memcmp(tile.yuv, yuv, sizeof(yuv)) != 0) {
+        tile.layout = layout;
+        tile.width = w;
+        tile.height = h;
+        std::memcpy(tile.yuv, yuv, sizeof(yuv));
+        instancesDirty_ = true;
+    }
+}
+
+void MultiviewRenderer::uploadLayer(int array, int layer, GLenum format, int bytesPerPixel,
+                                    const uint8_t *data, int stride, int w, int h)
+{
+    ensureArray(array);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, arrays_[array].texture);
+
+    if (stride % bytesPerPixel == 0) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / bytesPerPixel);
+    } else {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, w, h, 1, format, GL_UNSIGNED_BYTE, data);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void MultiviewRenderer::growLayers(int width, int height, int layers)
+{
+    const int newWidth = std::max(layerWidth_, alignLayer(width));
+    const int newHeight = std::max(layerHeight_, alignLayer(height));
+    const int newCount = std::max(layerCount_, layers);
+    if (newWidth == layerWidth_ && newHeight == layerHeight_ && newCount == layerCount_)
+        return;
+
+    layerWidth_ = newWidth;
+    layerHeight_ = newHeight;
+    layerCount_ = newCount;
+    // 纹理坐标比例依赖层尺寸
+    instancesDirty_ = true;
+
+    for (int i = 0; i < ArrayCount; ++i) {
+        if (arrays_[i].texture)
+            ensureArray(i);
+    }
+}
+
+void MultiviewRenderer::ensureArray(int array)
+{
+    LayerArray &current = arrays_[array];
+    const bool chroma = array == ArrayU || array == ArrayV || array == ArrayUV;
+    const int w = chroma ? layerWidth_ / 2 : layerWidth_;
+    const int h = chroma ? layerHeight_ / 2 : layerHeight_;
+    if (w <= 0 || h <= 0 || layerCount_ <= 0)
+        return;
+    if (current.texture && current.width == w && current.height == h && current.layers == layerCount_)
+        return;
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, kArrayFormats[array], w, h, layerCount_);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // 不可变存储无法改尺寸：换新数组并在 GPU 上拷贝旧内容，空闲分格不必等新帧重新上传
+    if (current.texture) {
+        glCopyImageSubData(current.texture, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+                           texture, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+                           std::min(current.width, w), std::min(current.height, h),
+                           std::min(current.layers, layerCount_));
+        glDeleteTextures(1, &current.texture);
+    }
+
+    current.texture = texture;
+    current.width = w;
+    current.height = h;
+    current.layers = layerCount_;
+}
+
+void MultiviewRenderer::rebuildInstances()
+{
+    instancesDirty_ = false;
+    instances_.clear();
+
+    const double viewWidth = width();
+    const double viewHeight = height();
+    if (viewWidth <= 0 || viewHeight <= 0)
+        return;
+
+    for (int i = 0; i < tileCount(); ++i) {
+        const Tile &tile = tiles_[i];
+        if (tile.layout == PixelLayout::None || !tile.queue)
+            continue;
+
+        const QRectF rect = aspectFit(tileRect(i), tile.width, tile.height);
+        TileInstance instance;
+        instance.rect[0] = static_cast<GLfloat>(rect.left() / viewWidth * 2.0 - 1.0);
+        instance.rect[1] = static_cast<GLfloat>(1.0 - rect.top() / viewHeight * 2.0);
+        instance.rect[2] = static_cast<GLfloat>(rect.width() / viewWidth * 2.0);
+        instance.rect[3] = static_cast<GLfloat>(rect.height() / viewHeight * 2.0);
+        instance.texScale[0] = static_cast<GLfloat>(tile.width) / layerWidth_;
+        instance.texScale[1] = static_cast<GLfloat>(tile.height) / layerHeight_;
+        std::copy(std::begin(tile.yuv), std::end(tile.yuv), instance.yuv);
+        instance.layer = i;
+        instance.layout = static_cast<GLint>(tile.layout);
+        instances_.push_back(instance);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instances_.size() * sizeof(TileInstance)),
+                 instances_.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void MultiviewRenderer::scheduleNextPaint(qint64 nowNs)
+{
+    // 有分格此刻就能取帧时按 vsync 重绘；否则只为受限流的分格在其最早允许时刻安排一次
+    qint64 earliestNs = -1;
+    for (const Tile &tile : tiles_) {
+        if (!tile.queue || tile.queue->isEmpty())
+            continue;
+        const qint64 allowedNs = tile.lastPresentNs >= 0 ? tile.lastPresentNs + tile.minIntervalNs : 0;
+        if (tile.minIntervalNs <= 0 || allowedNs <= nowNs) {
+            throttleTimer_.stop();
+            update();
+            return;
+        }
+        if (earliestNs < 0 || allowedNs < earliestNs)
+            earliestNs = allowedNs;
+    }
+
+    if (earliestNs < 0)
+        return;
+    const int delayMs = static_cast<int>((earliestNs - nowNs + 999'999) / 1'000'000);
+    if (!throttleTimer_.isActive() || throttleTimer_.remainingTime() > delayMs)
+        throttleTimer_.start(delayMs);
+}
+
+void MultiviewRenderer::emitTargetSizes()
+{
+    const qreal ratio = devicePixelRatioF();
+    for (int i = 0; i < tileCount(); ++i)
+        emit tileTargetSizeChanged(i, (tileRect(i).size() * ratio).toSize());
+}
+
+void MultiviewRenderer::initShaders()
+{
+    shaderProgram_ = new QOpenGLShaderProgram(this);
+
+    const char *vShader =
+        R"(#version 430 core
+        layout(location = 0) in vec4 a_rect;       // 左上角 x、y 与宽高（NDC）
+        layout(location = 1) in vec2 a_texScale;
+        layout(location = 2) in vec3 a_yuv;
+        layout(location = 3) in ivec2 a_tile;      // 层号、像素布局
+        out vec2 v_texCoord;
+        flat out vec2 v_texScale;
+        flat out vec3 v_yuv;
+        flat out int v_layer;
+        flat out int v_layout;
+        void main() {
+            // 三角带顶点顺序：左上、右上、左下、右下
+            vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+            gl_Position = vec4(a_rect.x + corner.x * a_rect.z, a_rect.y - corner.y * a_rect.w, 0.0, 1.0);
+            v_texCoord = corner * a_texScale;
+            v_texScale = a_texScale;
+            v_yuv = a_yuv;
+            v_layer = a_tile.x;
+            v_layout = a_tile.y;
+        })";
+
+    const char *fShader =
+        R"(#version 430 core
+        in vec2 v_texCoord;
+        flat in vec2 v_texScale;
+        flat in vec3 v_yuv;         // kr, kb, 是否全范围
+        flat in int v_layer;
+        flat in int v_layout;       // 1 RGB, 2 I420, 3 NV12
+        out vec4 fragColor;
+        uniform sampler2DArray u_texY;
+        uniform sampler2DArray u_texU;
+        uniform sampler2DArray u_texV;
+        uniform sampler2DArray u_texUV;
+        uniform sampler2DArray u_texRgb;
+
+        // 帧只占层的左上部分，线性过滤不能采到层内其余区域
+        vec3 layerCoord(sampler2DArray s) {
+            vec2 limit = v_texScale - 0.5 / vec2(textureSize(s, 0).xy);
+            return vec3(min(v_texCoord, limit), float(v_layer));
+        }
+
+        void main() {
+            if (v_layout == 1) {
+                fragColor = vec4(texture(u_texRgb, layerCoord(u_texRgb)).rgb, 1.0);
+                return;
+            }
+            float y = texture(u_texY, layerCoord(u_texY)).r;
+            vec2 c;
+            if (v_layout == 2) {
+                c = vec2(texture(u_texU, layerCoord(u_texU)).r, texture(u_texV, layerCoord(u_texV)).r);
+            } else {
+                c = texture(u_texUV, layerCoord(u_texUV)).rg;
+            }
+
+            float kr = v_yuv.x;
+            float kb = v_yuv.y;
+            float kg = 1.0 - kr - kb;
+            bool full = v_yuv.z > 0.5;
+            y = (y - (full ? 0.0 : 16.0 / 255.0)) * (full ? 1.0 : 255.0 / 219.0);
+            c = (c - 128.0 / 255.0) * (full ? 1.0 : 255.0 / 224.0);
+
+            vec3 rgb = vec3(y + 2.0 * (1.0 - kr) * c.y,
+                            y - 2.0 * (1.0 - kb) * kb / kg * c.x - 2.0 * (1.0 - kr) * kr / kg * c.y,
+                            y + 2.0 * (1.0 - kb) * c.x);
+            fragColor = vec4(clamp(rgb, 0.0, 1.0), 1.0);
+        })";
+
+    if (!shaderProgram_->addShaderFromSourceCode(QOpenGLShader::Vertex, vShader))
+        qDebug() << "Vertex shader compile error:" << shaderProgram_->log();
+
+    if (!shaderProgram_->addShaderFromSourceCode(QOpenGLShader::Fragment, fShader))
+        qDebug() << "Fragment shader compile error:" << shaderProgram_->log();
+
+    if (!shaderProgram_->link())
+        qDebug() << "Shader link error:" << shaderProgram_->log();
+
+    // 纹理单元与 LayerArrayIndex 一一对应，绑定关系固定不变
+    shaderProgram_->bind();
+    shaderProgram_->setUniformValue("u_texY", static_cast<GLint>(ArrayY));
+    shaderProgram_->setUniformValue("u_texU", static_cast<GLint>(ArrayU));
+    shaderProgram_->setUniformValue("u_texV", static_cast<GLint>(ArrayV));
+    shaderProgram_->setUniformValue("u_texUV", static_cast<GLint>(ArrayUV));
+    shaderProgram_->setUniformValue("u_texRgb", static_cast<GLint>(ArrayRgb));
+    shaderProgram_->release();
+}
+
+void MultiviewRenderer::cleanup()
+{
+    makeCurrent();
+
+    for (LayerArray &array : arrays_) {
+        if (array.texture)
+            glDeleteTextures(1, &array.texture);
+        array = LayerArray();
+    }
+    if (instanceBuffer_)
+        glDeleteBuffers(1, &instanceBuffer_);
+    if (vao_)
+        glDeleteVertexArrays(1, &vao_);
+    instanceBuffer_ = 0;
+    vao_ = 0;
+
+    doneCurrent();
+}
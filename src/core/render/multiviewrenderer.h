@@ -0,0 +1,144 @@
+#ifndef MULTIVIEWRENDERER_H
+#define MULTIVIEWRENDERER_H
+
+#include <QtOpenGLWidgets/QOpenGLWidget>  // 必须首先包含
+#include <QOpenGLFunctions_4_3_Core>
+#include <QOpenGLShaderProgram>
+#include <QElapsedTimer>
+#include <QRectF>
+#include <QSize>
+#include <QTimer>
+#include <memory>
+#include <vector>
+
+#include "framequeue.h"
+#include "playbackclock.h"
+
+// 多路监看：一个 GL 上下文按网格渲染 N 路流。
+// 每路的帧上传到纹理数组中与其编号相同的层（Y/U/V/UV/RGB 各一个数组，按需分配），
+// 所有分格用一次实例化绘制画出。每格独立等比适配、独立限制刷新率；
+// 没有新帧的分格不取帧也不上传，只在合批绘制中复用上次的纹理层。
+// 所有接口须在 GUI 线程调用。
+class MultiviewRenderer : public QOpenGLWidget, protected QOpenGLFunctions_4_3_Core
+{
+    Q_OBJECT
+public:
+    struct Stats {
+        quint64 paints = 0;
+        quint64 uploads = 0;          // 上传的帧数（所有分格合计）
+        quint64 draws = 0;            // 实例化绘制调用次数，每次 paintGL 至多一次
+        quint64 instances = 0;        // 最近一次绘制的分格数
+        double averageUploadUs = 0.0; // 每帧上传的 CPU 耗时
+        double averageDrawUs = 0.0;
+    };
+
+    struct TileStats {
+        quint64 presented = 0;
+        quint64 dropped = 0;
+        quint64 throttled = 0;        // 因刷新率上限推迟取帧的次数
+    };
+
+    explicit MultiviewRenderer(QWidget *parent = nullptr);
+    ~MultiviewRenderer() override;
+
+    // 网格列数 × 行数，分格编号按行优先；缩小网格时多出的分格解除绑定
+    void setGrid(int columns, int rows);
+    int columns() const { return columns_; }
+    int rows() const { return rows_; }
+    int tileCount() const { return static_cast<int>(tiles_.size()); }
+    // 分格之间的间隔（逻辑像素）
+    void setSpacing(int pixels);
+
+    // queue 由调用方持有，解除绑定（传 nullptr）或析构本对象之前须保持有效
+    void setTileQueue(int tile, FrameQueue* queue);
+    // 该格的最高刷新率，<= 0 表示不限（每次 vsync 都可取帧）
+    void setTileMaxFps(int tile, double fps);
+    void setDropPolicy(DropPolicy policy) { dropPolicy_ = policy; }
+
+    // 分格在窗口中的区域（逻辑像素，未做等比适配）
+    QRectF tileRect(int tile) const;
+
+    Stats stats() const { return stats_; }
+    TileStats tileStats(int tile) const;
+    void resetStats();
+
+signals:
+    // 分格的物理像素尺寸，连接 DecoderPool::setTargetSize 后解码端按此尺寸输出
+    void tileTargetSizeChanged(int tile, const QSize& size);
+
+public slots:
+    void onFrameQueued();
+
+protected:
+    void initializeGL() override;
+    void paintGL() override;
+    void resizeGL(int w, int h) override;
+
+private:
+    // 与着色器 u_layout 取值一致
+    enum class PixelLayout { None = 0, Rgb = 1, I420 = 2, Nv12 = 3 };
+    enum LayerArrayIndex { ArrayY, ArrayU, ArrayV, ArrayUV, ArrayRgb, ArrayCount };
+
+    struct LayerArray {
+        GLuint texture = 0;
+        int width = 0;
+        int height = 0;
+        int layers = 0;
+    };
+
+    struct Tile {
+        FrameQueue* queue = nullptr;
+        std::unique_ptr<PlaybackClock> clock;
+        int serial = 0;
+        qint64 minIntervalNs = 0;
+        qint64 lastPresentNs = -1;
+        PixelLayout layout = PixelLayout::None;
+        int width = 0;                // 层内当前帧的尺寸
+        int height = 0;
+        float yuv[3] = {};            // kr, kb, 是否全范围
+        TileStats stats;
+    };
+
+    // 顶点属性布局，每个分格一个实例
+    struct TileInstance {
+        GLfloat rect[4];              // NDC 左上角 x、y 与宽高
+        GLfloat texScale[2];          // 帧在层内所占比例
+        GLfloat yuv[3];
+        GLint layer;
+        GLint layout;
+    };
+
+    void initShaders();
+    bool pullTile(Tile& tile, qint64 nowNs, VideoFrame* out);
+    void uploadTile(int index, const FrameBuffer& frame);
+    void uploadLayer(int array, int layer, GLenum format, int bytesPerPixel,
+                     const uint8_t* data, int stride, int w, int h);
+    void growLayers(int width, int height, int layers);
+    void ensureArray(int array);
+    void rebuildInstances();
+    void scheduleNextPaint(qint64 nowNs);
+    void emitTargetSizes();
+    void cleanup();
+
+    std::vector<Tile> tiles_;
+    int columns_ = 0;
+    int rows_ = 0;
+    int spacing_ = 2;
+    DropPolicy dropPolicy_ = DropPolicy::DropStale;
+
+    QOpenGLShaderProgram* shaderProgram_ = nullptr;
+    GLuint vao_ = 0;
+    GLuint instanceBuffer_ = 0;
+    LayerArray arrays_[ArrayCount];
+    int layerWidth_ = 0;              // 亮度层尺寸，色度层为其一半；只增不减
+    int layerHeight_ = 0;
+    int layerCount_ = 0;
+    std::vector<TileInstance> instances_;
+    bool instancesDirty_ = true;      // 布局、分格格式或层尺寸变化后重建实例数据
+
+    QElapsedTimer monotonic_;
+    QTimer throttleTimer_;            // 只有受限流的分格待显示时，在其下次允许取帧的时刻重绘
+    Stats stats_;
+};
+
+#endif // MULTIVIEWRENDERER_H
@@ -1,14 +1,52 @@
-#include "RenderOpenGL.h"
+#include "renderopengl.h"
+#include "aspectfit.h"
+#include "type.h"
 
 #include <QOpenGLBuffer>
+#include <QOpenGLContext>
 #include <QOpenGLVertexArrayObject>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace {
+// 队首帧与时钟偏差超过该值（秒）时重新锚定时钟，用于换流或解码长时间卡顿
+constexpr double kResyncThreshold = 1.0;
+
+// 像素缓冲内各平面的起始偏移按缓存行对齐
+constexpr qint64 kStagingAlignment = 64;
+
+using BufferStorageFn = void (QOPENGLF_APIENTRYP)(GLenum target, GLsizeiptr size, const void *data,
+                                                 GLbitfield flags);
+
+qint64 alignStaging(qint64 bytes)
+{
+    return (bytes + kStagingAlignment - 1) / kStagingAlignment * kStagingAlignment;
+}
+}
 
 RenderOpenGL::RenderOpenGL(QWidget *parent)
     : QOpenGLWidget(parent)
 {
     setMinimumSize(640, 480);
     setUpdateBehavior(QOpenGLWidget::PartialUpdate);
+    danmuClock_.start();
+    danmuBlocklist_.load(zg::path::danmuBlocklist());
+
+    // 队列中仍有待显示帧或弹幕仍在滚动时，每次交换缓冲后继续请求下一次 vsync 绘制
+    connect(this, &QOpenGLWidget::frameSwapped, this, [this]() {
+        if ((frameQueue_ && !frameQueue_->isEmpty()) || danmu_.isActive() || !pendingDanmu_.isEmpty())
+            update();
+    });
 }
 
 RenderOpenGL::~RenderOpenGL()
@@ -26,6 +64,20 @@ void RenderOpenGL::initializeGL()
 
     initShaders();
     initGeometry();
+    glGenQueries(kTimerQueries, timerQueries_);
+    danmu_.initialize(this);
+
+    QOpenGLContext *ctx = context();
+    if (ctx->format().version() >= qMakePair(4, 4) || ctx->hasExtension("GL_ARB_buffer_storage"))
+        bufferStorage_ = ctx->getProcAddress("glBufferStorage");
+    if (!bufferStorage_)
+        qInfo() << "glBufferStorage unavailable, textures are uploaded from client memory";
+}
+
+RenderOpenGL::UploadMode RenderOpenGL::uploadMode() const
+{
+    return uploadMode_ == UploadMode::PersistentPbo && bufferStorage_ ? UploadMode::PersistentPbo
+                                                                      : UploadMode::Direct;
 }
 
 void RenderOpenGL::resizeGL(int w, int h)
@@ -34,6 +86,9 @@ void RenderOpenGL::resizeGL(int w, int h)
     windowHeight_ = h;
     glViewport(0, 0, w, h);
     updateVertices();
+
+    // 解码端自行去抖，这里每次尺寸变化都如实通知
+    emit targetSizeChanged(QSize(w, h) * devicePixelRatioF());
 }
 
 void RenderOpenGL::updateVertices()
@@ -41,26 +96,17 @@ void RenderOpenGL::updateVertices()
     if (videoWidth_ == 0 || videoHeight_ == 0 || windowWidth_ == 0 || windowHeight_ == 0)
         return;
 
-    float windowAspect = (float)windowWidth_ / windowHeight_;
-    float videoAspect = (float)videoWidth_ / videoHeight_;
-
-    float scaleX = 1.0f;
-    float scaleY = 1.0f;
-
-    if (windowAspect > videoAspect) {
-        // 窗口比视频宽，宽度缩小
-        scaleX = videoAspect / windowAspect;
-    } else {
-        // 窗口比视频高，高度缩小
-        scaleY = windowAspect / videoAspect;
-    }
+    const QRectF window(0, 0, windowWidth_, windowHeight_);
+    const QRectF video = aspectFit(window, videoWidth_, videoHeight_);
+    const float scaleX = static_cast<float>(video.width() / window.width());
+    const float scaleY = static_cast<float>(video.height() / window.height());
 
     GLfloat vertices[] = {
         // positions           // texCoords
-        -scaleX,  scaleY, 0.0f,   0.0f, 1.0f, // top-left
-        -scaleX, -scaleY, 0.0f,   0.0f, 0.0f, // bottom-left
-        scaleX, -scaleY, 0.0f,   1.0f, 0.0f, // bottom-right
-        scaleX,  scaleY, 0.0f,   1.0f, 1.0f  // top-right
+        -scaleX,  scaleY, 0.0f,   0.0f, 0.0f, // top-left
+        -scaleX, -scaleY, 0.0f,   0.0f, 1.0f, // bottom-left
+        scaleX, -scaleY, 0.0f,   1.0f, 1.0f, // bottom-right
+        scaleX,  scaleY, 0.0f,   1.0f, 0.0f  // top-right
     };
 
     glBindBuffer(GL_ARRAY_BUFFER, vbo_);
@@ -75,32 +121,363 @@ void RenderOpenGL::paintGL()
 
     QMutexLocker locker(&textureMutex_);
 
-    if (currentImage_.isNull())
-        return;
+    if (frameQueue_)
+        pullDueFrame();
+
+    // 取出待上传的内容后即释放锁，上传期间 updateImage() 等调用方不再被阻塞
+    FrameRef frame = std::move(currentFrame_);
+    currentFrame_.reset();
+    QImage image = currentImage_;
+    currentImage_ = QImage();
+    locker.unlock();
+
+    collectGpuTimers();
+    const bool gpuTiming = beginGpuTimer();
+    QElapsedTimer cpuTimer;
+    cpuTimer.start();
+
+    bool uploaded = true;
+    if (frame) {
+        uploadFrame(*frame);
+        frame.reset();
+    } else if (!image.isNull()) {
+        beginStaging(static_cast<qint64>(image.bytesPerLine()) * image.height());
+        if (image.format() == QImage::Format_RGBA8888)
+            uploadPlane(0, GL_RGBA8, GL_RGBA, 4, image.constBits(), image.bytesPerLine(),
+                        image.width(), image.height());
+        else
+            uploadPlane(0, GL_RGB8, GL_RGB, 3, image.constBits(), image.bytesPerLine(),
+                        image.width(), image.height());
+        endStaging();
+        pixelLayout_ = PixelLayout::Rgb;
+    } else {
+        uploaded = false;
+    }
 
-    if (!texture_) {
-        texture_ = new QOpenGLTexture(QOpenGLTexture::Target2D);
-        texture_->create();
+    if (uploaded) {
+        RenderTiming &t = renderTiming_;
+        t.lastUploadUs = cpuTimer.nsecsElapsed() / 1000.0;
+        ++t.uploads;
+        t.averageUploadUs += (t.lastUploadUs - t.averageUploadUs) / t.uploads;
     }
 
-    texture_->bind();
-    texture_->setMinificationFilter(QOpenGLTexture::Linear);
-    texture_->setMagnificationFilter(QOpenGLTexture::Linear);
-    texture_->setWrapMode(QOpenGLTexture::ClampToEdge);
+    if (pixelLayout_ == PixelLayout::None) {
+        if (gpuTiming)
+            endGpuTimer();
+        renderDanmu();
+        return;
+    }
+    cpuTimer.start();
 
-    QImage glImage = currentImage_.convertToFormat(QImage::Format_RGBA8888).mirrored();
-    texture_->setData(glImage);
+    const int planes = pixelLayout_ == PixelLayout::I420 ? 3 : pixelLayout_ == PixelLayout::Nv12 ? 2 : 1;
+    for (int i = 0; i < planes; ++i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, planes_[i].texture);
+    }
 
     shaderProgram_->bind();
     glBindVertexArray(vao_);
 
-    shaderProgram_->setUniformValue("u_texture", 0);  // texture unit 0
+    shaderProgram_->setUniformValue("u_texture", 0);  // texture unit 0：RGB 或 Y
+    shaderProgram_->setUniformValue("u_texU", 1);     // U，或 NV12 的交错 UV
+    shaderProgram_->setUniformValue("u_texV", 2);
+    shaderProgram_->setUniformValue("u_layout", static_cast<int>(pixelLayout_));
+    shaderProgram_->setUniformValue("u_yuvMatrix", yuvMatrix_);
+    shaderProgram_->setUniformValue("u_yuvOffset", yuvOffset_);
 
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
 
     glBindVertexArray(0);
     shaderProgram_->release();
-    texture_->release();
+    for (int i = planes - 1; i >= 0; --i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    RenderTiming &t = renderTiming_;
+    t.lastDrawUs = cpuTimer.nsecsElapsed() / 1000.0;
+    ++t.draws;
+    t.averageDrawUs += (t.lastDrawUs - t.averageDrawUs) / t.draws;
+    if (gpuTiming)
+        endGpuTimer();
+
+    renderDanmu();
+}
+
+bool RenderOpenGL::beginGpuTimer()
+{
+    // 当前槽位的结果还没读回时跳过本帧，绝不阻塞等待 GPU
+    if (!timerQueries_[timerIndex_] || timerPending_[timerIndex_])
+        return false;
+    glBeginQuery(GL_TIME_ELAPSED, timerQueries_[timerIndex_]);
+    return true;
+}
+
+void RenderOpenGL::endGpuTimer()
+{
+    glEndQuery(GL_TIME_ELAPSED);
+    timerPending_[timerIndex_] = true;
+    timerIndex_ = (timerIndex_ + 1) % kTimerQueries;
+}
+
+void RenderOpenGL::collectGpuTimers()
+{
+    for (int i = 0; i < kTimerQueries; ++i) {
+        if (!timerPending_[i])
+            continue;
+        GLint available = 0;
+        glGetQueryObjectiv(timerQueries_[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(timerQueries_[i], GL_QUERY_RESULT, &ns);
+        timerPending_[i] = false;
+
+        RenderTiming &t = renderTiming_;
+        t.lastGpuUs = ns / 1000.0;
+        ++t.gpuSamples;
+        t.averageGpuUs += (t.lastGpuUs - t.averageGpuUs) / t.gpuSamples;
+    }
+}
+
+void RenderOpenGL::uploadFrame(const FrameBuffer &frame)
+{
+    const int w = frame.width;
+    const int h = frame.height;
+    const int cw = (w + 1) / 2;
+    const int ch = (h + 1) / 2;
+
+    PixelLayout layout = PixelLayout::None;
+    switch (frame.format) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+        layout = PixelLayout::I420;
+        break;
+    case AV_PIX_FMT_NV12:
+        layout = PixelLayout::Nv12;
+        break;
+    case AV_PIX_FMT_RGB24:
+    case AV_PIX_FMT_RGBA:
+        layout = PixelLayout::Rgb;
+        break;
+    default:
+        qDebug() << "Unsupported frame format:" << frame.format;
+        return;
+    }
+
+    qint64 bytes = 0;
+    for (int i = 0; i < 3 && frame.data[i]; ++i)
+        bytes += alignStaging(static_cast<qint64>(frame.linesize[i]) * (i == 0 ? h : ch));
+    beginStaging(bytes);
+
+    switch (frame.format) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+        uploadPlane(0, GL_R8, GL_RED, 1, frame.data[0], frame.linesize[0], w, h);
+        uploadPlane(1, GL_R8, GL_RED, 1, frame.data[1], frame.linesize[1], cw, ch);
+        uploadPlane(2, GL_R8, GL_RED, 1, frame.data[2], frame.linesize[2], cw, ch);
+        break;
+    case AV_PIX_FMT_NV12:
+        uploadPlane(0, GL_R8, GL_RED, 1, frame.data[0], frame.linesize[0], w, h);
+        uploadPlane(1, GL_RG8, GL_RG, 2, frame.data[1], frame.linesize[1], cw, ch);
+        break;
+    case AV_PIX_FMT_RGB24:
+        uploadPlane(0, GL_RGB8, GL_RGB, 3, frame.data[0], frame.linesize[0], w, h);
+        break;
+    default:
+        uploadPlane(0, GL_RGBA8, GL_RGBA, 4, frame.data[0], frame.linesize[0], w, h);
+        break;
+    }
+
+    endStaging();
+    pixelLayout_ = layout;
+    if (layout == PixelLayout::Rgb)
+        return;
+
+    AVColorRange range = frame.colorRange;
+    if (frame.format == AV_PIX_FMT_YUVJ420P)
+        range = AVCOL_RANGE_JPEG;
+    updateYuvParams(frame.colorSpace, range, h);
+}
+
+void RenderOpenGL::updateYuvParams(AVColorSpace space, AVColorRange range, int height)
+{
+    // 未标注色彩空间时按分辨率猜测：高清用 BT.709，标清用 BT.601
+    bool bt709 = false;
+    switch (space) {
+    case AVCOL_SPC_BT709:
+        bt709 = true;
+        break;
+    case AVCOL_SPC_BT470BG:
+    case AVCOL_SPC_SMPTE170M:
+    case AVCOL_SPC_FCC:
+        bt709 = false;
+        break;
+    default:
+        bt709 = height >= 720;
+        break;
+    }
+
+    const float kr = bt709 ? 0.2126f : 0.299f;
+    const float kb = bt709 ? 0.0722f : 0.114f;
+    const float kg = 1.0f - kr - kb;
+
+    // 有限范围：Y ∈ [16, 235]，UV ∈ [16, 240]；全范围直接使用 [0, 255]
+    const bool full = (range == AVCOL_RANGE_JPEG);
+    const float ys = full ? 1.0f : 255.0f / 219.0f;
+    const float cs = full ? 1.0f : 255.0f / 224.0f;
+
+    const float rv = 2.0f * (1.0f - kr);
+    const float bu = 2.0f * (1.0f - kb);
+    const float gu = -bu * kb / kg;
+    const float gv = -rv * kr / kg;
+
+    const float values[] = {
+        ys, 0.0f,    rv * cs,
+        ys, gu * cs, gv * cs,
+        ys, bu * cs, 0.0f
+    };
+    yuvMatrix_ = QMatrix3x3(values);
+    yuvOffset_ = QVector3D(full ? 0.0f : 16.0f / 255.0f, 128.0f / 255.0f, 128.0f / 255.0f);
+}
+
+void RenderOpenGL::uploadPlane(int index, GLint internalFormat, GLenum format, int bytesPerPixel,
+                               const uint8_t *data, int stride, int w, int h)
+{
+    PlaneTexture &plane = planes_[index];
+    // 不可变存储只在尺寸或格式变化时整体重建，之后每帧只更新内容
+    if (!plane.texture || w != plane.width || h != plane.height || internalFormat != plane.internalFormat) {
+        if (plane.texture)
+            glDeleteTextures(1, &plane.texture);
+        glGenTextures(1, &plane.texture);
+        glBindTexture(GL_TEXTURE_2D, plane.texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, w, h);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        plane.width = w;
+        plane.height = h;
+        plane.internalFormat = internalFormat;
+    } else {
+        glBindTexture(GL_TEXTURE_2D, plane.texture);
+    }
+
+    // 经像素缓冲上传时 source 是缓冲内的偏移，glTexSubImage2D 只记录命令，不等待传输
+    const uint8_t *source = stagePlane(data, stride, h);
+
+    // 按源数据行宽直接上传，省去 CPU 端的格式转换和翻转（翻转由纹理坐标完成）
+    if (stride % bytesPerPixel == 0) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / bytesPerPixel);
+    } else {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, format, GL_UNSIGNED_BYTE, source);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+bool RenderOpenGL::beginStaging(qint64 bytes)
+{
+    stagingCursor_ = -1;
+    if (uploadMode() != UploadMode::PersistentPbo) {
+        if (stagingBuffer_)
+            releaseStagingRing();
+        return false;
+    }
+    if (!ensureStagingRing(bytes))
+        return false;
+
+    GLsync &fence = stagingFences_[stagingSlot_];
+    if (fence) {
+        // 槽位仍在被 GPU 读取时不等待，本帧退回直接上传
+        const GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            ++renderTiming_.pboFallbacks;
+            return false;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer_);
+    stagingCursor_ = 0;
+    return true;
+}
+
+const uint8_t *RenderOpenGL::stagePlane(const uint8_t *data, int stride, int rows)
+{
+    if (stagingCursor_ < 0)
+        return data;
+
+    const qint64 bytes = static_cast<qint64>(stride) * rows;
+    const qint64 offset = stagingSlot_ * stagingSlotBytes_ + stagingCursor_;
+    // 映射是 COHERENT 的，拷贝完成后无需显式刷新
+    std::memcpy(stagingMapped_ + offset, data, static_cast<size_t>(bytes));
+    stagingCursor_ += alignStaging(bytes);
+    return reinterpret_cast<const uint8_t *>(static_cast<quintptr>(offset));
+}
+
+void RenderOpenGL::endStaging()
+{
+    if (stagingCursor_ < 0)
+        return;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    stagingFences_[stagingSlot_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    stagingSlot_ = (stagingSlot_ + 1) % kStagingSlots;
+    stagingCursor_ = -1;
+    ++renderTiming_.pboUploads;
+}
+
+bool RenderOpenGL::ensureStagingRing(qint64 slotBytes)
+{
+    if (stagingBuffer_ && slotBytes <= stagingSlotBytes_)
+        return true;
+
+    // 视频尺寸变大时整体重建；已提交的传输由驱动保证在删除前完成
+    releaseStagingRing();
+    const qint64 total = slotBytes * kStagingSlots;
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &stagingBuffer_);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer_);
+    reinterpret_cast<BufferStorageFn>(bufferStorage_)(GL_PIXEL_UNPACK_BUFFER, total, nullptr, flags);
+    stagingMapped_ = static_cast<uint8_t *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total, flags));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (!stagingMapped_) {
+        qWarning() << "Failed to map" << total << "byte upload buffer, falling back to direct uploads";
+        releaseStagingRing();
+        uploadMode_ = UploadMode::Direct;
+        return false;
+    }
+    stagingSlotBytes_ = slotBytes;
+    stagingSlot_ = 0;
+    return true;
+}
+
+void RenderOpenGL::releaseStagingRing()
+{
+    for (GLsync &fence : stagingFences_) {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (stagingBuffer_) {
+        if (stagingMapped_) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer_);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &stagingBuffer_);
+    }
+    stagingBuffer_ = 0;
+    stagingMapped_ = nullptr;
+    stagingSlotBytes_ = 0;
+    stagingSlot_ = 0;
 }
 
 void RenderOpenGL::setVideoSize(int w, int h)
@@ -110,11 +487,204 @@ void RenderOpenGL::setVideoSize(int w, int h)
     updateVertices();
 }
 
+void RenderOpenGL::setFrameQueue(FrameQueue *queue)
+{
+    QMutexLocker locker(&textureMutex_);
+    frameQueue_ = queue;
+    clock_->reset();
+    update();
+}
+
+void RenderOpenGL::setClock(PlaybackClock *clock)
+{
+    QMutexLocker locker(&textureMutex_);
+    clock_ = clock ? clock : &ownClock_;
+}
+
+void RenderOpenGL::onFrameQueued()
+{
+    update();
+}
+
+void RenderOpenGL::setDanmuOverflowPolicy(DanmuLayout::OverflowPolicy policy)
+{
+    DanmuLayout::Config config = danmuLayout_.config();
+    config.overflow = policy;
+    danmuLayout_.setConfig(config);
+    resetDanmuQueue();
+}
+
+void RenderOpenGL::setDanmuDedupConfig(const DanmuDedup::Config &config)
+{
+    danmuDedup_.setConfig(config);
+    danmuHandles_.clear();
+}
+
+void RenderOpenGL::addDanmu(const QString &text, const QColor &color, DanmuLayout::Mode mode)
+{
+    if (text.isEmpty())
+        return;
+    // 被屏蔽的弹幕不进入去重窗口，也不占用行
+    if (danmuBlocklist_.isBlocked(QStringView(text))) {
+        ++danmuBlocked_;
+        return;
+    }
+
+    syncDanmuLayout();
+    const quint64 id = nextDanmuId_++;
+    const double now = danmuClock_.nsecsElapsed() / 1e9;
+
+    DanmuDedup::Merge merge;
+    danmuReleased_.clear();
+    const bool merged = danmuDedup_.add(id, QStringView(text), now, &merge, &danmuReleased_);
+    for (quint64 released : danmuReleased_) {
+        danmuHandles_.remove(released);
+        auto pending = pendingDanmu_.find(released);
+        if (pending != pendingDanmu_.end())
+            pending->mergeable = false;
+    }
+    if (merged) {
+        mergeDanmu(merge);
+        return;
+    }
+
+    DanmuLayout::Placement placement;
+    switch (danmuLayout_.place(id, danmu_.textWidth(text), mode, now, &placement)) {
+    case DanmuLayout::Result::Placed:
+        danmuHandles_.insert(id, showDanmu(placement, text, color, 1));
+        break;
+    case DanmuLayout::Result::Queued:
+        pendingDanmu_.insert(id, PendingDanmu{ text, color });
+        break;
+    case DanmuLayout::Result::Dropped:
+        // 首条没能显示，之后的重复不能并入它
+        danmuDedup_.remove(id);
+        return;
+    }
+    update();
+}
+
+void RenderOpenGL::mergeDanmu(const DanmuDedup::Merge &merge)
+{
+    auto pending = pendingDanmu_.find(merge.id);
+    if (pending != pendingDanmu_.end()) {
+        pending->count = merge.count;
+        return;
+    }
+    // 只记下最新条数，绘制时每条弹幕替换一次角标，突发重复不会在叠加层里堆积被隐藏的角标
+    const quint64 handle = danmuHandles_.value(merge.id);
+    if (handle != 0) {
+        pendingBadges_.insert(handle, merge.count);
+        update();
+    }
+}
+
+void RenderOpenGL::resetDanmuQueue()
+{
+    // 排队的弹幕被丢弃，去重窗口一并清空，避免后续重复并入不会再显示的弹幕
+    pendingDanmu_.clear();
+    danmuDedup_.clear();
+    danmuHandles_.clear();
+}
+
+void RenderOpenGL::syncDanmuLayout()
+{
+    DanmuLayout::Config config = danmuLayout_.config();
+    if (config.width == windowWidth_ && config.height == windowHeight_ && config.lineHeight == danmu_.lineHeight()
+        && config.scrollDuration == danmu_.duration() && config.fixedDuration == danmu_.fixedDuration())
+        return;
+
+    // 重新划分行会清空排队，已在屏的弹幕不受影响，新弹幕可能与其短暂重叠
+    config.width = windowWidth_;
+    config.height = windowHeight_;
+    config.lineHeight = danmu_.lineHeight();
+    config.scrollDuration = danmu_.duration();
+    config.fixedDuration = danmu_.fixedDuration();
+    danmuLayout_.setConfig(config);
+    resetDanmuQueue();
+}
+
+quint64 RenderOpenGL::showDanmu(const DanmuLayout::Placement &placement, const QString &text, const QColor &color,
+                                int count)
+{
+    const DanmuOverlay::Motion motion = placement.mode == DanmuLayout::Mode::Scroll ? DanmuOverlay::Motion::Scroll
+                                                                                    : DanmuOverlay::Motion::Fixed;
+    const quint64 handle = danmu_.add(text, color, placement.y, motion);
+    if (count > 1)
+        danmu_.setBadge(handle, QStringLiteral("×%1").arg(count));
+    return handle;
+}
+
+void RenderOpenGL::renderDanmu()
+{
+    if (!pendingDanmu_.isEmpty()) {
+        // 排队的弹幕每帧重试一次
+        danmuPlaced_.clear();
+        danmuExpired_.clear();
+        danmuLayout_.pump(danmuClock_.nsecsElapsed() / 1e9, &danmuPlaced_, &danmuExpired_);
+        for (const DanmuLayout::Placement &placement : danmuPlaced_) {
+            const PendingDanmu pending = pendingDanmu_.take(placement.id);
+            const quint64 handle = showDanmu(placement, pending.text, pending.color, pending.count);
+            if (pending.mergeable)
+                danmuHandles_.insert(placement.id, handle);
+        }
+        for (quint64 id : danmuExpired_) {
+            pendingDanmu_.remove(id);
+            danmuDedup_.remove(id);
+        }
+    }
+    for (auto it = pendingBadges_.cbegin(); it != pendingBadges_.cend(); ++it)
+        danmu_.setBadge(it.key(), QStringLiteral("×%1").arg(it.value()));
+    pendingBadges_.clear();
+    danmu_.render(QSize(windowWidth_, windowHeight_));
+}
+
+void RenderOpenGL::pullDueFrame()
+{
+    VideoFrame* head = frameQueue_->peek();
+    if (!head)
+        return;
+
+    // 音频为主时钟时 anchor() 不生效，画面只能追随音频；跳转后以新位置的首帧重新锚定
+    if (!clock_->isAnchored() || head->serial != frameSerial_) {
+        frameSerial_ = head->serial;
+        clock_->anchor(head->pts);
+    }
+    double now = clock_->now();
+    if (clock_->source() == PlaybackClock::Source::Wall && std::abs(head->pts - now) > kResyncThreshold) {
+        clock_->anchor(head->pts);
+        now = head->pts;
+    }
+
+    VideoFrame frame;
+    int dropped = 0;
+    if (!frameQueue_->popDue(now, dropPolicy_, frame, &dropped)) {
+        ++syncStats_.repeated;   // 下一帧还早，当前帧继续显示
+        return;
+    }
+
+    droppedFrames_ += dropped;
+
+    const double errorMs = (frame.pts - now) * 1000.0;
+    syncStats_.dropped += dropped;
+    ++syncStats_.presented;
+    syncStats_.lastErrorMs = errorMs;
+    syncStats_.meanErrorMs += (errorMs - syncStats_.meanErrorMs) / syncStats_.presented;
+    syncStats_.maxAbsErrorMs = std::max(syncStats_.maxAbsErrorMs, std::abs(errorMs));
+    currentFrame_ = std::move(frame.buffer);
+
+    if (currentFrame_->width != videoWidth_ || currentFrame_->height != videoHeight_)
+        setVideoSize(currentFrame_->width, currentFrame_->height);
+}
+
 void RenderOpenGL::updateImage(const QImage &image)
 {
     {
         QMutexLocker locker(&textureMutex_);
-        currentImage_ = image.copy();
+        // 信号参数已是独立副本，隐式共享即可，无需再深拷贝；可直接上传的格式不再转换
+        const bool uploadable = image.format() == QImage::Format_RGB888
+                                || image.format() == QImage::Format_RGBA8888;
+        currentImage_ = uploadable ? image : image.convertToFormat(QImage::Format_RGBA8888);
     }
 
     setVideoSize(currentImage_.width(), currentImage_.height());
@@ -141,8 +711,26 @@ void RenderOpenGL::initShaders()
         in vec2 v_texCoord;
         out vec4 fragColor;
         uniform sampler2D u_texture;
+        uniform sampler2D u_texU;
+        uniform sampler2D u_texV;
+        uniform int u_layout;       // 1 RGB, 2 I420, 3 NV12
+        uniform mat3 u_yuvMatrix;
+        uniform vec3 u_yuvOffset;
         void main() {
-            fragColor = texture(u_texture, v_texCoord);
+            if (u_layout == 1) {
+                fragColor = vec4(texture(u_texture, v_texCoord).rgb, 1.0);
+                return;
+            }
+            vec3 yuv;
+            yuv.x = texture(u_texture, v_texCoord).r;
+            if (u_layout == 2) {
+                yuv.y = texture(u_texU, v_texCoord).r;
+                yuv.z = texture(u_texV, v_texCoord).r;
+            } else {
+                yuv.yz = texture(u_texU, v_texCoord).rg;
+            }
+            vec3 rgb = u_yuvMatrix * (yuv - u_yuvOffset);
+            fragColor = vec4(clamp(rgb, 0.0, 1.0), 1.0);
         })";
 
     if (!shaderProgram_->addShaderFromSourceCode(QOpenGLShader::Vertex, vShader))
@@ -157,12 +745,13 @@ void RenderOpenGL::initShaders()
 
 void RenderOpenGL::initGeometry()
 {
+    // 纹理按图像行序（首行在上）上传，纹理坐标 v 轴向下
     GLfloat vertices[] = {
         // positions      // texCoords
-        -1.0f,  1.0f, 0.0f,   0.0f, 1.0f, // top-left
-        -1.0f, -1.0f, 0.0f,   0.0f, 0.0f, // bottom-left
-        1.0f, -1.0f, 0.0f,   1.0f, 0.0f, // bottom-right
-        1.0f,  1.0f, 0.0f,   1.0f, 1.0f  // top-right
+        -1.0f,  1.0f, 0.0f,   0.0f, 0.0f, // top-left
+        -1.0f, -1.0f, 0.0f,   0.0f, 1.0f, // bottom-left
+        1.0f, -1.0f, 0.0f,   1.0f, 1.0f, // bottom-right
+        1.0f,  1.0f, 0.0f,   1.0f, 0.0f  // top-right
     };
 
     GLuint indices[] = {
@@ -195,9 +784,21 @@ void RenderOpenGL::cleanup()
 {
     makeCurrent();
 
-    if (texture_) {
-        delete texture_;
-        texture_ = nullptr;
+    releaseStagingRing();
+    danmu_.release();
+
+    for (PlaneTexture &plane : planes_) {
+        if (plane.texture)
+            glDeleteTextures(1, &plane.texture);
+        plane = PlaneTexture();
+    }
+
+    if (timerQueries_[0]) {
+        glDeleteQueries(kTimerQueries, timerQueries_);
+        for (int i = 0; i < kTimerQueries; ++i) {
+            timerQueries_[i] = 0;
+            timerPending_[i] = false;
+        }
     }
 
     if (vao_)
@@ -5,9 +5,19 @@
 #include <QtOpenGLWidgets/QOpenGLWidget>  // 必须首先包含
  #include <QOpenGLFunctions_4_3_Core>
 #include <QOpenGLShaderProgram>
-#include <QOpenGLTexture>
 #include <QMutex>
 #include <QImage>
+#include <QMatrix3x3>
+#include <QVector3D>
+#include <QElapsedTimer>
+#include <QHash>
+
+#include "danmudedup.h"
+#include "danmulayout.h"
+#include "keywordblocklist.h"
+#include "danmuoverlay.h"
+#include "framequeue.h"
+#include "playbackclock.h"
 
 class RenderOpenGL : public QOpenGLWidget, protected QOpenGLFunctions_4_3_Core
 {
@@ -16,9 +26,74 @@ public:
     explicit RenderOpenGL(QWidget *parent = nullptr);
     ~RenderOpenGL() override;
 
+    // 绑定解码帧队列后，每次 vsync 从队列中取出到期帧显示
+    void setFrameQueue(FrameQueue* queue);
+    void setDropPolicy(DropPolicy policy) { dropPolicy_ = policy; }
+    DropPolicy dropPolicy() const { return dropPolicy_; }
+    quint64 droppedFrames() const { return droppedFrames_; }
+
+    // 与解码器共享主时钟（有音频时由音频驱动）；为空时使用内部墙钟
+    void setClock(PlaybackClock* clock);
+
+    // 音画同步统计：误差 = 帧 pts - 显示时刻的主时钟
+    struct SyncStats {
+        quint64 presented = 0;
+        quint64 dropped = 0;        // 已过期被跳过的帧
+        quint64 repeated = 0;       // 下一帧未到期、重复显示当前帧的 vsync 次数
+        double lastErrorMs = 0.0;
+        double meanErrorMs = 0.0;
+        double maxAbsErrorMs = 0.0;
+    };
+    SyncStats syncStats() const { return syncStats_; }
+    void resetSyncStats() { syncStats_ = SyncStats(); }
+
+    // 每次绘制的耗时：upload/draw 为 CPU 端提交 GL 命令的时间，
+    // gpu 为 GL_TIME_ELAPSED 查询结果（上传 + 绘制），非阻塞读取，滞后若干帧
+    struct RenderTiming {
+        quint64 uploads = 0;
+        double lastUploadUs = 0.0;
+        double averageUploadUs = 0.0;
+        quint64 draws = 0;
+        double lastDrawUs = 0.0;
+        double averageDrawUs = 0.0;
+        quint64 gpuSamples = 0;
+        double lastGpuUs = 0.0;
+        double averageGpuUs = 0.0;
+        quint64 pboUploads = 0;      // 经像素缓冲环上传的帧数
+        quint64 pboFallbacks = 0;    // 环中槽位仍被 GPU 占用，改为直接上传的帧数
+    };
+    RenderTiming renderTiming() const { return renderTiming_; }
+    void resetRenderTiming() { renderTiming_ = RenderTiming(); }
+
+    // 纹理上传路径。PersistentPbo 先把数据拷入持久映射的像素缓冲环，再由 GPU 异步传输到纹理，
+    // 需要 GL 4.4 或 GL_ARB_buffer_storage，不支持时退回 Direct（glTexSubImage2D 读客户端内存）
+    enum class UploadMode { Direct, PersistentPbo };
+    void setUploadMode(UploadMode mode) { uploadMode_ = mode; }
+    // 实际生效的模式，initializeGL 之后才可靠
+    UploadMode uploadMode() const;
+
+    // 弹幕叠加层，画在视频之上；有弹幕在屏时按 vsync 持续重绘
+    DanmuOverlay* danmuOverlay() { return &danmu_; }
+    // 弹幕行分配，窗口尺寸、字体或时长变化后在下一条弹幕加入时自动重新划分
+    DanmuLayout::Stats danmuLayoutStats() const { return danmuLayout_.stats(); }
+    void setDanmuOverflowPolicy(DanmuLayout::OverflowPolicy policy);
+    // 重复弹幕合并：窗口内相同文本只显示首条并加“×N”角标，merged 即省去的渲染条数
+    DanmuDedup::Stats danmuDedupStats() const { return danmuDedup_.stats(); }
+    void setDanmuDedupConfig(const DanmuDedup::Config& config);
+    // 屏蔽词表，构造时加载 zg::path::danmuBlocklist() 并随文件热更新；命中的弹幕在去重与排布之前丢弃
+    KeywordBlocklist* danmuBlocklist() { return &danmuBlocklist_; }
+    quint64 danmuBlockedCount() const { return danmuBlocked_; }
+
+signals:
+    // 显示区域的物理像素尺寸，连接 VideoDecoder::setTargetSize 后解码端按此尺寸输出
+    void targetSizeChanged(const QSize& size);
+
 public slots:
     void updateImage(const QImage& image);
     void setVideoSize(int w, int h);
+    void onFrameQueued();
+    void addDanmu(const QString& text, const QColor& color = Qt::white,
+                  DanmuLayout::Mode mode = DanmuLayout::Mode::Scroll);
 
 protected:
     void initializeGL() override;
@@ -29,17 +104,94 @@ private:
     void initShaders();
     void initGeometry();
     void updateVertices();
+    void pullDueFrame();
+    void syncDanmuLayout();
+    quint64 showDanmu(const DanmuLayout::Placement& placement, const QString& text, const QColor& color, int count);
+    void mergeDanmu(const DanmuDedup::Merge& merge);
+    void resetDanmuQueue();
+    void renderDanmu();
+    void uploadFrame(const FrameBuffer& frame);
+    void uploadPlane(int index, GLint internalFormat, GLenum format, int bytesPerPixel,
+                     const uint8_t* data, int stride, int w, int h);
+    void updateYuvParams(AVColorSpace space, AVColorRange range, int height);
+
+    bool beginStaging(qint64 bytes);
+    const uint8_t* stagePlane(const uint8_t* data, int stride, int rows);
+    void endStaging();
+    bool ensureStagingRing(qint64 slotBytes);
+    void releaseStagingRing();
 
     void cleanup();
+    bool beginGpuTimer();
+    void endGpuTimer();
+    void collectGpuTimers();
 
     QOpenGLShaderProgram* shaderProgram_ = nullptr;
-    QOpenGLTexture* texture_ = nullptr;
-    QImage currentImage_;
+    // 与片元着色器 u_layout 取值一致
+    enum class PixelLayout { None = 0, Rgb = 1, I420 = 2, Nv12 = 3 };
+
+    struct PlaneTexture {
+        GLuint texture = 0;
+        int width = 0;
+        int height = 0;
+        GLint internalFormat = 0;
+    };
+
+    PlaneTexture planes_[3];     // RGB 只用 [0]；YUV 依次为 Y/U/V 或 Y/UV
+    PixelLayout pixelLayout_ = PixelLayout::None;
+    QMatrix3x3 yuvMatrix_;
+    QVector3D yuvOffset_;
+    FrameRef currentFrame_;     // 待上传的池缓冲，上传完成后立即归还
+    QImage currentImage_;       // updateImage() 传入的图像
     QMutex textureMutex_;
     GLuint vbo_ = 0;
     GLuint vao_ = 0;
     GLuint ebo_ = 0;
 
+    FrameQueue* frameQueue_ = nullptr;
+    PlaybackClock ownClock_;
+    PlaybackClock* clock_ = &ownClock_;
+    SyncStats syncStats_;
+    DropPolicy dropPolicy_ = DropPolicy::DropStale;
+    quint64 droppedFrames_ = 0;
+    int frameSerial_ = 0;   // 当前显示帧的跳转序号，变化时重新锚定时钟
+
+    static constexpr int kTimerQueries = 4;
+    GLuint timerQueries_[kTimerQueries] = {};
+    bool timerPending_[kTimerQueries] = {};
+    int timerIndex_ = 0;
+    RenderTiming renderTiming_;
+    DanmuOverlay danmu_;
+    DanmuLayout danmuLayout_;
+    QElapsedTimer danmuClock_;                    // 排布时间轴，只要求单调
+    struct PendingDanmu {
+        QString text;
+        QColor color;
+        int count = 1;                            // 排队期间并入的重复条数（含自身）
+        bool mergeable = true;                    // 排队超过去重窗口后，显示出来也不再接受合并
+    };
+    QHash<quint64, PendingDanmu> pendingDanmu_;   // 排队中的弹幕内容，按 id 取回
+    std::vector<DanmuLayout::Placement> danmuPlaced_;
+    std::vector<quint64> danmuExpired_;
+    KeywordBlocklist danmuBlocklist_;
+    quint64 danmuBlocked_ = 0;
+    DanmuDedup danmuDedup_;
+    QHash<quint64, quint64> danmuHandles_;        // 仍可被合并的在屏弹幕：id → 叠加层句柄
+    std::vector<quint64> danmuReleased_;
+    QHash<quint64, int> pendingBadges_;           // 本帧待更新的角标：叠加层句柄 → 最新条数
+    quint64 nextDanmuId_ = 0;
+
+    // 持久映射的上传缓冲环：每个槽位容纳一整帧，GPU 读完（栅栏触发）之前不会被覆写
+    static constexpr int kStagingSlots = 3;
+    UploadMode uploadMode_ = UploadMode::PersistentPbo;
+    QFunctionPointer bufferStorage_ = nullptr;   // glBufferStorage，4.3 函数表中没有
+    GLuint stagingBuffer_ = 0;
+    uint8_t* stagingMapped_ = nullptr;
+    qint64 stagingSlotBytes_ = 0;
+    GLsync stagingFences_[kStagingSlots] = {};
+    int stagingSlot_ = 0;
+    qint64 stagingCursor_ = -1;   // 当前帧在槽内的写入位置，-1 表示本帧直接上传
+
     int videoWidth_ = 0;
     int videoHeight_ = 0;
     int windowWidth_ = 640;
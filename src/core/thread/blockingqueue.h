@@ -0,0 +1,212 @@
+#ifndef BLOCKINGQUEUE_H
+#define BLOCKINGQUEUE_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+// 有界阻塞队列，用于流水线各阶段之间传递 AVPacket* / AVFrame*。
+// abort() 后所有阻塞的 push/pop 立即返回 false，直到 reset()。
+// Traits::release 负责释放 flush() 丢弃的元素。
+template <typename T, typename Traits>
+class BlockingQueue
+{
+public:
+    explicit BlockingQueue(int capacity)
+        : items_(capacity)
+        , capacity_(capacity)
+    {
+    }
+
+    ~BlockingQueue()
+    {
+        flush();
+    }
+
+    BlockingQueue(const BlockingQueue&) = delete;
+    BlockingQueue& operator=(const BlockingQueue&) = delete;
+
+    bool push(T item)
+    {
+        QMutexLocker locker(&mutex_);
+        while (!aborted_ && count_ >= capacity_)
+            notFull_.wait(&mutex_);
+
+        if (aborted_) {
+            locker.unlock();
+            Traits::release(item);
+            return false;
+        }
+
+        items_[(head_ + count_) % capacity_] = item;
+        ++count_;
+        depth_.store(count_, std::memory_order_relaxed);
+        notEmpty_.wakeOne();
+        return true;
+    }
+
+    bool pop(T& out)
+    {
+        QMutexLocker locker(&mutex_);
+        while (!aborted_ && count_ == 0)
+            notEmpty_.wait(&mutex_);
+
+        if (aborted_)
+            return false;
+
+        out = items_[head_];
+        head_ = (head_ + 1) % capacity_;
+        --count_;
+        depth_.store(count_, std::memory_order_relaxed);
+        notFull_.wakeOne();
+        return true;
+    }
+
+    // 不等待：队列为空或已中止时立即返回 false，供共享工作线程轮询
+    bool tryPop(T& out)
+    {
+        QMutexLocker locker(&mutex_);
+        if (aborted_ || count_ == 0)
+            return false;
+
+        out = items_[head_];
+        head_ = (head_ + 1) % capacity_;
+        --count_;
+        depth_.store(count_, std::memory_order_relaxed);
+        notFull_.wakeOne();
+        return true;
+    }
+
+    void flush()
+    {
+        QMutexLocker locker(&mutex_);
+        for (; count_ > 0; --count_) {
+            Traits::release(items_[head_]);
+            head_ = (head_ + 1) % capacity_;
+        }
+        depth_.store(0, std::memory_order_relaxed);
+        notFull_.wakeAll();
+    }
+
+    void abort()
+    {
+        QMutexLocker locker(&mutex_);
+        aborted_ = true;
+        notEmpty_.wakeAll();
+        notFull_.wakeAll();
+    }
+
+    void reset()
+    {
+        flush();
+        QMutexLocker locker(&mutex_);
+        aborted_ = false;
+    }
+
+    // 不加锁读取，供监控线程采样，值可能比实际稍旧
+    int size() const
+    {
+        return depth_.load(std::memory_order_relaxed);
+    }
+
+    int capacity() const { return capacity_; }
+
+private:
+    mutable QMutex mutex_;
+    QWaitCondition notEmpty_;
+    QWaitCondition notFull_;
+    std::vector<T> items_;   // 定长环形缓冲，入队出队不分配内存
+    int capacity_;
+    int head_ = 0;
+    int count_ = 0;
+    std::atomic<int> depth_{0};   // count_ 的无锁镜像
+    bool aborted_ = false;
+};
+
+// 复用 AVPacket/AVFrame 结构体本身，稳态下各阶段之间传递不再逐包分配
+template <typename T, typename Traits>
+class ShellPool
+{
+public:
+    explicit ShellPool(int capacity)
+        : capacity_(capacity)
+    {
+        shells_.reserve(capacity_);
+    }
+
+    ~ShellPool()
+    {
+        for (T& shell : shells_)
+            Traits::release(shell);
+    }
+
+    ShellPool(const ShellPool&) = delete;
+    ShellPool& operator=(const ShellPool&) = delete;
+
+    T take()
+    {
+        QMutexLocker locker(&mutex_);
+        if (shells_.empty())
+            return Traits::alloc();
+        T shell = shells_.back();
+        shells_.pop_back();
+        return shell;
+    }
+
+    void recycle(T shell)
+    {
+        if (!shell)
+            return;
+        Traits::unref(shell);
+
+        QMutexLocker locker(&mutex_);
+        if (static_cast<int>(shells_.size()) >= capacity_) {
+            locker.unlock();
+            Traits::release(shell);
+            return;
+        }
+        shells_.push_back(shell);
+    }
+
+private:
+    QMutex mutex_;
+    std::vector<T> shells_;
+    int capacity_;
+};
+
+// 跳转标记：与数据包同队列按序传递，解码阶段收到后清空解码器内部缓存。
+// 全局唯一且永不释放，不能交给 ShellPool 回收
+inline AVPacket* flushPacket()
+{
+    static AVPacket* const marker = av_packet_alloc();
+    return marker;
+}
+
+struct PacketTraits {
+    static AVPacket* alloc() { return av_packet_alloc(); }
+    static void unref(AVPacket* packet) { av_packet_unref(packet); }
+    static void release(AVPacket*& packet)
+    {
+        if (packet != flushPacket())
+            av_packet_free(&packet);
+    }
+};
+
+struct AVFrameTraits {
+    static AVFrame* alloc() { return av_frame_alloc(); }
+    static void unref(AVFrame* frame) { av_frame_unref(frame); }
+    static void release(AVFrame*& frame) { av_frame_free(&frame); }
+};
+
+// nullptr 元素作为流结束标记、flushPacket() 作为跳转标记在各阶段间传递
+using PacketQueue = BlockingQueue<AVPacket*, PacketTraits>;
+using DecodedFrameQueue = BlockingQueue<AVFrame*, AVFrameTraits>;
+using PacketShellPool = ShellPool<AVPacket*, PacketTraits>;
+using FrameShellPool = ShellPool<AVFrame*, AVFrameTraits>;
+
+#endif // BLOCKINGQUEUE_H
@@ -0,0 +1,90 @@
+#include "decoderoptions.h"
+
+#include <QThread>
+#include <algorithm>
+
+namespace {
+
+// 分辨率越高，单帧可并行的工作越多；小分辨率开太多线程只会增加同步开销
+int threadCapFor(int width, int height)
+{
+    const qint64 pixels = qint64(width) * height;
+    if (pixels <= 1280 * 720)
+        return 4;
+    if (pixels <= 1920 * 1088)
+        return 8;
+    return 16;  // FFmpeg 帧线程上限附近，4K 及以上
+}
+
+bool supportsFrameThreads(AVCodecID codecId)
+{
+    switch (codecId) {
+    case AV_CODEC_ID_H264:
+    case AV_CODEC_ID_HEVC:
+    case AV_CODEC_ID_VP8:
+    case AV_CODEC_ID_VP9:
+    case AV_CODEC_ID_MPEG4:
+    case AV_CODEC_ID_AV1:
+        return true;
+    default:
+        return false;
+    }
+}
+
+const char *threadTypeName(DecoderOptions::ThreadType type)
+{
+    switch (type) {
+    case DecoderOptions::ThreadType::Frame: return "frame";
+    case DecoderOptions::ThreadType::Slice: return "slice";
+    default: return "auto";
+    }
+}
+
+}
+
+DecoderOptions DecoderOptions::resolved(AVCodecID codecId, int width, int height) const
+{
+    DecoderOptions out = *this;
+
+    if (out.threadCount <= 0) {
+        const int cores = std::max(1, QThread::idealThreadCount());
+        out.threadCount = std::min(cores, threadCapFor(width, height));
+    }
+
+    if (out.threadType == ThreadType::Auto) {
+        // 低延迟模式下帧级并行的额外缓冲不可接受
+        if (out.lowDelay || !supportsFrameThreads(codecId))
+            out.threadType = ThreadType::Slice;
+        else
+            out.threadType = ThreadType::Frame;
+    }
+
+    return out;
+}
+
+void DecoderOptions::applyTo(AVCodecContext *ctx) const
+{
+    ctx->thread_count = threadCount;
+    switch (threadType) {
+    case ThreadType::Frame:
+        ctx->thread_type = FF_THREAD_FRAME;
+        break;
+    case ThreadType::Slice:
+        ctx->thread_type = FF_THREAD_SLICE;
+        break;
+    default:
+        ctx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        break;
+    }
+
+    if (lowDelay)
+        ctx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+}
+
+QString DecoderOptions::toString() const
+{
+    return QString("threads=%1 type=%2 lowDelay=%3")
+        .arg(threadCount)
+        .arg(threadTypeName(threadType))
+        .arg(lowDelay ? "on" : "off");
+}
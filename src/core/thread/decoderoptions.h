@@ -0,0 +1,31 @@
+#ifndef DECODEROPTIONS_H
+#define DECODEROPTIONS_H
+
+#include <QString>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+// FFmpeg 解码器多线程配置
+struct DecoderOptions {
+    enum class ThreadType {
+        Auto,   // 交给启发式 / FFmpeg 选择
+        Frame,  // 帧级并行：吞吐高，但引入 threadCount-1 帧延迟
+        Slice   // 片级并行：无额外延迟，依赖码流按 slice 编码
+    };
+
+    int threadCount = 0;                    // 0 = 自动（按 CPU 核数）
+    ThreadType threadType = ThreadType::Auto;
+    bool lowDelay = false;                  // AV_CODEC_FLAG_LOW_DELAY，并优先片级并行
+
+    // 按编码格式与分辨率补全 Auto 项，返回最终使用的配置
+    DecoderOptions resolved(AVCodecID codecId, int width, int height) const;
+
+    // 打开解码器前写入 AVCodecContext
+    void applyTo(AVCodecContext *ctx) const;
+
+    QString toString() const;
+};
+
+#endif // DECODEROPTIONS_H
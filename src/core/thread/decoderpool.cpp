@@ -0,0 +1,226 @@
+#include "decoderpool.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+
+DecoderPool::DecoderPool(int workerCount, QObject *parent)
+    : QObject(parent)
+{
+    if (workerCount <= 0)
+        workerCount = std::max(1, QThread::idealThreadCount() - 1);
+
+    m_options.threadCount = 1;
+
+    m_workers.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i) {
+        QThread *worker = QThread::create([this]() { workerLoop(); });
+        worker->start();
+        m_workers.push_back(worker);
+    }
+    qInfo() << "DecoderPool started with" << workerCount << "workers";
+}
+
+DecoderPool::~DecoderPool()
+{
+    // 在锁外注销：回调持有队列的锁再取 m_mutex，反过来会死锁
+    for (auto &item : m_streams)
+        item.second.queue->setSpaceAvailableCallback(nullptr);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        for (auto &item : m_streams)
+            item.second.decoder->stop();
+        m_workAvailable.wakeAll();
+    }
+
+    for (QThread *worker : m_workers) {
+        worker->wait();
+        delete worker;
+    }
+
+    // 工作线程已全部退出，解码器析构时只需等各自的解复用线程
+    m_streams.clear();
+}
+
+void DecoderPool::setDecoderOptions(const DecoderOptions &options)
+{
+    QMutexLocker locker(&m_mutex);
+    m_options = options;
+}
+
+DecoderPool::StreamId DecoderPool::addStream(const QString &url, FrameQueue *queue, Priority priority)
+{
+    // 渲染端取走帧使输出队列不再满时唤醒工作线程，空闲时无需轮询
+    queue->setSpaceAvailableCallback([this]() { wake(); });
+
+    QMutexLocker locker(&m_mutex);
+    const StreamId id = m_nextId++;
+
+    StreamDecoder::Callbacks callbacks;
+    callbacks.packetsAvailable = [this]() { wake(); };
+    callbacks.frameQueued = [this, id]() { emit frameQueued(id); };
+    callbacks.ended = [this, id]() { emit streamEnded(id); };
+    callbacks.failed = [this, id](const QString &reason) { emit streamFailed(id, reason); };
+
+    Entry &entry = m_streams[id];
+    entry.decoder = std::make_unique<StreamDecoder>(url, queue, m_options, std::move(callbacks));
+    entry.queue = queue;
+    entry.decoder->setPriority(priority);
+    // 新流从当前进度开始计，不因 vruntime 为 0 而长时间独占工作线程
+    entry.vruntime = m_minVruntime;
+    entry.decoder->start();
+
+    if (priority == Priority::Focused)
+        m_focused = id;
+    return id;
+}
+
+void DecoderPool::removeStream(StreamId id)
+{
+    std::unique_ptr<StreamDecoder> decoder;
+    FrameQueue *queue = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_streams.find(id);
+        if (it == m_streams.end())
+            return;
+
+        it->second.decoder->stop();
+        while (it->second.busy)
+            m_streamIdle.wait(&m_mutex);
+
+        decoder = std::move(it->second.decoder);
+        queue = it->second.queue;
+        m_streams.erase(it);
+        if (m_focused == id)
+            m_focused = 0;
+    }
+    // 在锁外注销与析构：注销要等进行中的回调返回，析构要等解复用线程退出
+    queue->setSpaceAvailableCallback(nullptr);
+    decoder.reset();
+}
+
+void DecoderPool::setPriority(StreamId id, Priority priority)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_streams.find(id);
+    if (it == m_streams.end())
+        return;
+
+    it->second.decoder->setPriority(priority);
+    if (priority == Priority::Focused) {
+        if (m_focused != id) {
+            auto previous = m_streams.find(m_focused);
+            if (previous != m_streams.end())
+                previous->second.decoder->setPriority(Priority::Visible);
+        }
+        m_focused = id;
+    } else if (m_focused == id) {
+        m_focused = 0;
+    }
+    m_workAvailable.wakeAll();
+}
+
+void DecoderPool::setFocused(StreamId id)
+{
+    setPriority(id, Priority::Focused);
+}
+
+void DecoderPool::setTargetSize(StreamId id, const QSize &size)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_streams.find(id);
+    if (it != m_streams.end())
+        it->second.decoder->setTargetSize(size);
+}
+
+DecoderPool::StreamStats DecoderPool::streamStats(StreamId id) const
+{
+    QMutexLocker locker(&m_mutex);
+    StreamStats stats;
+    auto it = m_streams.find(id);
+    if (it == m_streams.end())
+        return stats;
+
+    const StreamDecoder *decoder = it->second.decoder.get();
+    stats.priority = decoder->priority();
+    stats.state = decoder->state();
+    stats.decoder = decoder->stats();
+    stats.queuedPackets = decoder->queuedPackets();
+    return stats;
+}
+
+std::vector<DecoderPool::StreamId> DecoderPool::streams() const
+{
+    QMutexLocker locker(&m_mutex);
+    std::vector<StreamId> ids;
+    ids.reserve(m_streams.size());
+    for (const auto &item : m_streams)
+        ids.push_back(item.first);
+    return ids;
+}
+
+void DecoderPool::wake()
+{
+    QMutexLocker locker(&m_mutex);
+    m_workAvailable.wakeOne();
+}
+
+int DecoderPool::weightOf(Priority priority)
+{
+    switch (priority) {
+    case Priority::Focused: return 8;
+    case Priority::Visible: return 4;
+    default: return 1;
+    }
+}
+
+DecoderPool::Entry *DecoderPool::pickLocked(StreamId *id)
+{
+    // 加权公平：选出可运行且 vruntime 最小的流。流数量在几十以内，线性扫描足够
+    Entry *best = nullptr;
+    for (auto &item : m_streams) {
+        Entry &entry = item.second;
+        if (entry.busy || !entry.decoder->isReady())
+            continue;
+        // 空闲过的流不能凭旧的 vruntime 补回欠账
+        entry.vruntime = std::max(entry.vruntime, m_minVruntime);
+        if (!best || entry.vruntime < best->vruntime) {
+            best = &entry;
+            *id = item.first;
+        }
+    }
+    return best;
+}
+
+void DecoderPool::workerLoop()
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_stopping) {
+        StreamId id = 0;
+        Entry *entry = pickLocked(&id);
+        if (!entry) {
+            // 流变为可运行时都会唤醒：新包到达、输出队列腾出空间、优先级变化
+            m_workAvailable.wait(&m_mutex);
+            continue;
+        }
+
+        entry->busy = true;
+        m_minVruntime = std::max(m_minVruntime, entry->vruntime);
+        StreamDecoder *decoder = entry->decoder.get();
+        locker.unlock();
+
+        QElapsedTimer timer;
+        timer.start();
+        decoder->step();
+        const qint64 elapsedNs = timer.nsecsElapsed();
+
+        locker.relock();
+        // busy 期间 removeStream 会等待，entry 仍然有效
+        entry->busy = false;
+        entry->vruntime += elapsedNs / weightOf(decoder->priority());
+        m_streamIdle.wakeAll();
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef DECODERPOOL_H
+#define DECODERPOOL_H
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSize>
+#include <QString>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "streamdecoder.h"
+
+// 多路流共用固定数量的解码工作线程。
+// 每路流的解复用各占一个（主要阻塞在 I/O 上的）线程，解码与转换按包分片，
+// 由工作线程按加权公平调度执行：焦点流权重最高，隐藏流只解关键帧。
+// FFmpeg 内部线程默认关闭（threadCount = 1），总 CPU 占用由工作线程数决定。
+class DecoderPool : public QObject
+{
+    Q_OBJECT
+public:
+    using StreamId = int;
+    using Priority = StreamDecoder::Priority;
+
+    struct StreamStats {
+        Priority priority = Priority::Visible;
+        StreamDecoder::State state = StreamDecoder::State::Opening;
+        StreamDecoder::Stats decoder;
+        int queuedPackets = 0;
+    };
+
+    // workerCount <= 0 时取 CPU 核数减一（至少 1），给 GUI 线程留出余量
+    explicit DecoderPool(int workerCount = 0, QObject *parent = nullptr);
+    ~DecoderPool() override;
+
+    int workerCount() const { return static_cast<int>(m_workers.size()); }
+
+    // 新流的解码器配置，已添加的流不受影响
+    void setDecoderOptions(const DecoderOptions &options);
+
+    // queue 由调用方持有，须在 removeStream() 返回后才能释放
+    StreamId addStream(const QString &url, FrameQueue *queue, Priority priority = Priority::Visible);
+    // 返回时保证该流不再写入其 FrameQueue
+    void removeStream(StreamId id);
+
+    void setPriority(StreamId id, Priority priority);
+    // 焦点只有一个：原焦点流降为 Visible
+    void setFocused(StreamId id);
+    // 该流所在窗口的显示像素尺寸，输出按其等比缩小
+    void setTargetSize(StreamId id, const QSize &size);
+
+    StreamStats streamStats(StreamId id) const;
+    std::vector<StreamId> streams() const;
+
+signals:
+    // 均从工作线程或解复用线程发出
+    void frameQueued(int id);
+    void streamEnded(int id);
+    void streamFailed(int id, const QString &reason);
+
+private:
+    struct Entry {
+        std::unique_ptr<StreamDecoder> decoder;
+        FrameQueue *queue = nullptr;
+        bool busy = false;        // 正被某个工作线程 step()
+        qint64 vruntime = 0;      // 按权重折算的已用解码时间（ns）
+    };
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_workAvailable;
+    QWaitCondition m_streamIdle;
+    std::map<StreamId, Entry> m_streams;
+    std::vector<QThread *> m_workers;
+    DecoderOptions m_options;
+    StreamId m_nextId = 1;
+    StreamId m_focused = 0;
+    qint64 m_minVruntime = 0;
+    bool m_stopping = false;
+
+    void workerLoop();
+    Entry *pickLocked(StreamId *id);
+    void wake();
+    static int weightOf(Priority priority);
+};
+
+#endif // DECODERPOOL_H
@@ -0,0 +1,90 @@
+#include "framepacer.h"
+#include "playbackclock.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+// 单次 sleep 上限：期间主时钟可能被音频修正，分段睡眠便于重新计算
+constexpr std::chrono::milliseconds kMaxSleepSlice{20};
+}
+
+FramePacer::FramePacer(PlaybackClock *clock)
+    : clock_(clock)
+{
+}
+
+void FramePacer::reset()
+{
+    QMutexLocker locker(&statsMutex_);
+    stats_ = Stats();
+}
+
+FramePacer::Decision FramePacer::pace(double pts, const std::atomic<bool> &stop)
+{
+    using Clock = std::chrono::steady_clock;
+
+    if (!clock_->isAnchored())
+        clock_->anchor(pts);
+
+    if (isLate(pts)) {
+        recordDrop();
+        return Decision::Drop;
+    }
+
+    for (;;) {
+        if (stop)
+            return Decision::Drop;
+
+        const double wait = pts - clock_->now();
+        if (wait <= 0)
+            break;
+
+        const auto remaining = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(wait));
+        if (remaining > spinWindow_) {
+            const auto coarse = std::chrono::duration_cast<Clock::duration>(remaining - spinWindow_);
+            std::this_thread::sleep_for(std::min<Clock::duration>(coarse, kMaxSleepSlice));
+            continue;
+        }
+
+        // 最后一段自旋到单调时钟的截止时刻
+        const auto deadline = Clock::now() + remaining;
+        while (Clock::now() < deadline && !stop)
+            std::this_thread::yield();
+        break;
+    }
+
+    record(clock_->now() - pts);
+    return Decision::Present;
+}
+
+bool FramePacer::isLate(double pts) const
+{
+    const double threshold = lateThreshold_.load(std::memory_order_relaxed);
+    if (threshold <= 0 || !clock_->isAnchored())
+        return false;
+    return clock_->now() - pts > threshold;
+}
+
+void FramePacer::recordDrop()
+{
+    QMutexLocker locker(&statsMutex_);
+    ++stats_.dropped;
+}
+
+FramePacer::Stats FramePacer::stats() const
+{
+    QMutexLocker locker(&statsMutex_);
+    return stats_;
+}
+
+void FramePacer::record(double latenessSec)
+{
+    const double latenessMs = latenessSec * 1000.0;
+
+    QMutexLocker locker(&statsMutex_);
+    ++stats_.presented;
+    stats_.lastLatenessMs = latenessMs;
+    stats_.maxLatenessMs = std::max(stats_.maxLatenessMs, latenessMs);
+    stats_.cumulativeDriftMs += latenessMs;
+}
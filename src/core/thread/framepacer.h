@@ -0,0 +1,57 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <QMutex>
+#include <atomic>
+#include <chrono>
+
+class PlaybackClock;
+
+// 解码端帧节奏控制：按主时钟等待到帧的显示时刻，
+// 长等待用 sleep，最后一小段自旋，避免 msleep 的毫秒截断和调度抖动；
+// 已经晚于阈值的帧直接丢弃，防止延迟无限累积。
+class FramePacer
+{
+public:
+    enum class Decision { Present, Drop };
+
+    struct Stats {
+        quint64 presented = 0;
+        quint64 dropped = 0;
+        double lastLatenessMs = 0.0;     // 正值表示晚于 pts
+        double maxLatenessMs = 0.0;
+        double cumulativeDriftMs = 0.0;  // 已显示帧的迟到时间累计
+    };
+
+    explicit FramePacer(PlaybackClock *clock);
+
+    // 晚于 pts 超过该值的帧被丢弃；<= 0 表示从不丢帧。可在 pace() 运行时从其他线程调整
+    void setLateThreshold(double seconds) { lateThreshold_.store(seconds, std::memory_order_relaxed); }
+    double lateThreshold() const { return lateThreshold_.load(std::memory_order_relaxed); }
+
+    // 距离目标时刻小于该值后改为自旋等待
+    void setSpinWindow(std::chrono::microseconds window) { spinWindow_ = window; }
+
+    void reset();
+
+    // 阻塞到 pts 的显示时刻；stop 置位时提前返回 Drop
+    Decision pace(double pts, const std::atomic<bool> &stop);
+
+    // 不等待，只判断是否已晚于阈值（用于渲染端自行调度时提前丢弃）
+    bool isLate(double pts) const;
+    void recordDrop();
+
+    Stats stats() const;
+
+private:
+    void record(double latenessSec);
+
+    PlaybackClock *clock_ = nullptr;
+    std::atomic<double> lateThreshold_{0.1};
+    std::chrono::microseconds spinWindow_{1500};
+
+    mutable QMutex statsMutex_;
+    Stats stats_;
+};
+
+#endif // FRAMEPACER_H
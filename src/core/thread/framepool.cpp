@@ -0,0 +1,227 @@
+#include "framepool.h"
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/mem.h>
+}
+
+namespace {
+
+// RGB24 每像素 3 字节，按 4 字节对齐行宽可直接对应 GL_UNPACK_ALIGNMENT；
+// 其余格式按 32 字节对齐，方便 swscale 走 SIMD 路径
+int lineAlignFor(AVPixelFormat format)
+{
+    return format == AV_PIX_FMT_RGB24 ? 4 : 32;
+}
+
+}
+
+// ---------------- FrameRef ----------------
+
+FrameRef::FrameRef(FrameBuffer *buffer)
+    : buffer_(buffer)
+{
+    if (buffer_)
+        buffer_->refs_.fetch_add(1, std::memory_order_relaxed);
+}
+
+FrameRef::FrameRef(const FrameRef &other)
+    : FrameRef(other.buffer_)
+{
+}
+
+FrameRef::FrameRef(FrameRef &&other) noexcept
+    : buffer_(other.buffer_)
+{
+    other.buffer_ = nullptr;
+}
+
+FrameRef &FrameRef::operator=(FrameRef other) noexcept
+{
+    std::swap(buffer_, other.buffer_);
+    return *this;
+}
+
+FrameRef::~FrameRef()
+{
+    reset();
+}
+
+FrameBuffer *FrameRef::release()
+{
+    FrameBuffer *buffer = buffer_;
+    buffer_ = nullptr;
+    return buffer;
+}
+
+FrameRef FrameRef::adopt(FrameBuffer *buffer)
+{
+    FrameRef ref;
+    ref.buffer_ = buffer;
+    return ref;
+}
+
+void FrameRef::reset()
+{
+    if (!buffer_)
+        return;
+
+    FrameBuffer *buffer = buffer_;
+    buffer_ = nullptr;
+    if (buffer->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // 先取出池的引用，recycle 返回后池才可能析构
+        std::shared_ptr<FramePool> owner = std::move(buffer->owner_);
+        owner->recycle(buffer);
+    }
+}
+
+// ---------------- FramePool ----------------
+
+std::shared_ptr<FramePool> FramePool::create(int maxBuffers)
+{
+    return std::shared_ptr<FramePool>(new FramePool(maxBuffers));
+}
+
+FramePool::FramePool(int maxBuffers)
+    : maxBuffers_(maxBuffers)
+{
+    // 预留容量，保证稳态下 push_back 不会触发重新分配
+    free_.reserve(maxBuffers_);
+    all_.reserve(maxBuffers_);
+}
+
+FramePool::~FramePool()
+{
+    // 借出的缓冲持有池的 shared_ptr，析构时所有缓冲都已归还
+    for (FrameBuffer *buffer : all_)
+        freeBuffer(buffer);
+}
+
+void FramePool::configure(int width, int height, AVPixelFormat format, Storage storage)
+{
+    QMutexLocker locker(&mutex_);
+    if (width == width_ && height == height_ && format == format_ && storage == storage_)
+        return;
+
+    width_ = width;
+    height_ = height;
+    format_ = format;
+    storage_ = storage;
+    ++generation_;
+
+    for (FrameBuffer *buffer : free_)
+        freeBuffer(buffer);
+    free_.clear();
+    // 仍被借出的旧缓冲不再归池管理，归还时由 recycle 释放
+    all_.clear();
+}
+
+FrameRef FramePool::acquire()
+{
+    QMutexLocker locker(&mutex_);
+
+    FrameBuffer *buffer = nullptr;
+    if (!free_.empty()) {
+        buffer = free_.back();
+        free_.pop_back();
+    } else if (static_cast<int>(all_.size()) < maxBuffers_ && width_ > 0 && height_ > 0) {
+        buffer = allocateBuffer();
+        if (!buffer)
+            return FrameRef();
+        all_.push_back(buffer);
+    } else {
+        return FrameRef();
+    }
+
+    buffer->owner_ = shared_from_this();
+    ++stats_.acquires;
+    ++stats_.outstanding;
+    return FrameRef(buffer);
+}
+
+FrameRef FramePool::wrap(AVFrame *frame)
+{
+    FrameRef ref = acquire();
+    if (!ref)
+        return ref;
+
+    FrameBuffer *buffer = ref.get();
+    av_frame_move_ref(buffer->frame_, frame);
+    buffer->width = buffer->frame_->width;
+    buffer->height = buffer->frame_->height;
+    buffer->format = static_cast<AVPixelFormat>(buffer->frame_->format);
+    for (int i = 0; i < 4; ++i) {
+        buffer->data[i] = buffer->frame_->data[i];
+        buffer->linesize[i] = buffer->frame_->linesize[i];
+    }
+    buffer->colorSpace = buffer->frame_->colorspace;
+    buffer->colorRange = buffer->frame_->color_range;
+    return ref;
+}
+
+FramePool::Stats FramePool::stats() const
+{
+    QMutexLocker locker(&mutex_);
+    return stats_;
+}
+
+void FramePool::recycle(FrameBuffer *buffer)
+{
+    QMutexLocker locker(&mutex_);
+    --stats_.outstanding;
+    ++stats_.recycles;
+
+    // 尽早归还解码器的帧缓冲，避免其内部缓冲池膨胀
+    if (buffer->frame_)
+        av_frame_unref(buffer->frame_);
+
+    if (buffer->generation_ != generation_) {
+        freeBuffer(buffer);
+        return;
+    }
+    free_.push_back(buffer);
+}
+
+FrameBuffer *FramePool::allocateBuffer()
+{
+    if (storage_ == Storage::Borrowed) {
+        auto *buffer = new FrameBuffer;
+        buffer->frame_ = av_frame_alloc();
+        if (!buffer->frame_) {
+            delete buffer;
+            return nullptr;
+        }
+        buffer->generation_ = generation_;
+        ++stats_.allocations;
+        return buffer;
+    }
+
+    const int align = lineAlignFor(format_);
+    const int size = av_image_get_buffer_size(format_, width_, height_, align);
+    if (size <= 0)
+        return nullptr;
+
+    auto *buffer = new FrameBuffer;
+    buffer->storage_ = static_cast<uint8_t *>(av_malloc(size));
+    if (!buffer->storage_) {
+        delete buffer;
+        return nullptr;
+    }
+
+    buffer->width = width_;
+    buffer->height = height_;
+    buffer->format = format_;
+    buffer->generation_ = generation_;
+    av_image_fill_arrays(buffer->data, buffer->linesize, buffer->storage_,
+                         format_, width_, height_, align);
+
+    ++stats_.allocations;
+    return buffer;
+}
+
+void FramePool::freeBuffer(FrameBuffer *buffer)
+{
+    av_free(buffer->storage_);
+    av_frame_free(&buffer->frame_);
+    delete buffer;
+}
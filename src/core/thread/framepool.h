@@ -0,0 +1,120 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <QMutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+extern "C" {
+#include <libavutil/pixfmt.h>
+#include <libavutil/frame.h>
+}
+
+class FramePool;
+
+// 池内固定大小的帧缓冲，由 FrameRef 引用计数，计数归零后回到所属的池
+class FrameBuffer
+{
+public:
+    int width = 0;
+    int height = 0;
+    AVPixelFormat format = AV_PIX_FMT_NONE;
+    uint8_t *data[4] = {};
+    int linesize[4] = {};
+    AVColorSpace colorSpace = AVCOL_SPC_UNSPECIFIED;
+    AVColorRange colorRange = AVCOL_RANGE_UNSPECIFIED;
+
+private:
+    friend class FramePool;
+    friend class FrameRef;
+
+    std::atomic<int> refs_{0};
+    std::shared_ptr<FramePool> owner_;   // 借出期间持有，保证池比缓冲活得久
+    uint8_t *storage_ = nullptr;   // Owned 模式下的像素存储
+    AVFrame *frame_ = nullptr;     // Borrowed 模式下引用的解码帧
+    int generation_ = 0;
+};
+
+// FrameBuffer 的侵入式引用，拷贝只做原子加减，不分配内存
+class FrameRef
+{
+public:
+    FrameRef() = default;
+    explicit FrameRef(FrameBuffer *buffer);
+    FrameRef(const FrameRef &other);
+    FrameRef(FrameRef &&other) noexcept;
+    FrameRef &operator=(FrameRef other) noexcept;
+    ~FrameRef();
+
+    void reset();
+
+    // 交出引用而不减计数，供 QImage 清理回调等只能携带裸指针的场合；之后须以 adopt() 接回
+    FrameBuffer *release();
+    static FrameRef adopt(FrameBuffer *buffer);
+
+    FrameBuffer *get() const { return buffer_; }
+    FrameBuffer *operator->() const { return buffer_; }
+    explicit operator bool() const { return buffer_ != nullptr; }
+
+private:
+    FrameBuffer *buffer_ = nullptr;
+};
+
+// 按视频宽高和像素格式预分配的帧缓冲池。稳态下 acquire/release 不触发堆分配，
+// stats().allocations 只在预热或尺寸变化时增长，可用来验证解码→渲染链路零分配。
+class FramePool : public std::enable_shared_from_this<FramePool>
+{
+public:
+    struct Stats {
+        quint64 allocations = 0;   // 实际分配的缓冲数
+        quint64 acquires = 0;      // 借出次数
+        quint64 recycles = 0;      // 归还次数
+        int outstanding = 0;       // 当前借出数量
+    };
+
+    enum class Storage {
+        Owned,      // 池自己分配像素内存，供 sws_scale 写入
+        Borrowed    // 只借用解码器输出的 AVFrame 引用，平面数据零拷贝
+    };
+
+    static std::shared_ptr<FramePool> create(int maxBuffers = 12);
+    ~FramePool();
+
+    FramePool(const FramePool &) = delete;
+    FramePool &operator=(const FramePool &) = delete;
+
+    // 尺寸或格式变化时丢弃旧缓冲，已借出的旧缓冲在归还时释放
+    void configure(int width, int height, AVPixelFormat format, Storage storage = Storage::Owned);
+
+    // 池耗尽时返回空引用，调用方自行等待
+    FrameRef acquire();
+
+    // Borrowed 模式：把 frame 的引用转移进池缓冲，frame 随后为空
+    FrameRef wrap(AVFrame *frame);
+
+    Stats stats() const;
+
+private:
+    friend class FrameRef;
+
+    explicit FramePool(int maxBuffers);
+
+    void recycle(FrameBuffer *buffer);
+    FrameBuffer *allocateBuffer();
+    void freeBuffer(FrameBuffer *buffer);
+
+    mutable QMutex mutex_;
+    std::vector<FrameBuffer *> free_;
+    std::vector<FrameBuffer *> all_;
+    int maxBuffers_ = 0;
+    int width_ = 0;
+    int height_ = 0;
+    AVPixelFormat format_ = AV_PIX_FMT_NONE;
+    Storage storage_ = Storage::Owned;
+    int generation_ = 0;
+
+    Stats stats_;
+};
+
+#endif // FRAMEPOOL_H
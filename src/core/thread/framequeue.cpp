@@ -0,0 +1,119 @@
+#include "framequeue.h"
+
+namespace {
+
+size_t roundUpPow2(size_t v)
+{
+    size_t n = 2;
+    while (n < v)
+        n <<= 1;
+    return n;
+}
+
+}
+
+FrameQueue::FrameQueue(size_t capacity)
+    : slots_(roundUpPow2(capacity))
+{
+    mask_ = slots_.size() - 1;
+}
+
+bool FrameQueue::push(VideoFrame &&frame)
+{
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t head = head_.load(std::memory_order_acquire);
+    if (tail - head >= slots_.size())
+        return false;
+
+    slots_[tail & mask_] = std::move(frame);
+    // seq_cst：与 advanceHead 构成 Dekker 式握手，生产者看到队列仍满时消费者必然看到这次 push
+    tail_.store(tail + 1, std::memory_order_seq_cst);
+    return true;
+}
+
+void FrameQueue::setSpaceAvailableCallback(std::function<void()> callback)
+{
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    spaceAvailable_ = std::move(callback);
+}
+
+void FrameQueue::advanceHead(size_t head)
+{
+    head_.store(head + 1, std::memory_order_seq_cst);
+    if (tail_.load(std::memory_order_seq_cst) - head < slots_.size())
+        return;
+
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    if (spaceAvailable_)
+        spaceAvailable_();
+}
+
+void FrameQueue::discardBefore(int serial)
+{
+    minSerial_.store(serial, std::memory_order_release);
+}
+
+VideoFrame *FrameQueue::peek()
+{
+    const int minSerial = minSerial_.load(std::memory_order_acquire);
+    size_t head = head_.load(std::memory_order_relaxed);
+    while (head != tail_.load(std::memory_order_acquire)) {
+        VideoFrame &front = slots_[head & mask_];
+        if (front.serial >= minSerial)
+            return &front;
+        // 跳转前的旧帧：消费者侧丢弃，生产者无需等待队列排空
+        front = VideoFrame();
+        advanceHead(head++);
+    }
+    return nullptr;
+}
+
+bool FrameQueue::pop(VideoFrame &out)
+{
+    VideoFrame *front = peek();
+    if (!front)
+        return false;
+
+    const size_t head = head_.load(std::memory_order_relaxed);
+    out = std::move(*front);
+    *front = VideoFrame();  // 及时把缓冲还给池
+    advanceHead(head);
+    return true;
+}
+
+bool FrameQueue::popDue(double now, DropPolicy policy, VideoFrame &out, int *dropped)
+{
+    int skipped = 0;
+    bool found = false;
+
+    while (VideoFrame *front = peek()) {
+        if (front->pts > now)
+            break;
+
+        // 已有候选帧，说明上一帧已过期
+        if (found)
+            ++skipped;
+
+        pop(out);
+        found = true;
+
+        if (policy == DropPolicy::KeepAll)
+            break;
+    }
+
+    if (dropped)
+        *dropped = skipped;
+    return found;
+}
+
+void FrameQueue::clear()
+{
+    VideoFrame dummy;
+    while (pop(dummy)) {
+    }
+}
+
+size_t FrameQueue::size() const
+{
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_seq_cst);
+}
@@ -0,0 +1,69 @@
+#ifndef FRAMEQUEUE_H
+#define FRAMEQUEUE_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+
+#include "framepool.h"
+
+// 一帧解码结果，像素数据来自 FramePool，pts 单位为秒；
+// serial 在每次跳转后递增，用于识别跳转前残留的旧帧
+struct VideoFrame {
+    FrameRef buffer;
+    double pts = 0.0;
+    int serial = 0;
+};
+
+// 渲染端处理过期帧的策略
+enum class DropPolicy {
+    KeepAll,    // 不丢帧，每次 vsync 顺序显示一帧（落后时逐帧追赶）
+    DropStale   // 只显示已到期帧中最新的一帧，其余直接丢弃
+};
+
+// 单生产者/单消费者无锁环形队列：解码线程 push，渲染（GUI）线程 peek/pop。
+// 容量向上取整为 2 的幂，队列满时 push 返回 false，由生产者自行决定等待；
+// 不便阻塞等待的生产者（DecoderPool）可注册回调，在消费者取走帧使队列由满变为不满时被唤醒。
+class FrameQueue
+{
+public:
+    explicit FrameQueue(size_t capacity = 8);
+
+    FrameQueue(const FrameQueue&) = delete;
+    FrameQueue& operator=(const FrameQueue&) = delete;
+
+    // 生产者
+    bool push(VideoFrame&& frame);
+    // 跳转时调用：serial 更小的帧由消费者在 peek/pop 时直接丢弃
+    void discardBefore(int serial);
+    // 回调在消费者线程上调用，不得再调用本队列的方法；传空函数注销，返回后旧回调不再被调用
+    void setSpaceAvailableCallback(std::function<void()> callback);
+
+    // 消费者
+    VideoFrame* peek();
+    bool pop(VideoFrame& out);
+    bool popDue(double now, DropPolicy policy, VideoFrame& out, int* dropped = nullptr);
+    void clear();
+
+    size_t size() const;
+    int minSerial() const { return minSerial_.load(std::memory_order_acquire); }
+    size_t capacity() const { return slots_.size(); }
+    bool isEmpty() const { return size() == 0; }
+
+private:
+    void advanceHead(size_t head);
+
+    std::vector<VideoFrame> slots_;
+    size_t mask_ = 0;
+
+    alignas(64) std::atomic<size_t> head_{0};   // 消费者写
+    alignas(64) std::atomic<size_t> tail_{0};   // 生产者写
+    std::atomic<int> minSerial_{0};
+
+    std::mutex callbackMutex_;                  // 只在队列由满变为不满及注册时加锁
+    std::function<void()> spaceAvailable_;
+};
+
+#endif // FRAMEQUEUE_H
@@ -0,0 +1,91 @@
+#include "keyframeindex.h"
+
+#include <algorithm>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+static_assert(KeyframeIndex::kNoTimestamp == AV_NOPTS_VALUE, "kNoTimestamp must match AV_NOPTS_VALUE");
+
+void KeyframeIndex::reset()
+{
+    entries_.clear();
+    hasLast_ = false;
+    complete_ = false;
+    ptsOffset_ = 0;
+}
+
+int KeyframeIndex::loadFromStream(AVStream *stream)
+{
+    reset();
+
+    const int count = avformat_index_get_entries_count(stream);
+    entries_.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const AVIndexEntry *entry = avformat_index_get_entry(stream, i);
+        if (!entry || !(entry->flags & AVINDEX_KEYFRAME))
+            continue;
+        entries_.push_back(Node{ Entry{ entry->timestamp, entry->pos }, !entries_.empty() });
+    }
+
+    // 容器索引按时间戳有序且覆盖全部关键帧
+    complete_ = !entries_.empty();
+    return size();
+}
+
+void KeyframeIndex::add(int64_t dts, int64_t pts, int64_t pos)
+{
+    const int64_t timestamp = dts != kNoTimestamp ? dts : pts;
+    if (timestamp == kNoTimestamp)
+        return;
+    const int64_t offset = dts != kNoTimestamp && pts != kNoTimestamp ? pts - dts : kNoTimestamp;
+    if (offset != kNoTimestamp)
+        ptsOffset_ = offset;
+
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), timestamp,
+                               [](const Node &node, int64_t ts) { return node.entry.timestamp < ts; });
+    const bool found = it != entries_.end() && it->entry.timestamp == timestamp;
+    if (complete_) {
+        // 完整索引只补记偏移
+        if (found && offset != kNoTimestamp)
+            it->ptsOffset = offset;
+        return;
+    }
+
+    if (!found)
+        it = entries_.insert(it, Node{ Entry{ timestamp, pos }, false, offset });
+    else if (offset != kNoTimestamp)
+        it->ptsOffset = offset;
+
+    // 连续解复用时前一个关键帧紧邻在前，说明这一段区间已完整
+    if (hasLast_ && it != entries_.begin() && std::prev(it)->entry.timestamp == last_)
+        it->linked = true;
+
+    last_ = timestamp;
+    hasLast_ = true;
+}
+
+bool KeyframeIndex::floor(int64_t pts, Entry *out) const
+{
+    // 关键帧之间不重排，按 dts 排列时 pts 同样递增
+    auto it = std::upper_bound(entries_.begin(), entries_.end(), pts,
+                               [this](int64_t ts, const Node &node) { return ts < ptsOf(node); });
+    if (it == entries_.begin())
+        return false;
+
+    const Node &candidate = *std::prev(it);
+    // 逐步建立的索引：只有确认下一个关键帧紧随其后，才能保证中间没有更近的关键帧
+    const bool exact = ptsOf(candidate) == pts;
+    if (!complete_ && !exact && (it == entries_.end() || !it->linked))
+        return false;
+
+    if (out)
+        *out = candidate.entry;
+    return true;
+}
+
+int64_t KeyframeIndex::ptsOf(const Node &node) const
+{
+    return node.entry.timestamp + (node.ptsOffset != kNoTimestamp ? node.ptsOffset : ptsOffset_);
+}
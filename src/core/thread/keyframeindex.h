@@ -0,0 +1,56 @@
+#ifndef KEYFRAMEINDEX_H
+#define KEYFRAMEINDEX_H
+
+#include <cstdint>
+#include <vector>
+
+struct AVStream;
+
+// 视频流关键帧索引，条目时间戳为 dts（与容器索引一致），单位为流的 time_base。
+// 容器自带索引（mp4 stss、mkv cues 等）时打开即完整；否则在解复用过程中
+// 按遇到的关键帧逐步建立，只有确认中间没有遗漏关键帧的区间才用于定位。
+// 跳转目标在 pts 时间轴上：解复用时记下每个关键帧的 pts - dts，查找时按 pts 比较；
+// 尚未解复用到的容器条目使用最近一次观察到的偏移。
+// 仅由解复用线程访问，不加锁。
+class KeyframeIndex
+{
+public:
+    static constexpr int64_t kNoTimestamp = INT64_MIN;   // 与 AV_NOPTS_VALUE 相同
+
+    struct Entry {
+        int64_t timestamp = 0;   // dts，直接用于 avformat_seek_file
+        int64_t pos = -1;        // 包在文件中的字节偏移，未知为 -1
+    };
+
+    void reset();
+
+    // 导入容器索引中的关键帧，返回导入条数
+    int loadFromStream(AVStream *stream);
+
+    // 解复用时登记关键帧，dts / pts 未知时传 kNoTimestamp；跳转后先调用 markDiscontinuity()
+    void add(int64_t dts, int64_t pts, int64_t pos);
+    void markDiscontinuity() { hasLast_ = false; }
+
+    // 显示时间不晚于 pts 的最近关键帧；无法确认时返回 false，由调用方退回容器自身的定位
+    bool floor(int64_t pts, Entry *out) const;
+
+    int size() const { return static_cast<int>(entries_.size()); }
+    bool isComplete() const { return complete_; }
+
+private:
+    struct Node {
+        Entry entry;
+        bool linked = false;     // 与前一条之间没有遗漏的关键帧
+        int64_t ptsOffset = kNoTimestamp;   // pts - dts，尚未解复用到时未知
+    };
+
+    int64_t ptsOf(const Node &node) const;
+
+    std::vector<Node> entries_;
+    int64_t last_ = 0;           // 本段连续解复用中上一个登记的关键帧
+    bool hasLast_ = false;
+    bool complete_ = false;
+    int64_t ptsOffset_ = 0;      // 最近观察到的关键帧 pts - dts，用于偏移未知的条目
+};
+
+#endif // KEYFRAMEINDEX_H
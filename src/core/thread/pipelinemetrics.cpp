@@ -0,0 +1,124 @@
+#include "pipelinemetrics.h"
+
+#include <QDateTime>
+#include <QStringList>
+#include <QtAlgorithms>
+#include <algorithm>
+
+void PipelineMetrics::record(Stage stage, qint64 ns)
+{
+    if (ns < 0)
+        ns = 0;
+    Histogram &h = histograms_[static_cast<int>(stage)];
+    h.buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    h.count.fetch_add(1, std::memory_order_relaxed);
+    h.totalNs.fetch_add(static_cast<quint64>(ns), std::memory_order_relaxed);
+
+    // 每个阶段只有一个写线程，这里的 CAS 几乎不会重试
+    qint64 current = h.maxNs.load(std::memory_order_relaxed);
+    while (ns > current && !h.maxNs.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void PipelineMetrics::addFrameDropped(bool late)
+{
+    framesDropped_.fetch_add(1, std::memory_order_relaxed);
+    if (late)
+        framesLate_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PipelineMetrics::reset()
+{
+    for (Histogram &h : histograms_) {
+        for (auto &bucket : h.buckets)
+            bucket.store(0, std::memory_order_relaxed);
+        h.count.store(0, std::memory_order_relaxed);
+        h.totalNs.store(0, std::memory_order_relaxed);
+        h.maxNs.store(0, std::memory_order_relaxed);
+    }
+    packetsRead_.store(0, std::memory_order_relaxed);
+    framesDecoded_.store(0, std::memory_order_relaxed);
+    framesOutput_.store(0, std::memory_order_relaxed);
+    framesDropped_.store(0, std::memory_order_relaxed);
+    framesLate_.store(0, std::memory_order_relaxed);
+}
+
+PipelineMetrics::Snapshot PipelineMetrics::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.timestampMs = QDateTime::currentMSecsSinceEpoch();
+
+    for (int s = 0; s < static_cast<int>(Stage::Count); ++s) {
+        const Histogram &h = histograms_[s];
+        StageStats &out = snapshot.stages[s];
+
+        // 以桶计数之和为准，避免与 count 读取时刻不同导致分位数越界
+        quint64 total = 0;
+        for (int i = 0; i < kBuckets; ++i) {
+            out.buckets[i] = h.buckets[i].load(std::memory_order_relaxed);
+            total += out.buckets[i];
+        }
+        out.count = total;
+        if (total == 0)
+            continue;
+
+        const quint64 count = std::max<quint64>(1, h.count.load(std::memory_order_relaxed));
+        out.meanUs = h.totalNs.load(std::memory_order_relaxed) / 1000.0 / count;
+        out.maxUs = h.maxNs.load(std::memory_order_relaxed) / 1000.0;
+
+        const auto percentile = [&](double p) {
+            const quint64 rank = static_cast<quint64>(p * (total - 1)) + 1;
+            quint64 seen = 0;
+            for (int i = 0; i < kBuckets; ++i) {
+                seen += out.buckets[i];
+                if (seen >= rank)
+                    return std::min(bucketUpperUs(i), out.maxUs);
+            }
+            return out.maxUs;
+        };
+        out.p50Us = percentile(0.50);
+        out.p95Us = percentile(0.95);
+        out.p99Us = percentile(0.99);
+    }
+
+    snapshot.packetsRead = packetsRead_.load(std::memory_order_relaxed);
+    snapshot.framesDecoded = framesDecoded_.load(std::memory_order_relaxed);
+    snapshot.framesOutput = framesOutput_.load(std::memory_order_relaxed);
+    snapshot.framesDropped = framesDropped_.load(std::memory_order_relaxed);
+    snapshot.framesLate = framesLate_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+int PipelineMetrics::bucketOf(qint64 ns)
+{
+    const quint64 us = static_cast<quint64>(ns) / 1000;
+    if (us == 0)
+        return 0;
+    return std::min(kBuckets - 1, 63 - static_cast<int>(qCountLeadingZeroBits(us)));
+}
+
+double PipelineMetrics::bucketUpperUs(int bucket)
+{
+    return static_cast<double>(quint64(1) << (bucket + 1));
+}
+
+QString PipelineMetrics::Snapshot::toString() const
+{
+    static const char *const kNames[] = { "read", "decode", "convert", "handoff" };
+
+    QStringList parts;
+    for (int s = 0; s < static_cast<int>(Stage::Count); ++s) {
+        const StageStats &st = stages[s];
+        parts << QString("%1 n=%2 avg=%3us p95=%4us max=%5us")
+                     .arg(kNames[s])
+                     .arg(st.count)
+                     .arg(st.meanUs, 0, 'f', 1)
+                     .arg(st.p95Us, 0, 'f', 0)
+                     .arg(st.maxUs, 0, 'f', 0);
+    }
+    parts << QString("packets=%1 decoded=%2 output=%3 dropped=%4 late=%5")
+                 .arg(packetsRead).arg(framesDecoded).arg(framesOutput)
+                 .arg(framesDropped).arg(framesLate);
+    parts << QString("queues=%1/%2/%3").arg(packetQueueDepth).arg(decodedQueueDepth).arg(outputQueueDepth);
+    return parts.join(" | ");
+}
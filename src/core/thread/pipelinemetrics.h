@@ -0,0 +1,88 @@
+#ifndef PIPELINEMETRICS_H
+#define PIPELINEMETRICS_H
+
+#include <QMetaType>
+#include <QString>
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+
+// 解码流水线运行指标。各阶段线程只做 relaxed 原子累加，不加锁；
+// 任意线程可随时调用 snapshot() 读取，读到的各项之间不保证严格一致。
+class PipelineMetrics
+{
+public:
+    enum class Stage {
+        Read,      // av_read_frame
+        Decode,    // avcodec_send_packet / receive_frame，按输出帧摊分
+        Convert,   // sws_scale 或零拷贝包装
+        Handoff,   // 写入 FrameQueue / 发出 frameDecoded
+        Count
+    };
+
+    // 按 2 的幂分桶的耗时直方图：第 i 桶覆盖 [2^i, 2^(i+1)) 微秒，第 0 桶含 1 微秒以下
+    static constexpr int kBuckets = 24;   // 最后一桶约 8 秒以上
+
+    struct StageStats {
+        quint64 count = 0;
+        double meanUs = 0.0;
+        double p50Us = 0.0;    // 分位数取所在桶的上界
+        double p95Us = 0.0;
+        double p99Us = 0.0;
+        double maxUs = 0.0;
+        std::array<quint64, kBuckets> buckets{};
+    };
+
+    struct Snapshot {
+        qint64 timestampMs = 0;    // QDateTime::currentMSecsSinceEpoch()
+        std::array<StageStats, static_cast<int>(Stage::Count)> stages;
+        quint64 packetsRead = 0;
+        quint64 framesDecoded = 0;
+        quint64 framesOutput = 0;
+        quint64 framesDropped = 0;  // 所有未送达输出端的帧，含 framesLate
+        quint64 framesLate = 0;     // 晚于主时钟被丢弃的帧
+        int packetQueueDepth = 0;
+        int decodedQueueDepth = 0;
+        int outputQueueDepth = 0;
+
+        const StageStats &stage(Stage s) const { return stages[static_cast<int>(s)]; }
+        QString toString() const;
+    };
+
+    PipelineMetrics() = default;
+    PipelineMetrics(const PipelineMetrics &) = delete;
+    PipelineMetrics &operator=(const PipelineMetrics &) = delete;
+
+    void record(Stage stage, qint64 ns);
+    void addPacketRead() { packetsRead_.fetch_add(1, std::memory_order_relaxed); }
+    void addFrameDecoded() { framesDecoded_.fetch_add(1, std::memory_order_relaxed); }
+    void addFrameOutput() { framesOutput_.fetch_add(1, std::memory_order_relaxed); }
+    void addFrameDropped(bool late);
+
+    void reset();
+    // 队列深度由调用方采样后填入
+    Snapshot snapshot() const;
+
+private:
+    struct Histogram {
+        std::array<std::atomic<quint64>, kBuckets> buckets{};
+        std::atomic<quint64> count{0};
+        std::atomic<quint64> totalNs{0};
+        std::atomic<qint64> maxNs{0};
+    };
+
+    static int bucketOf(qint64 ns);
+    static double bucketUpperUs(int bucket);
+
+    // 各阶段由不同线程写入，分开缓存行避免伪共享
+    alignas(64) std::array<Histogram, static_cast<int>(Stage::Count)> histograms_;
+    alignas(64) std::atomic<quint64> packetsRead_{0};
+    alignas(64) std::atomic<quint64> framesDecoded_{0};
+    alignas(64) std::atomic<quint64> framesOutput_{0};
+    std::atomic<quint64> framesDropped_{0};
+    std::atomic<quint64> framesLate_{0};
+};
+
+Q_DECLARE_METATYPE(PipelineMetrics::Snapshot)
+
+#endif // PIPELINEMETRICS_H
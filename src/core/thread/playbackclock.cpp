@@ -0,0 +1,63 @@
+#include "playbackclock.h"
+
+PlaybackClock::PlaybackClock()
+{
+    timer_.start();
+}
+
+void PlaybackClock::anchor(double pts)
+{
+    QMutexLocker locker(&mutex_);
+    if (source_ == Source::Audio)
+        return;
+    anchorPts_ = pts;
+    anchorNs_ = timer_.nsecsElapsed();
+    anchored_ = true;
+}
+
+void PlaybackClock::reset()
+{
+    QMutexLocker locker(&mutex_);
+    anchored_ = false;
+    source_ = Source::Wall;
+}
+
+void PlaybackClock::setAudioTime(double pts)
+{
+    QMutexLocker locker(&mutex_);
+    anchorPts_ = pts;
+    anchorNs_ = timer_.nsecsElapsed();
+    anchored_ = true;
+    source_ = Source::Audio;
+}
+
+void PlaybackClock::clearAudio()
+{
+    QMutexLocker locker(&mutex_);
+    if (source_ != Source::Audio)
+        return;
+    // 从当前位置继续以墙钟推进，避免画面跳变
+    anchorPts_ += (timer_.nsecsElapsed() - anchorNs_) / 1e9;
+    anchorNs_ = timer_.nsecsElapsed();
+    source_ = Source::Wall;
+}
+
+bool PlaybackClock::isAnchored() const
+{
+    QMutexLocker locker(&mutex_);
+    return anchored_;
+}
+
+PlaybackClock::Source PlaybackClock::source() const
+{
+    QMutexLocker locker(&mutex_);
+    return source_;
+}
+
+double PlaybackClock::now() const
+{
+    QMutexLocker locker(&mutex_);
+    if (!anchored_)
+        return -1.0;
+    return anchorPts_ + (timer_.nsecsElapsed() - anchorNs_) / 1e9;
+}
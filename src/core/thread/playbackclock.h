@@ -0,0 +1,38 @@
+#ifndef PLAYBACKCLOCK_H
+#define PLAYBACKCLOCK_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+
+// 播放主时钟，返回当前应显示的媒体时间（秒）。
+// 有音频输出时由音频设备实际播放位置驱动（音频为主时钟），
+// 否则以某一帧的 pts 为锚点按单调时钟推进。可跨线程读写。
+class PlaybackClock
+{
+public:
+    enum class Source { Wall, Audio };
+
+    PlaybackClock();
+
+    // 墙钟模式下重新锚定；音频驱动时忽略
+    void anchor(double pts);
+    void reset();
+
+    // 音频输出线程调用：pts 为此刻正在播放的采样时间
+    void setAudioTime(double pts);
+    void clearAudio();
+
+    bool isAnchored() const;
+    Source source() const;
+    double now() const;
+
+private:
+    mutable QMutex mutex_;
+    QElapsedTimer timer_;           // 自构造起单调计时
+    qint64 anchorNs_ = 0;
+    double anchorPts_ = 0.0;
+    bool anchored_ = false;
+    Source source_ = Source::Wall;
+};
+
+#endif // PLAYBACKCLOCK_H
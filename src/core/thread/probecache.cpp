@@ -0,0 +1,83 @@
+#include "probecache.h"
+
+ProbeCache::Entry::~Entry()
+{
+    for (AVCodecParameters *&par : streams)
+        avcodec_parameters_free(&par);
+}
+
+ProbeCache *ProbeCache::instance()
+{
+    static ProbeCache cache;
+    return &cache;
+}
+
+std::shared_ptr<const ProbeCache::Entry> ProbeCache::find(const QString &url) const
+{
+    QMutexLocker locker(&mutex_);
+    const auto it = entries_.constFind(url);
+    if (it == entries_.constEnd())
+        return nullptr;
+
+    order_.removeOne(url);
+    order_.append(url);
+    return *it;
+}
+
+void ProbeCache::store(const QString &url, const AVFormatContext *ctx)
+{
+    auto entry = std::make_shared<Entry>();
+    entry->formatName = QString::fromLatin1(ctx->iformat->name);
+    entry->streams.reserve(ctx->nb_streams);
+    for (unsigned int i = 0; i < ctx->nb_streams; ++i) {
+        AVCodecParameters *par = avcodec_parameters_alloc();
+        if (!par || avcodec_parameters_copy(par, ctx->streams[i]->codecpar) < 0) {
+            avcodec_parameters_free(&par);
+            return;
+        }
+        entry->streams.push_back(par);
+    }
+
+    QMutexLocker locker(&mutex_);
+    order_.removeOne(url);
+    order_.append(url);
+    entries_.insert(url, std::move(entry));
+    while (order_.size() > kMaxEntries)
+        entries_.remove(order_.takeFirst());
+}
+
+void ProbeCache::remove(const QString &url)
+{
+    QMutexLocker locker(&mutex_);
+    entries_.remove(url);
+    order_.removeOne(url);
+}
+
+void ProbeCache::clear()
+{
+    QMutexLocker locker(&mutex_);
+    entries_.clear();
+    order_.clear();
+}
+
+bool ProbeCache::apply(const Entry &entry, AVFormatContext *ctx)
+{
+    // 无文件头的格式（如 FLV）打开时还没有流，只能走正常探测
+    if (ctx->nb_streams == 0 || ctx->nb_streams != entry.streams.size())
+        return false;
+
+    for (unsigned int i = 0; i < ctx->nb_streams; ++i) {
+        const AVCodecParameters *cached = entry.streams[i];
+        const AVCodecParameters *current = ctx->streams[i]->codecpar;
+        if (cached->codec_type != current->codec_type)
+            return false;
+        if (current->codec_id != AV_CODEC_ID_NONE && current->codec_id != cached->codec_id)
+            return false;
+    }
+
+    for (unsigned int i = 0; i < ctx->nb_streams; ++i) {
+        if (avcodec_parameters_copy(ctx->streams[i]->codecpar, entry.streams[i]) < 0)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef PROBECACHE_H
+#define PROBECACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <vector>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+// 按 URL 缓存 avformat_find_stream_info 的结果（封装格式与各流的编码参数）。
+// 再次打开已知源时跳过格式探测和流信息分析，直接用缓存参数打开解码器。
+// 仅保存在内存中，进程内共享，按最近使用淘汰。
+class ProbeCache
+{
+public:
+    struct Entry {
+        QString formatName;
+        std::vector<AVCodecParameters *> streams;   // 下标即流序号
+
+        Entry() = default;
+        Entry(const Entry &) = delete;
+        Entry &operator=(const Entry &) = delete;
+        ~Entry();
+    };
+
+    static ProbeCache *instance();
+
+    std::shared_ptr<const Entry> find(const QString &url) const;
+    // 探测成功后调用
+    void store(const QString &url, const AVFormatContext *ctx);
+    // 用缓存参数打开失败时调用，下次重新探测
+    void remove(const QString &url);
+    void clear();
+
+    // 流数量与类型一致时把缓存参数写入各流并返回 true；不一致说明源已变化
+    static bool apply(const Entry &entry, AVFormatContext *ctx);
+
+private:
+    ProbeCache() = default;
+
+    static constexpr int kMaxEntries = 64;
+
+    mutable QMutex mutex_;
+    QHash<QString, std::shared_ptr<const Entry>> entries_;
+    mutable QStringList order_;   // 最近使用的在末尾
+};
+
+#endif // PROBECACHE_H
@@ -0,0 +1,61 @@
+#include "scaletarget.h"
+
+#include <algorithm>
+#include <cmath>
+
+ScaleTarget::ScaleTarget(std::chrono::milliseconds debounce)
+    : debounce_(debounce)
+{
+}
+
+void ScaleTarget::set(const QSize &size)
+{
+    const quint64 value = size.width() > 0 && size.height() > 0 ? pack(size) : 0;
+    if (requested_.exchange(value, std::memory_order_acq_rel) != value)
+        changedAtNs_.store(nowNs(), std::memory_order_release);
+}
+
+QSize ScaleTarget::requested() const
+{
+    return unpack(requested_.load(std::memory_order_acquire));
+}
+
+QSize ScaleTarget::outputSize(int srcWidth, int srcHeight)
+{
+    const quint64 requested = requested_.load(std::memory_order_acquire);
+    if (requested != applied_) {
+        const qint64 elapsed = nowNs() - changedAtNs_.load(std::memory_order_acquire);
+        if (elapsed >= std::chrono::duration_cast<std::chrono::nanoseconds>(debounce_).count())
+            applied_ = requested;
+    }
+
+    const QSize source(srcWidth, srcHeight);
+    if (applied_ == 0 || srcWidth <= 0 || srcHeight <= 0)
+        return source;
+
+    const QSize target = unpack(applied_);
+    const double scale = std::min({ 1.0, double(target.width()) / srcWidth, double(target.height()) / srcHeight });
+    if (scale >= kMinScaleDown)
+        return source;
+
+    // 4:2:0 色度平面要求偶数尺寸
+    const int width = std::max(2, static_cast<int>(std::lround(srcWidth * scale / 2.0)) * 2);
+    const int height = std::max(2, static_cast<int>(std::lround(srcHeight * scale / 2.0)) * 2);
+    return QSize(width, height);
+}
+
+quint64 ScaleTarget::pack(const QSize &size)
+{
+    return (quint64(quint32(size.width())) << 32) | quint32(size.height());
+}
+
+QSize ScaleTarget::unpack(quint64 value)
+{
+    return QSize(static_cast<int>(value >> 32), static_cast<int>(value & 0xffffffffu));
+}
+
+qint64 ScaleTarget::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,37 @@
+#ifndef SCALETARGET_H
+#define SCALETARGET_H
+
+#include <QSize>
+#include <atomic>
+#include <chrono>
+
+// 渲染端显示区域的像素尺寸，决定解码输出缩放到多大。
+// 任意线程 set()，转换线程每帧调用 outputSize()；新尺寸保持 debounce 时长不变后才生效，
+// 拖动窗口时不会反复重建缩放上下文和帧池。
+class ScaleTarget
+{
+public:
+    explicit ScaleTarget(std::chrono::milliseconds debounce = std::chrono::milliseconds(150));
+
+    // 宽高 <= 0 表示不限制，按源分辨率输出
+    void set(const QSize &size);
+    QSize requested() const;
+
+    // 源尺寸按目标等比缩小后的输出尺寸（不放大，宽高取偶数）；
+    // 缩小不足 kMinScaleDown 时仍按源尺寸输出，小幅缩放省下的上传量抵不过额外的转换
+    QSize outputSize(int srcWidth, int srcHeight);
+
+private:
+    static constexpr double kMinScaleDown = 0.9;
+
+    static quint64 pack(const QSize &size);
+    static QSize unpack(quint64 value);
+    static qint64 nowNs();
+
+    std::chrono::milliseconds debounce_;
+    std::atomic<quint64> requested_{0};
+    std::atomic<qint64> changedAtNs_{0};
+    quint64 applied_ = 0;   // 只由转换线程读写
+};
+
+#endif // SCALETARGET_H
@@ -0,0 +1,315 @@
+#include "streamdecoder.h"
+#include "swsrange.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+namespace {
+// 每路只需缓冲一小段，隐藏时只剩关键帧，实际占用更少
+constexpr int kPacketQueueCapacity = 64;
+
+bool isPassthroughFormat(AVPixelFormat format)
+{
+    return format == AV_PIX_FMT_YUV420P
+           || format == AV_PIX_FMT_YUVJ420P
+           || format == AV_PIX_FMT_NV12;
+}
+}
+
+StreamDecoder::StreamDecoder(const QString &url, FrameQueue *queue, const DecoderOptions &options,
+                             Callbacks callbacks)
+    : m_url(url)
+    , m_frameQueue(queue)
+    , m_options(options)
+    , m_callbacks(std::move(callbacks))
+    , m_framePool(FramePool::create())
+    , m_packetQueue(kPacketQueueCapacity)
+    , m_packetShells(kPacketQueueCapacity + 2)
+{
+}
+
+StreamDecoder::~StreamDecoder()
+{
+    stop();
+    if (m_demuxThread) {
+        m_demuxThread->wait();
+        delete m_demuxThread;
+    }
+    m_packetQueue.flush();
+    cleanup();
+}
+
+void StreamDecoder::start()
+{
+    m_demuxThread = QThread::create([this]() { demuxLoop(); });
+    m_demuxThread->start();
+}
+
+void StreamDecoder::stop()
+{
+    m_stopped = true;
+    m_packetQueue.abort();
+}
+
+void StreamDecoder::setPriority(Priority priority)
+{
+    const Priority previous = m_priority.exchange(priority, std::memory_order_acq_rel);
+    // 隐藏期间只解码了关键帧，后续 P/B 帧的参考已缺失，等下一个关键帧再恢复
+    if (previous == Priority::Hidden && priority != Priority::Hidden)
+        m_waitKeyframe = true;
+}
+
+bool StreamDecoder::isReady() const
+{
+    if (m_stopped || m_state.load(std::memory_order_acquire) != State::Running)
+        return false;
+    if (m_packetQueue.size() == 0 && !m_codecPending.load(std::memory_order_acquire))
+        return false;
+    // 可见的流在输出队列满时等渲染端消费；隐藏的流不等，直接丢帧
+    return priority() == Priority::Hidden || m_frameQueue->size() < m_frameQueue->capacity();
+}
+
+StreamDecoder::Stats StreamDecoder::stats() const
+{
+    Stats stats;
+    stats.packets = m_packets.load(std::memory_order_relaxed);
+    stats.skippedPackets = m_skippedPackets.load(std::memory_order_relaxed);
+    stats.frames = m_frames.load(std::memory_order_relaxed);
+    stats.droppedFrames = m_droppedFrames.load(std::memory_order_relaxed);
+    stats.decodeNs = m_decodeNs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+int StreamDecoder::interruptCallback(void *opaque)
+{
+    return static_cast<StreamDecoder *>(opaque)->m_stopped ? 1 : 0;
+}
+
+// --- 解复用（本路独占线程） ---
+void StreamDecoder::demuxLoop()
+{
+    QString error;
+    if (!openInput(&error)) {
+        m_state = State::Failed;
+        if (!m_stopped && m_callbacks.failed)
+            m_callbacks.failed(error);
+        return;
+    }
+    m_state.store(State::Running, std::memory_order_release);
+
+    AVPacket *packet = av_packet_alloc();
+    while (!m_stopped) {
+        if (av_read_frame(m_formatCtx, packet) < 0) {
+            // 结束标记交给工作线程排空解码器
+            if (!m_stopped && m_packetQueue.push(nullptr) && m_callbacks.packetsAvailable)
+                m_callbacks.packetsAvailable();
+            break;
+        }
+
+        if (packet->stream_index != m_videoStreamIndex) {
+            av_packet_unref(packet);
+            continue;
+        }
+
+        // 隐藏时只保留关键帧，非关键帧在解复用阶段就丢掉，不占解码时间
+        const bool keyframe = packet->flags & AV_PKT_FLAG_KEY;
+        if (!keyframe && (priority() == Priority::Hidden || m_waitKeyframe)) {
+            m_skippedPackets.fetch_add(1, std::memory_order_relaxed);
+            av_packet_unref(packet);
+            continue;
+        }
+        if (keyframe)
+            m_waitKeyframe = false;
+
+        AVPacket *shell = m_packetShells.take();
+        av_packet_move_ref(shell, packet);
+        const bool wasEmpty = m_packetQueue.size() == 0;
+        if (!m_packetQueue.push(shell))
+            break;
+        if (wasEmpty && m_callbacks.packetsAvailable)
+            m_callbacks.packetsAvailable();
+    }
+    av_packet_free(&packet);
+}
+
+bool StreamDecoder::openInput(QString *error)
+{
+    m_formatCtx = avformat_alloc_context();
+    m_formatCtx->interrupt_callback.callback = &StreamDecoder::interruptCallback;
+    m_formatCtx->interrupt_callback.opaque = this;
+
+    if (avformat_open_input(&m_formatCtx, m_url.toStdString().c_str(), nullptr, nullptr) != 0) {
+        *error = "Failed to open input: " + m_url;
+        return false;
+    }
+
+    if (avformat_find_stream_info(m_formatCtx, nullptr) < 0) {
+        *error = "Failed to find stream info";
+        return false;
+    }
+
+    m_videoStreamIndex = av_find_best_stream(m_formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (m_videoStreamIndex < 0) {
+        *error = "No video stream found";
+        return false;
+    }
+
+    AVCodecParameters *codecPar = m_formatCtx->streams[m_videoStreamIndex]->codecpar;
+    const AVCodec *codec = avcodec_find_decoder(codecPar->codec_id);
+    if (!codec) {
+        *error = "Unsupported codec";
+        return false;
+    }
+
+    m_codecCtx = avcodec_alloc_context3(codec);
+    if (avcodec_parameters_to_context(m_codecCtx, codecPar) < 0) {
+        *error = "Failed to copy codec parameters";
+        return false;
+    }
+
+    m_options.resolved(codecPar->codec_id, codecPar->width, codecPar->height).applyTo(m_codecCtx);
+    m_appliedPriority = priority();
+    if (m_appliedPriority == Priority::Hidden)
+        m_codecCtx->skip_frame = AVDISCARD_NONKEY;
+
+    if (avcodec_open2(m_codecCtx, codec, nullptr) < 0) {
+        *error = "Failed to open codec";
+        return false;
+    }
+
+    m_frame = av_frame_alloc();
+    return true;
+}
+
+// --- 解码与转换（共享工作线程，同一时刻只有一个线程进入） ---
+void StreamDecoder::step()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const Priority current = priority();
+    if (current != m_appliedPriority) {
+        m_codecCtx->skip_frame = current == Priority::Hidden ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT;
+        m_appliedPriority = current;
+    }
+
+    // 上次因输出队列满而留在解码器里的帧先取完，取不完就不再送新包
+    if (m_codecPending.load(std::memory_order_acquire)) {
+        drainCodec();
+        m_decodeNs.fetch_add(timer.nsecsElapsed(), std::memory_order_relaxed);
+        return;
+    }
+
+    AVPacket *packet = nullptr;
+    if (!m_packetQueue.tryPop(packet))
+        return;
+
+    const bool endOfStream = (packet == nullptr);
+    // 切换到隐藏前已入队的非关键帧包
+    if (!endOfStream && current == Priority::Hidden && !(packet->flags & AV_PKT_FLAG_KEY)) {
+        m_skippedPackets.fetch_add(1, std::memory_order_relaxed);
+        m_packetShells.recycle(packet);
+        return;
+    }
+
+    const int ret = avcodec_send_packet(m_codecCtx, packet);
+    m_packetShells.recycle(packet);
+    if (!endOfStream)
+        m_packets.fetch_add(1, std::memory_order_relaxed);
+
+    if (ret >= 0 || endOfStream) {
+        m_codecPending.store(true, std::memory_order_release);
+        drainCodec();
+    }
+
+    m_decodeNs.fetch_add(timer.nsecsElapsed(), std::memory_order_relaxed);
+}
+
+void StreamDecoder::drainCodec()
+{
+    for (;;) {
+        // 可见的流不丢帧：队列满时帧留在解码器里，渲染端取走帧后由下一次 step() 继续
+        if (priority() != Priority::Hidden && m_frameQueue->size() >= m_frameQueue->capacity())
+            return;
+
+        const int ret = avcodec_receive_frame(m_codecCtx, m_frame);
+        if (ret == 0) {
+            outputFrame(m_frame);
+            av_frame_unref(m_frame);
+            continue;
+        }
+
+        m_codecPending.store(false, std::memory_order_release);
+        // 结束标记送入后解码器已全部吐出，此时最后一帧已入队
+        if (ret == AVERROR_EOF) {
+            m_state = State::Ended;
+            if (m_callbacks.ended)
+                m_callbacks.ended();
+        }
+        return;
+    }
+}
+
+void StreamDecoder::outputFrame(AVFrame *frame)
+{
+    // 隐藏的流不等渲染端：放不下就丢（可见的流在 drainCodec 中已确认有空位）
+    if (m_frameQueue->size() >= m_frameQueue->capacity()) {
+        m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    double pts = 0.0;
+    if (frame->best_effort_timestamp != AV_NOPTS_VALUE)
+        pts = frame->best_effort_timestamp * av_q2d(m_formatCtx->streams[m_videoStreamIndex]->time_base);
+
+    const AVPixelFormat srcFormat = static_cast<AVPixelFormat>(frame->format);
+    // 多画面墙的小窗口按显示尺寸输出，转换与上传量随面积下降
+    const QSize outSize = m_scaleTarget.outputSize(frame->width, frame->height);
+    const bool downscale = outSize.width() != frame->width || outSize.height() != frame->height;
+
+    FrameRef buffer;
+    if (isPassthroughFormat(srcFormat) && !downscale) {
+        m_framePool->configure(frame->width, frame->height, srcFormat, FramePool::Storage::Borrowed);
+        buffer = m_framePool->wrap(frame);
+    } else {
+        m_swsCtx = sws_getCachedContext(m_swsCtx,
+                                        frame->width, frame->height, srcFormat,
+                                        outSize.width(), outSize.height(), AV_PIX_FMT_YUV420P,
+                                        downscale ? SWS_AREA : SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (m_swsCtx) {
+            m_framePool->configure(outSize.width(), outSize.height(), AV_PIX_FMT_YUV420P);
+            buffer = m_framePool->acquire();
+        }
+        if (buffer) {
+            buffer->colorRange = configureSwsRange(m_swsCtx, frame);
+            sws_scale(m_swsCtx, frame->data, frame->linesize, 0, frame->height,
+                      buffer->data, buffer->linesize);
+            buffer->colorSpace = frame->colorspace;
+            if (downscale && frame->colorspace == AVCOL_SPC_UNSPECIFIED)
+                buffer->colorSpace = frame->height >= 720 ? AVCOL_SPC_BT709 : AVCOL_SPC_SMPTE170M;
+        }
+    }
+
+    if (!buffer || !m_frameQueue->push(VideoFrame{ std::move(buffer), pts })) {
+        m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    m_frames.fetch_add(1, std::memory_order_relaxed);
+    if (m_frameQueue->size() == 1 && m_callbacks.frameQueued)
+        m_callbacks.frameQueued();
+}
+
+void StreamDecoder::cleanup()
+{
+    if (m_frame)
+        av_frame_free(&m_frame);
+    if (m_codecCtx)
+        avcodec_free_context(&m_codecCtx);
+    if (m_formatCtx)
+        avformat_close_input(&m_formatCtx);
+    if (m_swsCtx) {
+        sws_freeContext(m_swsCtx);
+        m_swsCtx = nullptr;
+    }
+}
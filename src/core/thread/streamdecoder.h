@@ -0,0 +1,115 @@
+#ifndef STREAMDECODER_H
+#define STREAMDECODER_H
+
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "framequeue.h"
+#include "blockingqueue.h"
+#include "decoderoptions.h"
+#include "scaletarget.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+// DecoderPool 中的一路流。解复用在自己的线程里做（主要阻塞在网络 I/O 上），
+// 解码与格式转换由 DecoderPool 的共享工作线程调用 step() 分片执行，
+// 每次处理一个数据包，不在工作线程上阻塞。输出只写 FrameQueue（YUV）。
+class StreamDecoder
+{
+public:
+    enum class Priority {
+        Hidden,     // 不可见：只解复用并解码关键帧
+        Visible,    // 可见：正常解码
+        Focused     // 焦点：调度权重最高
+    };
+
+    enum class State { Opening, Running, Ended, Failed };
+
+    struct Stats {
+        quint64 packets = 0;           // 送入解码器的包
+        quint64 skippedPackets = 0;    // 隐藏期间丢弃的非关键帧包
+        quint64 frames = 0;            // 写入 FrameQueue 的帧
+        quint64 droppedFrames = 0;     // 输出队列满或缓冲耗尽时丢弃的帧
+        qint64 decodeNs = 0;           // step() 累计耗时
+    };
+
+    // 回调可能来自解复用线程或工作线程
+    struct Callbacks {
+        std::function<void()> packetsAvailable;   // 包队列由空变为非空
+        std::function<void()> frameQueued;        // FrameQueue 由空变为非空
+        std::function<void()> ended;
+        std::function<void(const QString &)> failed;
+    };
+
+    StreamDecoder(const QString &url, FrameQueue *queue, const DecoderOptions &options,
+                  Callbacks callbacks);
+    ~StreamDecoder();
+
+    StreamDecoder(const StreamDecoder &) = delete;
+    StreamDecoder &operator=(const StreamDecoder &) = delete;
+
+    // 启动解复用线程，输入在该线程中打开
+    void start();
+    // 中止解复用并让 isReady() 返回 false；析构前须保证没有工作线程在 step()
+    void stop();
+
+    void setPriority(Priority priority);
+    // 显示区域像素尺寸，输出按其等比缩小；任意线程调用
+    void setTargetSize(const QSize &size) { m_scaleTarget.set(size); }
+    Priority priority() const { return m_priority.load(std::memory_order_acquire); }
+    State state() const { return m_state.load(std::memory_order_acquire); }
+
+    // 工作线程调用：有待解码的包或解码器中有未取出的帧，且输出端有空间
+    bool isReady() const;
+    void step();
+
+    Stats stats() const;
+    int queuedPackets() const { return m_packetQueue.size(); }
+
+private:
+    QString m_url;
+    FrameQueue *m_frameQueue = nullptr;
+    DecoderOptions m_options;
+    Callbacks m_callbacks;
+    std::shared_ptr<FramePool> m_framePool;
+
+    QThread *m_demuxThread = nullptr;
+    std::atomic<bool> m_stopped{false};
+    std::atomic<State> m_state{State::Opening};
+    std::atomic<Priority> m_priority{Priority::Visible};
+    std::atomic<bool> m_waitKeyframe{false};   // 离开隐藏状态后等到关键帧再恢复全量解码
+    std::atomic<bool> m_codecPending{false};   // 解码器里可能还有未取出的帧（输出队列满时留在其中）
+    Priority m_appliedPriority = Priority::Visible;
+    ScaleTarget m_scaleTarget;
+
+    AVFormatContext *m_formatCtx = nullptr;
+    AVCodecContext *m_codecCtx = nullptr;
+    AVFrame *m_frame = nullptr;
+    SwsContext *m_swsCtx = nullptr;
+    int m_videoStreamIndex = -1;
+
+    PacketQueue m_packetQueue;
+    PacketShellPool m_packetShells;
+
+    std::atomic<quint64> m_packets{0};
+    std::atomic<quint64> m_skippedPackets{0};
+    std::atomic<quint64> m_frames{0};
+    std::atomic<quint64> m_droppedFrames{0};
+    std::atomic<qint64> m_decodeNs{0};
+
+    void demuxLoop();
+    bool openInput(QString *error);
+    void drainCodec();
+    void outputFrame(AVFrame *frame);
+    void cleanup();
+    static int interruptCallback(void *opaque);
+};
+
+#endif // STREAMDECODER_H
@@ -0,0 +1,37 @@
+#ifndef SWSRANGE_H
+#define SWSRANGE_H
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+
+// sws_scale 只凭像素格式判断输入范围（YUVJ* 为全范围），标注为 JPEG 范围的 YUV420P 等会被当成有限范围；
+// 输出到 YUV 时 swscale 总是写有限范围。这里按源帧的实际范围设置输入端、输出端固定为有限范围，
+// 返回值用于标注输出缓冲，渲染端据此展开，不会重复扩展。范围未变化时不重建转换表。
+inline AVColorRange configureSwsRange(SwsContext *ctx, const AVFrame *frame)
+{
+    const AVPixelFormat format = static_cast<AVPixelFormat>(frame->format);
+    const int srcRange = frame->color_range == AVCOL_RANGE_JPEG
+                         || format == AV_PIX_FMT_YUVJ420P || format == AV_PIX_FMT_YUVJ422P
+                         || format == AV_PIX_FMT_YUVJ444P || format == AV_PIX_FMT_YUVJ440P
+                         || format == AV_PIX_FMT_YUVJ411P ? 1 : 0;
+
+    int *invTable = nullptr;
+    int *table = nullptr;
+    int currentSrcRange = 0;
+    int currentDstRange = 0;
+    int brightness = 0;
+    int contrast = 0;
+    int saturation = 0;
+    if (sws_getColorspaceDetails(ctx, &invTable, &currentSrcRange, &table, &currentDstRange,
+                                 &brightness, &contrast, &saturation) < 0)
+        return frame->color_range;
+
+    if (currentSrcRange != srcRange || currentDstRange != 0)
+        sws_setColorspaceDetails(ctx, invTable, srcRange, table, 0, brightness, contrast, saturation);
+    return AVCOL_RANGE_MPEG;
+}
+
+#endif // SWSRANGE_H
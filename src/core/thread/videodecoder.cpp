@@ -1,10 +1,82 @@
 #include "videodecoder.h"
+#include "audiooutput.h"
+#include "swsrange.h"
+
 #include <QDebug>
+#include <QFileInfo>
+#include <QMetaMethod>
+#include <QUrl>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/samplefmt.h>
+}
+
+namespace {
+constexpr int kPacketQueueCapacity = 256;
+constexpr int kDecodedQueueCapacity = 8;
+// 音频包体积小、数量多，交错不均匀的文件里需要更深的队列避免阻塞解复用
+constexpr int kAudioPacketQueueCapacity = 512;
+// 精确跳转时 pts 比较的容差，避免浮点误差把目标帧本身丢掉
+constexpr double kSeekTolerance = 0.001;
+constexpr double kNoSkip = -std::numeric_limits<double>::infinity();
+// 低延迟模式的探测上限：直播首个关键帧通常在前几十 KB 内
+constexpr int64_t kLowLatencyProbeSize = 32 * 1024;
+constexpr int64_t kLowLatencyAnalyzeDurationUs = 500 * 1000;
+constexpr int kDefaultMetricsIntervalMs = 1000;
+
+int frameSerial(const AVFrame *frame)
+{
+    return static_cast<int>(reinterpret_cast<intptr_t>(frame->opaque));
+}
+
+// YUV420P/NV12 一遍转换并缩放到 RGBA，替代 sws_scale 转 RGB24 再由渲染端补 alpha
+void convertToRgba(const AVFrame *frame, uint8_t *dst, int dstStride, const QSize &size,
+                   YuvConverter::Workspace &workspace)
+{
+    YuvConverter::Source src;
+    src.format = frame->format == AV_PIX_FMT_NV12 ? YuvConverter::Format::NV12 : YuvConverter::Format::I420;
+    src.width = frame->width;
+    src.height = frame->height;
+    src.y = frame->data[0];
+    src.u = frame->data[1];
+    src.v = frame->data[2];
+    src.yStride = frame->linesize[0];
+    src.uStride = frame->linesize[1];
+    src.vStride = frame->linesize[2];
+
+    // 与 RenderOpenGL 的着色器一致：未标注时高清按 BT.709、标清按 BT.601
+    YuvConverter::Options options;
+    const bool bt601 = frame->colorspace == AVCOL_SPC_BT470BG || frame->colorspace == AVCOL_SPC_SMPTE170M
+                       || frame->colorspace == AVCOL_SPC_FCC
+                       || (frame->colorspace != AVCOL_SPC_BT709 && frame->height < 720);
+    options.colorSpace = bt601 ? YuvConverter::ColorSpace::Bt601 : YuvConverter::ColorSpace::Bt709;
+    options.fullRange = frame->color_range == AVCOL_RANGE_JPEG || frame->format == AV_PIX_FMT_YUVJ420P;
+
+    YuvConverter::toRgba(src, dst, dstStride, size.width(), size.height(), options, workspace);
+}
+}
 
 VideoDecoder::VideoDecoder(QObject *parent)
     : QThread(parent)
+    , m_framePool(FramePool::create())
+    , m_packetQueue(kPacketQueueCapacity)
+    , m_decodedQueue(kDecodedQueueCapacity)
+    , m_packetShells(kPacketQueueCapacity + kAudioPacketQueueCapacity + 2)
+    , m_frameShells(kDecodedQueueCapacity + 2)
+    , m_audioOutput(new AudioOutput(this))
+    , m_audioPacketQueue(kAudioPacketQueueCapacity)
+    , m_pacer(&m_clock)
 {
     avformat_network_init();
+    qRegisterMetaType<PipelineMetrics::Snapshot>();
+
+    m_metricsTimer = new QTimer(this);
+    m_metricsTimer->setInterval(kDefaultMetricsIntervalMs);
+    connect(m_metricsTimer, &QTimer::timeout, this, [this]() { emit metricsUpdated(metricsSnapshot()); });
 }
 
 VideoDecoder::~VideoDecoder()
@@ -17,33 +89,380 @@ VideoDecoder::~VideoDecoder()
 void VideoDecoder::startDecoding(const QString &url)
 {
     QMutexLocker locker(&m_mutex);
-    if (isRunning()) stopDecoding();
+    if (isRunning()) {
+        stopDecoding();
+        wait();
+    }
     m_url = url;
     m_stopped = false;
+    m_openNs = -1;
+    m_probeNs = -1;
+    m_firstFrameNs = -1;
+    m_probeCacheHit = false;
+    m_metrics.reset();
+    m_startupTimer.start();
     start();
 }
 
 void VideoDecoder::stopDecoding()
 {
     m_stopped = true;
+    // 唤醒阻塞在队列上的各阶段线程
+    m_packetQueue.abort();
+    m_decodedQueue.abort();
+    m_audioPacketQueue.abort();
+    m_audioOutput->device()->abort();
+    m_readAhead.abort();
+
+    QMutexLocker locker(&m_seekMutex);
+    m_seekPending = false;
+    m_seekCond.wakeAll();
+}
+
+int VideoDecoder::seek(double position, SeekMode mode)
+{
+    const int serial = m_requestSerial.fetch_add(1, std::memory_order_acq_rel) + 1;
+    {
+        QMutexLocker locker(&m_seekMutex);
+        m_seekRequest = SeekRequest{ position, mode, serial };
+        m_seekPending = true;
+        m_seekCond.wakeAll();
+    }
+
+    // 渲染端立即跳过旧帧；清空包队列让阻塞在 push 上的解复用尽快处理请求
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_frameQueue)
+            m_frameQueue->discardBefore(serial);
+    }
+    m_packetQueue.flush();
+    m_audioPacketQueue.flush();
+    m_decodedQueue.flush();
+    return serial;
+}
+
+void VideoDecoder::setReadAheadEnabled(bool enabled)
+{
+    m_readAheadEnabled = enabled;
+}
+
+void VideoDecoder::setReadAheadOptions(const ReadAheadIO::Options &options)
+{
+    QMutexLocker locker(&m_optionsMutex);
+    m_readAheadOptions = options;
+}
+
+ReadAheadIO::Stats VideoDecoder::readAheadStats() const
+{
+    return m_readAhead.stats();
+}
+
+void VideoDecoder::setMappedInputEnabled(bool enabled)
+{
+    m_mappedInputEnabled = enabled;
+}
+
+MappedFileIO::Stats VideoDecoder::mappedInputStats() const
+{
+    return m_mappedInput.stats();
+}
+
+void VideoDecoder::setLowLatency(bool enabled)
+{
+    m_lowLatency = enabled;
+}
+
+void VideoDecoder::setProbeCacheEnabled(bool enabled)
+{
+    m_probeCacheEnabled = enabled;
+}
+
+VideoDecoder::StartupTiming VideoDecoder::startupTiming() const
+{
+    const auto toMs = [](qint64 ns) { return ns < 0 ? -1.0 : ns / 1e6; };
+    StartupTiming timing;
+    timing.openMs = toMs(m_openNs.load(std::memory_order_relaxed));
+    timing.probeMs = toMs(m_probeNs.load(std::memory_order_relaxed));
+    timing.timeToFirstFrameMs = toMs(m_firstFrameNs.load(std::memory_order_acquire));
+    timing.probeCacheHit = m_probeCacheHit.load(std::memory_order_relaxed);
+    return timing;
+}
+
+void VideoDecoder::recordFirstFrame()
+{
+    // 只有转换线程写入
+    if (m_firstFrameNs.load(std::memory_order_relaxed) >= 0)
+        return;
+    m_firstFrameNs.store(m_startupTimer.nsecsElapsed(), std::memory_order_release);
+
+    const StartupTiming timing = startupTiming();
+    qInfo() << "Startup: open" << timing.openMs << "ms, probe" << timing.probeMs
+            << "ms, first frame" << timing.timeToFirstFrameMs << "ms"
+            << (timing.probeCacheHit ? "(probe cache hit)" : "");
+}
+
+PipelineMetrics::Snapshot VideoDecoder::metricsSnapshot() const
+{
+    PipelineMetrics::Snapshot snapshot = m_metrics.snapshot();
+    const QueueDepths depths = queueDepths();
+    snapshot.packetQueueDepth = depths.packets;
+    snapshot.decodedQueueDepth = depths.decodedFrames;
+    snapshot.outputQueueDepth = depths.outputFrames;
+    return snapshot;
+}
+
+void VideoDecoder::setMetricsInterval(int ms)
+{
+    QMetaObject::invokeMethod(m_metricsTimer, [timer = m_metricsTimer, ms]() {
+        timer->setInterval(std::max(1, ms));
+    });
+}
+
+void VideoDecoder::connectNotify(const QMetaMethod &signal)
+{
+    if (signal == QMetaMethod::fromSignal(&VideoDecoder::metricsUpdated))
+        updateMetricsTimer();
+    QThread::connectNotify(signal);
+}
+
+void VideoDecoder::disconnectNotify(const QMetaMethod &signal)
+{
+    // 断开全部连接时 signal 无效，同样需要检查
+    if (!signal.isValid() || signal == QMetaMethod::fromSignal(&VideoDecoder::metricsUpdated))
+        updateMetricsTimer();
+    QThread::disconnectNotify(signal);
+}
+
+void VideoDecoder::updateMetricsTimer()
+{
+    // 没有接收者时不计时，也不生成快照；connect 可能发生在任意线程，转到定时器所在线程执行
+    QMetaObject::invokeMethod(this, [this]() {
+        if (isSignalConnected(QMetaMethod::fromSignal(&VideoDecoder::metricsUpdated))) {
+            if (!m_metricsTimer->isActive())
+                m_metricsTimer->start();
+        } else {
+            m_metricsTimer->stop();
+        }
+    }, Qt::QueuedConnection);
+}
+
+void VideoDecoder::setLateFrameThreshold(double seconds)
+{
+    m_pacer.setLateThreshold(seconds);
+}
+
+FramePacer::Stats VideoDecoder::pacerStats() const
+{
+    return m_pacer.stats();
+}
+
+void VideoDecoder::setAudioEnabled(bool enabled)
+{
+    m_audioEnabled = enabled;
+}
+
+void VideoDecoder::setFrameQueue(FrameQueue *queue)
+{
+    QMutexLocker locker(&m_mutex);
+    m_frameQueue = queue;
+}
+
+void VideoDecoder::setOutputFormat(OutputFormat format)
+{
+    m_outputFormat = format;
+}
+
+void VideoDecoder::setTargetSize(const QSize &size)
+{
+    m_scaleTarget.set(size);
+}
+
+VideoDecoder::QueueDepths VideoDecoder::queueDepths() const
+{
+    QueueDepths depths;
+    depths.packets = m_packetQueue.size();
+    depths.decodedFrames = m_decodedQueue.size();
+    depths.outputFrames = m_frameQueue ? static_cast<int>(m_frameQueue->size()) : 0;
+    return depths;
+}
+
+void VideoDecoder::setDecoderOptions(const DecoderOptions &options)
+{
+    QMutexLocker locker(&m_optionsMutex);
+    m_decoderOptions = options;
+}
+
+DecoderOptions VideoDecoder::decoderOptions() const
+{
+    QMutexLocker locker(&m_optionsMutex);
+    return m_decoderOptions;
+}
+
+DecoderOptions VideoDecoder::effectiveDecoderOptions() const
+{
+    QMutexLocker locker(&m_optionsMutex);
+    return m_effectiveOptions;
+}
+
+VideoDecoder::DecodeTiming VideoDecoder::decodeTiming() const
+{
+    DecodeTiming timing;
+    timing.frames = m_decodedFrames.load(std::memory_order_relaxed);
+    timing.lastFrameUs = m_lastDecodeNs.load(std::memory_order_relaxed) / 1000.0;
+    if (timing.frames > 0)
+        timing.averageFrameUs = m_totalDecodeNs.load(std::memory_order_relaxed) / 1000.0 / timing.frames;
+    return timing;
+}
+
+bool VideoDecoder::enqueueFrame(VideoFrame &&frame)
+{
+    // 队列满时阻塞转换线程，形成背压；解码最多领先渲染 capacity 帧。
+    // 等待期间发生跳转则放弃这一帧
+    while (!m_stopped && !m_frameQueue->push(std::move(frame))) {
+        if (frame.serial != m_serial.load(std::memory_order_acquire))
+            return false;
+        QThread::usleep(500);
+    }
+    if (m_stopped)
+        return false;
+
+    if (m_frameQueue->size() == 1)
+        emit frameQueued();
+    return true;
+}
+
+int VideoDecoder::interruptCallback(void *opaque)
+{
+    // 网络读取阻塞时也能及时响应 stopDecoding()
+    return static_cast<VideoDecoder *>(opaque)->m_stopped ? 1 : 0;
 }
 
 void VideoDecoder::run()
 {
-    playbackTimer_.start();
-    firstPts_ = -1;
+    m_clock.reset();
+    m_pacer.reset();
+    m_serial = m_requestSerial.load();
+    m_skipUntil = kNoSkip;
     cleanup();
 
-    m_formatCtx = avformat_alloc_context();
-    if (avformat_open_input(&m_formatCtx, m_url.toStdString().c_str(), nullptr, nullptr) != 0) {
-        emit decodingFailed("Failed to open input: " + m_url);
+    if (!openInput()) {
+        cleanup();
         return;
     }
 
-    if (avformat_find_stream_info(m_formatCtx, nullptr) < 0) {
-        emit decodingFailed("Failed to find stream info");
-        return;
+    m_packetQueue.reset();
+    m_decodedQueue.reset();
+    m_audioPacketQueue.reset();
+
+    QThread *decodeThread = QThread::create([this]() { decodeLoop(); });
+    QThread *convertThread = QThread::create([this]() { convertLoop(); });
+    QThread *audioThread = nullptr;
+    decodeThread->start();
+    convertThread->start();
+    if (m_audioStreamIndex >= 0) {
+        audioThread = QThread::create([this]() { audioDecodeLoop(); });
+        audioThread->start();
+    }
+
+    demuxLoop();
+
+    // 解复用只在停止时返回；reset() 可能晚于 stopDecoding()，这里再中止一次确保下游退出
+    m_packetQueue.abort();
+    m_decodedQueue.abort();
+    m_audioPacketQueue.abort();
+    m_audioOutput->device()->abort();
+
+    decodeThread->wait();
+    convertThread->wait();
+    delete decodeThread;
+    delete convertThread;
+    if (audioThread) {
+        audioThread->wait();
+        delete audioThread;
+    }
+
+    if (m_stopped && m_audioStreamIndex >= 0) {
+        QMetaObject::invokeMethod(m_audioOutput, [output = m_audioOutput]() { output->stop(); },
+                                  Qt::QueuedConnection);
+        m_clock.clearAudio();
+    }
+
+    m_packetQueue.flush();
+    m_decodedQueue.flush();
+    m_audioPacketQueue.flush();
+    cleanup();
+}
+
+bool VideoDecoder::openInput()
+{
+    m_formatCtx = avformat_alloc_context();
+    m_formatCtx->interrupt_callback.callback = &VideoDecoder::interruptCallback;
+    m_formatCtx->interrupt_callback.opaque = this;
+
+    const bool lowLatency = m_lowLatency;
+    if (lowLatency) {
+        m_formatCtx->probesize = kLowLatencyProbeSize;
+        m_formatCtx->max_analyze_duration = kLowLatencyAnalyzeDurationUs;
+        m_formatCtx->flags |= AVFMT_FLAG_NOBUFFER;
+    }
+
+    // 网络输入：由预读线程从协议层读取，解复用只从环形缓冲取数据
+    m_readAheadActive = m_readAheadEnabled && isNetworkUrl(m_url);
+    if (m_readAheadActive) {
+        {
+            QMutexLocker locker(&m_optionsMutex);
+            ReadAheadIO::Options options = m_readAheadOptions;
+            // 低延迟模式下有数据即交给解复用，抖动靠渲染端丢帧消化
+            if (lowLatency)
+                options.prebufferSeconds = 0.0;
+            m_readAhead.setOptions(options);
+        }
+        if (m_readAhead.open(m_url) < 0) {
+            emit decodingFailed("Failed to open input: " + m_url);
+            return false;
+        }
+        // open() 会清除中止状态，补上期间到达的 stopDecoding()
+        if (m_stopped)
+            m_readAhead.abort();
+        m_formatCtx->pb = m_readAhead.context();
+        m_formatCtx->flags |= AVFMT_FLAG_CUSTOM_IO;
+    } else if (m_mappedInputEnabled) {
+        // 本地文件：从内存映射区读取，省去逐块 read() 的系统调用
+        const QString path = localFilePath(m_url);
+        m_mappedInputActive = !path.isEmpty() && m_mappedInput.open(path);
+        if (m_mappedInputActive) {
+            m_formatCtx->pb = m_mappedInput.context();
+            m_formatCtx->flags |= AVFMT_FLAG_CUSTOM_IO;
+        }
+    }
+
+    // 已知源直接指定封装格式，省去读取开头数据做格式探测
+    const std::shared_ptr<const ProbeCache::Entry> cached =
+        m_probeCacheEnabled ? ProbeCache::instance()->find(m_url) : nullptr;
+    const AVInputFormat *inputFormat = nullptr;
+    if (cached)
+        inputFormat = av_find_input_format(cached->formatName.toLatin1().constData());
+
+    if (avformat_open_input(&m_formatCtx, m_url.toStdString().c_str(), inputFormat, nullptr) != 0) {
+        // 源的封装格式可能已变化，去掉缓存按常规方式重试一次
+        if (!inputFormat || m_stopped) {
+            emit decodingFailed("Failed to open input: " + m_url);
+            return false;
+        }
+        ProbeCache::instance()->remove(m_url);
+        cleanup();
+        return openInput();
     }
+    m_openNs = m_startupTimer.nsecsElapsed();
+
+    const bool cacheHit = cached && ProbeCache::apply(*cached, m_formatCtx);
+    m_probeCacheHit = cacheHit;
+    if (!cacheHit && !probeStreams())
+        return false;
+    m_probeNs = m_startupTimer.nsecsElapsed();
+
+    if (m_readAheadActive)
+        m_readAhead.setBitrate(m_formatCtx->bit_rate);
 
     m_videoStreamIndex = -1;
     for (unsigned int i = 0; i < m_formatCtx->nb_streams; ++i) {
@@ -55,89 +474,576 @@ void VideoDecoder::run()
 
     if (m_videoStreamIndex == -1) {
         emit decodingFailed("No video stream found");
-        return;
+        return false;
     }
 
     AVCodecParameters *codecPar = m_formatCtx->streams[m_videoStreamIndex]->codecpar;
     m_codec = avcodec_find_decoder(codecPar->codec_id);
     if (!m_codec) {
         emit decodingFailed("Unsupported codec");
-        return;
+        return false;
     }
 
     m_codecCtx = avcodec_alloc_context3(m_codec);
     if (avcodec_parameters_to_context(m_codecCtx, codecPar) < 0) {
         emit decodingFailed("Failed to copy codec parameters");
-        return;
+        return false;
     }
 
+    DecoderOptions requested = decoderOptions();
+    if (lowLatency)
+        requested.lowDelay = true;
+    DecoderOptions effective = requested.resolved(codecPar->codec_id, codecPar->width, codecPar->height);
+    effective.applyTo(m_codecCtx);
+
     if (avcodec_open2(m_codecCtx, m_codec, nullptr) < 0) {
+        // 缓存的参数可能已不适用（如分辨率或 extradata 变化），下次重新探测
+        if (cacheHit)
+            ProbeCache::instance()->remove(m_url);
         emit decodingFailed("Failed to open codec");
-        return;
+        return false;
     }
 
+    // 以打开后的上下文为准，解码器不支持的线程模式会被 FFmpeg 回退
+    if (m_codecCtx->active_thread_type & FF_THREAD_FRAME) {
+        effective.threadType = DecoderOptions::ThreadType::Frame;
+        effective.threadCount = m_codecCtx->thread_count;
+    } else if (m_codecCtx->active_thread_type & FF_THREAD_SLICE) {
+        effective.threadType = DecoderOptions::ThreadType::Slice;
+        effective.threadCount = m_codecCtx->thread_count;
+    } else {
+        effective.threadCount = 1;
+    }
+
+    {
+        QMutexLocker locker(&m_optionsMutex);
+        m_effectiveOptions = effective;
+    }
+    m_lastDecodeNs = 0;
+    m_totalDecodeNs = 0;
+    m_decodedFrames = 0;
+
+    qInfo() << "Decoder" << m_codec->name << m_codecCtx->width << "x" << m_codecCtx->height
+            << effective.toString();
+
+    // 音频可选：打不开时只播放画面，时钟退回墙钟
+    if (m_audioEnabled && !openAudio())
+        m_audioStreamIndex = -1;
+
+    // 容器自带关键帧索引时直接使用，否则在解复用过程中逐步建立
+    const int indexed = m_keyframeIndex.loadFromStream(m_formatCtx->streams[m_videoStreamIndex]);
+    if (indexed == 0)
+        qInfo() << "No container keyframe index, building lazily";
+
     m_frame = av_frame_alloc();
     m_packet = av_packet_alloc();
+    return true;
+}
+
+bool VideoDecoder::probeStreams()
+{
+    if (avformat_find_stream_info(m_formatCtx, nullptr) < 0) {
+        emit decodingFailed("Failed to find stream info");
+        return false;
+    }
+    // 只缓存完整的结果：低延迟模式下探测不足时部分流可能没有拿到编码参数
+    if (m_probeCacheEnabled) {
+        bool complete = m_formatCtx->nb_streams > 0;
+        for (unsigned int i = 0; i < m_formatCtx->nb_streams && complete; ++i) {
+            const AVCodecParameters *par = m_formatCtx->streams[i]->codecpar;
+            if (par->codec_id == AV_CODEC_ID_NONE
+                || (par->codec_type == AVMEDIA_TYPE_VIDEO && (par->width <= 0 || par->height <= 0))
+                || (par->codec_type == AVMEDIA_TYPE_AUDIO && par->sample_rate <= 0))
+                complete = false;
+        }
+        if (complete)
+            ProbeCache::instance()->store(m_url, m_formatCtx);
+    }
+    return true;
+}
+
+bool VideoDecoder::openAudio()
+{
+    m_audioStreamIndex = -1;
+    const int index = av_find_best_stream(m_formatCtx, AVMEDIA_TYPE_AUDIO, -1, m_videoStreamIndex, nullptr, 0);
+    if (index < 0)
+        return false;
 
-    m_swsCtx = sws_getContext(
-        m_codecCtx->width,
-        m_codecCtx->height,
-        m_codecCtx->pix_fmt,
-        m_codecCtx->width,
-        m_codecCtx->height,
-        AV_PIX_FMT_RGB24,
-        SWS_BILINEAR,
-        nullptr, nullptr, nullptr
-        );
-
-    int rgbStride[1] = { 3 * m_codecCtx->width };
-    uint8_t *rgbBuffer = new uint8_t[rgbStride[0] * m_codecCtx->height];
-
-    AVFrame *rgbFrame = av_frame_alloc();
-    av_image_fill_arrays(rgbFrame->data, rgbFrame->linesize, rgbBuffer, AV_PIX_FMT_RGB24,
-                         m_codecCtx->width, m_codecCtx->height, 1);
-
-    while (!m_stopped && av_read_frame(m_formatCtx, m_packet) >= 0) {
+    AVCodecParameters *codecPar = m_formatCtx->streams[index]->codecpar;
+    const AVCodec *codec = avcodec_find_decoder(codecPar->codec_id);
+    if (!codec)
+        return false;
+
+    m_audioCodecCtx = avcodec_alloc_context3(codec);
+    if (avcodec_parameters_to_context(m_audioCodecCtx, codecPar) < 0
+        || avcodec_open2(m_audioCodecCtx, codec, nullptr) < 0) {
+        qWarning() << "Failed to open audio codec" << codec->name;
+        return false;
+    }
+
+    // 统一重采样到输出设备格式（交错 S16）
+    const QAudioFormat format = AudioOutput::outputFormat();
+    AVChannelLayout outLayout;
+    av_channel_layout_default(&outLayout, format.channelCount());
+    const int ret = swr_alloc_set_opts2(&m_swrCtx,
+                                        &outLayout, AV_SAMPLE_FMT_S16, format.sampleRate(),
+                                        &m_audioCodecCtx->ch_layout, m_audioCodecCtx->sample_fmt,
+                                        m_audioCodecCtx->sample_rate,
+                                        0, nullptr);
+    av_channel_layout_uninit(&outLayout);
+    if (ret < 0 || swr_init(m_swrCtx) < 0) {
+        qWarning() << "Failed to init audio resampler";
+        return false;
+    }
+
+    m_audioFrame = av_frame_alloc();
+    m_audioStreamIndex = index;
+    m_nextAudioPts = 0.0;
+
+    m_audioOutput->prepare(&m_clock);
+    QMetaObject::invokeMethod(m_audioOutput, [output = m_audioOutput]() { output->start(); },
+                              Qt::QueuedConnection);
+    return true;
+}
+
+// --- 解复用阶段（本线程） ---
+void VideoDecoder::demuxLoop()
+{
+    bool endOfFile = false;
+
+    while (!m_stopped) {
+        SeekRequest request;
+        if (takeSeekRequest(endOfFile, &request)) {
+            performSeek(request);
+            endOfFile = false;
+            continue;
+        }
+        if (endOfFile)
+            break;   // 等待期间被停止
+
+        const qint64 readStart = m_startupTimer.nsecsElapsed();
+        const int readResult = av_read_frame(m_formatCtx, m_packet);
+        m_metrics.record(PipelineMetrics::Stage::Read, m_startupTimer.nsecsElapsed() - readStart);
+        if (readResult < 0) {
+            if (m_stopped)
+                break;
+            // 读到结尾：发送结束标记让下游排空缓存帧，之后等待跳转或停止
+            m_packetQueue.push(nullptr);
+            if (m_audioStreamIndex >= 0)
+                m_audioPacketQueue.push(nullptr);
+            endOfFile = true;
+            continue;
+        }
+
+        m_metrics.addPacketRead();
+
+        PacketQueue *target = nullptr;
         if (m_packet->stream_index == m_videoStreamIndex) {
-            if (avcodec_send_packet(m_codecCtx, m_packet) == 0) {
-                while (avcodec_receive_frame(m_codecCtx, m_frame) == 0) {
-
-                    // --- 播放节奏控制开始 ---
-                    double pts_sec = 0.0;
-                    if (m_frame->pts != AV_NOPTS_VALUE) {
-                        pts_sec = m_frame->pts * av_q2d(m_formatCtx->streams[m_videoStreamIndex]->time_base);
-                    }
-
-                    if (firstPts_ < 0) {
-                        firstPts_ = pts_sec;
-                        playbackTimer_.restart();
-                    }
-
-                    double elapsed = playbackTimer_.elapsed() / 1000.0; // 转成秒
-                    double waitTime = pts_sec - firstPts_ - elapsed;
-                    if (waitTime > 0) {
-                        QThread::msleep(static_cast<unsigned long>(waitTime * 1000));
-                    }
-                    // --- 播放节奏控制结束 ---
-
-                    sws_scale(m_swsCtx,
-                              m_frame->data, m_frame->linesize,
-                              0, m_codecCtx->height,
-                              rgbFrame->data, rgbFrame->linesize);
-
-                    QImage img(rgbFrame->data[0], m_codecCtx->width, m_codecCtx->height,
-                               rgbFrame->linesize[0], QImage::Format_RGB888);
-
-                    emit frameDecoded(img.copy());
-                }
+            target = &m_packetQueue;
+            if (m_packet->flags & AV_PKT_FLAG_KEY)
+                m_keyframeIndex.add(m_packet->dts, m_packet->pts, m_packet->pos);
+        } else if (m_packet->stream_index == m_audioStreamIndex) {
+            target = &m_audioPacketQueue;
+        }
+
+        if (!target) {
+            av_packet_unref(m_packet);
+            continue;
+        }
+
+        AVPacket *packet = m_packetShells.take();
+        av_packet_move_ref(packet, m_packet);
+        if (!target->push(packet))
+            return;
+    }
+}
+
+bool VideoDecoder::takeSeekRequest(bool wait, SeekRequest *out)
+{
+    // 常规路径只读一次原子量，不加锁
+    if (!wait && !m_seekPending.load(std::memory_order_acquire))
+        return false;
+
+    QMutexLocker locker(&m_seekMutex);
+    while (wait && !m_seekPending && !m_stopped)
+        m_seekCond.wait(&m_seekMutex);
+    if (!m_seekPending || m_stopped)
+        return false;
+
+    *out = m_seekRequest;
+    m_seekPending = false;
+    return true;
+}
+
+void VideoDecoder::performSeek(const SeekRequest &request)
+{
+    AVStream *stream = m_formatCtx->streams[m_videoStreamIndex];
+    const double timeBase = av_q2d(stream->time_base);
+    const double startSec = stream->start_time != AV_NOPTS_VALUE ? stream->start_time * timeBase : 0.0;
+    const double targetSec = startSec + std::max(0.0, request.position);
+    const int64_t target = static_cast<int64_t>(std::llround(targetSec / timeBase));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int ret = -1;
+    // target 在 pts 时间轴上，索引按关键帧的 pts 查找，返回的 dts 用于定位
+    KeyframeIndex::Entry keyframe;
+    const bool indexed = m_keyframeIndex.floor(target, &keyframe);
+    if (indexed) {
+        const int flags = m_formatCtx->iformat->flags;
+        if (!m_keyframeIndex.isComplete() && keyframe.pos >= 0
+            && (flags & AVFMT_TS_DISCONT) && !(flags & AVFMT_NO_BYTE_SEEK)) {
+            // TS/FLV 等无容器索引的格式按时间戳定位需要二分读包，已知关键帧偏移时直接按字节定位
+            ret = avformat_seek_file(m_formatCtx, -1, keyframe.pos, keyframe.pos, keyframe.pos, AVSEEK_FLAG_BYTE);
+        } else {
+            ret = avformat_seek_file(m_formatCtx, m_videoStreamIndex,
+                                     INT64_MIN, keyframe.timestamp, keyframe.timestamp, 0);
+        }
+    }
+    if (ret < 0)
+        ret = avformat_seek_file(m_formatCtx, m_videoStreamIndex, INT64_MIN, target, target, 0);
+    if (ret < 0)
+        qWarning() << "Seek failed at" << request.position << "s, continuing from current position";
+
+    // 无论定位是否成功都切换 serial，保证渲染端丢弃的旧帧与这里一致
+    m_serial.store(request.serial, std::memory_order_release);
+    m_skipUntil.store(request.mode == SeekMode::Accurate && ret >= 0 ? targetSec - kSeekTolerance : kNoSkip,
+                      std::memory_order_release);
+    m_keyframeIndex.markDiscontinuity();
+
+    m_packetQueue.flush();
+    m_audioPacketQueue.flush();
+    m_decodedQueue.flush();
+    m_clock.reset();
+    if (m_audioStreamIndex >= 0)
+        m_audioOutput->device()->discard();
+
+    m_packetQueue.push(flushPacket());
+    if (m_audioStreamIndex >= 0)
+        m_audioPacketQueue.push(flushPacket());
+
+    qInfo() << "Seek to" << request.position << "s"
+            << (indexed ? "via keyframe index" : "via container") << timer.nsecsElapsed() / 1000 << "us";
+}
+
+// --- 解码阶段 ---
+void VideoDecoder::decodeLoop()
+{
+    AVPacket *packet = nullptr;
+    QElapsedTimer timer;
+    qint64 busyNs = 0;   // 自上一帧输出以来花在解码调用上的时间
+    int serial = m_serial.load(std::memory_order_acquire);
+    double skipUntil = kNoSkip;
+
+    while (m_packetQueue.pop(packet)) {
+        if (packet == flushPacket()) {
+            avcodec_flush_buffers(m_codecCtx);
+            serial = m_serial.load(std::memory_order_acquire);
+            skipUntil = m_skipUntil.load(std::memory_order_acquire);
+            busyNs = 0;
+            continue;
+        }
+
+        const bool endOfStream = (packet == nullptr);
+        timer.start();
+        const int ret = avcodec_send_packet(m_codecCtx, packet);
+        busyNs += timer.nsecsElapsed();
+        m_packetShells.recycle(packet);
+        if (ret < 0 && !endOfStream)
+            continue;
+
+        for (;;) {
+            timer.start();
+            const int received = avcodec_receive_frame(m_codecCtx, m_frame);
+            busyNs += timer.nsecsElapsed();
+            if (received != 0)
+                break;
+
+            m_lastDecodeNs.store(busyNs, std::memory_order_relaxed);
+            m_totalDecodeNs.fetch_add(busyNs, std::memory_order_relaxed);
+            m_decodedFrames.fetch_add(1, std::memory_order_relaxed);
+            m_metrics.record(PipelineMetrics::Stage::Decode, busyNs);
+            m_metrics.addFrameDecoded();
+            busyNs = 0;
+
+            // 精确跳转：目标之前的帧只用于建立参考，不进入转换阶段
+            if (m_frame->best_effort_timestamp != AV_NOPTS_VALUE
+                && framePts(m_frame, m_videoStreamIndex) < skipUntil) {
+                av_frame_unref(m_frame);
+                continue;
             }
+            skipUntil = kNoSkip;
+
+            AVFrame *frame = m_frameShells.take();
+            av_frame_move_ref(frame, m_frame);
+            frame->opaque = reinterpret_cast<void *>(static_cast<intptr_t>(serial));
+            if (!m_decodedQueue.push(frame))
+                return;
+        }
+
+        if (endOfStream) {
+            m_decodedQueue.push(nullptr);
+            // 排空后解码器处于 EOF 状态，flush 后才能接受跳转后的数据包
+            avcodec_flush_buffers(m_codecCtx);
         }
-        av_packet_unref(m_packet);
     }
+}
 
-    delete[] rgbBuffer;
-    av_frame_free(&rgbFrame);
-    cleanup();
+// --- 音频解码阶段 ---
+void VideoDecoder::audioDecodeLoop()
+{
+    AVPacket *packet = nullptr;
+    bool outputLost = false;   // 设备不可用时继续消费音频包，避免阻塞解复用
+    double skipUntil = kNoSkip;
+
+    while (m_audioPacketQueue.pop(packet)) {
+        if (packet == flushPacket()) {
+            avcodec_flush_buffers(m_audioCodecCtx);
+            swr_init(m_swrCtx);   // 丢弃重采样器内部缓存的旧采样
+            skipUntil = m_skipUntil.load(std::memory_order_acquire);
+            // 阻塞期间可能又写入了旧数据，按队列顺序再清一次
+            m_audioOutput->device()->discard();
+            continue;
+        }
+
+        const bool endOfStream = (packet == nullptr);
+        if (outputLost) {
+            m_packetShells.recycle(packet);
+            continue;
+        }
+
+        const int ret = avcodec_send_packet(m_audioCodecCtx, packet);
+        m_packetShells.recycle(packet);
+        if (ret < 0 && !endOfStream)
+            continue;
+
+        while (!outputLost && avcodec_receive_frame(m_audioCodecCtx, m_audioFrame) == 0) {
+            if (m_audioFrame->best_effort_timestamp == AV_NOPTS_VALUE
+                || framePts(m_audioFrame, m_audioStreamIndex) >= skipUntil)
+                outputLost = !writeAudioFrame(m_audioFrame);
+            av_frame_unref(m_audioFrame);
+        }
+
+        if (endOfStream)
+            avcodec_flush_buffers(m_audioCodecCtx);
+    }
+}
+
+bool VideoDecoder::writeAudioFrame(AVFrame *frame)
+{
+    const QAudioFormat format = AudioOutput::outputFormat();
+    const int channels = format.channelCount();
+
+    const int maxSamples = swr_get_out_samples(m_swrCtx, frame->nb_samples);
+    if (maxSamples > m_audioBufferSamples) {
+        av_freep(&m_audioBuffer);
+        if (av_samples_alloc(&m_audioBuffer, nullptr, channels, maxSamples, AV_SAMPLE_FMT_S16, 0) < 0) {
+            m_audioBufferSamples = 0;
+            return true;
+        }
+        m_audioBufferSamples = maxSamples;
+    }
+
+    const int samples = swr_convert(m_swrCtx, &m_audioBuffer, m_audioBufferSamples,
+                                    const_cast<const uint8_t **>(frame->extended_data), frame->nb_samples);
+    if (samples <= 0)
+        return true;
+
+    double pts = m_nextAudioPts;
+    if (frame->best_effort_timestamp != AV_NOPTS_VALUE)
+        pts = framePts(frame, m_audioStreamIndex);
+    m_nextAudioPts = pts + double(samples) / format.sampleRate();
+
+    return m_audioOutput->device()->writePcm(m_audioBuffer, samples * channels * 2, pts);
+}
+
+// --- 转换阶段 ---
+void VideoDecoder::convertLoop()
+{
+    AVFrame *frame = nullptr;
+    while (m_decodedQueue.pop(frame)) {
+        if (!frame) {
+            emit endOfStream();
+            continue;
+        }
+        // 跳转前解码出的旧帧直接丢弃
+        const int serial = frameSerial(frame);
+        if (serial == m_serial.load(std::memory_order_acquire))
+            convertFrame(frame, serial);
+        else
+            m_metrics.addFrameDropped(false);
+        m_frameShells.recycle(frame);
+    }
+}
+
+double VideoDecoder::framePts(const AVFrame *frame, int streamIndex) const
+{
+    return frame->best_effort_timestamp * av_q2d(m_formatCtx->streams[streamIndex]->time_base);
+}
+
+void VideoDecoder::convertFrame(AVFrame *frame, int serial)
+{
+    double pts_sec = 0.0;
+    if (frame->best_effort_timestamp != AV_NOPTS_VALUE)
+        pts_sec = framePts(frame, m_videoStreamIndex);
+
+    if (!m_frameQueue) {
+        // 信号输出：在转换前等到显示时刻，已严重迟到的帧连转换也省掉
+        if (m_pacer.pace(pts_sec, m_stopped) == FramePacer::Decision::Drop) {
+            m_metrics.addFrameDropped(!m_stopped);
+            return;
+        }
+    } else if (m_pacer.isLate(pts_sec)) {
+        // 渲染端调度：解码跟不上时提前丢弃，避免延迟持续累积
+        m_pacer.recordDrop();
+        m_metrics.addFrameDropped(true);
+        return;
+    }
+
+    QElapsedTimer stageTimer;
+    stageTimer.start();
+
+    const AVPixelFormat srcFormat = static_cast<AVPixelFormat>(frame->format);
+    const bool yuvOutput = m_frameQueue && m_outputFormat == OutputFormat::Yuv;
+    // 显示区域小于源分辨率时直接输出显示尺寸，转换与上传量随面积下降
+    const QSize outSize = m_scaleTarget.outputSize(frame->width, frame->height);
+    const bool downscale = outSize.width() != frame->width || outSize.height() != frame->height;
+
+    FrameRef buffer;
+    if (!yuvOutput && isPassthroughFormat(srcFormat)) {
+        // RGB 输出（队列的软件回退与信号输出）：SIMD 内核一遍完成转换与缩放
+        m_framePool->configure(outSize.width(), outSize.height(), AV_PIX_FMT_RGBA);
+        buffer = acquireBuffer();
+        if (!buffer)
+            return;
+        convertToRgba(frame, buffer->data[0], buffer->linesize[0], outSize, m_yuvWorkspace);
+    } else if (yuvOutput && isPassthroughFormat(srcFormat) && !downscale) {
+        // 渲染端可直接采样的平面格式：只转移解码帧引用，不做任何像素拷贝
+        m_framePool->configure(frame->width, frame->height, srcFormat, FramePool::Storage::Borrowed);
+        buffer = m_framePool->wrap(frame);
+        while (!buffer && !m_stopped) {
+            QThread::usleep(500);
+            buffer = m_framePool->wrap(frame);
+        }
+        if (!buffer)
+            return;
+    } else {
+        // 其余格式或需要缩小时：YUV 模式下统一转成 YUV420P（比 RGB 便宜且上传量小），否则转 RGB24
+        const AVPixelFormat dstFormat = yuvOutput ? AV_PIX_FMT_YUV420P : AV_PIX_FMT_RGB24;
+
+        // 分辨率或显示尺寸变化时自动重建缩放上下文；缩小用区域平均，避免双线性的混叠
+        m_swsCtx = sws_getCachedContext(
+            m_swsCtx,
+            frame->width,
+            frame->height,
+            srcFormat,
+            outSize.width(),
+            outSize.height(),
+            dstFormat,
+            downscale ? SWS_AREA : SWS_BILINEAR,
+            nullptr, nullptr, nullptr
+            );
+        if (!m_swsCtx)
+            return;
+
+        // 输出缓冲全部来自帧池，稳态下不再逐帧分配
+        m_framePool->configure(outSize.width(), outSize.height(), dstFormat);
+
+        buffer = acquireBuffer();
+        if (!buffer)
+            return;
+
+        // 输出为有限范围（RGB 输出时该标注不使用）
+        buffer->colorRange = configureSwsRange(m_swsCtx, frame);
+        sws_scale(m_swsCtx,
+                  frame->data, frame->linesize,
+                  0, frame->height,
+                  buffer->data, buffer->linesize);
+        buffer->colorSpace = frame->colorspace;
+        // 渲染端对未标注的色彩空间按高度猜测，缩小后须按源分辨率先定下来
+        if (downscale && frame->colorspace == AVCOL_SPC_UNSPECIFIED)
+            buffer->colorSpace = frame->height >= 720 ? AVCOL_SPC_BT709 : AVCOL_SPC_SMPTE170M;
+    }
+
+    // 转换耗时包含等待帧池归还缓冲的时间，持续偏高说明渲染端跟不上
+    m_metrics.record(PipelineMetrics::Stage::Convert, stageTimer.nsecsElapsed());
+    stageTimer.start();
+
+    if (m_frameQueue) {
+        // 由渲染端按 pts 调度，转换线程不再等待
+        if (!enqueueFrame(VideoFrame{ std::move(buffer), pts_sec, serial })) {
+            m_metrics.addFrameDropped(false);
+            return;
+        }
+    } else {
+        emit frameDecoded(wrapImage(std::move(buffer)));
+    }
+    m_metrics.record(PipelineMetrics::Stage::Handoff, stageTimer.nsecsElapsed());
+    m_metrics.addFrameOutput();
+    recordFirstFrame();
+}
+
+bool VideoDecoder::isPassthroughFormat(AVPixelFormat format)
+{
+    return format == AV_PIX_FMT_YUV420P
+           || format == AV_PIX_FMT_YUVJ420P
+           || format == AV_PIX_FMT_NV12;
+}
+
+bool VideoDecoder::isNetworkUrl(const QString &url)
+{
+    // 只处理字节流协议；rtsp 等由 demuxer 自己管理连接，不能套自定义 IO
+    static const char *const kSchemes[] = { "http", "https", "tcp", "udp", "rtmp", "rtmps", "srt" };
+    const QString scheme = url.section(QStringLiteral("://"), 0, 0).toLower();
+    if (scheme == url)
+        return false;
+    for (const char *candidate : kSchemes) {
+        if (scheme == QLatin1String(candidate))
+            return true;
+    }
+    return false;
+}
+
+QString VideoDecoder::localFilePath(const QString &url)
+{
+    QString path = url;
+    if (path.startsWith(QLatin1String("file:"), Qt::CaseInsensitive))
+        path = QUrl(url).toLocalFile();
+    else if (path.contains(QLatin1String("://")))
+        return QString();
+    return QFileInfo(path).isFile() ? path : QString();
+}
+
+FrameRef VideoDecoder::acquireBuffer()
+{
+    // 池耗尽说明渲染端还持有全部缓冲，等待其归还
+    FrameRef buffer = m_framePool->acquire();
+    while (!buffer && !m_stopped) {
+        QThread::usleep(500);
+        buffer = m_framePool->acquire();
+    }
+    return buffer;
+}
+
+QImage VideoDecoder::wrapImage(FrameRef buffer)
+{
+    // 信号输出也用池内缓冲：QImage 只读地引用像素，最后一份 QImage 析构时把缓冲还给池，
+    // 不再逐帧分配和整帧拷贝。接收方修改图像时 QImage 自行分离拷贝，不会写坏池内存
+    const QImage::Format format = buffer->format == AV_PIX_FMT_RGBA ? QImage::Format_RGBA8888
+                                                                      : QImage::Format_RGB888;
+    const uchar *pixels = buffer->data[0];
+    const int width = buffer->width;
+    const int height = buffer->height;
+    const int stride = buffer->linesize[0];
+    return QImage(pixels, width, height, stride, format,
+                  [](void *info) { FrameRef::adopt(static_cast<FrameBuffer *>(info)); },
+                  buffer.release());
+}
+
+FramePool::Stats VideoDecoder::framePoolStats() const
+{
+    return m_framePool->stats();
 }
 
 void VideoDecoder::cleanup()
@@ -162,8 +1068,32 @@ void VideoDecoder::cleanup()
         m_formatCtx = nullptr;
     }
 
+    // 自定义 IO 不随 avformat_close_input 释放
+    if (m_readAheadActive) {
+        m_readAhead.close();
+        m_readAheadActive = false;
+    }
+    if (m_mappedInputActive) {
+        m_mappedInput.close();
+        m_mappedInputActive = false;
+    }
+
     if (m_swsCtx) {
         sws_freeContext(m_swsCtx);
         m_swsCtx = nullptr;
     }
+
+    if (m_audioFrame)
+        av_frame_free(&m_audioFrame);
+
+    if (m_audioCodecCtx)
+        avcodec_free_context(&m_audioCodecCtx);
+
+    if (m_swrCtx)
+        swr_free(&m_swrCtx);
+
+    if (m_audioBuffer) {
+        av_freep(&m_audioBuffer);
+        m_audioBufferSamples = 0;
+    }
 }
@@ -3,42 +3,198 @@
 
 #include <QThread>
 #include <QMutex>
+#include <QWaitCondition>
 #include <QImage>
+#include <QElapsedTimer>
 #include <QString>
+#include <QTimer>
 #include <atomic>
 #include <functional>
+#include <memory>
+
+#include "framequeue.h"
+#include "blockingqueue.h"
+#include "decoderoptions.h"
+#include "playbackclock.h"
+#include "framepacer.h"
+#include "keyframeindex.h"
+#include "readaheadio.h"
+#include "mappedfileio.h"
+#include "probecache.h"
+#include "pipelinemetrics.h"
+#include "scaletarget.h"
+#include "yuvconvert.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
 #include <libswscale/swscale.h>
+#include <libswresample/swresample.h>
 #include <libavutil/imgutils.h>
 }
 
+class AudioOutput;
+
+// 解码流水线：本线程（run）负责解复用，另起解码线程和转换线程，
+// 阶段之间通过有界队列衔接，网络读取抖动与解码耗时互不阻塞。
 class VideoDecoder : public QThread
 {
     Q_OBJECT
 public:
+    // 写入 FrameQueue 的像素格式；frameDecoded 信号始终输出 RGB
+    // （YUV420P/NV12 源为 RGBA8888，其余为 RGB888）
+    enum class OutputFormat {
+        Rgb,    // YUV420P/NV12 源由 YuvConverter 转 RGBA，其余经 sws_scale 转 RGB24
+        Yuv     // YUV420P/NV12 原样交给渲染端，由着色器做色彩转换
+    };
+
+    // 各阶段输入队列当前深度
+    struct QueueDepths {
+        int packets = 0;        // 解复用 → 解码
+        int decodedFrames = 0;  // 解码 → 转换
+        int outputFrames = 0;   // 转换 → 渲染（FrameQueue）
+    };
+
+    enum class SeekMode {
+        Keyframe,   // 定位到不晚于目标的最近关键帧，最快，画面可能略早于目标
+        Accurate    // 从最近关键帧向后解码，目标之前的帧只解码不转换
+    };
+
+    // 启动各阶段耗时（毫秒），均从 startDecoding() 起算；尚未到达的阶段为 -1
+    struct StartupTiming {
+        double openMs = -1.0;              // avformat_open_input 返回
+        double probeMs = -1.0;             // 流参数就绪（探测完成或命中缓存）
+        double timeToFirstFrameMs = -1.0;  // 首帧交给输出端
+        bool probeCacheHit = false;
+    };
+
+    // 解码阶段耗时：send/receive 调用累计时间按输出帧摊分
+    struct DecodeTiming {
+        double lastFrameUs = 0.0;
+        double averageFrameUs = 0.0;
+        quint64 frames = 0;
+    };
+
     explicit VideoDecoder(QObject *parent = nullptr);
     ~VideoDecoder();
 
     void startDecoding(const QString &url);
     void stopDecoding();
 
+    // 任意线程调用，由解复用线程执行，不重新打开输入与解码器。
+    // position 为相对流起点的秒数；返回本次跳转的 serial，此后输出的帧带该 serial。
+    // 连续调用时只执行最后一次；读到结尾后仍可跳转
+    int seek(double position, SeekMode mode = SeekMode::Keyframe);
+
+    // 设置后解码帧写入队列，由渲染端按 pts 调度显示；为空时沿用 frameDecoded 信号
+    void setFrameQueue(FrameQueue *queue);
+
+    void setOutputFormat(OutputFormat format);
+    OutputFormat outputFormat() const { return m_outputFormat; }
+
+    // 显示区域像素尺寸，通常连接 RenderOpenGL::targetSizeChanged。任意线程调用，
+    // 转换阶段按该尺寸等比缩小输出（不放大），尺寸稳定一段时间后才重建缩放器；空尺寸恢复源分辨率
+    void setTargetSize(const QSize &size);
+    QSize targetSize() const { return m_scaleTarget.requested(); }
+
+    // 帧池统计，稳态播放时 allocations 应保持不变
+    FramePool::Stats framePoolStats() const;
+
+    QueueDepths queueDepths() const;
+
+    // 下次 startDecoding() 生效；Auto 项在打开解码器时按编码格式与分辨率确定
+    void setDecoderOptions(const DecoderOptions &options);
+    DecoderOptions decoderOptions() const;
+    // 当前流实际生效的配置（FFmpeg 不支持的线程模式会被回退）
+    DecoderOptions effectiveDecoderOptions() const;
+    DecodeTiming decodeTiming() const;
+
+    // 音频解码输出，同时作为主时钟；下次 startDecoding() 生效
+    void setAudioEnabled(bool enabled);
+    bool audioEnabled() const { return m_audioEnabled; }
+
+    // 播放主时钟：有音频时由音频设备驱动，渲染端应与之同步
+    PlaybackClock *clock() { return &m_clock; }
+
+    // 网络输入经预读线程与环形缓冲读取，吸收网络抖动；本地文件不受影响。下次 startDecoding() 生效
+    void setReadAheadEnabled(bool enabled);
+    void setReadAheadOptions(const ReadAheadIO::Options &options);
+    ReadAheadIO::Stats readAheadStats() const;
+
+    // 本地文件经内存映射读取，映射失败时自动退回 FFmpeg file 协议。下次 startDecoding() 生效
+    void setMappedInputEnabled(bool enabled);
+    MappedFileIO::Stats mappedInputStats() const;
+
+    // 低延迟打开：缩小探测量与分析时长、关闭解复用缓冲、解码器启用低延迟标志，
+    // 预读不攒预缓冲。适合直播，点播文件可能因探测不足拿不到完整流信息。下次 startDecoding() 生效
+    void setLowLatency(bool enabled);
+    bool lowLatency() const { return m_lowLatency; }
+
+    // 打开过的源记录探测结果，再次打开时跳过 avformat_find_stream_info。下次 startDecoding() 生效
+    void setProbeCacheEnabled(bool enabled);
+
+    StartupTiming startupTiming() const;
+    double timeToFirstFrameMs() const { return startupTiming().timeToFirstFrameMs; }
+
+    // 流水线指标：任意线程可调用，不阻塞解码；队列深度为调用时刻的采样
+    PipelineMetrics::Snapshot metricsSnapshot() const;
+    // metricsUpdated 的发出间隔，仅在有连接时计时
+    void setMetricsInterval(int ms);
+
+    // 晚于主时钟超过该值（秒）的帧在转换前丢弃，<= 0 表示不丢帧；直播建议 0.1 左右
+    void setLateFrameThreshold(double seconds);
+    FramePacer::Stats pacerStats() const;
+
 signals:
     void frameDecoded(const QImage &frame);
+    void frameQueued();   // 队列由空变为非空时发出，用于唤醒渲染端
     void decodingFailed(const QString &reason);
+    void endOfStream();   // 最后一帧已交给输出端，流水线保持打开等待跳转
+    // 每隔 setMetricsInterval() 发出一次（默认 1 秒），在 VideoDecoder 所属线程发出
+    void metricsUpdated(const PipelineMetrics::Snapshot &snapshot);
 
 protected:
     void run() override;
+    void connectNotify(const QMetaMethod &signal) override;
+    void disconnectNotify(const QMetaMethod &signal) override;
 
 private:
-    QElapsedTimer playbackTimer_;
-    double firstPts_ = -1.0;
-
     QString m_url;
     std::atomic<bool> m_stopped = false;
     QMutex m_mutex;
+    FrameQueue *m_frameQueue = nullptr;
+    std::shared_ptr<FramePool> m_framePool;
+    std::atomic<OutputFormat> m_outputFormat{OutputFormat::Yuv};
+    PlaybackClock m_clock;
+
+    mutable QMutex m_optionsMutex;
+    DecoderOptions m_decoderOptions;
+    DecoderOptions m_effectiveOptions;
+    ReadAheadIO::Options m_readAheadOptions;
+    std::atomic<bool> m_readAheadEnabled{true};
+    ReadAheadIO m_readAhead;
+    bool m_readAheadActive = false;
+    std::atomic<bool> m_mappedInputEnabled{true};
+    MappedFileIO m_mappedInput;
+    bool m_mappedInputActive = false;
+
+    std::atomic<bool> m_lowLatency{false};
+    std::atomic<bool> m_probeCacheEnabled{true};
+
+    // 启动耗时（ns，-1 表示未到达）
+    QElapsedTimer m_startupTimer;
+    std::atomic<qint64> m_openNs{-1};
+    std::atomic<qint64> m_probeNs{-1};
+    std::atomic<qint64> m_firstFrameNs{-1};
+    std::atomic<bool> m_probeCacheHit{false};
+
+    ScaleTarget m_scaleTarget;
+    PipelineMetrics m_metrics;
+    QTimer *m_metricsTimer = nullptr;
+
+    std::atomic<qint64> m_lastDecodeNs{0};
+    std::atomic<qint64> m_totalDecodeNs{0};
+    std::atomic<quint64> m_decodedFrames{0};
 
     AVFormatContext *m_formatCtx = nullptr;
     AVCodecContext *m_codecCtx = nullptr;
@@ -46,9 +202,66 @@ private:
     AVFrame *m_frame = nullptr;
     AVPacket *m_packet = nullptr;
     SwsContext *m_swsCtx = nullptr;
+    YuvConverter::Workspace m_yuvWorkspace;     // 仅转换线程使用
     int m_videoStreamIndex = -1;
 
+    PacketQueue m_packetQueue;
+    DecodedFrameQueue m_decodedQueue;
+    PacketShellPool m_packetShells;
+    FrameShellPool m_frameShells;
+
+    // 音频
+    AudioOutput *m_audioOutput = nullptr;
+    std::atomic<bool> m_audioEnabled{true};
+    int m_audioStreamIndex = -1;
+    AVCodecContext *m_audioCodecCtx = nullptr;
+    SwrContext *m_swrCtx = nullptr;
+    AVFrame *m_audioFrame = nullptr;
+    PacketQueue m_audioPacketQueue;
+    uint8_t *m_audioBuffer = nullptr;
+    int m_audioBufferSamples = 0;
+    double m_nextAudioPts = 0.0;
+
+    FramePacer m_pacer;
+
+    // 跳转
+    struct SeekRequest {
+        double position = 0.0;
+        SeekMode mode = SeekMode::Keyframe;
+        int serial = 0;
+    };
+    QMutex m_seekMutex;
+    QWaitCondition m_seekCond;
+    SeekRequest m_seekRequest;
+    std::atomic<bool> m_seekPending{false};
+    std::atomic<int> m_requestSerial{0};   // seek() 分配
+    std::atomic<int> m_serial{0};          // 解复用已执行的跳转
+    std::atomic<double> m_skipUntil{-1.0}; // 精确跳转目标 pts（秒），之前的帧丢弃
+    KeyframeIndex m_keyframeIndex;
+
+    bool openInput();
+    bool probeStreams();
+    void recordFirstFrame();
+    bool openAudio();
+    void demuxLoop();
+    bool takeSeekRequest(bool wait, SeekRequest *out);
+    void performSeek(const SeekRequest &request);
+    void decodeLoop();
+    void audioDecodeLoop();
+    bool writeAudioFrame(AVFrame *frame);
+    void convertLoop();
+    void convertFrame(AVFrame *frame, int serial);
+    double framePts(const AVFrame *frame, int streamIndex) const;
+
     void cleanup();
+    bool enqueueFrame(VideoFrame &&frame);
+    void updateMetricsTimer();
+    FrameRef acquireBuffer();
+    static QImage wrapImage(FrameRef buffer);
+    static int interruptCallback(void *opaque);
+    static bool isPassthroughFormat(AVPixelFormat format);
+    static bool isNetworkUrl(const QString &url);
+    static QString localFilePath(const QString &url);
 };
 
 #endif // VIDEODECODE_H
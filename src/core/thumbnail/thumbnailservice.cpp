@@ -0,0 +1,341 @@
+#include "thumbnailservice.h"
+#include "decoderoptions.h"
+#include "type.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+namespace {
+
+constexpr int kMemoryCacheKb = 32 * 1024;
+constexpr qint64 kFingerprintChunk = 64 * 1024;
+// 关键帧稀疏或文件损坏时的读包上限，防止单个请求长期占用线程
+constexpr int kMaxPackets = 4096;
+constexpr int kJpegQuality = 85;
+
+// 路径 + 大小 + 修改时间，用于记住已经算过的内容指纹
+QString identityOf(const QFileInfo &info)
+{
+    return info.absoluteFilePath() + '|' + QString::number(info.size()) + '|'
+           + QString::number(info.lastModified().toMSecsSinceEpoch());
+}
+
+// 一次提取所需的 FFmpeg 对象，析构时统一释放
+struct ExtractContext {
+    AVFormatContext *format = nullptr;
+    AVCodecContext *codec = nullptr;
+    AVPacket *packet = nullptr;
+    AVFrame *frame = nullptr;
+    SwsContext *sws = nullptr;
+
+    ~ExtractContext()
+    {
+        sws_freeContext(sws);
+        av_frame_free(&frame);
+        av_packet_free(&packet);
+        avcodec_free_context(&codec);
+        avformat_close_input(&format);
+    }
+};
+
+// 按显示宽高比等比缩放到 maxSize 以内，不放大
+QSize fittedSize(const AVFrame *frame, const QSize &maxSize)
+{
+    double displayWidth = frame->width;
+    if (frame->sample_aspect_ratio.num > 0 && frame->sample_aspect_ratio.den > 0)
+        displayWidth *= av_q2d(frame->sample_aspect_ratio);
+
+    const double scale = std::min({ maxSize.width() / displayWidth,
+                                    maxSize.height() / double(frame->height),
+                                    1.0 });
+    return QSize(std::max(1, int(std::lround(displayWidth * scale))),
+                 std::max(1, int(std::lround(frame->height * scale))));
+}
+
+}
+
+ThumbnailService::ThumbnailService(int maxThreads, QObject *parent)
+    : QObject(parent)
+    , m_memory(kMemoryCacheKb)
+{
+    if (maxThreads <= 0)
+        maxThreads = std::max(1, QThread::idealThreadCount() / 2);
+    m_pool.setMaxThreadCount(maxThreads);
+}
+
+ThumbnailService::~ThumbnailService()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+bool ThumbnailService::lookup(const QString &path, double position, const QSize &maxSize, QImage *out)
+{
+    const QString identity = identityOf(QFileInfo(path));
+
+    QMutexLocker locker(&m_mutex);
+    const auto fingerprint = m_fingerprints.constFind(identity);
+    if (fingerprint == m_fingerprints.constEnd())
+        return false;
+
+    const QImage *image = m_memory.object(cacheKey(*fingerprint, position, maxSize));
+    if (!image)
+        return false;
+
+    *out = *image;
+    m_memoryHits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+quint64 ThumbnailService::request(const QString &path, double position, const QSize &maxSize)
+{
+    const quint64 id = m_nextId.fetch_add(1, std::memory_order_relaxed);
+
+    QImage image;
+    if (lookup(path, position, maxSize, &image)) {
+        QMetaObject::invokeMethod(this, [this, id, path, position, image]() {
+            emit thumbnailReady(id, path, position, image);
+        }, Qt::QueuedConnection);
+        return id;
+    }
+
+    const Job job{ id, path, position, maxSize };
+    m_pool.start([this, job]() { run(job); });
+    return id;
+}
+
+QVector<quint64> ThumbnailService::requestStrip(const QString &path, double duration, int count,
+                                                const QSize &maxSize)
+{
+    QVector<quint64> ids;
+    if (duration <= 0.0 || count <= 0)
+        return ids;
+
+    ids.reserve(count);
+    for (int i = 0; i < count; ++i)
+        ids.append(request(path, (i + 0.5) * duration / count, maxSize));
+    return ids;
+}
+
+void ThumbnailService::clearMemoryCache()
+{
+    QMutexLocker locker(&m_mutex);
+    m_memory.clear();
+}
+
+ThumbnailService::Stats ThumbnailService::stats() const
+{
+    Stats stats;
+    stats.memoryHits = m_memoryHits.load(std::memory_order_relaxed);
+    stats.diskHits = m_diskHits.load(std::memory_order_relaxed);
+    stats.decodes = m_decodes.load(std::memory_order_relaxed);
+    stats.failures = m_failures.load(std::memory_order_relaxed);
+    if (stats.decodes > 0)
+        stats.averageDecodeMs = m_decodeNs.load(std::memory_order_relaxed) / 1e6 / stats.decodes;
+    return stats;
+}
+
+// --- 工作线程 ---
+void ThumbnailService::run(const Job &job)
+{
+    const QString fingerprint = fingerprintFor(job.path);
+    if (fingerprint.isEmpty()) {
+        m_failures.fetch_add(1, std::memory_order_relaxed);
+        emit thumbnailFailed(job.id, job.path, job.position);
+        return;
+    }
+
+    const QString key = cacheKey(fingerprint, job.position, job.maxSize);
+    {
+        QMutexLocker locker(&m_mutex);
+        if (const QImage *image = m_memory.object(key)) {
+            const QImage copy = *image;
+            locker.unlock();
+            m_memoryHits.fetch_add(1, std::memory_order_relaxed);
+            emit thumbnailReady(job.id, job.path, job.position, copy);
+            return;
+        }
+
+        auto inflight = m_inflight.find(key);
+        if (inflight != m_inflight.end()) {
+            inflight->append(job);
+            return;
+        }
+        m_inflight.insert(key, QVector<Job>{ job });
+    }
+
+    const QString file = diskPath(key);
+    QImage image;
+    if (image.load(file, "JPG")) {
+        m_diskHits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        QElapsedTimer timer;
+        timer.start();
+        image = extract(job.path, job.position, job.maxSize);
+        m_decodeNs.fetch_add(timer.nsecsElapsed(), std::memory_order_relaxed);
+        m_decodes.fetch_add(1, std::memory_order_relaxed);
+
+        if (!image.isNull()) {
+            zg::path::ensureDir(QFileInfo(file).absolutePath());
+            QSaveFile out(file);
+            if (out.open(QIODevice::WriteOnly) && image.save(&out, "JPG", kJpegQuality))
+                out.commit();
+            else
+                qWarning() << "Failed to write thumbnail cache" << file;
+        }
+    }
+
+    finish(key, image);
+}
+
+void ThumbnailService::finish(const QString &key, const QImage &image)
+{
+    QVector<Job> waiters;
+    {
+        QMutexLocker locker(&m_mutex);
+        waiters = m_inflight.take(key);
+        if (!image.isNull())
+            m_memory.insert(key, new QImage(image), std::max<qsizetype>(1, image.sizeInBytes() / 1024));
+    }
+
+    for (const Job &job : std::as_const(waiters)) {
+        if (image.isNull()) {
+            m_failures.fetch_add(1, std::memory_order_relaxed);
+            emit thumbnailFailed(job.id, job.path, job.position);
+        } else {
+            emit thumbnailReady(job.id, job.path, job.position, image);
+        }
+    }
+}
+
+QString ThumbnailService::fingerprintFor(const QString &path)
+{
+    const QFileInfo info(path);
+    if (!info.isFile())
+        return QString();
+
+    const QString identity = identityOf(info);
+    {
+        QMutexLocker locker(&m_mutex);
+        const auto it = m_fingerprints.constFind(identity);
+        if (it != m_fingerprints.constEnd())
+            return *it;
+    }
+
+    // 只读首尾各 64 KiB 与文件大小：改名、移动后仍能命中，大文件也无需整读
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(file.read(kFingerprintChunk));
+    if (info.size() > 2 * kFingerprintChunk && file.seek(info.size() - kFingerprintChunk))
+        hash.addData(file.read(kFingerprintChunk));
+    const QString fingerprint = QString::fromLatin1(hash.result().toHex());
+
+    QMutexLocker locker(&m_mutex);
+    m_fingerprints.insert(identity, fingerprint);
+    return fingerprint;
+}
+
+QString ThumbnailService::cacheKey(const QString &fingerprint, double position, const QSize &maxSize)
+{
+    // 时间点按 100ms 取整，拖动进度条时相邻请求可以复用
+    const QString source = fingerprint + '|' + QString::number(std::llround(position * 10.0)) + '|'
+                           + QString::number(maxSize.width()) + 'x' + QString::number(maxSize.height());
+    return QString::fromLatin1(QCryptographicHash::hash(source.toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+
+QString ThumbnailService::diskPath(const QString &key)
+{
+    // 按前两位分目录，避免单目录文件过多
+    return zg::path::thumbnailCacheDir() + '/' + key.left(2) + '/' + key + ".jpg";
+}
+
+QImage ThumbnailService::extract(const QString &path, double position, const QSize &maxSize)
+{
+    ExtractContext ctx;
+    if (avformat_open_input(&ctx.format, path.toStdString().c_str(), nullptr, nullptr) != 0)
+        return QImage();
+    if (avformat_find_stream_info(ctx.format, nullptr) < 0)
+        return QImage();
+
+    const int index = av_find_best_stream(ctx.format, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (index < 0)
+        return QImage();
+
+    AVStream *stream = ctx.format->streams[index];
+    const AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    if (!codec)
+        return QImage();
+
+    ctx.codec = avcodec_alloc_context3(codec);
+    if (avcodec_parameters_to_context(ctx.codec, stream->codecpar) < 0)
+        return QImage();
+
+    // 并行度来自线程池里的多个请求，单个解码器不再开内部线程
+    DecoderOptions options;
+    options.threadCount = 1;
+    options.resolved(stream->codecpar->codec_id, stream->codecpar->width, stream->codecpar->height)
+        .applyTo(ctx.codec);
+    ctx.codec->skip_frame = AVDISCARD_NONKEY;
+
+    if (avcodec_open2(ctx.codec, codec, nullptr) < 0)
+        return QImage();
+
+    const double timeBase = av_q2d(stream->time_base);
+    const double startSec = stream->start_time != AV_NOPTS_VALUE ? stream->start_time * timeBase : 0.0;
+    const int64_t target = static_cast<int64_t>(std::llround((startSec + std::max(0.0, position)) / timeBase));
+    if (position > 0.0)
+        avformat_seek_file(ctx.format, index, INT64_MIN, target, target, 0);
+
+    ctx.packet = av_packet_alloc();
+    ctx.frame = av_frame_alloc();
+
+    bool decoded = false;
+    for (int read = 0; read < kMaxPackets && !decoded; ++read) {
+        const bool endOfFile = av_read_frame(ctx.format, ctx.packet) < 0;
+        if (!endOfFile && (ctx.packet->stream_index != index || !(ctx.packet->flags & AV_PKT_FLAG_KEY))) {
+            av_packet_unref(ctx.packet);
+            continue;
+        }
+
+        avcodec_send_packet(ctx.codec, endOfFile ? nullptr : ctx.packet);
+        av_packet_unref(ctx.packet);
+        decoded = avcodec_receive_frame(ctx.codec, ctx.frame) == 0;
+        if (endOfFile)
+            break;
+    }
+    if (!decoded)
+        return QImage();
+
+    // 缩放与 RGB 转换一步完成，直接写入 QImage 的像素内存
+    const QSize size = fittedSize(ctx.frame, maxSize);
+    ctx.sws = sws_getContext(ctx.frame->width, ctx.frame->height,
+                             static_cast<AVPixelFormat>(ctx.frame->format),
+                             size.width(), size.height(), AV_PIX_FMT_RGB24,
+                             SWS_AREA, nullptr, nullptr, nullptr);
+    if (!ctx.sws)
+        return QImage();
+
+    QImage image(size, QImage::Format_RGB888);
+    uint8_t *dst[4] = { image.bits(), nullptr, nullptr, nullptr };
+    int dstLinesize[4] = { static_cast<int>(image.bytesPerLine()), 0, 0, 0 };
+    sws_scale(ctx.sws, ctx.frame->data, ctx.frame->linesize, 0, ctx.frame->height, dst, dstLinesize);
+    return image;
+}
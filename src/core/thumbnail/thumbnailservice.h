@@ -0,0 +1,82 @@
+#ifndef THUMBNAILSERVICE_H
+#define THUMBNAILSERVICE_H
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+
+// 缩略图服务：只解码关键帧（skip_frame = AVDISCARD_NONKEY），转换时直接缩放到目标尺寸，
+// 请求在独立线程池中并行执行。结果按内容指纹寻址缓存到 zg::path::thumbnailCacheDir()，
+// 同时保留一份内存缓存，重复请求不再打开 FFmpeg。仅支持本地文件。
+class ThumbnailService : public QObject
+{
+    Q_OBJECT
+public:
+    struct Stats {
+        quint64 memoryHits = 0;
+        quint64 diskHits = 0;
+        quint64 decodes = 0;
+        quint64 failures = 0;
+        double averageDecodeMs = 0.0;
+    };
+
+    // maxThreads <= 0 时取 CPU 核数的一半，避免与播放解码争抢
+    explicit ThumbnailService(int maxThreads = 0, QObject *parent = nullptr);
+    ~ThumbnailService() override;
+
+    // 只查内存缓存（仅 stat 一次文件），不读文件也不打开 FFmpeg；指纹尚未算过时返回 false
+    bool lookup(const QString &path, double position, const QSize &maxSize, QImage *out);
+
+    // 异步请求，结果通过 thumbnailReady / thumbnailFailed 发出；内存命中时也经由事件循环回调。
+    // position 单位为秒，结果为不晚于该时刻的最近关键帧，按 maxSize 等比缩放
+    quint64 request(const QString &path, double position, const QSize &maxSize = QSize(160, 90));
+
+    // 进度条预览：在 duration（秒，由调用方提供，避免在调用线程探测文件）内均匀取 count 张
+    QVector<quint64> requestStrip(const QString &path, double duration, int count,
+                                  const QSize &maxSize = QSize(160, 90));
+
+    void clearMemoryCache();
+    Stats stats() const;
+
+signals:
+    void thumbnailReady(quint64 id, const QString &path, double position, const QImage &image);
+    void thumbnailFailed(quint64 id, const QString &path, double position);
+
+private:
+    struct Job {
+        quint64 id = 0;
+        QString path;
+        double position = 0.0;
+        QSize maxSize;
+    };
+
+    QThreadPool m_pool;
+    mutable QMutex m_mutex;
+    QCache<QString, QImage> m_memory;                 // 缓存键 → 缩略图
+    QHash<QString, QString> m_fingerprints;           // 路径|大小|修改时间 → 内容指纹
+    QHash<QString, QVector<Job>> m_inflight;          // 同一缩略图的并发请求只解码一次
+    std::atomic<quint64> m_nextId{1};
+
+    std::atomic<quint64> m_memoryHits{0};
+    std::atomic<quint64> m_diskHits{0};
+    std::atomic<quint64> m_decodes{0};
+    std::atomic<quint64> m_failures{0};
+    std::atomic<qint64> m_decodeNs{0};
+
+    void run(const Job &job);
+    void finish(const QString &key, const QImage &image);
+    QString fingerprintFor(const QString &path);
+
+    static QString cacheKey(const QString &fingerprint, double position, const QSize &maxSize);
+    static QString diskPath(const QString &key);
+    static QImage extract(const QString &path, double position, const QSize &maxSize);
+};
+
+#endif // THUMBNAILSERVICE_H
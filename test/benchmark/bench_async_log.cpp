@@ -0,0 +1,189 @@
+// 异步日志基准：1 个与 4 个线程各写入固定条数的日志（约 80 字节一条，落到临时目录下的文件），
+// 比较同步 file sink、spdlog 自带的 async_logger 与 zg::log::AsyncLogBackend 三种溢出策略下
+// 调用线程单条耗时的分位数、总吞吐以及丢弃条数。环容量取得比单线程写入量小，使溢出策略真正起作用。
+// 用法：bench_async_log [--quick] [--capacity <n>] [--output <file>]，结果为 JSON。
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <spdlog/async.h>
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "asynclog.h"
+
+namespace {
+
+struct Sample {
+    std::vector<qint64> callNs;
+    qint64 elapsedNs = 0;
+};
+
+QJsonObject percentiles(std::vector<qint64> samples)
+{
+    QJsonObject object;
+    if (samples.empty())
+        return object;
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](double q) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()))];
+    };
+    double sum = 0.0;
+    for (qint64 ns : samples)
+        sum += ns;
+    object["mean_ns"] = sum / samples.size();
+    object["p50_ns"] = at(0.50);
+    object["p99_ns"] = at(0.99);
+    object["p999_ns"] = at(0.999);
+    object["max_ns"] = samples.back();
+    return object;
+}
+
+// 各线程同时开始写 perThread 条，记录每次调用的耗时；flush 计入总耗时
+Sample hammer(spdlog::logger &logger, int threads, int perThread)
+{
+    std::vector<std::vector<qint64>> perThreadNs(threads);
+    std::vector<std::thread> workers;
+    QElapsedTimer wall;
+    wall.start();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&logger, &perThreadNs, t, perThread]() {
+            std::vector<qint64> &ns = perThreadNs[t];
+            ns.reserve(perThread);
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < perThread; ++i) {
+                const qint64 begin = timer.nsecsElapsed();
+                logger.info("decoder thread {} frame {} pts {:.3f} queue {} / {}", t, i, i / 30.0, i % 64, 64);
+                ns.push_back(timer.nsecsElapsed() - begin);
+            }
+        });
+    }
+    for (std::thread &worker : workers)
+        worker.join();
+    logger.flush();
+
+    Sample sample;
+    sample.elapsedNs = wall.nsecsElapsed();
+    for (const std::vector<qint64> &ns : perThreadNs)
+        sample.callNs.insert(sample.callNs.end(), ns.begin(), ns.end());
+    return sample;
+}
+
+QJsonObject report(const char *method, int threads, const Sample &sample, qint64 dropped)
+{
+    QJsonObject object;
+    object["method"] = method;
+    object["threads"] = threads;
+    object["messages"] = static_cast<qint64>(sample.callNs.size());
+    object["dropped"] = dropped;
+    object["elapsed_ms"] = sample.elapsedNs / 1e6;
+    object["messages_per_second"] = sample.elapsedNs > 0 ? sample.callNs.size() * 1e9 / sample.elapsedNs : 0.0;
+    object["call"] = percentiles(sample.callNs);
+    return object;
+}
+
+spdlog::sink_ptr fileSink(const QTemporaryDir &dir, const QString &name)
+{
+    auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(dir.filePath(name).toStdString(), true);
+    sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] [%t] %v");
+    return sink;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const bool quick = args.contains("--quick");
+    auto option = [&args](const char *name, const QString &fallback) {
+        const int index = args.indexOf(name);
+        return index >= 0 && index + 1 < args.size() ? args.at(index + 1) : fallback;
+    };
+    const int capacity = std::max(2, option("--capacity", "8192").toInt());
+    const QString outputPath = option("--output", QString());
+    const int perThread = quick ? 20000 : 200000;
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        std::fprintf(stderr, "cannot create temporary directory\n");
+        return 1;
+    }
+
+    struct Policy {
+        const char *name;
+        zg::log::OverflowPolicy policy;
+    };
+    const Policy policies[] = {
+        { "zg_async_block", zg::log::OverflowPolicy::Block },
+        { "zg_async_drop_oldest", zg::log::OverflowPolicy::DropOldest },
+        { "zg_async_drop_newest", zg::log::OverflowPolicy::DropNewest },
+    };
+
+    QJsonArray results;
+    int run = 0;
+    for (int threads : { 1, 4 }) {
+        {
+            spdlog::logger logger("bench", fileSink(dir, QString("sync_%1.log").arg(run++)));
+            results.append(report("spdlog_sync", threads, hammer(logger, threads, perThread), 0));
+        }
+
+        for (auto overflow : { spdlog::async_overflow_policy::block, spdlog::async_overflow_policy::overrun_oldest }) {
+            auto pool = std::make_shared<spdlog::details::thread_pool>(capacity, 1);
+            auto logger = std::make_shared<spdlog::async_logger>(
+                "bench", fileSink(dir, QString("spdlog_async_%1.log").arg(run++)), pool, overflow);
+            Sample sample = hammer(*logger, threads, perThread);
+            // async_logger::flush 只是把 flush 请求入队，销毁线程池时才写完剩余消息，这段时间也计入总耗时
+            QElapsedTimer drain;
+            drain.start();
+            logger.reset();
+            const qint64 dropped = static_cast<qint64>(pool->overrun_counter());
+            pool.reset();
+            sample.elapsedNs += drain.nsecsElapsed();
+            results.append(report(overflow == spdlog::async_overflow_policy::block
+                                      ? "spdlog_async_block" : "spdlog_async_overrun_oldest",
+                                  threads, sample, dropped));
+        }
+
+        for (const Policy &policy : policies) {
+            zg::log::AsyncOptions options;
+            options.capacity = capacity;
+            options.overflow = policy.policy;
+            auto backend = std::make_shared<zg::log::AsyncLogBackend>(options);
+            const int route = backend->addRoute({ fileSink(dir, QString("zg_async_%1.log").arg(run++)) });
+            backend->start();
+            spdlog::logger logger("bench", std::make_shared<zg::log::AsyncLogSink>(backend, route));
+            const Sample sample = hammer(logger, threads, perThread);
+            backend->stop();
+            results.append(report(policy.name, threads, sample, static_cast<qint64>(backend->stats().dropped)));
+        }
+    }
+
+    QJsonObject output;
+    output["benchmark"] = "async_log";
+    output["quick"] = quick;
+    output["capacity"] = capacity;
+    output["messages_per_thread"] = perThread;
+    output["results"] = results;
+
+    const QByteArray json = QJsonDocument(output).toJson(QJsonDocument::Indented);
+    if (!outputPath.isEmpty()) {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(outputPath));
+            return 1;
+        }
+        file.write(json);
+    }
+    std::printf("%s\n", json.constData());
+    return 0;
+}
@@ -0,0 +1,132 @@
+// 弹幕叠加层基准：offscreen 平台上 RenderOpenGL 同时显示 N 条滚动弹幕时的每帧耗时。
+// 用法：bench_danmu [--comments <n>] [--frames <n>] [--software] [--output <file>]，结果为 JSON。
+// --software 强制使用软件 OpenGL（Mesa llvmpipe），检验无独显环境下的表现。
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <cstdio>
+
+#include "renderopengl.h"
+
+namespace {
+
+constexpr double kTargetFrameUs = 1e6 / 60.0;
+
+QString argValue(const QStringList &args, const QString &name, const QString &fallback)
+{
+    const int index = args.indexOf(name);
+    return index >= 0 && index + 1 < args.size() ? args.at(index + 1) : fallback;
+}
+
+// 中英混排、长短不一，字形种类接近真实直播间
+QString randomComment(QRandomGenerator &rng)
+{
+    static const QStringList words = {
+        QStringLiteral("哈哈哈"), QStringLiteral("前方高能"), QStringLiteral("666"), QStringLiteral("awsl"),
+        QStringLiteral("来了来了"), QStringLiteral("主播好"), QStringLiteral("yyds"), QStringLiteral("打卡"),
+        QStringLiteral("这波可以"), QStringLiteral("GG"), QStringLiteral("名场面"), QStringLiteral("泪目"),
+        QStringLiteral("？？？"), QStringLiteral("233333"), QStringLiteral("下次一定"), QStringLiteral("nice"),
+    };
+    QString text;
+    const int parts = 1 + rng.bounded(4);
+    for (int i = 0; i < parts; ++i)
+        text += words.at(rng.bounded(words.size()));
+    return text;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    bool software = false;
+    for (int i = 1; i < argc; ++i)
+        software = software || qstrcmp(argv[i], "--software") == 0;
+    if (software) {
+        qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+        QCoreApplication::setAttribute(Qt::AA_UseSoftwareOpenGL);
+    }
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const int comments = std::max(1, argValue(args, "--comments", "5000").toInt());
+    const int frames = std::max(10, argValue(args, "--frames", "300").toInt());
+    const QString outputPath = argValue(args, "--output", QString());
+
+    RenderOpenGL view;
+    view.resize(1920, 1080);
+    view.show();
+    view.grabFramebuffer();
+    if (!view.isValid()) {
+        std::fprintf(stderr, "no OpenGL 4.3 context on platform %s\n", qPrintable(app.platformName()));
+        return 1;
+    }
+
+    view.makeCurrent();
+    QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
+    const QString renderer = reinterpret_cast<const char *>(gl->glGetString(GL_RENDERER));
+    view.doneCurrent();
+
+    // 时长足够长，测量期间所有弹幕都在屏上
+    DanmuOverlay *overlay = view.danmuOverlay();
+    overlay->setDuration(600.0);
+    QRandomGenerator rng(2024);
+    QElapsedTimer addTimer;
+    addTimer.start();
+    for (int i = 0; i < comments; ++i) {
+        const QColor color = i % 5 == 0 ? QColor::fromHsv(rng.bounded(360), 200, 255) : QColor(Qt::white);
+        overlay->add(randomComment(rng), color, rng.bounded(1080 - overlay->lineHeight()));
+    }
+    const double addUs = addTimer.nsecsElapsed() / 1000.0 / comments;
+
+    // 首帧包含图集与实例缓冲的整体上传，单独记录
+    QElapsedTimer timer;
+    timer.start();
+    view.grabFramebuffer();
+    const double firstFrameUs = timer.nsecsElapsed() / 1000.0;
+
+    const DanmuOverlay::Stats before = overlay->stats();
+    timer.start();
+    for (int i = 0; i < frames; ++i)
+        view.grabFramebuffer();
+    const double frameUs = timer.nsecsElapsed() / 1000.0 / frames;
+    const DanmuOverlay::Stats after = overlay->stats();
+
+    QJsonObject report;
+    report["benchmark"] = "danmu";
+    report["platform"] = app.platformName();
+    report["renderer"] = renderer;
+    report["software"] = software;
+    report["surface"] = QString("%1x%2").arg(view.width()).arg(view.height());
+    report["comments"] = after.comments;
+    report["glyph_instances"] = after.glyphInstances;
+    report["atlas_glyphs"] = after.atlasGlyphs;
+    report["add_us_per_comment"] = addUs;
+    report["first_frame_us"] = firstFrameUs;
+    report["frames"] = frames;
+    // 含 grabFramebuffer 的读回开销，是实际显示耗时的上界
+    report["frame_us"] = frameUs;
+    report["overlay_cpu_us"] = after.averageDrawUs;
+    report["bytes_uploaded_per_frame"] = double(after.uploadedBytes - before.uploadedBytes) / frames;
+    report["meets_60fps"] = frameUs <= kTargetFrameUs;
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (!outputPath.isEmpty()) {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(outputPath));
+            return 1;
+        }
+        file.write(json);
+    }
+    std::printf("%s\n", json.constData());
+    return 0;
+}
@@ -0,0 +1,189 @@
+// 弹幕去重基准：按固定速率（默认 20000 条/秒）在虚拟时钟上送入弹幕，其中一部分取自少量刷屏短语
+// （带大小写、全角、标点、重复字符等变体），每隔几秒有一段“高能”时刻刷屏比例升到 90%，其余为各不相同的文本。
+// 对若干窗口与容量组合给出省去的渲染条数、单条耗时分位数与占用内存；默认配置另以 UTF-8 输入跑一遍。
+// 用法：bench_danmu_dedup [--quick] [--rate <n>] [--output <file>]，结果为 JSON。
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "danmudedup.h"
+
+namespace {
+
+struct Arrival {
+    double time;
+    QString text;
+};
+
+const char16_t *const kHype[] = {
+    u"前方高能", u"哈哈哈", u"awsl", u"666", u"泪目", u"名场面", u"好活", u"下次一定",
+    u"爷青回", u"起飞", u"GG", u"nice", u"妙啊", u"笑死", u"破防了", u"2333",
+};
+
+// 同一短语的常见写法差异，归一化后应视为相同
+QString variant(QString text, std::mt19937 &rng)
+{
+    switch (std::uniform_int_distribution<int>(0, 5)(rng)) {
+    case 0:
+        text = text.toUpper();
+        break;
+    case 1:
+        text += QStringLiteral("！！");
+        break;
+    case 2:
+        text += text.back();
+        text += text.back();
+        break;
+    case 3:
+        text = QStringLiteral(" ") + text + QStringLiteral("~");
+        break;
+    default:
+        break;
+    }
+    return text;
+}
+
+std::vector<Arrival> makeWorkload(int rate, double seconds)
+{
+    std::mt19937 rng(2024);
+    std::uniform_int_distribution<int> hype(0, static_cast<int>(std::size(kHype)) - 1);
+    std::uniform_int_distribution<int> percent(0, 99);
+
+    const int count = static_cast<int>(rate * seconds);
+    std::vector<Arrival> arrivals;
+    arrivals.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const double time = double(i) / rate;
+        // 每 5 秒中有 1 秒为高能时刻
+        const int hypePercent = static_cast<int>(time) % 5 == 4 ? 90 : 40;
+        QString text;
+        if (percent(rng) < hypePercent)
+            text = variant(QString::fromUtf16(kHype[hype(rng)]), rng);
+        else
+            text = QStringLiteral("第%1条弹幕，来自%2").arg(i).arg(rng() % 100000);
+        arrivals.push_back({ time, text });
+    }
+    return arrivals;
+}
+
+QJsonObject percentiles(std::vector<qint64> samples)
+{
+    QJsonObject object;
+    if (samples.empty())
+        return object;
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](double q) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()))];
+    };
+    double sum = 0.0;
+    for (qint64 ns : samples)
+        sum += ns;
+    object["mean_ns"] = sum / samples.size();
+    object["p50_ns"] = at(0.50);
+    object["p99_ns"] = at(0.99);
+    object["max_ns"] = samples.back();
+    return object;
+}
+
+template <typename Text>
+QJsonObject run(const std::vector<Arrival> &arrivals, const std::vector<Text> &texts,
+                const DanmuDedup::Config &config, const char *input)
+{
+    DanmuDedup dedup(config);
+    std::vector<qint64> addNs;
+    addNs.reserve(arrivals.size());
+    int maxTracked = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (size_t i = 0; i < arrivals.size(); ++i) {
+        const qint64 begin = timer.nsecsElapsed();
+        dedup.add(i, texts[i], arrivals[i].time);
+        addNs.push_back(timer.nsecsElapsed() - begin);
+        if ((i & 1023) == 0)
+            maxTracked = std::max(maxTracked, dedup.stats().tracked);
+    }
+
+    const DanmuDedup::Stats stats = dedup.stats();
+    QJsonObject result;
+    result["input"] = input;
+    result["window_s"] = config.window;
+    result["capacity"] = config.capacity;
+    result["received"] = static_cast<qint64>(stats.received);
+    result["merged"] = static_cast<qint64>(stats.merged);
+    result["render_items"] = static_cast<qint64>(stats.received - stats.merged);
+    result["saved_ratio"] = stats.received > 0 ? double(stats.merged) / stats.received : 0.0;
+    result["evicted"] = static_cast<qint64>(stats.evicted);
+    result["max_tracked"] = maxTracked;
+    result["memory_bytes"] = static_cast<qint64>(stats.memoryBytes);
+    result["add"] = percentiles(addNs);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const bool quick = args.contains("--quick");
+    auto option = [&args](const char *name, const QString &fallback) {
+        const int index = args.indexOf(name);
+        return index >= 0 && index + 1 < args.size() ? args.at(index + 1) : fallback;
+    };
+    const int rate = std::max(1, option("--rate", "20000").toInt());
+    const double seconds = quick ? 5.0 : 20.0;
+    const QString outputPath = option("--output", QString());
+
+    const std::vector<Arrival> arrivals = makeWorkload(rate, seconds);
+    std::vector<QStringView> utf16;
+    std::vector<QByteArray> utf8Storage;
+    std::vector<QUtf8StringView> utf8;
+    utf16.reserve(arrivals.size());
+    utf8Storage.reserve(arrivals.size());
+    utf8.reserve(arrivals.size());
+    for (const Arrival &arrival : arrivals) {
+        utf16.emplace_back(arrival.text);
+        utf8Storage.push_back(arrival.text.toUtf8());
+        utf8.emplace_back(utf8Storage.back());
+    }
+
+    QJsonArray results;
+    for (double window : { 1.0, 3.0, 5.0 }) {
+        for (int capacity : { 1024, 4096, 16384 }) {
+            DanmuDedup::Config config;
+            config.window = window;
+            config.capacity = capacity;
+            results.append(run(arrivals, utf16, config, "utf16"));
+        }
+    }
+    results.append(run(arrivals, utf8, DanmuDedup::Config(), "utf8"));
+
+    QJsonObject report;
+    report["benchmark"] = "danmu_dedup";
+    report["quick"] = quick;
+    report["rate_per_second"] = rate;
+    report["seconds"] = seconds;
+    report["comments"] = static_cast<qint64>(arrivals.size());
+    report["results"] = results;
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (!outputPath.isEmpty()) {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(outputPath));
+            return 1;
+        }
+        file.write(json);
+    }
+    std::printf("%s\n", json.constData());
+    return 0;
+}
@@ -0,0 +1,218 @@
+// 弹幕排布基准：按固定速率（默认 20000 条/秒）在虚拟时钟上持续送入弹幕，逐条计时 DanmuLayout::place，
+// 给出放置耗时分位数与放下、丢弃、排队、超时条数；排队策略下另计每帧（60Hz）pump 的耗时。
+// 同一负载再交给逐条扫描在屏弹幕的朴素实现作对照（只排滚动弹幕、不排队）。
+// 计时包含一次 QElapsedTimer 读数的开销（通常几十 ns），只用于同机横向比较。
+// 用法：bench_danmu_layout [--quick] [--rate <n>] [--seconds <s>] [--output <file>]，结果为 JSON。
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "danmulayout.h"
+
+namespace {
+
+struct Arrival {
+    double time;
+    double width;
+    DanmuLayout::Mode mode;
+};
+
+// 宽度 50~650 像素；85% 滚动、10% 顶部、5% 底部
+std::vector<Arrival> makeWorkload(int rate, double seconds)
+{
+    std::mt19937 rng(2024);
+    std::uniform_real_distribution<double> width(50.0, 650.0);
+    std::uniform_int_distribution<int> mode(0, 99);
+
+    const int count = static_cast<int>(rate * seconds);
+    std::vector<Arrival> arrivals;
+    arrivals.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const int m = mode(rng);
+        arrivals.push_back({ double(i) / rate, width(rng),
+                             m < 85 ? DanmuLayout::Mode::Scroll : m < 95 ? DanmuLayout::Mode::Top : DanmuLayout::Mode::Bottom });
+    }
+    return arrivals;
+}
+
+QJsonObject percentiles(std::vector<qint64> samples)
+{
+    QJsonObject object;
+    if (samples.empty())
+        return object;
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](double q) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()))];
+    };
+    double sum = 0.0;
+    for (qint64 ns : samples)
+        sum += ns;
+    object["samples"] = static_cast<qint64>(samples.size());
+    object["mean_ns"] = sum / samples.size();
+    object["p50_ns"] = at(0.50);
+    object["p90_ns"] = at(0.90);
+    object["p99_ns"] = at(0.99);
+    object["p999_ns"] = at(0.999);
+    object["max_ns"] = samples.back();
+    return object;
+}
+
+QJsonObject runLayout(const std::vector<Arrival> &arrivals, DanmuLayout::OverflowPolicy policy)
+{
+    DanmuLayout::Config config;
+    config.overflow = policy;
+    DanmuLayout layout(config);
+
+    std::vector<qint64> placeNs;
+    std::vector<qint64> pumpNs;
+    placeNs.reserve(arrivals.size());
+    std::vector<DanmuLayout::Placement> placed;
+    DanmuLayout::Placement placement;
+    QElapsedTimer timer;
+    timer.start();
+
+    constexpr double kFrame = 1.0 / 60.0;
+    double nextFrame = kFrame;
+    for (size_t i = 0; i < arrivals.size(); ++i) {
+        const Arrival &arrival = arrivals[i];
+        while (arrival.time >= nextFrame) {
+            placed.clear();
+            const qint64 begin = timer.nsecsElapsed();
+            layout.pump(nextFrame, &placed);
+            pumpNs.push_back(timer.nsecsElapsed() - begin);
+            nextFrame += kFrame;
+        }
+        const qint64 begin = timer.nsecsElapsed();
+        layout.place(i, arrival.width, arrival.mode, arrival.time, &placement);
+        placeNs.push_back(timer.nsecsElapsed() - begin);
+    }
+
+    const DanmuLayout::Stats stats = layout.stats();
+    QJsonObject result;
+    result["policy"] = policy == DanmuLayout::OverflowPolicy::Drop ? "drop" : "queue";
+    result["lanes"] = layout.laneCount();
+    result["place"] = percentiles(placeNs);
+    if (policy == DanmuLayout::OverflowPolicy::Queue)
+        result["pump_per_frame"] = percentiles(pumpNs);
+    result["placed"] = static_cast<qint64>(stats.placed);
+    result["placed_from_queue"] = static_cast<qint64>(stats.placedFromQueue);
+    result["dropped"] = static_cast<qint64>(stats.dropped);
+    result["expired"] = static_cast<qint64>(stats.expired);
+    result["queued_at_end"] = stats.queued;
+    return result;
+}
+
+// 朴素实现：每行保存全部在屏弹幕，放置时逐条检查是否与新弹幕相撞
+QJsonObject runNaive(const std::vector<Arrival> &arrivals)
+{
+    const DanmuLayout::Config config;
+    const int lanes = config.height / config.lineHeight;
+    struct OnScreen {
+        double start;
+        double speed;
+        double width;
+    };
+    std::vector<std::vector<OnScreen>> rows(lanes);
+
+    std::vector<qint64> placeNs;
+    placeNs.reserve(arrivals.size());
+    qint64 placed = 0;
+    qint64 dropped = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    for (const Arrival &arrival : arrivals) {
+        if (arrival.mode != DanmuLayout::Mode::Scroll)
+            continue;
+        const qint64 begin = timer.nsecsElapsed();
+        const double now = arrival.time;
+        const double speed = (config.width + arrival.width) / config.scrollDuration;
+        bool done = false;
+        for (std::vector<OnScreen> &row : rows) {
+            row.erase(std::remove_if(row.begin(), row.end(),
+                                     [&](const OnScreen &c) { return c.start + config.scrollDuration < now; }),
+                      row.end());
+            bool fits = true;
+            for (const OnScreen &c : row) {
+                const double exit = c.start + config.scrollDuration;
+                if (c.speed * (now - c.start) < c.width + config.minGap
+                    || speed * (exit - now) > config.width - config.minGap) {
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits) {
+                row.push_back({ now, speed, arrival.width });
+                done = true;
+                break;
+            }
+        }
+        placeNs.push_back(timer.nsecsElapsed() - begin);
+        if (done)
+            ++placed;
+        else
+            ++dropped;
+    }
+
+    QJsonObject result;
+    result["policy"] = "naive_drop_scroll_only";
+    result["lanes"] = lanes;
+    result["place"] = percentiles(placeNs);
+    result["placed"] = placed;
+    result["dropped"] = dropped;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const bool quick = args.contains("--quick");
+    auto option = [&args](const char *name, const QString &fallback) {
+        const int index = args.indexOf(name);
+        return index >= 0 && index + 1 < args.size() ? args.at(index + 1) : fallback;
+    };
+    const int rate = std::max(1, option("--rate", "20000").toInt());
+    const double seconds = std::max(0.1, option("--seconds", quick ? "2" : "10").toDouble());
+    const QString outputPath = option("--output", QString());
+
+    const std::vector<Arrival> arrivals = makeWorkload(rate, seconds);
+
+    QJsonArray results;
+    results.append(runLayout(arrivals, DanmuLayout::OverflowPolicy::Drop));
+    results.append(runLayout(arrivals, DanmuLayout::OverflowPolicy::Queue));
+    results.append(runNaive(arrivals));
+
+    const DanmuLayout::Config config;
+    QJsonObject report;
+    report["benchmark"] = "danmu_layout";
+    report["quick"] = quick;
+    report["rate_per_second"] = rate;
+    report["seconds"] = seconds;
+    report["comments"] = static_cast<qint64>(arrivals.size());
+    report["screen"] = QString("%1x%2").arg(config.width).arg(config.height);
+    report["line_height"] = config.lineHeight;
+    report["results"] = results;
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (!outputPath.isEmpty()) {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(outputPath));
+            return 1;
+        }
+        file.write(json);
+    }
+    std::printf("%s\n", json.constData());
+    return 0;
+}
@@ -0,0 +1,232 @@
+// 弹幕传输格式基准：同一批合成弹幕分别编码为 protobuf（danmu.proto）与 JSON，各自带或不带按批 zlib 压缩，
+// 比较每条弹幕的平均线上字节数与客户端解码吞吐（条/秒）。两种格式都解码进同一个 DanmuArena，
+// JSON 一侧使用 QJsonDocument，每批前带 4 字节长度与 4 字节原始大小（与 Packet.raw_size 对应）。
+// 用法：bench_danmu_wire [--quick] [--output <file>]，结果为 JSON。
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <zlib.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "danmu.pb.h"
+#include "danmuloopback.h"
+#include "danmuwire.h"
+
+namespace {
+
+constexpr int kBatchSizes[] = { 1, 16, 64, 256 };
+
+QByteArray compressBatch(const QByteArray &raw)
+{
+    uLongf size = compressBound(static_cast<uLong>(raw.size()));
+    QByteArray out(static_cast<qsizetype>(size), Qt::Uninitialized);
+    compress2(reinterpret_cast<Bytef*>(out.data()), &size, reinterpret_cast<const Bytef*>(raw.constData()),
+              static_cast<uLong>(raw.size()), 6);
+    out.resize(static_cast<qsizetype>(size));
+    return out;
+}
+
+QByteArray toJson(const danmu::wire::Batch &batch)
+{
+    QJsonArray comments;
+    for (const danmu::wire::Comment &comment : batch.comments()) {
+        QJsonObject object;
+        object["id"] = static_cast<qint64>(comment.id());
+        object["t"] = static_cast<qint64>(comment.offset_ms());
+        object["mode"] = static_cast<int>(comment.mode());
+        if (comment.has_color())
+            object["color"] = static_cast<qint64>(comment.color());
+        object["user"] = QString::number(comment.user());   // 64 位整数超出 double 精度，按字符串传
+        object["text"] = QString::fromStdString(comment.text());
+        comments.append(object);
+    }
+    QJsonObject root;
+    root["seq"] = static_cast<qint64>(batch.sequence());
+    root["base"] = static_cast<qint64>(batch.base_time_ms());
+    root["comments"] = comments;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+void appendWord(QByteArray *stream, quint32 value)
+{
+    const char bytes[4] = { char(value), char(value >> 8), char(value >> 16), char(value >> 24) };
+    stream->append(bytes, 4);
+}
+
+quint32 readWord(const char *data)
+{
+    const uchar *p = reinterpret_cast<const uchar*>(data);
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (quint32(p[3]) << 24);
+}
+
+void appendFramed(QByteArray *stream, const QByteArray &payload, qsizetype rawSize)
+{
+    appendWord(stream, static_cast<quint32>(payload.size()));
+    appendWord(stream, static_cast<quint32>(rawSize));
+    stream->append(payload);
+}
+
+void decodeJson(const QByteArray &stream, bool compressed, DanmuArena *arena)
+{
+    QByteArray inflated;
+    for (qsizetype pos = 0; pos + 8 <= stream.size();) {
+        const quint32 size = readWord(stream.constData() + pos);
+        const quint32 rawSize = readWord(stream.constData() + pos + 4);
+        const char *payload = stream.constData() + pos + 8;
+        pos += 8 + size;
+
+        QJsonDocument document;
+        if (compressed) {
+            if (inflated.size() < rawSize)
+                inflated.resize(rawSize);
+            uLongf inflatedSize = rawSize;
+            uncompress(reinterpret_cast<Bytef*>(inflated.data()), &inflatedSize,
+                       reinterpret_cast<const Bytef*>(payload), size);
+            document = QJsonDocument::fromJson(QByteArray::fromRawData(inflated.constData(), inflatedSize));
+        } else {
+            document = QJsonDocument::fromJson(QByteArray::fromRawData(payload, size));
+        }
+
+        const QJsonObject root = document.object();
+        const qint64 base = root.value("base").toInteger();
+        const quint64 sequence = static_cast<quint64>(root.value("seq").toInteger());
+        for (const QJsonValue &value : root.value("comments").toArray()) {
+            const QJsonObject object = value.toObject();
+            DanmuArena::Comment &comment = arena->append();
+            comment.id = static_cast<quint64>(object.value("id").toInteger());
+            comment.timeMs = base + object.value("t").toInteger();
+            comment.mode = static_cast<DanmuArena::Mode>(object.value("mode").toInt());
+            comment.color = static_cast<quint32>(object.value("color").toInteger(0xFFFFFF));
+            comment.user = object.value("user").toString().toULongLong();
+            comment.batch = sequence;
+            const QByteArray text = object.value("text").toString().toUtf8();
+            comment.textOffset = arena->appendText(text.constData(), static_cast<int>(text.size()));
+            comment.textSize = static_cast<quint32>(text.size());
+        }
+    }
+}
+
+// 反复解码整段数据直到累计超过 minNs，返回条/秒
+template <typename Fn>
+double measureRate(Fn &&decode, int comments, qint64 minNs)
+{
+    decode();
+    QElapsedTimer timer;
+    timer.start();
+    qint64 total = 0;
+    do {
+        decode();
+        total += comments;
+    } while (timer.nsecsElapsed() < minNs);
+    return total * 1e9 / timer.nsecsElapsed();
+}
+
+QJsonObject runCase(int batchSize, int comments, qint64 minNs)
+{
+    const int batches = std::max(1, comments / batchSize);
+    comments = batches * batchSize;
+
+    DanmuLoopbackProducer::Options options;
+    options.batchSize = batchSize;
+    options.compress = false;
+    DanmuLoopbackProducer rawProducer(options);
+    options.compress = true;
+    DanmuLoopbackProducer zlibProducer(options);
+
+    QByteArray pbRaw;
+    QByteArray pbZlib;
+    QByteArray jsonRaw;
+    QByteArray jsonZlib;
+    for (int i = 0; i < batches; ++i) {
+        const qint64 base = qint64(i) * 1000;
+        rawProducer.produce(base, 1000, &pbRaw);
+        zlibProducer.produce(base, 1000, &pbZlib);
+        const QByteArray json = toJson(rawProducer.lastBatch());
+        appendFramed(&jsonRaw, json, json.size());
+        appendFramed(&jsonZlib, compressBatch(json), json.size());
+    }
+
+    DanmuArena arena;
+    arena.reserve(comments, comments * 32);
+    DanmuWireDecoder decoder;
+
+    struct Format {
+        const char *name;
+        const QByteArray *stream;
+        bool json;
+        bool compressed;
+    };
+    const Format formats[] = {
+        { "protobuf", &pbRaw, false, false },
+        { "protobuf_zlib", &pbZlib, false, true },
+        { "json", &jsonRaw, true, false },
+        { "json_zlib", &jsonZlib, true, true },
+    };
+
+    QJsonArray results;
+    for (const Format &format : formats) {
+        const double rate = measureRate([&]() {
+            arena.clear();
+            if (format.json)
+                decodeJson(*format.stream, format.compressed, &arena);
+            else
+                decoder.feed(format.stream->constData(), format.stream->size(), &arena);
+        }, comments, minNs);
+        QJsonObject result;
+        result["format"] = format.name;
+        result["bytes_per_message"] = double(format.stream->size()) / comments;
+        result["decode_messages_per_sec"] = rate;
+        result["decoded"] = arena.size();
+        results.append(result);
+    }
+
+    QJsonObject result;
+    result["batch_size"] = batchSize;
+    result["comments"] = comments;
+    result["decode_errors"] = static_cast<qint64>(decoder.stats().errors);
+    result["formats"] = results;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const bool quick = args.contains("--quick");
+    QString outputPath;
+    const int outputIndex = args.indexOf("--output");
+    if (outputIndex >= 0 && outputIndex + 1 < args.size())
+        outputPath = args.at(outputIndex + 1);
+
+    const int comments = quick ? 20000 : 200000;
+    const qint64 minNs = quick ? 200000000 : 1000000000;
+    QJsonArray cases;
+    for (int batchSize : kBatchSizes)
+        cases.append(runCase(batchSize, comments, minNs));
+
+    QJsonObject report;
+    report["benchmark"] = "danmu_wire";
+    report["quick"] = quick;
+    report["zlib"] = zlibVersion();
+    report["cases"] = cases;
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (!outputPath.isEmpty()) {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(outputPath));
+            return 1;
+        }
+        file.write(json);
+    }
+    std::printf("%s\n", json.constData());
+    return 0;
+}
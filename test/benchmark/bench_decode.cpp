@@ -0,0 +1,224 @@
+// 解码与转换基准：合成片源上 VideoDecoder 不限速运行的吞吐（含 YUV 直通与 RGB 转换两种输出），
+// 以及脱离流水线的 sws_scale 单帧转换耗时。
+// 用法：bench_decode [--quick] [--clips <dir>] [--ffmpeg <path>] [--output <file>]，结果为 JSON。
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+#include "syntheticmedia.h"
+#include "videodecoder.h"
+
+extern "C" {
+#include <libavutil/avutil.h>
+#include <libavutil/cpu.h>
+#include <libavutil/pixdesc.h>
+}
+
+namespace {
+
+constexpr qint64 kTimeoutNs = 300'000'000'000;
+
+QJsonObject stageJson(const PipelineMetrics::StageStats &stage)
+{
+    QJsonObject object;
+    object["count"] = static_cast<qint64>(stage.count);
+    object["mean_us"] = stage.meanUs;
+    object["p50_us"] = stage.p50Us;
+    object["p95_us"] = stage.p95Us;
+    object["max_us"] = stage.maxUs;
+    return object;
+}
+
+// 不限速解码整段片源：消费端取到帧立即释放，VideoDecoder 不按时钟等待也不丢帧
+QJsonObject runDecode(const QString &path, VideoDecoder::OutputFormat format, const QSize &target = QSize())
+{
+    FrameQueue queue(16);
+    VideoDecoder decoder;
+    decoder.setAudioEnabled(false);
+    decoder.setLateFrameThreshold(0.0);
+    decoder.setOutputFormat(format);
+    decoder.setTargetSize(target);
+    decoder.setFrameQueue(&queue);
+
+    std::atomic<bool> ended{false};
+    QObject::connect(&decoder, &VideoDecoder::endOfStream, &decoder, [&ended]() { ended = true; },
+                     Qt::DirectConnection);
+    std::atomic<bool> failed{false};
+    QObject::connect(&decoder, &VideoDecoder::decodingFailed, &decoder, [&failed]() { failed = true; },
+                     Qt::DirectConnection);
+
+    QElapsedTimer timer;
+    timer.start();
+    decoder.startDecoding(path);
+
+    quint64 frames = 0;
+    qint64 firstFrameNs = -1;
+    VideoFrame frame;
+    while (!failed && timer.nsecsElapsed() < kTimeoutNs) {
+        if (queue.pop(frame)) {
+            if (firstFrameNs < 0)
+                firstFrameNs = timer.nsecsElapsed();
+            frame.buffer.reset();
+            ++frames;
+            continue;
+        }
+        // endOfStream 在最后一帧入队之后发出，此时队列为空即已取完
+        if (ended && queue.isEmpty())
+            break;
+        QThread::usleep(50);
+    }
+    const qint64 elapsedNs = timer.nsecsElapsed();
+
+    const PipelineMetrics::Snapshot metrics = decoder.metricsSnapshot();
+    const DecoderOptions effective = decoder.effectiveDecoderOptions();
+    decoder.stopDecoding();
+    decoder.wait();
+
+    QJsonObject result;
+    result["output"] = format == VideoDecoder::OutputFormat::Yuv ? "yuv" : "rgb";
+    result["target"] = target.isValid() ? QString("%1x%2").arg(target.width()).arg(target.height()) : "source";
+    result["ok"] = !failed && ended;
+    result["frames"] = static_cast<qint64>(frames);
+    result["elapsed_ms"] = elapsedNs / 1e6;
+    result["fps"] = elapsedNs > 0 ? frames * 1e9 / elapsedNs : 0.0;
+    result["first_frame_ms"] = firstFrameNs / 1e6;
+    result["decoder"] = effective.toString();
+    result["dropped"] = static_cast<qint64>(metrics.framesDropped);
+
+    QJsonObject stages;
+    stages["read"] = stageJson(metrics.stage(PipelineMetrics::Stage::Read));
+    stages["decode"] = stageJson(metrics.stage(PipelineMetrics::Stage::Decode));
+    stages["convert"] = stageJson(metrics.stage(PipelineMetrics::Stage::Convert));
+    stages["handoff"] = stageJson(metrics.stage(PipelineMetrics::Stage::Handoff));
+    result["stages"] = stages;
+    return result;
+}
+
+// 单帧 sws_scale 耗时，源帧内容固定，与解码无关
+QJsonObject runConvert(int width, int height, AVPixelFormat src, AVPixelFormat dst, int iterations)
+{
+    AVFrame *in = av_frame_alloc();
+    AVFrame *out = av_frame_alloc();
+    in->format = src;
+    in->width = width;
+    in->height = height;
+    out->format = dst;
+    out->width = width;
+    out->height = height;
+    av_frame_get_buffer(in, 64);
+    av_frame_get_buffer(out, 64);
+    for (int plane = 0; plane < 4 && in->data[plane]; ++plane) {
+        const int rows = plane == 0 ? height : (height + 1) / 2;
+        for (int y = 0; y < rows; ++y)
+            for (int x = 0; x < in->linesize[plane]; ++x)
+                in->data[plane][y * in->linesize[plane] + x] = static_cast<uint8_t>(x * 3 + y * 7 + plane * 50);
+    }
+
+    SwsContext *sws = sws_getContext(width, height, src, width, height, dst, SWS_BILINEAR,
+                                     nullptr, nullptr, nullptr);
+    // 预热一次，排除首帧初始化查找表的开销
+    sws_scale(sws, in->data, in->linesize, 0, height, out->data, out->linesize);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i)
+        sws_scale(sws, in->data, in->linesize, 0, height, out->data, out->linesize);
+    const double perFrameUs = timer.nsecsElapsed() / 1000.0 / iterations;
+
+    sws_freeContext(sws);
+    av_frame_free(&in);
+    av_frame_free(&out);
+
+    QJsonObject result;
+    result["src"] = av_get_pix_fmt_name(src);
+    result["dst"] = av_get_pix_fmt_name(dst);
+    result["width"] = width;
+    result["height"] = height;
+    result["iterations"] = iterations;
+    result["per_frame_us"] = perFrameUs;
+    result["ns_per_pixel"] = perFrameUs * 1000.0 / (double(width) * height);
+    return result;
+}
+
+QString argValue(const QStringList &args, const QString &name, const QString &fallback)
+{
+    const int index = args.indexOf(name);
+    return index >= 0 && index + 1 < args.size() ? args.at(index + 1) : fallback;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const bool quick = args.contains("--quick");
+    const QString clipDir = argValue(args, "--clips", bench::defaultClipDirectory());
+    const QString ffmpeg = argValue(args, "--ffmpeg", "ffmpeg");
+    const QString outputPath = argValue(args, "--output", QString());
+
+    QJsonArray decodeResults;
+    for (const bench::ClipSpec &spec : bench::defaultClips(quick)) {
+        QJsonObject clip;
+        clip["clip"] = spec.name;
+        clip["width"] = spec.width;
+        clip["height"] = spec.height;
+        clip["encoder"] = spec.encoder;
+
+        QString error;
+        const QString path = bench::ensureClip(spec, clipDir, ffmpeg, &error);
+        if (path.isEmpty()) {
+            // 缺少编码器不算失败，报告中标记跳过，便于不同机器之间比较
+            clip["skipped"] = error;
+            decodeResults.append(clip);
+            continue;
+        }
+        std::fprintf(stderr, "decoding %s\n", qPrintable(spec.name));
+
+        QJsonArray runs;
+        runs.append(runDecode(path, VideoDecoder::OutputFormat::Yuv));
+        runs.append(runDecode(path, VideoDecoder::OutputFormat::Rgb));
+        // 多画面墙小窗口：解码端直接输出显示尺寸
+        runs.append(runDecode(path, VideoDecoder::OutputFormat::Yuv, QSize(640, 360)));
+        clip["runs"] = runs;
+        decodeResults.append(clip);
+    }
+
+    struct Size { int width; int height; };
+    const QVector<Size> sizes = quick ? QVector<Size>{ { 1280, 720 }, { 1920, 1080 } }
+                                      : QVector<Size>{ { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 } };
+    QJsonArray convertResults;
+    for (const Size &size : sizes) {
+        const int iterations = std::max(10, 200 * 1280 * 720 / (size.width * size.height));
+        convertResults.append(runConvert(size.width, size.height, AV_PIX_FMT_YUV420P, AV_PIX_FMT_RGB24, iterations));
+        convertResults.append(runConvert(size.width, size.height, AV_PIX_FMT_YUV420P, AV_PIX_FMT_RGBA, iterations));
+        convertResults.append(runConvert(size.width, size.height, AV_PIX_FMT_NV12, AV_PIX_FMT_YUV420P, iterations));
+    }
+
+    QJsonObject report;
+    report["benchmark"] = "decode";
+    report["quick"] = quick;
+    report["cpu_count"] = av_cpu_count();
+    report["ffmpeg"] = av_version_info();
+    report["decode"] = decodeResults;
+    report["convert"] = convertResults;
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (!outputPath.isEmpty()) {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(outputPath));
+            return 1;
+        }
+        file.write(json);
+    }
+    std::printf("%s\n", json.constData());
+    return 0;
+}
@@ -0,0 +1,163 @@
+// 弹幕关键词屏蔽基准：随机生成中英文混合的关键词表（默认 20000 个）与弹幕（约 5% 含关键词），
+// 比较 KeywordFilter（UTF-16 与 UTF-8 输入）和逐个关键词 QString::contains 的每秒弹幕数，并给出自动机构建耗时与内存。
+// 朴素实现很慢，只取前若干条弹幕计时；两者命中结果须一致，否则以非零状态退出。
+// 用法：bench_keyword_filter [--quick] [--keywords <n>] [--output <file>]，结果为 JSON。
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "keywordfilter.h"
+
+namespace {
+
+// 常用汉字与字母混合，使关键词之间有较多公共前缀
+const QString kAlphabet = QStringLiteral("的一是不了人我在有他这中大来上个国到说们为子和你地出道也时年"
+                                         "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789");
+
+QString randomText(std::mt19937 &rng, int minLength, int maxLength)
+{
+    std::uniform_int_distribution<int> length(minLength, maxLength);
+    std::uniform_int_distribution<int> letter(0, static_cast<int>(kAlphabet.size()) - 1);
+    QString text;
+    const int n = length(rng);
+    text.reserve(n);
+    for (int i = 0; i < n; ++i)
+        text.append(kAlphabet.at(letter(rng)));
+    return text;
+}
+
+QStringList makeKeywords(int count)
+{
+    std::mt19937 rng(7);
+    QStringList keywords;
+    keywords.reserve(count);
+    for (int i = 0; i < count; ++i)
+        keywords.append(randomText(rng, 4, 10));
+    return keywords;
+}
+
+// 弹幕 4~40 字，约 5% 在随机位置插入一个关键词
+QStringList makeMessages(const QStringList &keywords, int count)
+{
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> pick(0, static_cast<int>(keywords.size()) - 1);
+    QStringList messages;
+    messages.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QString text = randomText(rng, 4, 40);
+        if (percent(rng) < 5) {
+            const int at = std::uniform_int_distribution<int>(0, static_cast<int>(text.size()))(rng);
+            text.insert(at, keywords.at(pick(rng)));
+        }
+        messages.append(text);
+    }
+    return messages;
+}
+
+QJsonObject throughput(const char *name, qint64 messages, qint64 blocked, qint64 ns)
+{
+    QJsonObject object;
+    object["method"] = name;
+    object["messages"] = messages;
+    object["blocked"] = blocked;
+    object["elapsed_ms"] = ns / 1e6;
+    object["messages_per_second"] = ns > 0 ? messages * 1e9 / ns : 0.0;
+    return object;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const bool quick = args.contains("--quick");
+    auto option = [&args](const char *name, const QString &fallback) {
+        const int index = args.indexOf(name);
+        return index >= 0 && index + 1 < args.size() ? args.at(index + 1) : fallback;
+    };
+    const int keywordCount = std::max(1, option("--keywords", quick ? "5000" : "20000").toInt());
+    const QString outputPath = option("--output", QString());
+    const int messageCount = quick ? 50000 : 500000;
+    const int naiveCount = quick ? 200 : 1000;
+
+    const QStringList keywords = makeKeywords(keywordCount);
+    const QStringList messages = makeMessages(keywords, messageCount);
+    std::vector<QByteArray> utf8;
+    utf8.reserve(messages.size());
+    for (const QString &message : messages)
+        utf8.push_back(message.toUtf8());
+
+    QElapsedTimer timer;
+    timer.start();
+    const KeywordFilter filter(keywords);
+    const qint64 buildNs = timer.nsecsElapsed();
+    const KeywordFilter::Stats stats = filter.stats();
+
+    QJsonArray results;
+    std::vector<bool> expected(messages.size());
+
+    qint64 blocked = 0;
+    timer.restart();
+    for (int i = 0; i < messages.size(); ++i) {
+        expected[i] = filter.matches(QStringView(messages.at(i)));
+        blocked += expected[i];
+    }
+    results.append(throughput("aho_corasick_utf16", messages.size(), blocked, timer.nsecsElapsed()));
+
+    blocked = 0;
+    int mismatches = 0;
+    timer.restart();
+    for (size_t i = 0; i < utf8.size(); ++i) {
+        const bool hit = filter.matches(QUtf8StringView(utf8[i]));
+        blocked += hit;
+        mismatches += hit != expected[i];
+    }
+    results.append(throughput("aho_corasick_utf8", static_cast<qint64>(utf8.size()), blocked, timer.nsecsElapsed()));
+
+    blocked = 0;
+    timer.restart();
+    for (int i = 0; i < naiveCount; ++i) {
+        bool hit = false;
+        for (const QString &keyword : keywords) {
+            if (messages.at(i).contains(keyword, Qt::CaseInsensitive)) {
+                hit = true;
+                break;
+            }
+        }
+        blocked += hit;
+        mismatches += hit != expected[i];
+    }
+    results.append(throughput("naive_contains", naiveCount, blocked, timer.nsecsElapsed()));
+
+    QJsonObject report;
+    report["benchmark"] = "keyword_filter";
+    report["quick"] = quick;
+    report["keywords"] = stats.keywords;
+    report["states"] = stats.states;
+    report["memory_bytes"] = static_cast<qint64>(stats.memoryBytes);
+    report["build_ms"] = buildNs / 1e6;
+    report["mismatches"] = mismatches;
+    report["results"] = results;
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (!outputPath.isEmpty()) {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(outputPath));
+            return 1;
+        }
+        file.write(json);
+    }
+    std::printf("%s\n", json.constData());
+    return mismatches == 0 ? 0 : 1;
+}
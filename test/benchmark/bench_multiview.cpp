@@ -0,0 +1,153 @@
+// 多路监看基准：在 offscreen 平台上驱动 MultiviewRenderer，N 个分格中每帧只有 k 格有到期的新帧，
+// 测量每帧的上传、绘制提交 CPU 耗时与含读回的墙钟耗时，并核对每次 paintGL 只有一次实例化绘制。
+// 用法：bench_multiview [--quick] [--frames <n>] [--output <file>]，结果为 JSON。
+// 默认使用 QT_QPA_PLATFORM=offscreen；驱动不支持时可设为 xcb 等在有显示的环境下运行。
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "multiviewrenderer.h"
+
+namespace {
+
+// 每帧内容不同，避免驱动识别出重复上传
+void fillFrame(FrameBuffer *buffer, int index)
+{
+    const int chromaHeight = (buffer->height + 1) / 2;
+    for (int plane = 0; plane < 4 && buffer->data[plane]; ++plane) {
+        const int rows = plane == 0 ? buffer->height : chromaHeight;
+        const int bytes = buffer->linesize[plane] * rows;
+        std::memset(buffer->data[plane], (index * 13 + plane * 71) & 0xff, static_cast<size_t>(bytes));
+    }
+}
+
+QString argValue(const QStringList &args, const QString &name, const QString &fallback)
+{
+    const int index = args.indexOf(name);
+    return index >= 0 && index + 1 < args.size() ? args.at(index + 1) : fallback;
+}
+
+// columns × columns 的网格，每帧轮换 due 个分格送入新帧（pts 为 0，总是到期），其余分格复用上次的纹理层
+QJsonObject runGrid(MultiviewRenderer &view, int columns, int due, const QSize &frameSize, int frames)
+{
+    const int count = columns * columns;
+    view.setGrid(columns, columns);
+
+    std::vector<std::unique_ptr<FrameQueue>> queues;
+    std::vector<std::shared_ptr<FramePool>> pools;
+    for (int i = 0; i < count; ++i) {
+        queues.push_back(std::make_unique<FrameQueue>(4));
+        pools.push_back(FramePool::create(4));
+        pools.back()->configure(frameSize.width(), frameSize.height(), AV_PIX_FMT_YUV420P);
+        view.setTileQueue(i, queues.back().get());
+    }
+
+    const auto push = [&](int tile, int index) {
+        FrameRef buffer = pools[tile]->acquire();
+        fillFrame(buffer.get(), index);
+        queues[tile]->push(VideoFrame{ std::move(buffer), 0.0, 0 });
+    };
+
+    // 预热：每格一帧，分配纹理数组并建立实例数据，不计入统计
+    for (int i = 0; i < count; ++i)
+        push(i, 0);
+    view.grabFramebuffer();
+    view.resetStats();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int frame = 1; frame <= frames; ++frame) {
+        for (int j = 0; j < due; ++j)
+            push((frame * due + j) % count, frame);
+        // grabFramebuffer 同步调用 paintGL 并读回结果，保证每帧都已在 GPU 上完成
+        view.grabFramebuffer();
+    }
+    const double wallUs = timer.nsecsElapsed() / 1000.0 / frames;
+    const MultiviewRenderer::Stats stats = view.stats();
+
+    for (int i = 0; i < count; ++i)
+        view.setTileQueue(i, nullptr);
+
+    QJsonObject result;
+    result["tiles"] = count;
+    result["due_tiles"] = due;
+    result["frame_width"] = frameSize.width();
+    result["frame_height"] = frameSize.height();
+    result["paints"] = static_cast<qint64>(stats.paints);
+    result["uploads"] = static_cast<qint64>(stats.uploads);
+    result["draws"] = static_cast<qint64>(stats.draws);
+    result["instances"] = static_cast<qint64>(stats.instances);
+    result["single_draw_per_paint"] = stats.paints > 0 && stats.draws == stats.paints
+                                      && stats.instances == static_cast<quint64>(count);
+    result["upload_us_per_tile"] = stats.averageUploadUs;
+    result["upload_us_per_paint"] = stats.paints > 0 ? stats.averageUploadUs * stats.uploads / stats.paints : 0.0;
+    result["draw_us"] = stats.averageDrawUs;
+    result["wall_us"] = wallUs;   // 含 grabFramebuffer 的读回开销，只用于同机横向比较
+    return result;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const bool quick = args.contains("--quick");
+    const int frames = std::max(10, argValue(args, "--frames", quick ? "60" : "300").toInt());
+    const QString outputPath = argValue(args, "--output", QString());
+
+    MultiviewRenderer view;
+    view.resize(1920, 1080);
+    view.show();
+    view.grabFramebuffer();
+    if (!view.isValid()) {
+        std::fprintf(stderr, "no OpenGL 4.3 context on platform %s\n", qPrintable(app.platformName()));
+        return 1;
+    }
+
+    // 分格帧尺寸取 DecoderPool 按显示尺寸缩小后的典型值
+    const QSize frameSize(640, 360);
+    const QVector<int> grids = quick ? QVector<int>{ 2, 4 } : QVector<int>{ 2, 3, 4, 5 };
+
+    QJsonArray results;
+    for (int columns : grids) {
+        const int count = columns * columns;
+        QVector<int> dues = { 0, 1, count / 4, count / 2, count };
+        std::sort(dues.begin(), dues.end());
+        dues.erase(std::unique(dues.begin(), dues.end()), dues.end());
+        for (int due : dues) {
+            std::fprintf(stderr, "multiview %d tiles, %d due\n", count, due);
+            results.append(runGrid(view, columns, due, frameSize, frames));
+        }
+    }
+
+    QJsonObject report;
+    report["benchmark"] = "multiview";
+    report["platform"] = app.platformName();
+    report["surface"] = QString("%1x%2").arg(view.width()).arg(view.height());
+    report["frames"] = frames;
+    report["results"] = results;
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (!outputPath.isEmpty()) {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(outputPath));
+            return 1;
+        }
+        file.write(json);
+    }
+    std::printf("%s\n", json.constData());
+    return 0;
+}
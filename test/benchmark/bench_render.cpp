@@ -0,0 +1,155 @@
+// 渲染基准：在 offscreen 平台上驱动 RenderOpenGL，测量各分辨率与像素格式下的纹理上传、
+// 绘制提交耗时（CPU）与 GPU 耗时（GL_TIME_ELAPSED），直接上传与持久映射像素缓冲两种上传路径分别测量。
+// 用法：bench_render [--quick] [--frames <n>] [--output <file>]，结果为 JSON。
+// 默认使用 QT_QPA_PLATFORM=offscreen；驱动不支持时可设为 xcb 等在有显示的环境下运行。
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "renderopengl.h"
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+namespace {
+
+// 每帧内容不同，避免驱动识别出重复上传
+void fillFrame(FrameBuffer *buffer, int index)
+{
+    const int chromaHeight = (buffer->height + 1) / 2;
+    for (int plane = 0; plane < 4 && buffer->data[plane]; ++plane) {
+        const int rows = plane == 0 ? buffer->height : chromaHeight;
+        const int bytes = buffer->linesize[plane] * rows;
+        std::memset(buffer->data[plane], (index * 13 + plane * 71) & 0xff, static_cast<size_t>(bytes));
+    }
+}
+
+const char *uploadModeName(RenderOpenGL::UploadMode mode)
+{
+    return mode == RenderOpenGL::UploadMode::PersistentPbo ? "persistent_pbo" : "direct";
+}
+
+QJsonObject runRender(RenderOpenGL &view, int width, int height, AVPixelFormat format, int frames,
+                      RenderOpenGL::UploadMode mode)
+{
+    view.setUploadMode(mode);
+    auto pool = FramePool::create(4);
+    pool->configure(width, height, format);
+    FrameQueue queue(4);
+
+    view.setFrameQueue(&queue);
+    view.resetRenderTiming();
+
+    // 预热：首帧分配纹理存储，不计入统计
+    const auto present = [&](int index) {
+        FrameRef buffer = pool->acquire();
+        fillFrame(buffer.get(), index);
+        queue.push(VideoFrame{ std::move(buffer), 0.0, 0 });
+        // grabFramebuffer 同步调用 paintGL 并读回结果，保证每帧都已在 GPU 上完成
+        view.grabFramebuffer();
+    };
+    present(0);
+    view.resetRenderTiming();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 1; i <= frames; ++i)
+        present(i);
+    const double wallUs = timer.nsecsElapsed() / 1000.0 / frames;
+    // 再画一次收回尚未读取的 GPU 查询
+    view.grabFramebuffer();
+
+    view.setFrameQueue(nullptr);
+    const RenderOpenGL::RenderTiming timing = view.renderTiming();
+
+    QJsonObject result;
+    result["width"] = width;
+    result["height"] = height;
+    result["format"] = av_get_pix_fmt_name(format);
+    result["upload_mode"] = uploadModeName(view.uploadMode());
+    result["pbo_uploads"] = static_cast<qint64>(timing.pboUploads);
+    result["pbo_fallbacks"] = static_cast<qint64>(timing.pboFallbacks);
+    result["frames"] = static_cast<qint64>(timing.uploads);
+    result["upload_us"] = timing.averageUploadUs;
+    result["draw_us"] = timing.averageDrawUs;
+    result["gpu_us"] = timing.gpuSamples > 0 ? timing.averageGpuUs : -1.0;
+    result["gpu_samples"] = static_cast<qint64>(timing.gpuSamples);
+    result["wall_us"] = wallUs;   // 含 grabFramebuffer 的读回开销，只用于同机横向比较
+    return result;
+}
+
+QString argValue(const QStringList &args, const QString &name, const QString &fallback)
+{
+    const int index = args.indexOf(name);
+    return index >= 0 && index + 1 < args.size() ? args.at(index + 1) : fallback;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const bool quick = args.contains("--quick");
+    const int frames = std::max(10, argValue(args, "--frames", quick ? "60" : "300").toInt());
+    const QString outputPath = argValue(args, "--output", QString());
+
+    RenderOpenGL view;
+    view.resize(1280, 720);
+    view.show();
+    view.grabFramebuffer();
+    if (!view.isValid()) {
+        std::fprintf(stderr, "no OpenGL 4.3 context on platform %s\n", qPrintable(app.platformName()));
+        return 1;
+    }
+
+    struct Size { int width; int height; };
+    const QVector<Size> sizes = quick ? QVector<Size>{ { 1280, 720 }, { 1920, 1080 } }
+                                      : QVector<Size>{ { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 } };
+    const AVPixelFormat formats[] = { AV_PIX_FMT_YUV420P, AV_PIX_FMT_NV12, AV_PIX_FMT_RGB24 };
+
+    const RenderOpenGL::UploadMode modes[] = { RenderOpenGL::UploadMode::Direct,
+                                               RenderOpenGL::UploadMode::PersistentPbo };
+
+    QJsonArray results;
+    for (const Size &size : sizes) {
+        for (AVPixelFormat format : formats) {
+            for (RenderOpenGL::UploadMode mode : modes) {
+                std::fprintf(stderr, "rendering %dx%d %s (%s)\n", size.width, size.height,
+                             av_get_pix_fmt_name(format), uploadModeName(mode));
+                results.append(runRender(view, size.width, size.height, format, frames, mode));
+            }
+        }
+    }
+
+    QJsonObject report;
+    report["benchmark"] = "render";
+    report["platform"] = app.platformName();
+    report["surface"] = QString("%1x%2").arg(view.width()).arg(view.height());
+    report["frames"] = frames;
+    view.setUploadMode(RenderOpenGL::UploadMode::PersistentPbo);
+    report["persistent_pbo_supported"] = view.uploadMode() == RenderOpenGL::UploadMode::PersistentPbo;
+    report["results"] = results;
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (!outputPath.isEmpty()) {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(outputPath));
+            return 1;
+        }
+        file.write(json);
+    }
+    std::printf("%s\n", json.constData());
+    return 0;
+}
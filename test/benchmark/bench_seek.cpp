@@ -0,0 +1,181 @@
+// 跳转耗时基准：从 seek() 调用到新位置首帧进入 FrameQueue 的时间。
+// 用法：bench_seek <file> [iterations]，结果以 JSON 输出到 stdout。
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "videodecoder.h"
+
+namespace {
+
+constexpr qint64 kTimeoutNs = 5'000'000'000;
+constexpr double kTargetMs = 100.0;
+
+struct MediaInfo {
+    double duration = 0.0;
+    double startTime = 0.0;
+    int width = 0;
+    int height = 0;
+    QString codec;
+};
+
+bool probe(const QString &path, MediaInfo *info)
+{
+    AVFormatContext *ctx = nullptr;
+    if (avformat_open_input(&ctx, path.toStdString().c_str(), nullptr, nullptr) != 0)
+        return false;
+
+    bool ok = false;
+    if (avformat_find_stream_info(ctx, nullptr) >= 0) {
+        const int index = av_find_best_stream(ctx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (index >= 0 && ctx->duration > 0) {
+            const AVStream *stream = ctx->streams[index];
+            info->duration = ctx->duration / double(AV_TIME_BASE);
+            if (stream->start_time != AV_NOPTS_VALUE)
+                info->startTime = stream->start_time * av_q2d(stream->time_base);
+            info->width = stream->codecpar->width;
+            info->height = stream->codecpar->height;
+            info->codec = avcodec_get_name(stream->codecpar->codec_id);
+            ok = true;
+        }
+    }
+    avformat_close_input(&ctx);
+    return ok;
+}
+
+// 消费端轮询队列，等待指定 serial 的首帧；返回耗时（毫秒），超时返回 -1
+double waitForSerial(FrameQueue &queue, int serial, QElapsedTimer &timer, double *pts)
+{
+    while (timer.nsecsElapsed() < kTimeoutNs) {
+        if (VideoFrame *head = queue.peek()) {
+            if (head->serial == serial) {
+                const double elapsedMs = timer.nsecsElapsed() / 1e6;
+                *pts = head->pts;
+                queue.clear();
+                return elapsedMs;
+            }
+            VideoFrame dropped;
+            queue.pop(dropped);
+            continue;
+        }
+        QThread::usleep(100);
+    }
+    return -1.0;
+}
+
+double percentile(std::vector<double> sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    std::sort(sorted.begin(), sorted.end());
+    const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p * (sorted.size() - 1) + 0.5));
+    return sorted[index];
+}
+
+QJsonObject runMode(VideoDecoder &decoder, FrameQueue &queue, const MediaInfo &info,
+                    VideoDecoder::SeekMode mode, int iterations)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(0.0, info.duration * 0.9);
+
+    std::vector<double> latencies;
+    double maxEarlyMs = 0.0;   // 首帧早于目标的最大偏差，关键帧模式下即 GOP 误差
+    int timeouts = 0;
+
+    for (int i = 0; i < iterations; ++i) {
+        const double position = dist(rng);
+        QElapsedTimer timer;
+        timer.start();
+        const int serial = decoder.seek(position, mode);
+
+        double pts = 0.0;
+        const double ms = waitForSerial(queue, serial, timer, &pts);
+        if (ms < 0) {
+            ++timeouts;
+            continue;
+        }
+        latencies.push_back(ms);
+        maxEarlyMs = std::max(maxEarlyMs, (info.startTime + position - pts) * 1000.0);
+    }
+
+    double sum = 0.0;
+    for (double ms : latencies)
+        sum += ms;
+
+    QJsonObject result;
+    result["samples"] = static_cast<int>(latencies.size());
+    result["timeouts"] = timeouts;
+    result["mean_ms"] = latencies.empty() ? 0.0 : sum / latencies.size();
+    result["p50_ms"] = percentile(latencies, 0.50);
+    result["p95_ms"] = percentile(latencies, 0.95);
+    result["max_ms"] = percentile(latencies, 1.0);
+    result["max_early_ms"] = maxEarlyMs;
+    result["pass"] = timeouts == 0 && percentile(latencies, 0.95) < kTargetMs;
+    return result;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    if (args.size() < 2) {
+        std::fprintf(stderr, "usage: bench_seek <file> [iterations]\n");
+        return 2;
+    }
+
+    const QString path = args.at(1);
+    const int iterations = args.size() > 2 ? std::max(1, args.at(2).toInt()) : 50;
+
+    MediaInfo info;
+    if (!probe(path, &info)) {
+        std::fprintf(stderr, "cannot probe %s\n", qPrintable(path));
+        return 1;
+    }
+
+    FrameQueue queue(8);
+    VideoDecoder decoder;
+    decoder.setAudioEnabled(false);
+    decoder.setLateFrameThreshold(0.0);   // 没有渲染端推进时钟，不能按迟到丢帧
+    decoder.setFrameQueue(&queue);
+    decoder.startDecoding(path);
+
+    // 等首帧出来再开始计时，排除打开与探测的耗时
+    QElapsedTimer warmup;
+    warmup.start();
+    double firstPts = 0.0;
+    if (waitForSerial(queue, 0, warmup, &firstPts) < 0) {
+        std::fprintf(stderr, "no frame decoded from %s\n", qPrintable(path));
+        decoder.stopDecoding();
+        decoder.wait();
+        return 1;
+    }
+
+    QJsonObject modes;
+    modes["keyframe"] = runMode(decoder, queue, info, VideoDecoder::SeekMode::Keyframe, iterations);
+    modes["accurate"] = runMode(decoder, queue, info, VideoDecoder::SeekMode::Accurate, iterations);
+
+    decoder.stopDecoding();
+    decoder.wait();
+
+    QJsonObject report;
+    report["benchmark"] = "seek";
+    report["file"] = path;
+    report["codec"] = info.codec;
+    report["width"] = info.width;
+    report["height"] = info.height;
+    report["duration_s"] = info.duration;
+    report["iterations"] = iterations;
+    report["target_ms"] = kTargetMs;
+    report["modes"] = modes;
+    std::printf("%s\n", QJsonDocument(report).toJson(QJsonDocument::Indented).constData());
+    return 0;
+}
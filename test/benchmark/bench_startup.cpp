@@ -0,0 +1,101 @@
+// 启动耗时基准：startDecoding() 到首帧进入 FrameQueue 的时间，对比首次打开与命中探测缓存。
+// 用法：bench_startup <url> [rounds] [--low-latency]，结果以 JSON 输出到 stdout。
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "videodecoder.h"
+
+namespace {
+
+constexpr qint64 kTimeoutNs = 15'000'000'000;
+constexpr double kTargetMs = 300.0;
+
+// 轮询等待首帧；超时返回 false
+bool waitForFrame(FrameQueue &queue)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.nsecsElapsed() < kTimeoutNs) {
+        if (queue.peek())
+            return true;
+        QThread::usleep(100);
+    }
+    return false;
+}
+
+QJsonObject toJson(const VideoDecoder::StartupTiming &timing)
+{
+    QJsonObject object;
+    object["open_ms"] = timing.openMs;
+    object["probe_ms"] = timing.probeMs;
+    object["first_frame_ms"] = timing.timeToFirstFrameMs;
+    object["probe_cache_hit"] = timing.probeCacheHit;
+    return object;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+    const bool lowLatency = args.removeAll(QStringLiteral("--low-latency")) > 0;
+    if (args.size() < 2) {
+        std::fprintf(stderr, "usage: bench_startup <url> [rounds] [--low-latency]\n");
+        return 2;
+    }
+
+    const QString url = args.at(1);
+    const int rounds = args.size() > 2 ? std::max(2, args.at(2).toInt()) : 5;
+
+    ProbeCache::instance()->clear();
+
+    QJsonArray samples;
+    std::vector<double> cachedMs;
+    int failures = 0;
+    for (int i = 0; i < rounds; ++i) {
+        FrameQueue queue(8);
+        VideoDecoder decoder;
+        decoder.setAudioEnabled(false);
+        decoder.setLateFrameThreshold(0.0);
+        decoder.setLowLatency(lowLatency);
+        decoder.setFrameQueue(&queue);
+        decoder.startDecoding(url);
+
+        const bool ok = waitForFrame(queue);
+        const VideoDecoder::StartupTiming timing = decoder.startupTiming();
+        decoder.stopDecoding();
+        decoder.wait();
+
+        if (!ok) {
+            ++failures;
+            continue;
+        }
+        samples.append(toJson(timing));
+        if (timing.probeCacheHit)
+            cachedMs.push_back(timing.timeToFirstFrameMs);
+    }
+
+    std::sort(cachedMs.begin(), cachedMs.end());
+    const double cachedMedian = cachedMs.empty() ? -1.0 : cachedMs[cachedMs.size() / 2];
+
+    QJsonObject report;
+    report["benchmark"] = "startup";
+    report["url"] = url;
+    report["low_latency"] = lowLatency;
+    report["rounds"] = rounds;
+    report["failures"] = failures;
+    report["samples"] = samples;
+    report["cached_median_ms"] = cachedMedian;
+    report["target_ms"] = kTargetMs;
+    report["pass"] = failures == 0 && cachedMedian >= 0 && cachedMedian < kTargetMs;
+    std::printf("%s\n", QJsonDocument(report).toJson(QJsonDocument::Indented).constData());
+    return 0;
+}
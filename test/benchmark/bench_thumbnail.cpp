@@ -0,0 +1,169 @@
+// 缩略图服务基准：合成片源上均匀取 N 个时间点，分别测量首次请求（解码）、lookup() 内存命中、
+// request() 内存命中（经事件循环回调）与新实例的磁盘缓存命中的延迟分位数。
+// 磁盘缓存落在 QStandardPaths 测试目录下，开始前清空。
+// 用法：bench_thumbnail [--quick] [--clips <dir>] [--ffmpeg <path>] [--output <file>]，结果为 JSON。
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "syntheticmedia.h"
+#include "thumbnailservice.h"
+#include "type.h"
+
+namespace {
+
+QString argValue(const QStringList &args, const QString &name, const QString &fallback)
+{
+    const int index = args.indexOf(name);
+    return index >= 0 && index + 1 < args.size() ? args.at(index + 1) : fallback;
+}
+
+QJsonObject percentiles(std::vector<qint64> samples)
+{
+    QJsonObject object;
+    object["count"] = static_cast<qint64>(samples.size());
+    if (samples.empty())
+        return object;
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](double q) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()))] / 1000.0;
+    };
+    double sum = 0.0;
+    for (qint64 ns : samples)
+        sum += ns;
+    object["mean_us"] = sum / samples.size() / 1000.0;
+    object["p50_us"] = at(0.50);
+    object["p99_us"] = at(0.99);
+    object["max_us"] = samples.back() / 1000.0;
+    return object;
+}
+
+// 发出请求并在事件循环中等待结果，返回耗时（ns），失败返回 -1
+qint64 timedRequest(ThumbnailService &service, const QString &path, double position)
+{
+    QEventLoop loop;
+    quint64 expected = 0;
+    bool done = false;
+    bool ok = false;
+    auto finish = [&](quint64 id, bool success) {
+        if (id != expected)
+            return;
+        done = true;
+        ok = success;
+        loop.quit();
+    };
+    QObject::connect(&service, &ThumbnailService::thumbnailReady, &loop,
+                     [&](quint64 id, const QString &, double, const QImage &) { finish(id, true); });
+    QObject::connect(&service, &ThumbnailService::thumbnailFailed, &loop,
+                     [&](quint64 id, const QString &, double) { finish(id, false); });
+
+    QElapsedTimer timer;
+    timer.start();
+    // 结果排队到本线程，赋值 expected 之前不会被处理
+    expected = service.request(path, position);
+    if (!done)
+        loop.exec();
+    return ok ? timer.nsecsElapsed() : -1;
+}
+
+QJsonObject runRequests(ThumbnailService &service, const QString &path, const QVector<double> &positions,
+                        int *failures)
+{
+    std::vector<qint64> samples;
+    for (double position : positions) {
+        const qint64 ns = timedRequest(service, path, position);
+        if (ns < 0)
+            ++*failures;
+        else
+            samples.push_back(ns);
+    }
+    return percentiles(std::move(samples));
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const bool quick = args.contains("--quick");
+    const QString clipDir = argValue(args, "--clips", bench::defaultClipDirectory());
+    const QString ffmpeg = argValue(args, "--ffmpeg", "ffmpeg");
+    const QString outputPath = argValue(args, "--output", QString());
+
+    QStandardPaths::setTestModeEnabled(true);
+    QDir(zg::path::thumbnailCacheDir()).removeRecursively();
+
+    const bench::ClipSpec spec = bench::defaultClips(quick).first();
+    const int count = quick ? 20 : 100;
+    const int lookupRounds = quick ? 100 : 1000;
+
+    QJsonObject report;
+    report["benchmark"] = "thumbnail";
+    report["quick"] = quick;
+    report["clip"] = spec.name;
+    report["positions"] = count;
+
+    QString error;
+    const QString path = bench::ensureClip(spec, clipDir, ffmpeg, &error);
+    if (path.isEmpty()) {
+        report["skipped"] = error;
+    } else {
+        QVector<double> positions;
+        for (int i = 0; i < count; ++i)
+            positions.append((i + 0.5) * spec.seconds / count);
+
+        int failures = 0;
+        {
+            ThumbnailService service;
+            report["cold"] = runRequests(service, path, positions, &failures);
+            report["average_decode_ms"] = service.stats().averageDecodeMs;
+
+            // 同一调用线程上的直接查询，不经过线程池与事件循环
+            std::vector<qint64> samples;
+            samples.reserve(size_t(count) * lookupRounds);
+            QElapsedTimer timer;
+            timer.start();
+            QImage image;
+            for (int round = 0; round < lookupRounds; ++round) {
+                for (double position : positions) {
+                    const qint64 begin = timer.nsecsElapsed();
+                    const bool hit = service.lookup(path, position, QSize(160, 90), &image);
+                    samples.push_back(timer.nsecsElapsed() - begin);
+                    if (!hit)
+                        ++failures;
+                }
+            }
+            report["lookup_hit"] = percentiles(std::move(samples));
+            report["request_memory_hit"] = runRequests(service, path, positions, &failures);
+        }
+
+        // 新实例：内存缓存为空，指纹需重新计算，图像从磁盘缓存读出
+        ThumbnailService service;
+        report["request_disk_hit"] = runRequests(service, path, positions, &failures);
+        report["disk_hits"] = static_cast<qint64>(service.stats().diskHits);
+        report["failures"] = failures;
+    }
+    QDir(zg::path::thumbnailCacheDir()).removeRecursively();
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (!outputPath.isEmpty()) {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(outputPath));
+            return 1;
+        }
+        file.write(json);
+    }
+    std::printf("%s\n", json.constData());
+    return 0;
+}
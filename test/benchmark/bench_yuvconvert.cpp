@@ -0,0 +1,210 @@
+// YUV→RGBA 转换微基准：YuvConverter 各指令集实现与 sws_scale 对比，
+// 覆盖 I420 / NV12、1080p 原尺寸与缩小到 640x360 两种情况。
+// x86 上以 rdtsc 计数给出 cycles/pixel（不含变频修正，仅用于同机横向比较），其他平台只给 ns/pixel。
+// 用法：bench_yuvconvert [--quick] [--output <file>]，结果为 JSON。
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "yuvconvert.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define BENCH_HAVE_RDTSC
+#endif
+
+extern "C" {
+#include <libavutil/avutil.h>
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+namespace {
+
+struct Case {
+    const char *name;
+    int srcWidth;
+    int srcHeight;
+    int dstWidth;
+    int dstHeight;
+};
+
+constexpr Case kCases[] = {
+    { "1080p", 1920, 1080, 1920, 1080 },
+    { "1080p_to_360p", 1920, 1080, 640, 360 },
+};
+
+struct Timing {
+    double nsPerPixel = 0.0;
+    double cyclesPerPixel = -1.0;
+    double perFrameUs = 0.0;
+};
+
+quint64 readCycles()
+{
+#ifdef BENCH_HAVE_RDTSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// 预热一次后计时 iterations 次，按输出像素折算
+template <typename Fn>
+Timing measure(Fn &&convert, int iterations, qint64 pixels)
+{
+    convert();
+
+    QElapsedTimer timer;
+    timer.start();
+    const quint64 startCycles = readCycles();
+    for (int i = 0; i < iterations; ++i)
+        convert();
+    const quint64 cycles = readCycles() - startCycles;
+    const qint64 elapsedNs = timer.nsecsElapsed();
+
+    Timing timing;
+    const double total = double(pixels) * iterations;
+    timing.nsPerPixel = elapsedNs / total;
+    timing.perFrameUs = elapsedNs / 1000.0 / iterations;
+#ifdef BENCH_HAVE_RDTSC
+    timing.cyclesPerPixel = cycles / total;
+#else
+    Q_UNUSED(cycles);
+#endif
+    return timing;
+}
+
+QJsonObject timingJson(const char *implementation, const Timing &timing)
+{
+    QJsonObject object;
+    object["implementation"] = implementation;
+    object["ns_per_pixel"] = timing.nsPerPixel;
+    object["per_frame_us"] = timing.perFrameUs;
+    if (timing.cyclesPerPixel >= 0.0)
+        object["cycles_per_pixel"] = timing.cyclesPerPixel;
+    return object;
+}
+
+QJsonObject runCase(const Case &c, YuvConverter::Format format, int iterations)
+{
+    const bool nv12 = format == YuvConverter::Format::NV12;
+    AVFrame *in = av_frame_alloc();
+    in->format = nv12 ? AV_PIX_FMT_NV12 : AV_PIX_FMT_YUV420P;
+    in->width = c.srcWidth;
+    in->height = c.srcHeight;
+    av_frame_get_buffer(in, 64);
+    for (int plane = 0; plane < 3 && in->data[plane]; ++plane) {
+        const int rows = plane == 0 ? c.srcHeight : (c.srcHeight + 1) / 2;
+        for (int y = 0; y < rows; ++y)
+            for (int x = 0; x < in->linesize[plane]; ++x)
+                in->data[plane][y * in->linesize[plane] + x] = static_cast<uint8_t>(x * 3 + y * 7 + plane * 50);
+    }
+
+    YuvConverter::Source src;
+    src.format = format;
+    src.width = c.srcWidth;
+    src.height = c.srcHeight;
+    src.y = in->data[0];
+    src.u = in->data[1];
+    src.v = in->data[2];
+    src.yStride = in->linesize[0];
+    src.uStride = in->linesize[1];
+    src.vStride = in->linesize[2];
+
+    const int dstStride = c.dstWidth * 4;
+    std::vector<uint8_t> dst(static_cast<size_t>(dstStride) * c.dstHeight);
+    const qint64 pixels = qint64(c.dstWidth) * c.dstHeight;
+    const YuvConverter::Options options;
+
+    QJsonArray results;
+    const YuvConverter::Isa best = YuvConverter::bestSupportedIsa();
+    for (int isa = 0; isa <= static_cast<int>(best); ++isa) {
+        YuvConverter::setIsa(static_cast<YuvConverter::Isa>(isa));
+        const Timing timing = measure([&]() {
+            YuvConverter::toRgba(src, dst.data(), dstStride, c.dstWidth, c.dstHeight, options);
+        }, iterations, pixels);
+        results.append(timingJson(YuvConverter::isaName(YuvConverter::isa()), timing));
+    }
+    YuvConverter::setIsa(best);
+
+    // 基线：原尺寸用 SWS_POINT（swscale 的专用转换路径），缩小用与本实现相当的 SWS_BILINEAR
+    const bool scaled = c.srcWidth != c.dstWidth || c.srcHeight != c.dstHeight;
+    SwsContext *sws = sws_getContext(c.srcWidth, c.srcHeight, static_cast<AVPixelFormat>(in->format),
+                                     c.dstWidth, c.dstHeight, AV_PIX_FMT_RGBA,
+                                     scaled ? SWS_BILINEAR : SWS_POINT, nullptr, nullptr, nullptr);
+    uint8_t *dstData[4] = { dst.data(), nullptr, nullptr, nullptr };
+    const int dstLinesize[4] = { dstStride, 0, 0, 0 };
+    const Timing swsTiming = measure([&]() {
+        sws_scale(sws, in->data, in->linesize, 0, c.srcHeight, dstData, dstLinesize);
+    }, iterations, pixels);
+    results.append(timingJson(scaled ? "swscale_bilinear" : "swscale_point", swsTiming));
+    sws_freeContext(sws);
+    av_frame_free(&in);
+
+    QJsonObject result;
+    result["case"] = c.name;
+    result["format"] = nv12 ? "nv12" : "i420";
+    result["src_width"] = c.srcWidth;
+    result["src_height"] = c.srcHeight;
+    result["dst_width"] = c.dstWidth;
+    result["dst_height"] = c.dstHeight;
+    result["iterations"] = iterations;
+    result["results"] = results;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const bool quick = args.contains("--quick");
+    QString outputPath;
+    const int outputIndex = args.indexOf("--output");
+    if (outputIndex >= 0 && outputIndex + 1 < args.size())
+        outputPath = args.at(outputIndex + 1);
+
+    const int iterations = quick ? 20 : 200;
+    QJsonArray cases;
+    for (const Case &c : kCases)
+        for (YuvConverter::Format format : { YuvConverter::Format::I420, YuvConverter::Format::NV12 })
+            cases.append(runCase(c, format, iterations));
+
+    YuvConverter::setIsa(YuvConverter::bestSupportedIsa());
+    QJsonObject report;
+    report["benchmark"] = "yuvconvert";
+    report["quick"] = quick;
+    report["best_isa"] = YuvConverter::isaName(YuvConverter::bestSupportedIsa());
+#ifdef BENCH_HAVE_RDTSC
+    report["cycle_counter"] = "rdtsc";
+#else
+    report["cycle_counter"] = "none";
+#endif
+    report["ffmpeg"] = av_version_info();
+    report["cases"] = cases;
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (!outputPath.isEmpty()) {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(outputPath));
+            return 1;
+        }
+        file.write(json);
+    }
+    std::printf("%s\n", json.constData());
+    return 0;
+}
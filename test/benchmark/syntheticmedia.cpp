@@ -0,0 +1,107 @@
+#include "syntheticmedia.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QStringList>
+
+namespace bench {
+
+namespace {
+
+QStringList encoderArgs(const ClipSpec &spec)
+{
+    // 编码参数只求生成快、结果稳定，不追求画质
+    if (spec.encoder == "libx264")
+        return { "-preset", "ultrafast", "-tune", "zerolatency", "-threads", "1" };
+    if (spec.encoder == "libx265")
+        return { "-preset", "ultrafast", "-x265-params", "pools=1:frame-threads=1:log-level=error" };
+    if (spec.encoder == "libvpx-vp9")
+        return { "-deadline", "realtime", "-cpu-used", "8", "-row-mt", "0", "-threads", "1" };
+    return {};
+}
+
+QStringList ffmpegArgs(const ClipSpec &spec, const QString &output)
+{
+    QStringList args = {
+        "-hide_banner", "-loglevel", "error", "-y",
+        "-f", "lavfi",
+        "-i", QString("testsrc2=size=%1x%2:rate=%3:duration=%4")
+                  .arg(spec.width).arg(spec.height).arg(spec.fps).arg(spec.seconds),
+        "-c:v", spec.encoder,
+        "-pix_fmt", "yuv420p",
+        "-g", QString::number(spec.fps * 2),
+        "-fflags", "+bitexact",
+        "-flags:v", "+bitexact",
+    };
+    args << encoderArgs(spec) << output;
+    return args;
+}
+
+}
+
+QVector<ClipSpec> defaultClips(bool quick)
+{
+    if (quick) {
+        return {
+            { "720p-h264", 1280, 720, "libx264", "mp4", 30, 5 },
+            { "1080p-hevc", 1920, 1080, "libx265", "mp4", 30, 5 },
+        };
+    }
+    return {
+        { "720p-h264", 1280, 720, "libx264", "mp4", 30, 10 },
+        { "1080p-h264", 1920, 1080, "libx264", "mp4", 30, 10 },
+        { "1080p-hevc", 1920, 1080, "libx265", "mp4", 30, 10 },
+        { "1080p-vp9", 1920, 1080, "libvpx-vp9", "webm", 30, 10 },
+        { "2160p-h264", 3840, 2160, "libx264", "mp4", 30, 5 },
+        { "2160p-hevc", 3840, 2160, "libx265", "mp4", 30, 5 },
+    };
+}
+
+QString defaultClipDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/yyz-bench-clips";
+}
+
+QString ensureClip(const ClipSpec &spec, const QString &directory, const QString &ffmpeg, QString *error)
+{
+    if (!QDir().mkpath(directory)) {
+        *error = "cannot create " + directory;
+        return QString();
+    }
+
+    const QByteArray digest = QCryptographicHash::hash(ffmpegArgs(spec, QString()).join(' ').toUtf8(),
+                                                       QCryptographicHash::Sha1).toHex().left(8);
+    const QString path = QString("%1/%2-%3.%4").arg(directory, spec.name, QString::fromLatin1(digest), spec.container);
+    if (QFileInfo(path).size() > 0)
+        return path;
+
+    // 先写临时文件，生成中断不会留下被当成有效片源的半成品
+    const QString partial = path + ".part." + spec.container;
+    QProcess process;
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start(ffmpeg, ffmpegArgs(spec, partial));
+    if (!process.waitForStarted()) {
+        *error = "cannot start " + ffmpeg;
+        return QString();
+    }
+    process.waitForFinished(-1);
+    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        *error = QString::fromLocal8Bit(process.readAll()).trimmed();
+        if (error->isEmpty())
+            *error = "ffmpeg failed";
+        QFile::remove(partial);
+        return QString();
+    }
+
+    QFile::remove(path);
+    if (!QFile::rename(partial, path)) {
+        *error = "cannot rename " + partial;
+        return QString();
+    }
+    return path;
+}
+
+}
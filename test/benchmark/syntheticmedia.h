@@ -0,0 +1,32 @@
+#ifndef SYNTHETICMEDIA_H
+#define SYNTHETICMEDIA_H
+
+#include <QString>
+#include <QVector>
+
+// 基准用合成片源：调用本机 ffmpeg 以 lavfi testsrc2 生成，参数固定、bitexact 输出，
+// 同一参数只生成一次，文件名包含参数摘要，参数变化时自动重新生成。
+namespace bench {
+
+struct ClipSpec {
+    QString name;        // 报告中的标识，如 "1080p-hevc"
+    int width = 0;
+    int height = 0;
+    QString encoder;     // ffmpeg 编码器名，如 libx264
+    QString container;   // mp4 / webm
+    int fps = 30;
+    int seconds = 10;
+};
+
+// quick 只包含 720p/1080p 的少量组合，供 CI 快速比较
+QVector<ClipSpec> defaultClips(bool quick);
+
+// 返回片源路径；ffmpeg 不可用或缺少编码器时返回空字符串并写入 error
+QString ensureClip(const ClipSpec &spec, const QString &directory, const QString &ffmpeg, QString *error);
+
+// --clips 未指定时的缓存目录
+QString defaultClipDirectory();
+
+}
+
+#endif // SYNTHETICMEDIA_H
@@ -0,0 +1,111 @@
+#include "syntheticclip.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/opt.h>
+}
+
+namespace synthetic {
+
+bool writeClip(const QString &path, const ClipSpec &spec, std::set<int> *keyframes, QString *error)
+{
+    const AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+    if (!codec) {
+        *error = "MPEG-4 encoder not available";
+        return false;
+    }
+
+    AVFormatContext *format = nullptr;
+    avformat_alloc_output_context2(&format, nullptr, "matroska", path.toStdString().c_str());
+    AVCodecContext *ctx = avcodec_alloc_context3(codec);
+    AVFrame *frame = av_frame_alloc();
+    AVPacket *packet = av_packet_alloc();
+    bool ok = false;
+
+    auto writePackets = [&](AVStream *stream) {
+        while (avcodec_receive_packet(ctx, packet) == 0) {
+            if (keyframes && (packet->flags & AV_PKT_FLAG_KEY))
+                keyframes->insert(static_cast<int>(packet->pts));
+            av_packet_rescale_ts(packet, ctx->time_base, stream->time_base);
+            packet->stream_index = stream->index;
+            if (av_interleaved_write_frame(format, packet) < 0)
+                return false;
+        }
+        return true;
+    };
+
+    do {
+        if (!format || !ctx || !frame || !packet) {
+            *error = "allocation failed";
+            break;
+        }
+        AVStream *stream = avformat_new_stream(format, nullptr);
+        ctx->width = spec.size.width();
+        ctx->height = spec.size.height();
+        ctx->pix_fmt = AV_PIX_FMT_YUV420P;
+        ctx->time_base = AVRational{ 1, spec.fps };
+        ctx->framerate = AVRational{ spec.fps, 1 };
+        ctx->gop_size = spec.gop;
+        ctx->max_b_frames = 0;
+        ctx->bit_rate = 2000000;
+        if (format->oformat->flags & AVFMT_GLOBALHEADER)
+            ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        // 关闭场景切换检测，关键帧只按 GOP 出现
+        av_opt_set_int(ctx, "sc_threshold", 1000000000, AV_OPT_SEARCH_CHILDREN);
+        if (!stream || avcodec_open2(ctx, codec, nullptr) < 0
+            || avcodec_parameters_from_context(stream->codecpar, ctx) < 0) {
+            *error = "cannot open encoder";
+            break;
+        }
+        stream->time_base = ctx->time_base;
+        if (avio_open(&format->pb, path.toStdString().c_str(), AVIO_FLAG_WRITE) < 0
+            || avformat_write_header(format, nullptr) < 0) {
+            *error = "cannot write header";
+            break;
+        }
+
+        frame->format = ctx->pix_fmt;
+        frame->width = ctx->width;
+        frame->height = ctx->height;
+        if (av_frame_get_buffer(frame, 0) < 0) {
+            *error = "cannot allocate frame";
+            break;
+        }
+
+        bool written = true;
+        for (int i = 0; i < spec.frames && written; ++i) {
+            av_frame_make_writable(frame);
+            // 移动的渐变加噪点，帧间有足够的残差，解码耗时不至于过小
+            for (int y = 0; y < ctx->height; ++y) {
+                uint8_t *row = frame->data[0] + y * frame->linesize[0];
+                for (int x = 0; x < ctx->width; ++x)
+                    row[x] = static_cast<uint8_t>(x + y + i * 3 + ((x * 7919 + y * 104729 + i * 31) >> 3) % 23);
+            }
+            for (int plane = 1; plane < 3; ++plane) {
+                for (int y = 0; y < ctx->height / 2; ++y) {
+                    uint8_t *row = frame->data[plane] + y * frame->linesize[plane];
+                    for (int x = 0; x < ctx->width / 2; ++x)
+                        row[x] = static_cast<uint8_t>(128 + plane * (x - y + i) % 64);
+                }
+            }
+            frame->pts = i;
+            written = avcodec_send_frame(ctx, frame) >= 0 && writePackets(stream);
+        }
+        if (!written || avcodec_send_frame(ctx, nullptr) < 0 || !writePackets(stream)) {
+            *error = "encoding failed";
+            break;
+        }
+        ok = av_write_trailer(format) == 0;
+    } while (false);
+
+    if (format && format->pb)
+        avio_closep(&format->pb);
+    avformat_free_context(format);
+    avcodec_free_context(&ctx);
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    return ok;
+}
+
+}
@@ -0,0 +1,24 @@
+#ifndef SYNTHETICCLIP_H
+#define SYNTHETICCLIP_H
+
+#include <QSize>
+#include <QString>
+#include <set>
+
+// 测试用合成片源：用 FFmpeg 自带的 MPEG-4 编码器在进程内写 mkv，不依赖外部 ffmpeg 程序。
+// 画面为移动的渐变加噪点，无 B 帧，关键帧只按 GOP 出现。
+namespace synthetic {
+
+struct ClipSpec {
+    QSize size = QSize(640, 360);
+    int fps = 25;
+    int frames = 250;
+    int gop = 25;
+};
+
+// keyframes 可为空，否则写入关键帧序号（pts × fps）；失败时返回 false 并写入 error
+bool writeClip(const QString &path, const ClipSpec &spec, std::set<int> *keyframes, QString *error);
+
+}
+
+#endif // SYNTHETICCLIP_H
@@ -0,0 +1,203 @@
+#include <QtTest/QtTest>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/ostream_sink.h>
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <sstream>
+#include <thread>
+#include "asynclog.h"
+
+namespace {
+// 记录收到的消息；gate 打开前第一条消息停在 sink 里，用来制造确定的溢出
+class GateSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    std::promise<void> entered;
+    std::promise<void> gate;
+    std::vector<std::string> messages;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        if (messages.empty() && msg.logger_name != "log") {
+            entered.set_value();
+            gate.get_future().wait();
+        }
+        messages.emplace_back(msg.payload.data(), msg.payload.size());
+    }
+    void flush_() override {}
+};
+
+// 下游写得慢，使环中始终积压消息
+class SlowSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    std::vector<int> values;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+        values.push_back(std::stoi(std::string(msg.payload.data(), msg.payload.size())));
+    }
+    void flush_() override {}
+};
+
+spdlog::details::log_msg message(const std::string &text)
+{
+    return spdlog::details::log_msg("test", spdlog::level::info, text);
+}
+}
+
+class TestAsyncLog : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testInstallKeepsOrder();
+    void testShutdownWhileLogging();
+    void testDropNewest();
+    void testDropOldest();
+};
+
+void TestAsyncLog::testInstallKeepsOrder()
+{
+    std::ostringstream out;
+    auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(out);
+    sink->set_pattern("%v");
+    auto logger = std::make_shared<spdlog::logger>("asynclog_test", sink);
+    spdlog::register_logger(logger);
+
+    zg::log::AsyncOptions options;
+    options.capacity = 64;
+    options.overflow = zg::log::OverflowPolicy::Block;
+    zg::log::installAsyncBackend(options);
+    QVERIFY(logger->sinks().front() != sink);
+
+    // 每个线程内的顺序不变，Block 策略下一条不丢
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&logger, t]() {
+            for (int i = 0; i < kPerThread; ++i)
+                logger->info("{} {}", t, i);
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+    logger->flush();
+
+    const zg::log::AsyncStats stats = zg::log::asyncStats();
+    QCOMPARE(stats.enqueued, uint64_t(kThreads * kPerThread));
+    QCOMPARE(stats.written, stats.enqueued);
+    QCOMPARE(stats.dropped, uint64_t(0));
+
+    zg::log::shutdownAsyncBackend();
+    spdlog::drop("asynclog_test");
+
+    std::istringstream lines(out.str());
+    std::vector<int> next(kThreads, 0);
+    int t = 0;
+    int i = 0;
+    int count = 0;
+    while (lines >> t >> i) {
+        QCOMPARE(i, next[t]);
+        ++next[t];
+        ++count;
+    }
+    QCOMPARE(count, kThreads * kPerThread);
+}
+
+void TestAsyncLog::testShutdownWhileLogging()
+{
+    auto sink = std::make_shared<SlowSink>();
+    auto logger = std::make_shared<spdlog::logger>("asynclog_shutdown", sink);
+    spdlog::register_logger(logger);
+
+    zg::log::AsyncOptions options;
+    options.capacity = 64;
+    options.overflow = zg::log::OverflowPolicy::Block;
+    zg::log::installAsyncBackend(options);
+
+    // 退出时解码线程往往还在写日志：shutdown 与写入并发，环中积压的消息不能丢，
+    // 之后同步写出的消息也不能排到它们前面
+    std::atomic<bool> stop{ false };
+    std::atomic<int> written{ 0 };
+    std::thread writer([&]() {
+        for (int i = 0; !stop.load(std::memory_order_relaxed) || i < 2000; ++i) {
+            logger->info("{}", i);
+            written.store(i + 1, std::memory_order_relaxed);
+        }
+    });
+    while (written.load(std::memory_order_relaxed) < 500)
+        std::this_thread::yield();
+    zg::log::shutdownAsyncBackend();
+    stop.store(true, std::memory_order_relaxed);
+    writer.join();
+    spdlog::drop("asynclog_shutdown");
+
+    int mismatch = -1;
+    for (size_t i = 0; i < sink->values.size(); ++i) {
+        if (sink->values[i] != static_cast<int>(i)) {
+            mismatch = static_cast<int>(i);
+            break;
+        }
+    }
+    QCOMPARE(mismatch, -1);
+    QCOMPARE(static_cast<int>(sink->values.size()), written.load());
+}
+
+void TestAsyncLog::testDropNewest()
+{
+    auto sink = std::make_shared<GateSink>();
+    zg::log::AsyncOptions options;
+    options.capacity = 16;
+    options.overflow = zg::log::OverflowPolicy::DropNewest;
+    zg::log::AsyncLogBackend backend(options);
+    const int route = backend.addRoute({ sink });
+    backend.start();
+
+    backend.push(route, message("0"));
+    sink->entered.get_future().wait();
+    // 第 0 条已离开环、停在 sink 里，环中还能放 16 条
+    for (int i = 1; i < 100; ++i)
+        backend.push(route, message(std::to_string(i)));
+    QCOMPARE(backend.stats().dropped, uint64_t(83));
+
+    sink->gate.set_value();
+    backend.stop();
+    QCOMPARE(backend.stats().written, uint64_t(17));
+    QCOMPARE(sink->messages.size(), size_t(18));      // 含一条丢弃提示
+    QCOMPARE(sink->messages[16], std::string("16"));
+    QVERIFY(sink->messages.back().find("83 messages dropped") != std::string::npos);
+}
+
+void TestAsyncLog::testDropOldest()
+{
+    auto sink = std::make_shared<GateSink>();
+    zg::log::AsyncOptions options;
+    options.capacity = 16;
+    options.overflow = zg::log::OverflowPolicy::DropOldest;
+    zg::log::AsyncLogBackend backend(options);
+    const int route = backend.addRoute({ sink });
+    backend.start();
+
+    backend.push(route, message("0"));
+    sink->entered.get_future().wait();
+    for (int i = 1; i < 100; ++i)
+        backend.push(route, message(std::to_string(i)));
+    QCOMPARE(backend.stats().dropped, uint64_t(83));
+
+    sink->gate.set_value();
+    backend.stop();
+    // 留下正在写的第 0 条和最新的 16 条
+    QCOMPARE(backend.stats().written, uint64_t(17));
+    QCOMPARE(sink->messages[1], std::string("84"));
+    QCOMPARE(sink->messages[16], std::string("99"));
+}
+
+QTEST_MAIN(TestAsyncLog)
+#include "test_asynclog.moc"
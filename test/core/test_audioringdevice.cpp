@@ -0,0 +1,171 @@
+#include <QtTest/QtTest>
+#include <QScopeGuard>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include "audiooutput.h"
+#include "playbackclock.h"
+
+// 音频环形缓冲：不经过音频设备，直接写入与读取。
+// 读位置越过 pts 标记后时钟跟随新基准，跳转丢弃后不再沿用旧基准，abort() 唤醒阻塞的写端
+class TestAudioRingDevice : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testClockFollowsReadPosition();
+    void testDiscardResetsClockBase();
+    void testReadUnblocksWriter();
+    void testAbortUnblocksWriter();
+
+private:
+    static constexpr int kBytesPerSecond = 10000;
+
+    // 按读取顺序调用 read()，无缓冲打开，保证每次 read 都直接到达 readData
+    static qint64 readBytes(AudioRingDevice *device, qint64 bytes);
+    static bool closeTo(double value, double expected) { return std::abs(value - expected) < 0.01; }
+};
+
+qint64 TestAudioRingDevice::readBytes(AudioRingDevice *device, qint64 bytes)
+{
+    std::vector<char> buffer(static_cast<size_t>(bytes));
+    return device->read(buffer.data(), bytes);
+}
+
+void TestAudioRingDevice::testClockFollowsReadPosition()
+{
+    PlaybackClock clock;
+    AudioRingDevice device;
+    device.configure(kBytesPerSecond, 1.0, &clock);
+    QVERIFY(device.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+
+    const std::vector<uint8_t> pcm(2000, 0);
+    QVERIFY(device.writePcm(pcm.data(), 2000, 1.0));
+    QVERIFY(device.writePcm(pcm.data(), 2000, 1.2));   // 与按字节推算的位置一致，不产生标记
+    QVERIFY(device.writePcm(pcm.data(), 2000, 5.0));   // 不连续：偏移 4000 处的新基准
+    QVERIFY(closeTo(device.bufferedSeconds(), 0.6));
+    QVERIFY(!clock.isAnchored());
+
+    QCOMPARE(readBytes(&device, 1000), qint64(1000));
+    QCOMPARE(clock.source(), PlaybackClock::Source::Audio);
+    QVERIFY2(closeTo(clock.now(), 1.1), qPrintable(QString::number(clock.now())));
+
+    QCOMPARE(readBytes(&device, 2000), qint64(2000));
+    QVERIFY2(closeTo(clock.now(), 1.3), qPrintable(QString::number(clock.now())));
+
+    // 读位置越过标记，时钟从 5.0 起算
+    QCOMPARE(readBytes(&device, 1500), qint64(1500));
+    QVERIFY2(closeTo(clock.now(), 5.05), qPrintable(QString::number(clock.now())));
+
+    // 设备缓冲中的数据尚未被听到
+    device.setOutputLatency(0.02);
+    QCOMPARE(readBytes(&device, 500), qint64(500));
+    QVERIFY2(closeTo(clock.now(), 5.08), qPrintable(QString::number(clock.now())));
+    QVERIFY(closeTo(device.bufferedSeconds(), 0.1));
+}
+
+void TestAudioRingDevice::testDiscardResetsClockBase()
+{
+    PlaybackClock clock;
+    AudioRingDevice device;
+    device.configure(kBytesPerSecond, 1.0, &clock);
+    QVERIFY(device.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+
+    const std::vector<uint8_t> pcm(4000, 0);
+    QVERIFY(device.writePcm(pcm.data(), 4000, 0.0));
+    QCOMPARE(readBytes(&device, 1000), qint64(1000));
+    QVERIFY(closeTo(clock.now(), 0.1));
+
+    // 跳转：丢弃未播放数据，解码端同时重置时钟
+    device.discard();
+    clock.reset();
+    QCOMPARE(device.bytesAvailable(), qint64(0));
+    QCOMPARE(device.bufferedSeconds(), 0.0);
+    QCOMPARE(readBytes(&device, 1000), qint64(0));
+    QVERIFY(!clock.isAnchored());
+
+    // 新 pts 与旧基准推算的位置只差 30ms（不足以判为不连续），丢弃后仍以新 pts 为基准
+    QVERIFY(device.writePcm(pcm.data(), 2000, 0.43));
+    QCOMPARE(readBytes(&device, 500), qint64(500));
+    QVERIFY2(closeTo(clock.now(), 0.48), qPrintable(QString::number(clock.now())));
+
+    device.discard();
+    clock.reset();
+    QVERIFY(device.writePcm(pcm.data(), 2000, 30.0));
+    QCOMPARE(readBytes(&device, 1000), qint64(1000));
+    QVERIFY2(closeTo(clock.now(), 30.1), qPrintable(QString::number(clock.now())));
+}
+
+void TestAudioRingDevice::testReadUnblocksWriter()
+{
+    PlaybackClock clock;
+    AudioRingDevice device;
+    device.configure(kBytesPerSecond, 0.5, &clock);   // 5000 字节
+    QVERIFY(device.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+
+    const std::vector<uint8_t> pcm(8000, 0);
+    std::atomic<bool> finished{ false };
+    bool ok = false;
+    std::thread writer([&]() {
+        ok = device.writePcm(pcm.data(), 8000, 0.0);
+        finished = true;
+    });
+    // 断言提前返回时也要让写端退出，否则 std::thread 析构会终止进程
+    const auto joinWriter = qScopeGuard([&]() {
+        device.abort();
+        if (writer.joinable())
+            writer.join();
+    });
+
+    QTRY_VERIFY(closeTo(device.bufferedSeconds(), 0.5));
+    QTest::qWait(50);
+    QVERIFY(!finished);
+
+    // 读走的空间让写端写完剩余部分
+    QCOMPARE(readBytes(&device, 4000), qint64(4000));
+    QTRY_VERIFY(finished.load());
+    writer.join();
+    QVERIFY(ok);
+    QVERIFY(closeTo(device.bufferedSeconds(), 0.4));
+}
+
+void TestAudioRingDevice::testAbortUnblocksWriter()
+{
+    PlaybackClock clock;
+    AudioRingDevice device;
+    device.configure(kBytesPerSecond, 0.5, &clock);
+
+    const std::vector<uint8_t> pcm(8000, 0);
+    std::atomic<bool> finished{ false };
+    bool ok = true;
+    std::thread writer([&]() {
+        ok = device.writePcm(pcm.data(), 8000, 0.0);
+        finished = true;
+    });
+    const auto joinWriter = qScopeGuard([&]() {
+        device.abort();
+        if (writer.joinable())
+            writer.join();
+    });
+
+    // 缓冲写满后写端阻塞，没有读端时只能靠 abort() 返回
+    QTRY_VERIFY(closeTo(device.bufferedSeconds(), 0.5));
+    QTest::qWait(50);
+    QVERIFY(!finished);
+
+    device.abort();
+    QTRY_VERIFY(finished.load());
+    writer.join();
+    QVERIFY(!ok);
+
+    // abort 状态保留到 reset()，期间写入立即失败
+    QVERIFY(!device.writePcm(pcm.data(), 100, 1.0));
+    device.discard();
+    QVERIFY(!device.writePcm(pcm.data(), 100, 1.0));
+    device.reset();
+    QVERIFY(device.writePcm(pcm.data(), 100, 1.0));
+}
+
+QTEST_MAIN(TestAudioRingDevice)
+#include "test_audioringdevice.moc"
@@ -0,0 +1,127 @@
+#include <QtTest/QtTest>
+#include <algorithm>
+#include <deque>
+#include <random>
+#include "danmudedup.h"
+
+class TestDanmuDedup : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testMergeWithinWindow();
+    void testNormalize();
+    void testRemove();
+    void testMatchesReference();
+};
+
+void TestDanmuDedup::testMergeWithinWindow()
+{
+    DanmuDedup::Config config;
+    config.window = 3.0;
+    DanmuDedup dedup(config);
+    DanmuDedup::Merge merge;
+    std::vector<quint64> released;
+
+    QVERIFY(!dedup.add(1, QStringView(u"前方高能"), 0.0, &merge, &released));
+    QVERIFY(dedup.add(2, QStringView(u"前方高能！！"), 0.5, &merge, &released));
+    QCOMPARE(merge.id, quint64(1));
+    QCOMPARE(merge.count, 2);
+    QVERIFY(dedup.add(3, QUtf8StringView("前方 高能"), 3.0, &merge, &released));
+    QCOMPARE(merge.count, 3);
+    QVERIFY(released.empty());
+
+    // 窗口从首条算起，过期后相同文本重新作为新弹幕
+    QVERIFY(!dedup.add(4, QStringView(u"前方高能"), 3.5, &merge, &released));
+    QCOMPARE(released, std::vector<quint64>{ 1 });
+    QVERIFY(dedup.add(5, QStringView(u"前方高能"), 3.6, &merge));
+    QCOMPARE(merge.id, quint64(4));
+
+    const DanmuDedup::Stats stats = dedup.stats();
+    QCOMPARE(stats.received, quint64(5));
+    QCOMPARE(stats.merged, quint64(3));
+    QCOMPARE(stats.tracked, 1);
+}
+
+void TestDanmuDedup::testNormalize()
+{
+    auto same = [](QStringView a, QStringView b) { return DanmuDedup::fingerprint(a) == DanmuDedup::fingerprint(b); };
+    QVERIFY(same(u"AWSL", u"awsl"));
+    QVERIFY(same(u"ＡＷＳＬ", u"awsl"));
+    QVERIFY(same(u"哈哈哈哈哈哈", u"哈哈哈"));
+    QVERIFY(same(u"2333", u"233333"));
+    QVERIFY(same(u"好 活 ！", u"好活"));
+    QVERIFY(same(u"？？？？", u"???"));
+    QVERIFY(!same(u"哈哈", u"哈哈哈"));
+    QVERIFY(!same(u"???", u"!!!"));
+    QVERIFY(!same(u"好活", u"活好"));
+    QCOMPARE(DanmuDedup::fingerprint(QUtf8StringView("\xF0\x9F\x94\xA5 Nice")),
+             DanmuDedup::fingerprint(QStringView(u"\U0001F525nice")));
+}
+
+void TestDanmuDedup::testRemove()
+{
+    DanmuDedup dedup;
+    DanmuDedup::Merge merge;
+    QVERIFY(!dedup.add(1, QStringView(u"666"), 0.0));
+    dedup.remove(1);   // 首条被排布丢弃
+    QVERIFY(!dedup.add(2, QStringView(u"666"), 0.1));
+    QVERIFY(dedup.add(3, QStringView(u"666"), 0.2, &merge));
+    QCOMPARE(merge.id, quint64(2));
+    QCOMPARE(dedup.stats().tracked, 1);
+}
+
+void TestDanmuDedup::testMatchesReference()
+{
+    // 与逐项线性查找的参考实现对比，覆盖过期、容量挤出与撤销；文本取自小集合以产生大量重复
+    DanmuDedup::Config config;
+    config.window = 1.0;
+    config.capacity = 32;
+    DanmuDedup dedup(config);
+
+    struct Ref {
+        quint64 fingerprint;
+        quint64 id;
+        double first;
+        int count;
+        bool live;
+    };
+    std::deque<Ref> ref;
+
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> word(0, 59);
+    std::uniform_int_distribution<int> percent(0, 99);
+    const qsizetype memory = dedup.stats().memoryBytes;
+    double now = 0.0;
+    for (quint64 id = 0; id < 20000; ++id) {
+        now += std::uniform_real_distribution<double>(0.0, 0.02)(rng);
+        const QString text = QString::number(word(rng)) + QStringLiteral("弹幕");
+        const quint64 fingerprint = DanmuDedup::fingerprint(QStringView(text));
+
+        while (!ref.empty() && (!ref.front().live || ref.front().first + config.window < now))
+            ref.pop_front();
+        auto hit = std::find_if(ref.begin(), ref.end(),
+                                [&](const Ref &r) { return r.live && r.fingerprint == fingerprint; });
+        DanmuDedup::Merge merge;
+        const bool merged = dedup.add(id, QStringView(text), now, &merge);
+        QCOMPARE(merged, hit != ref.end());
+        if (merged) {
+            ++hit->count;
+            QCOMPARE(merge.id, hit->id);
+            QCOMPARE(merge.count, hit->count);
+            continue;
+        }
+        if (static_cast<int>(ref.size()) == config.capacity)
+            ref.pop_front();
+        ref.push_back({ fingerprint, id, now, 1, true });
+        if (percent(rng) < 10) {
+            dedup.remove(id);
+            ref.back().live = false;
+        }
+    }
+    QVERIFY(dedup.stats().tracked <= config.capacity);
+    QCOMPARE(dedup.stats().memoryBytes, memory);
+}
+
+QTEST_MAIN(TestDanmuDedup)
+#include "test_danmudedup.moc"
@@ -0,0 +1,170 @@
+#include <QtTest/QtTest>
+#include <random>
+#include <vector>
+#include "danmulayout.h"
+
+class TestDanmuLayout : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testNoCollision();
+    void testFixedLanes();
+    void testOverflow();
+    void testQueueExpiry();
+};
+
+namespace {
+struct Shown {
+    double start;
+    double speed;
+    double width;
+};
+
+// 同一滚动行中 b 晚于 a 出现，检查两者在 a 的整个可见时段内都不重叠
+bool overlaps(const Shown &a, const Shown &b, double screen, double duration, double gap)
+{
+    const double end = a.start + duration;
+    for (double t = b.start; t <= end; t += 0.01) {
+        const double aLeft = screen - a.speed * (t - a.start);
+        const double bLeft = screen - b.speed * (t - b.start);
+        if (bLeft < aLeft + a.width + gap - 1e-6)
+            return true;
+    }
+    return false;
+}
+}
+
+void TestDanmuLayout::testNoCollision()
+{
+    DanmuLayout::Config config;
+    config.width = 1280;
+    config.height = 720;
+    config.minGap = 16.0;
+    DanmuLayout layout(config);
+    QCOMPARE(layout.laneCount(), 720 / 36);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> width(20.0, 700.0);
+    std::vector<std::vector<Shown>> lanes(layout.laneCount());
+    std::vector<DanmuLayout::Placement> placed;
+
+    std::vector<double> widths;
+    auto record = [&](const DanmuLayout::Placement &placement) {
+        QCOMPARE(placement.y, placement.lane * 36.0);
+        const double w = widths[placement.id];
+        lanes[placement.lane].push_back({ placement.start, (config.width + w) / config.scrollDuration, w });
+    };
+
+    // 每 2ms 到达一条，排队的按 60Hz 重试
+    double now = 0.0;
+    for (quint64 id = 0; id < 20000; ++id) {
+        now += 0.002;
+        widths.push_back(width(rng));
+        DanmuLayout::Placement placement;
+        if (layout.place(id, widths.back(), DanmuLayout::Mode::Scroll, now, &placement) == DanmuLayout::Result::Placed)
+            record(placement);
+        if (id % 8 == 0) {
+            placed.clear();
+            layout.pump(now, &placed);
+            for (const DanmuLayout::Placement &p : placed)
+                record(p);
+        }
+    }
+    QVERIFY(layout.stats().placedFromQueue > 0);
+
+    int checked = 0;
+    for (const std::vector<Shown> &lane : lanes) {
+        for (size_t i = 1; i < lane.size(); ++i) {
+            QVERIFY(!overlaps(lane[i - 1], lane[i], config.width, config.scrollDuration, config.minGap));
+            ++checked;
+        }
+    }
+    QVERIFY(checked > 0);
+}
+
+void TestDanmuLayout::testFixedLanes()
+{
+    DanmuLayout::Config config;
+    config.height = 360;      // 10 行，顶部、底部各 5 行
+    config.fixedDuration = 4.0;
+    config.overflow = DanmuLayout::OverflowPolicy::Drop;
+    DanmuLayout layout(config);
+
+    DanmuLayout::Placement placement;
+    for (int i = 0; i < 5; ++i) {
+        QCOMPARE(layout.place(i, 100.0, DanmuLayout::Mode::Top, 0.0, &placement), DanmuLayout::Result::Placed);
+        QCOMPARE(placement.lane, i);
+        QCOMPARE(placement.y, i * 36.0);
+    }
+    QCOMPARE(layout.place(5, 100.0, DanmuLayout::Mode::Top, 1.0, &placement), DanmuLayout::Result::Dropped);
+
+    // 底部从下往上排，与顶部互不占用
+    QCOMPARE(layout.place(6, 100.0, DanmuLayout::Mode::Bottom, 1.0, &placement), DanmuLayout::Result::Placed);
+    QCOMPARE(placement.y, 360.0 - 36.0);
+
+    // 停留结束后行被释放
+    QCOMPARE(layout.place(7, 100.0, DanmuLayout::Mode::Top, 4.0, &placement), DanmuLayout::Result::Placed);
+    QCOMPARE(placement.lane, 0);
+}
+
+void TestDanmuLayout::testOverflow()
+{
+    DanmuLayout::Config config;
+    config.height = 36;       // 只有一行
+    config.overflow = DanmuLayout::OverflowPolicy::Drop;
+    DanmuLayout layout(config);
+
+    DanmuLayout::Placement placement;
+    QCOMPARE(layout.place(0, 200.0, DanmuLayout::Mode::Scroll, 0.0, &placement), DanmuLayout::Result::Placed);
+    QCOMPARE(layout.place(1, 200.0, DanmuLayout::Mode::Scroll, 0.0, &placement), DanmuLayout::Result::Dropped);
+    QCOMPARE(layout.stats().dropped, quint64(1));
+
+    config.overflow = DanmuLayout::OverflowPolicy::Queue;
+    config.maxQueued = 2;
+    layout.setConfig(config);
+    QCOMPARE(layout.place(0, 200.0, DanmuLayout::Mode::Scroll, 0.0, &placement), DanmuLayout::Result::Placed);
+    QCOMPARE(layout.place(1, 200.0, DanmuLayout::Mode::Scroll, 0.0, &placement), DanmuLayout::Result::Queued);
+    QCOMPARE(layout.place(2, 200.0, DanmuLayout::Mode::Scroll, 0.0, &placement), DanmuLayout::Result::Queued);
+    QCOMPARE(layout.place(3, 200.0, DanmuLayout::Mode::Scroll, 0.0, &placement), DanmuLayout::Result::Dropped);
+    QCOMPARE(layout.stats().queued, 2);
+
+    // 前一条完全进入并留出间距后，队首按到达顺序上屏
+    std::vector<DanmuLayout::Placement> placed;
+    QCOMPARE(layout.pump(0.1, &placed), 0);
+    QCOMPARE(layout.pump(1.0, &placed), 1);
+    QCOMPARE(placed.front().id, quint64(1));
+    QCOMPARE(placed.front().queuedFor, 1.0);
+
+    // 队列非空时新弹幕排到队尾，不插队
+    QCOMPARE(layout.place(4, 10.0, DanmuLayout::Mode::Scroll, 1.0, &placement), DanmuLayout::Result::Queued);
+}
+
+void TestDanmuLayout::testQueueExpiry()
+{
+    DanmuLayout::Config config;
+    config.height = 36;
+    config.fixedDuration = 4.0;
+    config.maxQueueDelay = 2.0;
+    DanmuLayout layout(config);
+
+    DanmuLayout::Placement placement;
+    QCOMPARE(layout.place(0, 100.0, DanmuLayout::Mode::Top, 0.0, &placement), DanmuLayout::Result::Placed);
+    QCOMPARE(layout.place(1, 100.0, DanmuLayout::Mode::Top, 0.5, &placement), DanmuLayout::Result::Queued);
+    QCOMPARE(layout.place(2, 100.0, DanmuLayout::Mode::Top, 3.0, &placement), DanmuLayout::Result::Queued);
+
+    std::vector<DanmuLayout::Placement> placed;
+    std::vector<quint64> expired;
+    QCOMPARE(layout.pump(3.0, &placed, &expired), 0);
+    QCOMPARE(expired.size(), size_t(1));
+    QCOMPARE(expired.front(), quint64(1));
+    QCOMPARE(layout.stats().expired, quint64(1));
+    QCOMPARE(layout.stats().queued, 1);
+
+    QCOMPARE(layout.pump(4.0, &placed, &expired), 1);
+    QCOMPARE(placed.front().id, quint64(2));
+    QCOMPARE(layout.stats().queued, 0);
+}
+
+QTEST_MAIN(TestDanmuLayout)
+#include "test_danmulayout.moc"
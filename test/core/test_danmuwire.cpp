@@ -0,0 +1,166 @@
+#include <QtTest/QtTest>
+#include <random>
+#include <string>
+#include "danmu.pb.h"
+#include "danmuloopback.h"
+#include "danmuwire.h"
+
+class TestDanmuWire : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRoundTrip_data();
+    void testRoundTrip();
+    void testUnknownFields();
+    void testCorruption();
+};
+
+namespace {
+// varint32 长度前缀 + 消息
+std::string delimited(const std::string &message)
+{
+    std::string out;
+    quint32 size = static_cast<quint32>(message.size());
+    while (size >= 0x80) {
+        out.push_back(static_cast<char>((size & 0x7F) | 0x80));
+        size >>= 7;
+    }
+    out.push_back(static_cast<char>(size));
+    return out + message;
+}
+
+std::string rawPacket(const danmu::wire::Batch &batch)
+{
+    danmu::wire::Packet packet;
+    packet.set_codec(danmu::wire::Packet::RAW);
+    packet.set_payload(batch.SerializeAsString());
+    packet.set_raw_size(static_cast<quint32>(packet.payload().size()));
+    return delimited(packet.SerializeAsString());
+}
+}
+
+void TestDanmuWire::testRoundTrip_data()
+{
+    QTest::addColumn<bool>("compress");
+    QTest::addColumn<int>("batchSize");
+    QTest::newRow("zlib-64") << true << 64;
+    QTest::newRow("zlib-1") << true << 1;
+    QTest::newRow("raw-200") << false << 200;
+}
+
+void TestDanmuWire::testRoundTrip()
+{
+    QFETCH(bool, compress);
+    QFETCH(int, batchSize);
+
+    DanmuLoopbackProducer::Options options;
+    options.compress = compress;
+    options.batchSize = batchSize;
+    DanmuLoopbackProducer producer(options);
+    DanmuWireDecoder decoder;
+    DanmuArena arena;
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> chunk(1, 97);
+
+    for (int round = 0; round < 20; ++round) {
+        QByteArray bytes;
+        producer.produce(1000000 + round * 500, 500, &bytes);
+
+        // 按任意长度切分送入，模拟网络分片
+        arena.clear();
+        int decoded = 0;
+        for (qsizetype pos = 0; pos < bytes.size();) {
+            const qsizetype n = std::min<qsizetype>(chunk(rng), bytes.size() - pos);
+            const int result = decoder.feed(bytes.constData() + pos, n, &arena);
+            QVERIFY(result >= 0);
+            decoded += result;
+            pos += n;
+        }
+
+        const danmu::wire::Batch &batch = producer.lastBatch();
+        QCOMPARE(decoded, batch.comments_size());
+        QCOMPARE(arena.size(), batch.comments_size());
+        for (int i = 0; i < arena.size(); ++i) {
+            const DanmuArena::Comment &comment = arena.at(i);
+            const danmu::wire::Comment &expected = batch.comments(i);
+            QCOMPARE(comment.id, static_cast<quint64>(expected.id()));
+            QCOMPARE(comment.batch, static_cast<quint64>(batch.sequence()));
+            QCOMPARE(comment.timeMs, static_cast<qint64>(batch.base_time_ms() + expected.offset_ms()));
+            QCOMPARE(static_cast<int>(comment.mode), static_cast<int>(expected.mode()));
+            QCOMPARE(comment.color, expected.has_color() ? expected.color() : 0xFFFFFFu);
+            QCOMPARE(comment.user, static_cast<quint64>(expected.user()));
+            QCOMPARE(arena.text(comment).toString(), QString::fromStdString(expected.text()));
+        }
+    }
+
+    const DanmuWireDecoder::Stats stats = decoder.stats();
+    QCOMPARE(stats.packets, quint64(20));
+    QCOMPARE(stats.comments, quint64(20 * batchSize));
+    QCOMPARE(stats.errors, quint64(0));
+    QCOMPARE(stats.sequenceGaps, quint64(0));
+}
+
+void TestDanmuWire::testUnknownFields()
+{
+    // 服务端新增的字段（此处为 Comment 的 15、16 号与 Batch 的 9 号）应被跳过
+    danmu::wire::Comment comment;
+    comment.set_id(42);
+    comment.set_text("新字段");
+    std::string commentBytes = comment.SerializeAsString();
+    commentBytes += std::string("\x78\x05", 2);                 // 15: varint 5
+    commentBytes += std::string("\x82\x01\x02hi", 5);           // 16: bytes "hi"
+
+    std::string batchBytes;
+    batchBytes += std::string("\x08\x07", 2);                   // sequence = 7
+    batchBytes += std::string("\x48\x01", 2);                   // 9: varint 1
+    batchBytes += '\x1A';
+    batchBytes += static_cast<char>(commentBytes.size());
+    batchBytes += commentBytes;
+    batchBytes += std::string("\x10\xE8\x07", 3);               // base_time_ms = 1000，位于 comments 之后
+
+    danmu::wire::Packet packet;
+    packet.set_payload(batchBytes);
+    packet.set_raw_size(static_cast<quint32>(batchBytes.size()));
+    const std::string bytes = delimited(packet.SerializeAsString());
+
+    DanmuWireDecoder decoder;
+    DanmuArena arena;
+    QCOMPARE(decoder.feed(bytes.data(), static_cast<qsizetype>(bytes.size()), &arena), 1);
+    QCOMPARE(arena.at(0).id, quint64(42));
+    QCOMPARE(arena.at(0).batch, quint64(7));
+    QCOMPARE(arena.at(0).timeMs, qint64(1000));
+    QCOMPARE(arena.at(0).color, 0xFFFFFFu);
+    QCOMPARE(arena.text(arena.at(0)).toString(), QString::fromUtf8("新字段"));
+}
+
+void TestDanmuWire::testCorruption()
+{
+    danmu::wire::Batch batch;
+    batch.set_sequence(1);
+    batch.add_comments()->set_text("ok");
+    const std::string good = rawPacket(batch);
+
+    // 内容损坏（Comment 长度越界）的包被跳过，后面的包照常解出
+    danmu::wire::Packet broken;
+    broken.set_payload(std::string("\x1A\x7F\x08", 3));
+    const std::string bad = delimited(broken.SerializeAsString());
+
+    DanmuWireDecoder decoder;
+    DanmuArena arena;
+    const std::string stream = bad + good;
+    QCOMPARE(decoder.feed(stream.data(), static_cast<qsizetype>(stream.size()), &arena), 1);
+    QCOMPARE(decoder.stats().errors, quint64(1));
+    QCOMPARE(arena.size(), 1);
+
+    // 长度前缀损坏时丢弃缓冲并报错，之后的完整包仍可解出
+    const std::string garbage(6, '\xFF');
+    QCOMPARE(decoder.feed(garbage.data(), static_cast<qsizetype>(garbage.size()), &arena), -1);
+    batch.set_sequence(2);
+    const std::string next = rawPacket(batch);
+    QCOMPARE(decoder.feed(next.data(), static_cast<qsizetype>(next.size()), &arena), 1);
+    QCOMPARE(decoder.stats().errors, quint64(2));
+}
+
+QTEST_MAIN(TestDanmuWire)
+#include "test_danmuwire.moc"
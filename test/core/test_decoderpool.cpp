@@ -0,0 +1,187 @@
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <cmath>
+#include <set>
+#include <thread>
+#include "decoderpool.h"
+#include "syntheticclip.h"
+
+// 多路合成流共用 2 个工作线程：隐藏流只输出关键帧，焦点流分到最多的解码时间，
+// 输出队列满后工作线程靠渲染端消费唤醒（不轮询）
+class TestDecoderPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void testHiddenQueuesKeyframesOnly();
+    void testFocusedGetsLargestShare();
+    void testResumesWhenQueueDrains();
+    void testSingleSlotQueueKeepsEveryFrame();
+
+private:
+    static constexpr int kFps = 25;
+    static constexpr int kFrames = 250;
+    static constexpr int kGop = 25;
+
+    // 消费者：不断取走各队列的帧，直到 done() 成立（之后再取空一次）或超时
+    template <typename Done>
+    bool drainUntil(const std::vector<FrameQueue *> &queues, Done done,
+                    std::vector<std::vector<double>> *pts = nullptr);
+
+    QTemporaryDir dir_;
+    QString clip_;
+    std::set<int> keyframes_;   // 关键帧序号（pts × fps）
+};
+
+void TestDecoderPool::initTestCase()
+{
+    QVERIFY(dir_.isValid());
+    clip_ = dir_.filePath("synthetic.mkv");
+    QString error;
+    synthetic::ClipSpec spec;
+    spec.fps = kFps;
+    spec.frames = kFrames;
+    spec.gop = kGop;
+    if (!synthetic::writeClip(clip_, spec, &keyframes_, &error))
+        QSKIP(qPrintable("cannot generate synthetic clip: " + error));
+    QCOMPARE(int(keyframes_.size()), kFrames / kGop);
+}
+
+template <typename Done>
+bool TestDecoderPool::drainUntil(const std::vector<FrameQueue *> &queues, Done done,
+                                 std::vector<std::vector<double>> *pts)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (;;) {
+        const bool finished = done();
+        bool any = false;
+        for (size_t i = 0; i < queues.size(); ++i) {
+            VideoFrame frame;
+            while (queues[i]->pop(frame)) {
+                any = true;
+                if (pts)
+                    (*pts)[i].push_back(frame.pts);
+            }
+        }
+        if (finished)
+            return true;
+        if (timer.elapsed() > 30000)
+            return false;
+        if (!any)
+            std::this_thread::yield();
+    }
+}
+
+void TestDecoderPool::testHiddenQueuesKeyframesOnly()
+{
+    FrameQueue visibleQueue(8);
+    FrameQueue hiddenQueue(8);
+    DecoderPool pool(2);
+    const auto visible = pool.addStream(clip_, &visibleQueue, DecoderPool::Priority::Visible);
+    const auto hidden = pool.addStream(clip_, &hiddenQueue, DecoderPool::Priority::Hidden);
+
+    auto ended = [&pool](DecoderPool::StreamId id) {
+        return pool.streamStats(id).state == StreamDecoder::State::Ended;
+    };
+    std::vector<std::vector<double>> pts(2);
+    QVERIFY(drainUntil({ &visibleQueue, &hiddenQueue },
+                       [&]() { return ended(visible) && ended(hidden); }, &pts));
+
+    QCOMPARE(int(pts[0].size()), kFrames);
+    QCOMPARE(int(pts[1].size()), int(keyframes_.size()));
+    for (double value : pts[1]) {
+        const int index = static_cast<int>(std::lround(value * kFps));
+        QVERIFY2(keyframes_.count(index), qPrintable(QString("non-key frame at %1 s").arg(value)));
+    }
+
+    const StreamDecoder::Stats stats = pool.streamStats(hidden).decoder;
+    QCOMPARE(int(stats.skippedPackets), kFrames - int(keyframes_.size()));
+    QCOMPARE(int(stats.packets), int(keyframes_.size()));
+}
+
+void TestDecoderPool::testFocusedGetsLargestShare()
+{
+    // 流多于工作线程且消费不设限，各流始终可运行，解码时间按权重 8:4:4:4 分配
+    constexpr int kStreams = 4;
+    std::vector<std::unique_ptr<FrameQueue>> queues;
+    std::vector<FrameQueue *> raw;
+    for (int i = 0; i < kStreams; ++i) {
+        queues.push_back(std::make_unique<FrameQueue>(8));
+        raw.push_back(queues.back().get());
+    }
+
+    DecoderPool pool(2);
+    std::vector<DecoderPool::StreamId> ids;
+    for (int i = 0; i < kStreams; ++i)
+        ids.push_back(pool.addStream(clip_, raw[i], i == 0 ? DecoderPool::Priority::Focused
+                                                           : DecoderPool::Priority::Visible));
+
+    QVERIFY(drainUntil(raw, [&]() {
+        return pool.streamStats(ids[0]).state == StreamDecoder::State::Ended;
+    }));
+
+    const DecoderPool::StreamStats focused = pool.streamStats(ids[0]);
+    QCOMPARE(focused.priority, DecoderPool::Priority::Focused);
+    QCOMPARE(int(focused.decoder.packets), kFrames);
+    for (int i = 1; i < kStreams; ++i) {
+        const DecoderPool::StreamStats visible = pool.streamStats(ids[i]);
+        QVERIFY2(visible.decoder.packets < focused.decoder.packets,
+                 qPrintable(QString("stream %1 decoded %2 packets, focused %3")
+                                .arg(i).arg(visible.decoder.packets).arg(focused.decoder.packets)));
+    }
+}
+
+void TestDecoderPool::testResumesWhenQueueDrains()
+{
+    // 队列很快被填满，工作线程随即无事可做；之后只有渲染端取帧能让它继续
+    FrameQueue queue(2);
+    DecoderPool pool(2);
+    const auto id = pool.addStream(clip_, &queue, DecoderPool::Priority::Visible);
+
+    QTRY_COMPARE(queue.size(), queue.capacity());
+    QTest::qWait(100);
+    QCOMPARE(queue.size(), queue.capacity());
+
+    std::vector<std::vector<double>> pts(1);
+    QVERIFY(drainUntil({ &queue }, [&]() {
+        return pool.streamStats(id).state == StreamDecoder::State::Ended;
+    }, &pts));
+
+    // 可见流在队列满时等待而不是丢帧
+    QCOMPARE(int(pts[0].size()), kFrames);
+    QCOMPARE(int(pool.streamStats(id).decoder.droppedFrames), 0);
+}
+
+void TestDecoderPool::testSingleSlotQueueKeepsEveryFrame()
+{
+    // 容量取整后只有两格，一次 step 的输出（含结束时排空解码器）经常放不下，
+    // 多出的帧须留到下一次 step，而不是在结束或突发时丢掉
+    FrameQueue queue(1);
+    DecoderPool pool(2);
+    const auto id = pool.addStream(clip_, &queue, DecoderPool::Priority::Focused);
+
+    std::vector<double> pts;
+    QElapsedTimer timer;
+    timer.start();
+    bool ended = false;
+    while (!ended && timer.elapsed() < 30000) {
+        ended = pool.streamStats(id).state == StreamDecoder::State::Ended;
+        VideoFrame frame;
+        while (queue.pop(frame))
+            pts.push_back(frame.pts);
+        // 消费慢于解码，队列多数时候是满的
+        QThread::usleep(500);
+    }
+    QVERIFY(ended);
+
+    QCOMPARE(int(pts.size()), kFrames);
+    for (int i = 0; i < kFrames; ++i)
+        QCOMPARE(int(std::lround(pts[i] * kFps)), i);
+    QCOMPARE(int(pool.streamStats(id).decoder.droppedFrames), 0);
+}
+
+QTEST_MAIN(TestDecoderPool)
+#include "test_decoderpool.moc"
@@ -0,0 +1,100 @@
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QThread>
+#include <atomic>
+#include <thread>
+#include "framepacer.h"
+#include "playbackclock.h"
+
+// 帧节奏：晚于阈值的帧丢弃、阈值 <= 0 时从不丢帧、stop 置位时立即结束等待
+class TestFramePacer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testLateThreshold();
+    void testNonPositiveThresholdNeverDrops();
+    void testWaitsUntilPts();
+    void testStopAbortsWait();
+};
+
+void TestFramePacer::testLateThreshold()
+{
+    PlaybackClock clock;
+    clock.anchor(10.0);
+    FramePacer pacer(&clock);
+    pacer.setLateThreshold(0.1);
+    const std::atomic<bool> stop{ false };
+
+    // 留出足够余量，避免调度抖动让结果越过阈值
+    QVERIFY(pacer.isLate(clock.now() - 0.5));
+    QCOMPARE(pacer.pace(clock.now() - 0.5, stop), FramePacer::Decision::Drop);
+    QVERIFY(!pacer.isLate(clock.now() - 0.02));
+    QCOMPARE(pacer.pace(clock.now() - 0.02, stop), FramePacer::Decision::Present);
+
+    // 放宽阈值后同样迟到的帧改为显示
+    pacer.setLateThreshold(1.0);
+    QCOMPARE(pacer.lateThreshold(), 1.0);
+    QCOMPARE(pacer.pace(clock.now() - 0.5, stop), FramePacer::Decision::Present);
+
+    const FramePacer::Stats stats = pacer.stats();
+    QCOMPARE(stats.dropped, quint64(1));
+    QCOMPARE(stats.presented, quint64(2));
+    QVERIFY(stats.maxLatenessMs >= 500.0);
+}
+
+void TestFramePacer::testNonPositiveThresholdNeverDrops()
+{
+    PlaybackClock clock;
+    clock.anchor(100.0);
+    FramePacer pacer(&clock);
+    const std::atomic<bool> stop{ false };
+
+    for (double threshold : { 0.0, -1.0 }) {
+        pacer.setLateThreshold(threshold);
+        QVERIFY(!pacer.isLate(0.0));
+        QCOMPARE(pacer.pace(0.0, stop), FramePacer::Decision::Present);
+    }
+    QCOMPARE(pacer.stats().dropped, quint64(0));
+    QCOMPARE(pacer.stats().presented, quint64(2));
+}
+
+void TestFramePacer::testWaitsUntilPts()
+{
+    PlaybackClock clock;
+    FramePacer pacer(&clock);
+    const std::atomic<bool> stop{ false };
+
+    // 未锚定时以首帧锚定，立即显示
+    QCOMPARE(pacer.pace(5.0, stop), FramePacer::Decision::Present);
+    QVERIFY(clock.isAnchored());
+
+    QCOMPARE(pacer.pace(5.05, stop), FramePacer::Decision::Present);
+    // 返回时主时钟已到达 pts
+    QVERIFY(clock.now() >= 5.05);
+    QVERIFY(pacer.stats().lastLatenessMs >= 0.0);
+}
+
+void TestFramePacer::testStopAbortsWait()
+{
+    PlaybackClock clock;
+    clock.anchor(0.0);
+    FramePacer pacer(&clock);
+    std::atomic<bool> stop{ false };
+
+    QElapsedTimer timer;
+    timer.start();
+    FramePacer::Decision decision = FramePacer::Decision::Present;
+    std::thread waiter([&]() { decision = pacer.pace(10.0, stop); });
+    QThread::msleep(50);
+    stop = true;
+    waiter.join();
+
+    // 分段睡眠，置位后最多一个睡眠片即返回，不会等到 10 秒
+    QVERIFY2(timer.elapsed() < 2000, qPrintable(QString("pace returned after %1 ms").arg(timer.elapsed())));
+    QCOMPARE(decision, FramePacer::Decision::Drop);
+    QCOMPARE(pacer.stats().presented, quint64(0));
+}
+
+QTEST_MAIN(TestFramePacer)
+#include "test_framepacer.moc"
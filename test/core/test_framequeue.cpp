@@ -0,0 +1,214 @@
+#include <QtTest/QtTest>
+#include <atomic>
+#include <thread>
+#include "framequeue.h"
+
+class TestFrameQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testCapacity();
+    void testPushPop();
+    void testPopDueDropStale();
+    void testPopDueKeepAll();
+    void testSpscOrder();
+    void testPoolRecycle();
+    void testDiscardBefore();
+    void testSpaceAvailableCallback();
+};
+
+void TestFrameQueue::testCapacity()
+{
+    FrameQueue queue(5);
+    QCOMPARE(queue.capacity(), size_t(8));
+
+    for (int i = 0; i < 8; ++i)
+        QVERIFY(queue.push(VideoFrame{ FrameRef(), double(i) }));
+    QVERIFY(!queue.push(VideoFrame{ FrameRef(), 8.0 }));
+    QCOMPARE(queue.size(), size_t(8));
+}
+
+void TestFrameQueue::testPushPop()
+{
+    FrameQueue queue(4);
+    QVERIFY(queue.peek() == nullptr);
+
+    auto pool = FramePool::create(2);
+    pool->configure(4, 4, AV_PIX_FMT_RGB24);
+    queue.push(VideoFrame{ pool->acquire(), 1.5 });
+    QCOMPARE(queue.peek()->pts, 1.5);
+
+    VideoFrame out;
+    QVERIFY(queue.pop(out));
+    QCOMPARE(out.pts, 1.5);
+    QCOMPARE(out.buffer->width, 4);
+    QVERIFY(queue.isEmpty());
+
+    // 出队后只剩 out 持有缓冲，释放后回到池中
+    out.buffer.reset();
+    QCOMPARE(pool->stats().outstanding, 0);
+}
+
+void TestFrameQueue::testPopDueDropStale()
+{
+    FrameQueue queue(8);
+    for (int i = 0; i < 5; ++i)
+        queue.push(VideoFrame{ FrameRef(), i * 0.04 });
+
+    VideoFrame out;
+    int dropped = 0;
+    QVERIFY(queue.popDue(0.10, DropPolicy::DropStale, out, &dropped));
+    QCOMPARE(out.pts, 0.08);
+    QCOMPARE(dropped, 2);
+    QCOMPARE(queue.size(), size_t(2));
+
+    QVERIFY(!queue.popDue(0.10, DropPolicy::DropStale, out, &dropped));
+    QCOMPARE(dropped, 0);
+}
+
+void TestFrameQueue::testPopDueKeepAll()
+{
+    FrameQueue queue(8);
+    for (int i = 0; i < 3; ++i)
+        queue.push(VideoFrame{ FrameRef(), i * 0.04 });
+
+    VideoFrame out;
+    int dropped = 0;
+    QVERIFY(queue.popDue(1.0, DropPolicy::KeepAll, out, &dropped));
+    QCOMPARE(out.pts, 0.0);
+    QCOMPARE(dropped, 0);
+    QCOMPARE(queue.size(), size_t(2));
+}
+
+void TestFrameQueue::testSpscOrder()
+{
+    FrameQueue queue(16);
+    const int count = 100000;
+
+    std::atomic<bool> stop{ false };
+
+    std::thread producer([&]() {
+        for (int i = 0; i < count; ++i) {
+            while (!queue.push(VideoFrame{ FrameRef(), double(i) })) {
+                if (stop.load(std::memory_order_relaxed))
+                    return;
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // 循环内不能直接 QCOMPARE：提前返回时 producer 仍可 join，会触发 std::terminate
+    int expected = 0;
+    double mismatch = -1.0;
+    VideoFrame out;
+    while (expected < count) {
+        if (queue.pop(out)) {
+            if (out.pts != double(expected)) {
+                mismatch = out.pts;
+                break;
+            }
+            ++expected;
+        }
+    }
+    stop.store(true, std::memory_order_relaxed);
+    producer.join();
+    if (mismatch >= 0.0)
+        QCOMPARE(mismatch, double(expected));
+    QVERIFY(queue.isEmpty());
+}
+
+void TestFrameQueue::testPoolRecycle()
+{
+    auto pool = FramePool::create(3);
+    pool->configure(64, 32, AV_PIX_FMT_RGB24);
+
+    // 预热：最多分配 maxBuffers 个缓冲
+    {
+        FrameRef a = pool->acquire();
+        FrameRef b = pool->acquire();
+        FrameRef c = pool->acquire();
+        QVERIFY(a && b && c);
+        QVERIFY(!pool->acquire());
+        QCOMPARE(a->linesize[0] % 4, 0);
+    }
+    QCOMPARE(pool->stats().allocations, quint64(3));
+
+    // 稳态：反复借还不再分配
+    for (int i = 0; i < 1000; ++i) {
+        FrameRef ref = pool->acquire();
+        FrameRef copy = ref;
+        QVERIFY(copy);
+    }
+    FramePool::Stats stats = pool->stats();
+    QCOMPARE(stats.allocations, quint64(3));
+    QCOMPARE(stats.outstanding, 0);
+    QCOMPARE(stats.acquires, stats.recycles);
+
+    // 尺寸变化后重新分配
+    pool->configure(32, 32, AV_PIX_FMT_RGB24);
+    FrameRef ref = pool->acquire();
+    QCOMPARE(ref->width, 32);
+    QCOMPARE(pool->stats().allocations, quint64(4));
+}
+
+void TestFrameQueue::testDiscardBefore()
+{
+    FrameQueue queue(8);
+    auto pool = FramePool::create(4);
+    pool->configure(4, 4, AV_PIX_FMT_RGB24);
+    queue.push(VideoFrame{ pool->acquire(), 5.0, 0 });
+    queue.push(VideoFrame{ pool->acquire(), 5.04, 0 });
+    queue.push(VideoFrame{ pool->acquire(), 1.0, 1 });
+
+    // 跳转后旧 serial 的帧在消费端被跳过，缓冲立即归还
+    queue.discardBefore(1);
+    VideoFrame *head = queue.peek();
+    QVERIFY(head != nullptr);
+    QCOMPARE(head->serial, 1);
+    QCOMPARE(head->pts, 1.0);
+    QCOMPARE(queue.size(), size_t(1));
+    QCOMPARE(pool->stats().outstanding, 1);
+
+    VideoFrame out;
+    QVERIFY(queue.popDue(1.0, DropPolicy::DropStale, out));
+    QCOMPARE(out.serial, 1);
+}
+
+void TestFrameQueue::testSpaceAvailableCallback()
+{
+    FrameQueue queue(4);
+    int calls = 0;
+    queue.setSpaceAvailableCallback([&calls]() { ++calls; });
+
+    VideoFrame out;
+    for (int i = 0; i < 3; ++i)
+        queue.push(VideoFrame{ FrameRef(), double(i) });
+    QVERIFY(queue.pop(out));
+    QCOMPARE(calls, 0);
+
+    // 只在由满变为不满时通知
+    queue.push(VideoFrame{ FrameRef(), 3.0 });
+    queue.push(VideoFrame{ FrameRef(), 4.0 });
+    QVERIFY(queue.pop(out));
+    QCOMPARE(calls, 1);
+    QVERIFY(queue.pop(out));
+    QCOMPARE(calls, 1);
+
+    // 消费端丢弃旧 serial 的帧同样会腾出空间
+    queue.push(VideoFrame{ FrameRef(), 5.0 });
+    queue.push(VideoFrame{ FrameRef(), 6.0 });
+    QCOMPARE(queue.size(), size_t(4));
+    queue.discardBefore(1);
+    QVERIFY(queue.peek() == nullptr);
+    QCOMPARE(calls, 2);
+
+    queue.setSpaceAvailableCallback(nullptr);
+    for (int i = 0; i < 4; ++i)
+        queue.push(VideoFrame{ FrameRef(), 7.0, 1 });
+    QVERIFY(queue.pop(out));
+    QCOMPARE(calls, 2);
+}
+
+QTEST_MAIN(TestFrameQueue)
+#include "test_framequeue.moc"
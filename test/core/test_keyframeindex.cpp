@@ -0,0 +1,166 @@
+#include <QtTest/QtTest>
+#include "keyframeindex.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+// 关键帧索引：逐步建立时只信任确认连续的区间，跳转后断开连续性，
+// 完整的容器索引总是可用；查找按 pts，返回 dts
+class TestKeyframeIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testUnlinkedIntervalFallsBack();
+    void testLinkedInterval();
+    void testMarkDiscontinuity();
+    void testLookupByPts();
+    void testCompleteIndex();
+};
+
+void TestKeyframeIndex::testUnlinkedIntervalFallsBack()
+{
+    KeyframeIndex index;
+    KeyframeIndex::Entry entry;
+    QVERIFY(!index.floor(0, &entry));
+
+    index.add(0, 0, 100);
+    index.markDiscontinuity();
+    index.add(250, 250, 900);
+    QCOMPARE(index.size(), 2);
+
+    // 0 与 250 之间可能还有没见过的关键帧
+    QVERIFY(!index.floor(100, &entry));
+    QVERIFY(!index.floor(300, &entry));
+    QVERIFY(!index.floor(-1, &entry));
+
+    // 恰好落在已知关键帧上时总是可用
+    QVERIFY(index.floor(0, &entry));
+    QCOMPARE(entry.timestamp, int64_t(0));
+    QCOMPARE(entry.pos, int64_t(100));
+    QVERIFY(index.floor(250, &entry));
+    QCOMPARE(entry.pos, int64_t(900));
+}
+
+void TestKeyframeIndex::testLinkedInterval()
+{
+    KeyframeIndex index;
+    for (int64_t ts : { 0, 25, 50, 75 })
+        index.add(ts, ts, ts * 10);
+    QVERIFY(!index.isComplete());
+
+    KeyframeIndex::Entry entry;
+    QVERIFY(index.floor(30, &entry));
+    QCOMPARE(entry.timestamp, int64_t(25));
+    QCOMPARE(entry.pos, int64_t(250));
+    QVERIFY(index.floor(74, &entry));
+    QCOMPARE(entry.timestamp, int64_t(50));
+
+    // 最后一个关键帧之后不知道下一个在哪里
+    QVERIFY(!index.floor(80, &entry));
+
+    // 重复登记不产生新条目，也不破坏连续性
+    index.markDiscontinuity();
+    index.add(25, 25, 250);
+    QCOMPARE(index.size(), 4);
+    QVERIFY(index.floor(60, &entry));
+    QCOMPARE(entry.timestamp, int64_t(50));
+}
+
+void TestKeyframeIndex::testMarkDiscontinuity()
+{
+    KeyframeIndex index;
+    index.add(0, 0, -1);
+    index.add(25, 25, -1);
+    // 跳转到 75 继续解复用：50 没见过，25 到 75 不能算连续
+    index.markDiscontinuity();
+    index.add(75, 75, -1);
+    index.add(100, 100, -1);
+
+    KeyframeIndex::Entry entry;
+    QVERIFY(index.floor(10, &entry));
+    QCOMPARE(entry.timestamp, int64_t(0));
+    QVERIFY(!index.floor(60, &entry));
+    QVERIFY(index.floor(90, &entry));
+    QCOMPARE(entry.timestamp, int64_t(75));
+
+    // 再从 25 顺序读过去，补上 50 后整段连续
+    index.markDiscontinuity();
+    index.add(25, 25, -1);
+    index.add(50, 50, -1);
+    index.add(75, 75, -1);
+    QVERIFY(index.floor(60, &entry));
+    QCOMPARE(entry.timestamp, int64_t(50));
+    QVERIFY(index.floor(30, &entry));
+    QCOMPARE(entry.timestamp, int64_t(25));
+}
+
+void TestKeyframeIndex::testLookupByPts()
+{
+    // 有 B 帧时关键帧的 dts 比 pts 早两帧
+    KeyframeIndex index;
+    for (int64_t pts : { 0, 25, 50 })
+        index.add(pts - 2, pts, -1);
+
+    KeyframeIndex::Entry entry;
+    // 目标 24 早于 pts 25 的关键帧，按 dts 比较会错选它
+    QVERIFY(index.floor(24, &entry));
+    QCOMPARE(entry.timestamp, int64_t(-2));
+    QVERIFY(index.floor(25, &entry));
+    QCOMPARE(entry.timestamp, int64_t(23));
+    QVERIFY(index.floor(49, &entry));
+    QCOMPARE(entry.timestamp, int64_t(23));
+
+    // 只有 pts 的包按 pts 登记
+    KeyframeIndex ptsOnly;
+    ptsOnly.add(KeyframeIndex::kNoTimestamp, 10, -1);
+    ptsOnly.add(KeyframeIndex::kNoTimestamp, KeyframeIndex::kNoTimestamp, -1);
+    QCOMPARE(ptsOnly.size(), 1);
+    QVERIFY(ptsOnly.floor(10, &entry));
+    QCOMPARE(entry.timestamp, int64_t(10));
+}
+
+void TestKeyframeIndex::testCompleteIndex()
+{
+    AVFormatContext *format = avformat_alloc_context();
+    QVERIFY(format);
+    AVStream *stream = avformat_new_stream(format, nullptr);
+    QVERIFY(stream);
+    for (int64_t dts : { 0, 25, 50, 75 })
+        QVERIFY(av_add_index_entry(stream, dts * 100, dts, 1000, 0, AVINDEX_KEYFRAME) >= 0);
+    // 非关键帧条目不导入
+    QVERIFY(av_add_index_entry(stream, 1234, 30, 1000, 5, 0) >= 0);
+
+    KeyframeIndex index;
+    QCOMPARE(index.loadFromStream(stream), 4);
+    avformat_free_context(format);
+    QVERIFY(index.isComplete());
+
+    // 完整索引不需要连续性确认，最后一个关键帧之后也可用
+    KeyframeIndex::Entry entry;
+    QVERIFY(index.floor(30, &entry));
+    QCOMPARE(entry.timestamp, int64_t(25));
+    QCOMPARE(entry.pos, int64_t(2500));
+    QVERIFY(index.floor(1000, &entry));
+    QCOMPARE(entry.timestamp, int64_t(75));
+    QVERIFY(!index.floor(-1, &entry));
+
+    // 解复用只补记 pts 偏移，不增加条目；未解复用到的条目沿用观察到的偏移
+    index.add(50, 52, 5000);
+    index.add(60, 62, 6000);
+    QCOMPARE(index.size(), 4);
+    QVERIFY(index.floor(51, &entry));
+    QCOMPARE(entry.timestamp, int64_t(25));
+    QVERIFY(index.floor(52, &entry));
+    QCOMPARE(entry.timestamp, int64_t(50));
+    QVERIFY(index.floor(76, &entry));
+    QCOMPARE(entry.timestamp, int64_t(50));
+
+    index.reset();
+    QCOMPARE(index.size(), 0);
+    QVERIFY(!index.isComplete());
+}
+
+QTEST_MAIN(TestKeyframeIndex)
+#include "test_keyframeindex.moc"
@@ -0,0 +1,157 @@
+#include <QtTest/QtTest>
+#include <QSemaphore>
+#include <QTemporaryDir>
+#include <atomic>
+#include <random>
+#include "keywordfilter.h"
+#include "keywordfilterloader.h"
+
+namespace {
+// 第一次读取停在 gate 上，用来让旧的构建在新的提交之后才完成；关键词即 path 本身
+class GatedLoader : public KeywordFilterLoader
+{
+public:
+    QSemaphore entered;
+    QSemaphore gate;
+    std::atomic<int> reads{ 0 };
+
+protected:
+    bool readKeywords(const QString &path, QStringList *keywords) override
+    {
+        if (reads.fetch_add(1) == 0) {
+            entered.release();
+            gate.acquire();
+        }
+        *keywords = QStringList{ path };
+        return true;
+    }
+};
+}
+
+class TestKeywordFilter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testOverlapping();
+    void testCaseAndUtf8();
+    void testMatchesContains();
+    void testParse();
+    void testLoaderReadsFile();
+    void testLoaderDiscardsStaleBuild();
+};
+
+void TestKeywordFilter::testOverlapping()
+{
+    const KeywordFilter filter(QStringList{ QStringLiteral("he"), QStringLiteral("she"), QStringLiteral("his"),
+                                            QStringLiteral("hers"), QStringLiteral("she"), QString() });
+    QCOMPARE(filter.stats().keywords, 4);   // 空串与重复项被忽略
+
+    int keyword = -1;
+    QVERIFY(filter.matches(QStringView(u"ushers"), &keyword));
+    QCOMPARE(filter.keyword(keyword), QStringLiteral("she"));          // 最先结束的命中
+    QVERIFY(filter.matches(QStringView(u"ahishers")));
+    QVERIFY(!filter.matches(QStringView(u"hi s h e")));
+    QVERIFY(!KeywordFilter().matches(QStringView(u"anything")));
+}
+
+void TestKeywordFilter::testCaseAndUtf8()
+{
+    const KeywordFilter filter(QStringList{ QStringLiteral("Spam"), QStringLiteral("广告"), QStringLiteral("\U0001F525火") });
+
+    QVERIFY(filter.matches(QStringView(u"buy SPAM now")));
+    QVERIFY(filter.matches(QUtf8StringView("加我看广告")));
+    QVERIFY(filter.matches(QUtf8StringView("\xF0\x9F\x94\xA5\xE7\x81\xAB")));   // 🔥火
+    QVERIFY(!filter.matches(QUtf8StringView("\xF0\x9F\x94\xA5 \xE7\x81\xAB")));
+    // 非法 UTF-8 按 U+FFFD 处理，不影响其后的匹配
+    QVERIFY(filter.matches(QUtf8StringView("\xFF\xC0spam")));
+    QVERIFY(!filter.matches(QUtf8StringView("\xE5\xB9")));   // 截断的“广”
+}
+
+void TestKeywordFilter::testMatchesContains()
+{
+    // 小字母表上的随机关键词与文本，结果与逐个 contains 一致
+    const QString alphabet = QStringLiteral("abAB中文");
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> letter(0, static_cast<int>(alphabet.size()) - 1);
+    auto randomString = [&](int maxLength) {
+        QString s;
+        const int length = std::uniform_int_distribution<int>(1, maxLength)(rng);
+        for (int i = 0; i < length; ++i)
+            s.append(alphabet.at(letter(rng)));
+        return s;
+    };
+
+    for (int round = 0; round < 20; ++round) {
+        QStringList keywords;
+        for (int i = 0; i < 30; ++i)
+            keywords.append(randomString(5));
+        const KeywordFilter filter(keywords);
+
+        for (int i = 0; i < 200; ++i) {
+            const QString text = randomString(24);
+            bool expected = false;
+            for (const QString &keyword : keywords)
+                expected = expected || text.contains(keyword, Qt::CaseInsensitive);
+            int index = -1;
+            QCOMPARE(filter.matches(QStringView(text), &index), expected);
+            QCOMPARE(filter.matches(QUtf8StringView(text.toUtf8())), expected);
+            if (expected)
+                QVERIFY(text.contains(filter.keyword(index), Qt::CaseInsensitive));
+        }
+    }
+}
+
+void TestKeywordFilter::testParse()
+{
+    const QStringList keywords = KeywordFilter::parse(QStringLiteral("# 注释\n  广告 \r\n\nspam\n#\n"));
+    QCOMPARE(keywords, QStringList({ QStringLiteral("广告"), QStringLiteral("spam") }));
+}
+
+void TestKeywordFilter::testLoaderReadsFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("blocklist.txt"));
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("# 注释\n广告\n");
+    file.close();
+
+    KeywordFilterLoader loader;
+    QSignalSpy spy(&loader, &KeywordFilterLoader::reloaded);
+    loader.rebuild(path, QStringList());
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toInt(), 1);
+    QVERIFY(loader.isBlocked(QStringView(u"加我看广告")));
+
+    // 文件不存在时为空表
+    loader.rebuild(dir.filePath(QStringLiteral("missing.txt")), QStringList());
+    QTRY_COMPARE(spy.count(), 2);
+    QVERIFY(!loader.isBlocked(QStringView(u"加我看广告")));
+}
+
+void TestKeywordFilter::testLoaderDiscardsStaleBuild()
+{
+    GatedLoader loader;
+    QSignalSpy spy(&loader, &KeywordFilterLoader::reloaded);
+    const std::shared_ptr<const KeywordFilter> initial = loader.filter();
+
+    // 旧的构建已在线程池中运行，新的提交无法取消它，只能在结果到达时按 generation 丢弃
+    const quint64 older = loader.rebuild(QStringLiteral("older"), QStringList());
+    loader.entered.acquire();
+    const quint64 newer = loader.rebuild(QStringLiteral("newer"), QStringList());
+    QVERIFY(newer > older);
+    QVERIFY(loader.filter() == initial);
+    loader.gate.release();
+
+    QTRY_COMPARE(spy.count(), 1);
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(loader.reads.load(), 2);
+    QVERIFY(loader.isBlocked(QStringView(u"newer")));
+    QVERIFY(!loader.isBlocked(QStringView(u"older")));
+}
+
+QTEST_MAIN(TestKeywordFilter)
+#include "test_keywordfilter.moc"
@@ -0,0 +1,92 @@
+#include <QtTest/QtTest>
+#include <thread>
+#include <vector>
+#include "pipelinemetrics.h"
+
+class TestPipelineMetrics : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testPercentiles();
+    void testCounters();
+    void testConcurrentRecord();
+};
+
+void TestPipelineMetrics::testPercentiles()
+{
+    PipelineMetrics metrics;
+    // 99 个 10us 样本、1 个 5ms 样本
+    for (int i = 0; i < 99; ++i)
+        metrics.record(PipelineMetrics::Stage::Decode, 10'000);
+    metrics.record(PipelineMetrics::Stage::Decode, 5'000'000);
+
+    const PipelineMetrics::Snapshot snapshot = metrics.snapshot();
+    const PipelineMetrics::StageStats &decode = snapshot.stage(PipelineMetrics::Stage::Decode);
+    QCOMPARE(decode.count, quint64(100));
+    QCOMPARE(decode.p50Us, 16.0);   // 10us 落在 [8, 16) 桶
+    QCOMPARE(decode.p95Us, 16.0);
+    QCOMPARE(decode.maxUs, 5000.0);
+    QVERIFY(qAbs(decode.meanUs - 59.9) < 0.01);
+
+    QCOMPARE(snapshot.stage(PipelineMetrics::Stage::Read).count, quint64(0));
+}
+
+void TestPipelineMetrics::testCounters()
+{
+    PipelineMetrics metrics;
+    metrics.addFrameDecoded();
+    metrics.addFrameDecoded();
+    metrics.addFrameOutput();
+    metrics.addFrameDropped(true);
+    metrics.addFrameDropped(false);
+
+    PipelineMetrics::Snapshot snapshot = metrics.snapshot();
+    QCOMPARE(snapshot.framesDecoded, quint64(2));
+    QCOMPARE(snapshot.framesOutput, quint64(1));
+    QCOMPARE(snapshot.framesDropped, quint64(2));
+    QCOMPARE(snapshot.framesLate, quint64(1));
+
+    metrics.reset();
+    snapshot = metrics.snapshot();
+    QCOMPARE(snapshot.framesDecoded, quint64(0));
+    QCOMPARE(snapshot.framesDropped, quint64(0));
+}
+
+void TestPipelineMetrics::testConcurrentRecord()
+{
+    PipelineMetrics metrics;
+    constexpr int kPerThread = 100000;
+
+    // 写线程与读线程并发，快照只要求单调且不越界
+    std::atomic<bool> done{false};
+    bool monotonic = true;
+    std::thread reader([&]() {
+        quint64 last = 0;
+        while (!done) {
+            const quint64 count = metrics.snapshot().stage(PipelineMetrics::Stage::Read).count;
+            monotonic = monotonic && count >= last;
+            last = count;
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&metrics, t]() {
+            for (int i = 0; i < kPerThread; ++i)
+                metrics.record(PipelineMetrics::Stage::Read, (i % 1000) * 1000 + t);
+        });
+    }
+    for (std::thread &writer : writers)
+        writer.join();
+    done = true;
+    reader.join();
+    QVERIFY(monotonic);
+
+    const PipelineMetrics::StageStats read = metrics.snapshot().stage(PipelineMetrics::Stage::Read);
+    QCOMPARE(read.count, quint64(4 * kPerThread));
+    QVERIFY(read.maxUs >= 999.0);
+}
+
+QTEST_MAIN(TestPipelineMetrics)
+#include "test_pipelinemetrics.moc"
@@ -0,0 +1,54 @@
+#include <QtTest/QtTest>
+#include <QThread>
+#include "scaletarget.h"
+
+class TestScaleTarget : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testFit();
+    void testDebounce();
+};
+
+void TestScaleTarget::testFit()
+{
+    ScaleTarget target(std::chrono::milliseconds(0));
+    QCOMPARE(target.outputSize(1920, 1080), QSize(1920, 1080));   // 未设置
+
+    target.set(QSize(640, 480));
+    QCOMPARE(target.outputSize(1920, 1080), QSize(640, 360));     // 按宽度适配
+    QCOMPARE(target.outputSize(1080, 1920), QSize(270, 480));     // 竖屏按高度适配
+    QCOMPARE(target.outputSize(320, 240), QSize(320, 240));       // 不放大
+
+    target.set(QSize(1800, 1000));
+    QCOMPARE(target.outputSize(1920, 1080), QSize(1920, 1080));   // 缩小幅度太小，保持源尺寸
+
+    target.set(QSize(333, 333));
+    const QSize odd = target.outputSize(1920, 1080);
+    QCOMPARE(odd.width() % 2, 0);
+    QCOMPARE(odd.height() % 2, 0);
+
+    target.set(QSize());
+    QCOMPARE(target.outputSize(1920, 1080), QSize(1920, 1080));
+}
+
+void TestScaleTarget::testDebounce()
+{
+    ScaleTarget target(std::chrono::milliseconds(50));
+    target.set(QSize(640, 360));
+    QThread::msleep(60);
+    QCOMPARE(target.outputSize(1920, 1080), QSize(640, 360));
+
+    // 连续变化期间保持旧尺寸
+    target.set(QSize(480, 270));
+    QCOMPARE(target.outputSize(1920, 1080), QSize(640, 360));
+    target.set(QSize(320, 180));
+    QCOMPARE(target.outputSize(1920, 1080), QSize(640, 360));
+
+    QThread::msleep(60);
+    QCOMPARE(target.outputSize(1920, 1080), QSize(320, 180));
+}
+
+QTEST_MAIN(TestScaleTarget)
+#include "test_scaletarget.moc"
@@ -0,0 +1,178 @@
+#include <QtTest/QtTest>
+#include <QImageWriter>
+#include <QTemporaryDir>
+#include "thumbnailservice.h"
+#include "syntheticclip.h"
+#include "type.h"
+
+// 缩略图缓存：重复请求走内存缓存，并发请求只解码一次，缓存键跟随文件内容而不是路径
+class TestThumbnailService : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanupTestCase();
+    void testSecondRequestIsLookupHit();
+    void testConcurrentRequestsCoalesce();
+    void testCopiedFileSharesCache();
+    void testDiskCacheAcrossInstances();
+
+private:
+    struct Result {
+        quint64 id = 0;
+        QImage image;
+    };
+
+    void collect(ThumbnailService *service);
+
+    QTemporaryDir dir_;
+    QString clip_;
+    QVector<Result> ready_;
+    QVector<quint64> failed_;
+};
+
+void TestThumbnailService::initTestCase()
+{
+    // 磁盘缓存落到测试专用目录，不影响真实用户缓存
+    QStandardPaths::setTestModeEnabled(true);
+
+    QVERIFY(dir_.isValid());
+    clip_ = dir_.filePath("synthetic.mkv");
+    synthetic::ClipSpec spec;
+    spec.frames = 250;
+    spec.gop = 25;
+    QString error;
+    if (!synthetic::writeClip(clip_, spec, nullptr, &error))
+        QSKIP(qPrintable("cannot generate synthetic clip: " + error));
+}
+
+void TestThumbnailService::init()
+{
+    QVERIFY(QDir(zg::path::thumbnailCacheDir()).removeRecursively());
+    ready_.clear();
+    failed_.clear();
+}
+
+void TestThumbnailService::cleanupTestCase()
+{
+    QDir(zg::path::thumbnailCacheDir()).removeRecursively();
+}
+
+void TestThumbnailService::collect(ThumbnailService *service)
+{
+    // 信号来自线程池，排队到测试线程再记录
+    connect(service, &ThumbnailService::thumbnailReady, this,
+            [this](quint64 id, const QString &, double, const QImage &image) { ready_.append({ id, image }); });
+    connect(service, &ThumbnailService::thumbnailFailed, this,
+            [this](quint64 id, const QString &, double) { failed_.append(id); });
+}
+
+void TestThumbnailService::testSecondRequestIsLookupHit()
+{
+    ThumbnailService service(2);
+    collect(&service);
+    const QSize maxSize(160, 90);
+
+    QImage image;
+    QVERIFY(!service.lookup(clip_, 2.0, maxSize, &image));
+
+    const quint64 first = service.request(clip_, 2.0, maxSize);
+    QTRY_COMPARE(ready_.size(), 1);
+    QVERIFY(failed_.isEmpty());
+    QCOMPARE(ready_[0].id, first);
+    // 16:9 源按 maxSize 等比缩小
+    QCOMPARE(ready_[0].image.size(), maxSize);
+    QCOMPARE(service.stats().decodes, quint64(1));
+
+    // 第二次：lookup 直接命中内存缓存，不再解码
+    QVERIFY(service.lookup(clip_, 2.0, maxSize, &image));
+    QCOMPARE(image, ready_[0].image);
+    ThumbnailService::Stats stats = service.stats();
+    QCOMPARE(stats.memoryHits, quint64(1));
+    QCOMPARE(stats.decodes, quint64(1));
+
+    // request 同样命中，仍经由事件循环回调
+    const quint64 second = service.request(clip_, 2.0, maxSize);
+    QCOMPARE(ready_.size(), 1);
+    QTRY_COMPARE(ready_.size(), 2);
+    QCOMPARE(ready_[1].id, second);
+    stats = service.stats();
+    QCOMPARE(stats.memoryHits, quint64(2));
+    QCOMPARE(stats.decodes, quint64(1));
+    QCOMPARE(stats.diskHits, quint64(0));
+
+    // 时间点按 100ms 取整后相同的请求共用缓存，不同尺寸则不共用
+    QVERIFY(service.lookup(clip_, 2.04, maxSize, &image));
+    QVERIFY(!service.lookup(clip_, 2.0, QSize(320, 180), &image));
+}
+
+void TestThumbnailService::testConcurrentRequestsCoalesce()
+{
+    ThumbnailService service(4);
+    collect(&service);
+
+    constexpr int kRequests = 8;
+    for (int i = 0; i < kRequests; ++i)
+        service.request(clip_, 5.0);
+
+    QTRY_COMPARE(ready_.size(), kRequests);
+    QVERIFY(failed_.isEmpty());
+    for (const Result &result : std::as_const(ready_))
+        QCOMPARE(result.image, ready_[0].image);
+
+    // 在途请求挂到同一次解码上，或在解码完成后命中内存缓存
+    QCOMPARE(service.stats().decodes, quint64(1));
+    QCOMPARE(service.stats().diskHits, quint64(0));
+}
+
+void TestThumbnailService::testCopiedFileSharesCache()
+{
+    ThumbnailService service(2);
+    collect(&service);
+
+    service.request(clip_, 3.0);
+    QTRY_COMPARE(ready_.size(), 1);
+    QCOMPARE(service.stats().decodes, quint64(1));
+
+    // 缓存键由内容指纹决定：复制（或改名）后的文件直接命中
+    const QString copy = dir_.filePath("copy.mkv");
+    QFile::remove(copy);
+    QVERIFY(QFile::copy(clip_, copy));
+
+    QImage image;
+    QVERIFY(!service.lookup(copy, 3.0, QSize(160, 90), &image));  // 新路径的指纹尚未算过
+    service.request(copy, 3.0);
+    QTRY_COMPARE(ready_.size(), 2);
+    QCOMPARE(ready_[1].image, ready_[0].image);
+    QCOMPARE(service.stats().decodes, quint64(1));
+    QVERIFY(service.lookup(copy, 3.0, QSize(160, 90), &image));
+}
+
+void TestThumbnailService::testDiskCacheAcrossInstances()
+{
+    if (!QImageWriter::supportedImageFormats().contains("jpg"))
+        QSKIP("JPEG image plugin not available");
+
+    {
+        ThumbnailService service(2);
+        collect(&service);
+        service.request(clip_, 4.0);
+        QTRY_COMPARE(ready_.size(), 1);
+        QCOMPARE(service.stats().decodes, quint64(1));
+    }
+
+    // 新实例没有内存缓存，从磁盘缓存读出，不打开 FFmpeg
+    ThumbnailService service(2);
+    collect(&service);
+    service.request(clip_, 4.0);
+    QTRY_COMPARE(ready_.size(), 2);
+    QCOMPARE(ready_[1].image.size(), ready_[0].image.size());
+    const ThumbnailService::Stats stats = service.stats();
+    QCOMPARE(stats.diskHits, quint64(1));
+    QCOMPARE(stats.decodes, quint64(0));
+}
+
+QTEST_MAIN(TestThumbnailService)
+#include "test_thumbnailservice.moc"
@@ -0,0 +1,267 @@
+#include <QtTest/QtTest>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "yuvconvert.h"
+
+extern "C" {
+#include <libswscale/swscale.h>
+#include <libavutil/frame.h>
+}
+
+// 对照 swscale 与浮点公式验证 YuvConverter，并确认各 SIMD 实现与标量逐字节一致
+class TestYuvConvert : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+    void testMatchesFormula();
+    void testIsaBitExact();
+    void testMatchesSwscale_data();
+    void testMatchesSwscale();
+    void testFlip();
+
+private:
+    struct Image {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> y, u, v, uv;
+    };
+
+    static Image gradient(int width, int height);
+    static YuvConverter::Source source(const Image &image, YuvConverter::Format format);
+    static std::vector<uint8_t> convert(const YuvConverter::Source &src, int width, int height,
+                                        const YuvConverter::Options &options);
+};
+
+void TestYuvConvert::cleanup()
+{
+    YuvConverter::setIsa(YuvConverter::bestSupportedIsa());
+}
+
+TestYuvConvert::Image TestYuvConvert::gradient(int width, int height)
+{
+    // 平滑渐变，避免色度采样位置约定的差异主导误差
+    Image image;
+    image.width = width;
+    image.height = height;
+    const int cw = (width + 1) / 2;
+    const int ch = (height + 1) / 2;
+    image.y.resize(static_cast<size_t>(width) * height);
+    image.u.resize(static_cast<size_t>(cw) * ch);
+    image.v.resize(image.u.size());
+    image.uv.resize(image.u.size() * 2);
+    for (int row = 0; row < height; ++row)
+        for (int x = 0; x < width; ++x)
+            image.y[row * width + x] = static_cast<uint8_t>(16 + (x + row) * 219 / (width + height));
+    for (int row = 0; row < ch; ++row) {
+        for (int x = 0; x < cw; ++x) {
+            const size_t i = static_cast<size_t>(row) * cw + x;
+            image.u[i] = static_cast<uint8_t>(32 + x * 192 / cw);
+            image.v[i] = static_cast<uint8_t>(224 - row * 192 / ch);
+            image.uv[2 * i] = image.u[i];
+            image.uv[2 * i + 1] = image.v[i];
+        }
+    }
+    return image;
+}
+
+YuvConverter::Source TestYuvConvert::source(const Image &image, YuvConverter::Format format)
+{
+    const int cw = (image.width + 1) / 2;
+    YuvConverter::Source src;
+    src.format = format;
+    src.width = image.width;
+    src.height = image.height;
+    src.y = image.y.data();
+    src.yStride = image.width;
+    if (format == YuvConverter::Format::NV12) {
+        src.u = image.uv.data();
+        src.uStride = cw * 2;
+    } else {
+        src.u = image.u.data();
+        src.v = image.v.data();
+        src.uStride = cw;
+        src.vStride = cw;
+    }
+    return src;
+}
+
+std::vector<uint8_t> TestYuvConvert::convert(const YuvConverter::Source &src, int width, int height,
+                                             const YuvConverter::Options &options)
+{
+    std::vector<uint8_t> out(static_cast<size_t>(width) * height * 4);
+    YuvConverter::toRgba(src, out.data(), width * 4, width, height, options);
+    return out;
+}
+
+void TestYuvConvert::testMatchesFormula()
+{
+    // 定点误差：与浮点公式相比不超过 1
+    for (bool full : { false, true }) {
+        for (YuvConverter::ColorSpace space : { YuvConverter::ColorSpace::Bt601, YuvConverter::ColorSpace::Bt709 }) {
+            const bool bt709 = space == YuvConverter::ColorSpace::Bt709;
+            const double kr = bt709 ? 0.2126 : 0.299;
+            const double kb = bt709 ? 0.0722 : 0.114;
+            const double kg = 1.0 - kr - kb;
+            const double ys = full ? 1.0 : 255.0 / 219.0;
+            const double cs = full ? 1.0 : 255.0 / 224.0;
+
+            YuvConverter::Options options;
+            options.colorSpace = space;
+            options.fullRange = full;
+
+            int maxError = 0;
+            for (int yv = 0; yv < 256; ++yv) {
+                for (int uv = 0; uv < 256; uv += 3) {
+                    for (int vv = 0; vv < 256; vv += 3) {
+                        const uint8_t y[2] = { uint8_t(yv), uint8_t(yv) };
+                        const uint8_t u = uint8_t(uv);
+                        const uint8_t v = uint8_t(vv);
+                        YuvConverter::Source src;
+                        src.width = 2;
+                        src.height = 1;
+                        src.y = y;
+                        src.u = &u;
+                        src.v = &v;
+                        src.yStride = 2;
+                        src.uStride = 1;
+                        src.vStride = 1;
+                        const std::vector<uint8_t> out = convert(src, 2, 1, options);
+
+                        const double yy = (yv - (full ? 0 : 16)) * ys;
+                        const double cu = (uv - 128) * cs;
+                        const double cv = (vv - 128) * cs;
+                        const double rgb[3] = {
+                            yy + 2.0 * (1.0 - kr) * cv,
+                            yy - 2.0 * (1.0 - kb) * kb / kg * cu - 2.0 * (1.0 - kr) * kr / kg * cv,
+                            yy + 2.0 * (1.0 - kb) * cu,
+                        };
+                        for (int c = 0; c < 3; ++c) {
+                            const int expected = int(std::lround(std::clamp(rgb[c], 0.0, 255.0)));
+                            maxError = std::max(maxError, std::abs(expected - out[c]));
+                        }
+                        QCOMPARE(out[3], uint8_t(0xff));
+                    }
+                }
+            }
+            QVERIFY2(maxError <= 1, qPrintable(QString("max error %1").arg(maxError)));
+        }
+    }
+}
+
+void TestYuvConvert::testIsaBitExact()
+{
+    std::mt19937 rng(11);
+    const YuvConverter::Isa best = YuvConverter::bestSupportedIsa();
+    for (int trial = 0; trial < 100; ++trial) {
+        // 覆盖奇数尺寸、尾部像素、缩放与 NV12
+        Image image;
+        image.width = 1 + int(rng() % 200);
+        image.height = 1 + int(rng() % 24);
+        const int cw = (image.width + 1) / 2;
+        const int ch = (image.height + 1) / 2;
+        image.y.resize(size_t(image.width) * image.height);
+        image.u.resize(size_t(cw) * ch);
+        image.v.resize(image.u.size());
+        image.uv.resize(image.u.size() * 2);
+        for (std::vector<uint8_t> *plane : { &image.y, &image.u, &image.v, &image.uv })
+            for (uint8_t &b : *plane)
+                b = uint8_t(rng());
+
+        const int dstWidth = trial % 3 == 0 ? 1 + int(rng() % 200) : image.width;
+        const int dstHeight = trial % 3 == 0 ? 1 + int(rng() % 24) : image.height;
+        YuvConverter::Options options;
+        options.fullRange = trial & 1;
+        options.flipVertical = trial & 2;
+        const YuvConverter::Format format = trial & 4 ? YuvConverter::Format::NV12 : YuvConverter::Format::I420;
+
+        YuvConverter::setIsa(YuvConverter::Isa::Scalar);
+        const std::vector<uint8_t> reference = convert(source(image, format), dstWidth, dstHeight, options);
+        for (int isa = 1; isa <= static_cast<int>(best); ++isa) {
+            YuvConverter::setIsa(static_cast<YuvConverter::Isa>(isa));
+            QVERIFY(convert(source(image, format), dstWidth, dstHeight, options) == reference);
+        }
+    }
+}
+
+void TestYuvConvert::testMatchesSwscale_data()
+{
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<int>("dstWidth");
+    QTest::addColumn<int>("dstHeight");
+    QTest::addColumn<bool>("nv12");
+
+    QTest::newRow("i420 1280x720") << 1280 << 720 << 1280 << 720 << false;
+    QTest::newRow("nv12 1280x720") << 1280 << 720 << 1280 << 720 << true;
+    QTest::newRow("i420 odd") << 333 << 191 << 333 << 191 << false;
+    QTest::newRow("i420 scale down") << 1920 << 1080 << 640 << 360 << false;
+    QTest::newRow("nv12 scale down") << 1920 << 1080 << 480 << 270 << true;
+}
+
+void TestYuvConvert::testMatchesSwscale()
+{
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(int, dstWidth);
+    QFETCH(int, dstHeight);
+    QFETCH(bool, nv12);
+
+    const Image image = gradient(width, height);
+    const YuvConverter::Format format = nv12 ? YuvConverter::Format::NV12 : YuvConverter::Format::I420;
+    YuvConverter::Options options;
+    options.colorSpace = YuvConverter::ColorSpace::Bt709;
+    const std::vector<uint8_t> ours = convert(source(image, format), dstWidth, dstHeight, options);
+
+    const YuvConverter::Source src = source(image, format);
+    const uint8_t *srcData[4] = { src.y, src.u, src.v, nullptr };
+    const int srcStride[4] = { src.yStride, src.uStride, src.vStride, 0 };
+    std::vector<uint8_t> theirs(ours.size());
+    uint8_t *dstData[4] = { theirs.data(), nullptr, nullptr, nullptr };
+    const int dstStride[4] = { dstWidth * 4, 0, 0, 0 };
+
+    SwsContext *sws = sws_getContext(width, height, nv12 ? AV_PIX_FMT_NV12 : AV_PIX_FMT_YUV420P,
+                                     dstWidth, dstHeight, AV_PIX_FMT_RGBA,
+                                     SWS_BILINEAR | SWS_ACCURATE_RND | SWS_FULL_CHR_H_INT,
+                                     nullptr, nullptr, nullptr);
+    QVERIFY(sws);
+    const int *coefficients = sws_getCoefficients(SWS_CS_ITU709);
+    sws_setColorspaceDetails(sws, coefficients, 0, coefficients, 1, 0, 1 << 16, 1 << 16);
+    sws_scale(sws, srcData, srcStride, 0, height, dstData, dstStride);
+    sws_freeContext(sws);
+
+    double total = 0.0;
+    int maxError = 0;
+    for (size_t i = 0; i < ours.size(); ++i) {
+        if (i % 4 == 3)
+            continue;
+        const int error = std::abs(int(ours[i]) - int(theirs[i]));
+        total += error;
+        maxError = std::max(maxError, error);
+    }
+    const double meanError = total / (ours.size() / 4 * 3);
+    QVERIFY2(meanError < 1.5, qPrintable(QString("mean error %1").arg(meanError)));
+    QVERIFY2(maxError <= 8, qPrintable(QString("max error %1").arg(maxError)));
+}
+
+void TestYuvConvert::testFlip()
+{
+    const Image image = gradient(64, 31);
+    const YuvConverter::Source src = source(image, YuvConverter::Format::I420);
+    YuvConverter::Options options;
+    const std::vector<uint8_t> upright = convert(src, 64, 31, options);
+    options.flipVertical = true;
+    const std::vector<uint8_t> flipped = convert(src, 64, 31, options);
+
+    const size_t rowBytes = 64 * 4;
+    for (int row = 0; row < 31; ++row) {
+        QVERIFY(std::equal(upright.begin() + row * rowBytes, upright.begin() + (row + 1) * rowBytes,
+                           flipped.begin() + (30 - row) * rowBytes));
+    }
+}
+
+QTEST_MAIN(TestYuvConvert)
+#include "test_yuvconvert.moc"